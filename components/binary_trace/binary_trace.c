@@ -0,0 +1,190 @@
+/*
+ * Deferred-formatting binary trace
+ *
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "binary_trace.h"
+#include <stdatomic.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+uint32_t binary_trace_float_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+#ifdef CONFIG_OPENER_BINARY_TRACE
+
+#define RING_WORDS  (CONFIG_OPENER_BINARY_TRACE_BUFFER_KB * 1024 / 4)
+#define RING_MASK   (RING_WORDS - 1)
+#define HEADER_WORDS 3  // info, format address, timestamp
+
+_Static_assert((RING_WORDS & RING_MASK) == 0,
+               "CONFIG_OPENER_BINARY_TRACE_BUFFER_KB must be a power of two");
+
+/*
+ * One ring per core. Only tasks and interrupts on that core write to it, and
+ * they do so with local interrupts masked, so writers need no lock and never
+ * wait for the other core. head and tail are free-running word counters:
+ * [tail, head) holds whole records. A writer that needs room moves tail past
+ * the oldest records before overwriting them, so a reader on the other core
+ * can copy without a lock and then drop whatever tail has moved past.
+ */
+typedef struct {
+    atomic_uint_least32_t head;
+    atomic_uint_least32_t tail;
+    uint32_t overwritten;
+    uint32_t words[RING_WORDS];
+} trace_ring_t;
+
+static trace_ring_t s_rings[portNUM_PROCESSORS];
+
+void binary_trace_write(const char *fmt, uint32_t nargs, const uint32_t *args)
+{
+    if (nargs > BINARY_TRACE_MAX_ARGS) {
+        nargs = BINARY_TRACE_MAX_ARGS;
+    }
+    uint32_t len = HEADER_WORDS + nargs;
+    
+    UBaseType_t irq_state = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint32_t timestamp = (uint32_t)esp_timer_get_time();
+    trace_ring_t *ring = &s_rings[xPortGetCoreID()];
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    
+    if (head + len - tail > RING_WORDS) {
+        // Make room by dropping the oldest records, then publish the new tail
+        // before their words are reused
+        do {
+            tail += HEADER_WORDS + (ring->words[tail & RING_MASK] & 0xFF);
+            ring->overwritten++;
+        } while (head + len - tail > RING_WORDS);
+        atomic_store_explicit(&ring->tail, tail, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+    }
+    
+    ring->words[head & RING_MASK] = (BINARY_TRACE_RECORD_MAGIC << 24) | nargs;
+    ring->words[(head + 1) & RING_MASK] = (uint32_t)(uintptr_t)fmt;
+    ring->words[(head + 2) & RING_MASK] = timestamp;
+    for (uint32_t i = 0; i < nargs; i++) {
+        ring->words[(head + HEADER_WORDS + i) & RING_MASK] = args[i];
+    }
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+    
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq_state);
+}
+
+size_t binary_trace_snapshot(uint32_t core, uint32_t *words, size_t max_words)
+{
+    if (core >= portNUM_PROCESSORS || words == NULL || max_words < RING_WORDS) {
+        return 0;
+    }
+    trace_ring_t *ring = &s_rings[core];
+    
+    // Retry if the writer laps the copy completely (only under a trace storm)
+    for (int attempt = 0; attempt < 4; attempt++) {
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if ((int32_t)(head - tail) < 0 || head - tail > RING_WORDS) {
+            continue;  // Read head and tail on either side of a write
+        }
+        
+        uint32_t count = head - tail;
+        for (uint32_t i = 0; i < count; i++) {
+            words[i] = ring->words[(tail + i) & RING_MASK];
+        }
+        
+        // Words before the current tail may have been reused while copying
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t new_tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        if ((int32_t)(new_tail - tail) <= 0) {
+            return count;
+        }
+        if ((int32_t)(head - new_tail) <= 0) {
+            continue;
+        }
+        uint32_t dropped = new_tail - tail;
+        memmove(words, words + dropped, (count - dropped) * sizeof(uint32_t));
+        return count - dropped;
+    }
+    return 0;
+}
+
+size_t binary_trace_ring_words(void)
+{
+    return RING_WORDS;
+}
+
+uint32_t binary_trace_overwritten(uint32_t core)
+{
+    return (core < portNUM_PROCESSORS) ? s_rings[core].overwritten : 0;
+}
+
+void binary_trace_clear(void)
+{
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_ring_t *ring = &s_rings[core];
+        // Moving tail up to head discards everything. A writer that is making
+        // room at the same moment may bring back a few old records.
+        atomic_store_explicit(&ring->tail, atomic_load_explicit(&ring->head, memory_order_acquire),
+                              memory_order_release);
+        ring->overwritten = 0;
+    }
+}
+
+#else // CONFIG_OPENER_BINARY_TRACE
+
+void binary_trace_write(const char *fmt, uint32_t nargs, const uint32_t *args)
+{
+    (void)fmt;
+    (void)nargs;
+    (void)args;
+}
+
+size_t binary_trace_snapshot(uint32_t core, uint32_t *words, size_t max_words)
+{
+    (void)core;
+    (void)words;
+    (void)max_words;
+    return 0;
+}
+
+size_t binary_trace_ring_words(void)
+{
+    return 0;
+}
+
+uint32_t binary_trace_overwritten(uint32_t core)
+{
+    (void)core;
+    return 0;
+}
+
+void binary_trace_clear(void)
+{
+}
+
+#endif // CONFIG_OPENER_BINARY_TRACE
@@ -0,0 +1,157 @@
+/*
+ * Deferred-formatting binary trace
+ *
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file binary_trace.h
+ * @brief Deferred-formatting binary trace
+ *
+ * BINARY_TRACE(fmt, ...) records the address of the format string, a
+ * microsecond timestamp and the raw argument words into a ring owned by the
+ * calling core, with local interrupts masked for the few stores involved.
+ * Nothing is formatted on the device. tools/trace_decode.py reads a dump of
+ * the rings (GET /api/trace) together with the firmware ELF, looks up the
+ * format strings and prints the lines.
+ *
+ * Arguments are stored as 32-bit words: integers and pointers as is (64-bit
+ * integers are truncated), float and double as float bits. A %s argument is
+ * only the pointer, so the decoder can show strings that live in the firmware
+ * image (literals, __func__) but not strings built at run time.
+ *
+ * Each ring keeps the newest records and overwrites the oldest ones. The
+ * format string must be a string literal.
+ *
+ * Without CONFIG_OPENER_BINARY_TRACE the macro expands to nothing and its
+ * arguments are not evaluated.
+ */
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BINARY_TRACE_MAX_ARGS     14
+#define BINARY_TRACE_RECORD_MAGIC 0xB7u   /**< Top byte of the first word of every record */
+#define BINARY_TRACE_DUMP_MAGIC   0x43525442u  /**< "BTRC" */
+#define BINARY_TRACE_DUMP_VERSION 1
+
+/**
+ * @brief Record one trace line (use BINARY_TRACE instead)
+ *
+ * @param fmt printf-style format string in the firmware image
+ * @param nargs Number of argument words
+ * @param args Argument words
+ */
+void binary_trace_write(const char *fmt, uint32_t nargs, const uint32_t *args);
+
+/**
+ * @brief Copy the records of one core's ring, oldest first
+ *
+ * Only whole records are copied. Safe to call while other tasks trace.
+ *
+ * @param core Core number
+ * @param words Output buffer
+ * @param max_words Size of words, at least binary_trace_ring_words()
+ * @return Number of words copied
+ */
+size_t binary_trace_snapshot(uint32_t core, uint32_t *words, size_t max_words);
+
+/**
+ * @brief Capacity of each core's ring in 32-bit words (0 when disabled)
+ */
+size_t binary_trace_ring_words(void);
+
+/**
+ * @brief Records overwritten on a core since boot (or the last clear)
+ */
+uint32_t binary_trace_overwritten(uint32_t core);
+
+/**
+ * @brief Discard all records
+ */
+void binary_trace_clear(void);
+
+/* Argument capture ***********************************************************/
+
+uint32_t binary_trace_float_bits(float value);
+
+// float and double are stored as float bits, everything else as an integer word
+#define BINARY_TRACE_IS_FLOAT(x)                                               \
+  (__builtin_types_compatible_p(__typeof__(x), float) ||                       \
+   __builtin_types_compatible_p(__typeof__(x), double))
+#define BINARY_TRACE_ARG(x)                                                    \
+  __builtin_choose_expr(BINARY_TRACE_IS_FLOAT(x),                              \
+    binary_trace_float_bits(__builtin_choose_expr(BINARY_TRACE_IS_FLOAT(x), (x), 0.0f)), \
+    (uint32_t)(uintptr_t)(x))
+
+#define BINARY_TRACE_A0() 0
+#define BINARY_TRACE_A1(a) BINARY_TRACE_ARG(a)
+#define BINARY_TRACE_A2(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A1(__VA_ARGS__)
+#define BINARY_TRACE_A3(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A2(__VA_ARGS__)
+#define BINARY_TRACE_A4(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A3(__VA_ARGS__)
+#define BINARY_TRACE_A5(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A4(__VA_ARGS__)
+#define BINARY_TRACE_A6(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A5(__VA_ARGS__)
+#define BINARY_TRACE_A7(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A6(__VA_ARGS__)
+#define BINARY_TRACE_A8(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A7(__VA_ARGS__)
+#define BINARY_TRACE_A9(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A8(__VA_ARGS__)
+#define BINARY_TRACE_A10(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A9(__VA_ARGS__)
+#define BINARY_TRACE_A11(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A10(__VA_ARGS__)
+#define BINARY_TRACE_A12(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A11(__VA_ARGS__)
+#define BINARY_TRACE_A13(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A12(__VA_ARGS__)
+#define BINARY_TRACE_A14(a, ...) BINARY_TRACE_ARG(a), BINARY_TRACE_A13(__VA_ARGS__)
+
+// Number of arguments after the format string (at most BINARY_TRACE_MAX_ARGS)
+#define BINARY_TRACE_COUNT(...)                                                \
+  BINARY_TRACE_COUNT_(__VA_ARGS__, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define BINARY_TRACE_COUNT_(fmt, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, \
+                            a12, a13, a14, n, ...) n
+
+#define BINARY_TRACE_CAT(a, b) BINARY_TRACE_CAT_(a, b)
+#define BINARY_TRACE_CAT_(a, b) a##b
+
+#define BINARY_TRACE_WRITE(n, fmt, ...)                                        \
+  do {                                                                         \
+    const uint32_t binary_trace_args_[] = { BINARY_TRACE_CAT(BINARY_TRACE_A, n)(__VA_ARGS__) }; \
+    binary_trace_write((fmt), (n), binary_trace_args_);                        \
+  } while (0)
+
+#ifdef CONFIG_OPENER_BINARY_TRACE
+/** @brief Record a printf-style trace line without formatting it */
+#define BINARY_TRACE(...) BINARY_TRACE_WRITE(BINARY_TRACE_COUNT(__VA_ARGS__), __VA_ARGS__)
+#else
+#define BINARY_TRACE(...) do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BINARY_TRACE_H
@@ -0,0 +1,447 @@
+/*
+ * Priority-scheduled access to a shared I2C master bus
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "i2c_scheduler.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "i2c_sched";
+
+typedef struct {
+    const i2c_sched_op_t *ops;
+    size_t count;
+    i2c_sched_class_t cls;
+    int64_t submitted_us;
+    esp_err_t result;
+    SemaphoreHandle_t done;
+    StaticSemaphore_t done_buffer;
+} sched_request_t;
+
+#define MUX_SELECTION_UNKNOWN 0xFFFF
+
+typedef struct sched_device {
+    i2c_master_dev_handle_t dev;
+    struct sched_device *mux;       // Multiplexer this device sits behind, or NULL
+    uint8_t mux_port;
+    uint16_t mux_selected;          // For multiplexers: active port mask, or MUX_SELECTION_UNKNOWN
+    i2c_sched_transfer_fn_t transfer;   // Custom transport, or NULL for the I2C master driver
+    void *transfer_ctx;
+    uint64_t wait_total_us;
+    uint64_t bus_total_us;
+    uint32_t waits;
+    i2c_sched_device_stats_t stats;
+} sched_device_t;
+
+typedef struct {
+    TaskHandle_t task;
+    i2c_sched_class_t cls;
+} sched_task_t;
+
+static QueueHandle_t s_queues[I2C_SCHED_CLASS_COUNT];
+static SemaphoreHandle_t s_pending = NULL;   // One count per queued request
+static TaskHandle_t s_worker = NULL;
+
+static sched_device_t s_devices[I2C_SCHED_MAX_DEVICES];
+static size_t s_device_count = 0;
+static sched_task_t s_tasks[I2C_SCHED_MAX_TASKS];
+static size_t s_task_count = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static sched_device_t *find_device(i2c_master_dev_handle_t dev)
+{
+    for (size_t i = 0; i < s_device_count; i++) {
+        if (s_devices[i].dev == dev) {
+            return &s_devices[i];
+        }
+    }
+    return NULL;
+}
+
+static void record_wait(i2c_master_dev_handle_t dev, uint32_t wait_us)
+{
+    taskENTER_CRITICAL(&s_lock);
+    sched_device_t *device = find_device(dev);
+    if (device != NULL) {
+        device->wait_total_us += wait_us;
+        device->waits++;
+        if (wait_us > device->stats.wait_max_us) {
+            device->stats.wait_max_us = wait_us;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static void record_transaction(i2c_master_dev_handle_t dev, uint32_t bus_us, esp_err_t ret)
+{
+    taskENTER_CRITICAL(&s_lock);
+    sched_device_t *device = find_device(dev);
+    if (device != NULL) {
+        device->stats.transactions++;
+        device->bus_total_us += bus_us;
+        if (bus_us > device->stats.bus_max_us) {
+            device->stats.bus_max_us = bus_us;
+        }
+        if (ret != ESP_OK) {
+            device->stats.errors++;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+// One transfer on the bus, or through the device's transport if it has one
+static esp_err_t bus_transfer(i2c_master_dev_handle_t dev, const uint8_t *write_buf, size_t write_len,
+                             uint8_t *read_buf, size_t read_len, int timeout_ms)
+{
+    taskENTER_CRITICAL(&s_lock);
+    sched_device_t *device = find_device(dev);
+    i2c_sched_transfer_fn_t fn = device != NULL ? device->transfer : NULL;
+    void *ctx = device != NULL ? device->transfer_ctx : NULL;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (fn != NULL) {
+        return fn(ctx, write_buf, write_len, read_buf, read_len, timeout_ms);
+    }
+    if (read_len == 0) {
+        return i2c_master_transmit(dev, write_buf, write_len, timeout_ms);
+    }
+    if (write_len == 0) {
+        return i2c_master_receive(dev, read_buf, read_len, timeout_ms);
+    }
+    return i2c_master_transmit_receive(dev, write_buf, write_len, read_buf, read_len, timeout_ms);
+}
+
+// Switch the multiplexer in front of dev to its port. Only the executing task
+// (the worker, or the caller before the worker starts) touches mux_selected.
+static esp_err_t select_route(i2c_master_dev_handle_t dev, int timeout_ms)
+{
+    taskENTER_CRITICAL(&s_lock);
+    sched_device_t *device = find_device(dev);
+    sched_device_t *mux = device != NULL ? device->mux : NULL;
+    uint8_t port = device != NULL ? device->mux_port : 0;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (mux == NULL || mux->mux_selected == (1U << port)) {
+        return ESP_OK;
+    }
+
+    uint8_t mask = (uint8_t)(1U << port);
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = bus_transfer(mux->dev, &mask, 1, NULL, 0, timeout_ms);
+    record_transaction(mux->dev, (uint32_t)(esp_timer_get_time() - start), ret);
+    mux->mux_selected = (ret == ESP_OK) ? mask : MUX_SELECTION_UNKNOWN;
+    return ret;
+}
+
+static esp_err_t execute_op(const i2c_sched_op_t *op)
+{
+    esp_err_t ret = select_route(op->dev, op->timeout_ms);
+    if (ret != ESP_OK) {
+        record_transaction(op->dev, 0, ret);
+        return ret;
+    }
+
+    int64_t start = esp_timer_get_time();
+    ret = bus_transfer(op->dev, op->write_buf, op->write_len, op->read_buf, op->read_len, op->timeout_ms);
+    record_transaction(op->dev, (uint32_t)(esp_timer_get_time() - start), ret);
+    return ret;
+}
+
+// Take the next request of a class higher than (numerically below) limit
+static sched_request_t *dequeue_above(i2c_sched_class_t limit)
+{
+    sched_request_t *req;
+    for (int cls = 0; cls < (int)limit; cls++) {
+        if (xQueueReceive(s_queues[cls], &req, 0) == pdTRUE) {
+            xSemaphoreTake(s_pending, 0);
+            return req;
+        }
+    }
+    return NULL;
+}
+
+static void run_request(sched_request_t *req)
+{
+    esp_err_t ret = ESP_OK;
+    record_wait(req->ops[0].dev, (uint32_t)(esp_timer_get_time() - req->submitted_us));
+
+    for (size_t i = 0; i < req->count; i++) {
+        // Let higher classes in between the transactions of this batch.
+        // They may in turn yield to even higher classes (at most two levels).
+        if (i > 0) {
+            sched_request_t *higher;
+            while ((higher = dequeue_above(req->cls)) != NULL) {
+                run_request(higher);
+            }
+        }
+        ret = execute_op(&req->ops[i]);
+        if (ret != ESP_OK) {
+            break;
+        }
+    }
+
+    req->result = ret;
+    xSemaphoreGive(req->done);
+}
+
+static void i2c_sched_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        xSemaphoreTake(s_pending, portMAX_DELAY);
+        sched_request_t *req;
+        for (int cls = 0; cls < I2C_SCHED_CLASS_COUNT; cls++) {
+            if (xQueueReceive(s_queues[cls], &req, 0) == pdTRUE) {
+                run_request(req);
+                break;
+            }
+        }
+    }
+}
+
+esp_err_t i2c_sched_init(UBaseType_t priority)
+{
+    if (s_worker != NULL) {
+        return ESP_OK;
+    }
+
+    s_pending = xSemaphoreCreateCounting(I2C_SCHED_CLASS_COUNT * I2C_SCHED_QUEUE_DEPTH, 0);
+    if (s_pending == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int cls = 0; cls < I2C_SCHED_CLASS_COUNT; cls++) {
+        s_queues[cls] = xQueueCreate(I2C_SCHED_QUEUE_DEPTH, sizeof(sched_request_t *));
+        if (s_queues[cls] == NULL) {
+            ESP_LOGE(TAG, "Failed to create queue for class %d", cls);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    if (xTaskCreate(i2c_sched_task, "i2c_sched", 3072, NULL, priority, &s_worker) != pdPASS) {
+        s_worker = NULL;
+        ESP_LOGE(TAG, "Failed to create worker task");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "I2C scheduler started (priority %u)", (unsigned)priority);
+    return ESP_OK;
+}
+
+esp_err_t i2c_sched_register_device(i2c_master_dev_handle_t dev, uint16_t address, const char *name)
+{
+    esp_err_t ret = ESP_OK;
+    taskENTER_CRITICAL(&s_lock);
+    sched_device_t *device = find_device(dev);
+    if (device == NULL && s_device_count < I2C_SCHED_MAX_DEVICES) {
+        device = &s_devices[s_device_count++];
+        memset(device, 0, sizeof(*device));
+        device->dev = dev;
+        device->mux_selected = MUX_SELECTION_UNKNOWN;
+    }
+    if (device != NULL) {
+        device->stats.address = address;
+        strncpy(device->stats.name, name != NULL ? name : "", sizeof(device->stats.name) - 1);
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+esp_err_t i2c_sched_set_mux_route(i2c_master_dev_handle_t dev, i2c_master_dev_handle_t mux_dev,
+                                  uint8_t port)
+{
+    if (port > 7 || dev == mux_dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    taskENTER_CRITICAL(&s_lock);
+    sched_device_t *device = find_device(dev);
+    sched_device_t *mux = find_device(mux_dev);
+    if (device != NULL && mux != NULL) {
+        device->mux = mux;
+        device->mux_port = port;
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+esp_err_t i2c_sched_set_device_transport(i2c_master_dev_handle_t dev, i2c_sched_transfer_fn_t transfer,
+                                         void *ctx)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    taskENTER_CRITICAL(&s_lock);
+    sched_device_t *device = find_device(dev);
+    if (device != NULL) {
+        device->transfer = transfer;
+        device->transfer_ctx = ctx;
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+esp_err_t i2c_sched_set_task_class(TaskHandle_t task, i2c_sched_class_t cls)
+{
+    if (cls >= I2C_SCHED_CLASS_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (task == NULL) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < s_task_count; i++) {
+        if (s_tasks[i].task == task) {
+            s_tasks[i].cls = cls;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    if (ret != ESP_OK && s_task_count < I2C_SCHED_MAX_TASKS) {
+        s_tasks[s_task_count].task = task;
+        s_tasks[s_task_count].cls = cls;
+        s_task_count++;
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+i2c_sched_class_t i2c_sched_task_class(void)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    i2c_sched_class_t cls = I2C_SCHED_CLASS_DIAG;
+    taskENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < s_task_count; i++) {
+        if (s_tasks[i].task == task) {
+            cls = s_tasks[i].cls;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return cls;
+}
+
+esp_err_t i2c_sched_submit(const i2c_sched_op_t *ops, size_t count, i2c_sched_class_t cls)
+{
+    if (ops == NULL || count == 0 || cls >= I2C_SCHED_CLASS_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Not started yet, or called from the worker: nothing to schedule against
+    if (s_worker == NULL || xTaskGetCurrentTaskHandle() == s_worker) {
+        esp_err_t ret = ESP_OK;
+        for (size_t i = 0; i < count && ret == ESP_OK; i++) {
+            ret = execute_op(&ops[i]);
+        }
+        return ret;
+    }
+
+    sched_request_t req = {
+        .ops = ops,
+        .count = count,
+        .cls = cls,
+        .submitted_us = esp_timer_get_time(),
+        .result = ESP_FAIL,
+    };
+    req.done = xSemaphoreCreateBinaryStatic(&req.done_buffer);
+    sched_request_t *req_ptr = &req;
+
+    // A full queue means the bus is badly oversubscribed; fail rather than wait
+    if (xQueueSend(s_queues[cls], &req_ptr, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGW(TAG, "Queue full for class %d", cls);
+        return ESP_ERR_TIMEOUT;
+    }
+    xSemaphoreGive(s_pending);
+
+    // The worker holds a pointer to req until it gives done, so wait without timeout.
+    // Each transaction is bounded by its own driver timeout.
+    xSemaphoreTake(req.done, portMAX_DELAY);
+    return req.result;
+}
+
+esp_err_t i2c_sched_transmit(i2c_master_dev_handle_t dev, const uint8_t *write_buf,
+                             size_t write_len, int timeout_ms)
+{
+    i2c_sched_op_t op = {
+        .dev = dev,
+        .write_buf = write_buf,
+        .write_len = write_len,
+        .timeout_ms = timeout_ms,
+    };
+    return i2c_sched_submit(&op, 1, i2c_sched_task_class());
+}
+
+esp_err_t i2c_sched_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *write_buf,
+                                     size_t write_len, uint8_t *read_buf, size_t read_len,
+                                     int timeout_ms)
+{
+    i2c_sched_op_t op = {
+        .dev = dev,
+        .write_buf = write_buf,
+        .write_len = write_len,
+        .read_buf = read_buf,
+        .read_len = read_len,
+        .timeout_ms = timeout_ms,
+    };
+    return i2c_sched_submit(&op, 1, i2c_sched_task_class());
+}
+
+size_t i2c_sched_get_stats(i2c_sched_device_stats_t *out, size_t max_devices)
+{
+    size_t count = 0;
+    taskENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < s_device_count && count < max_devices; i++) {
+        const sched_device_t *device = &s_devices[i];
+        out[count] = device->stats;
+        out[count].wait_avg_us = device->waits > 0 ?
+            (uint32_t)(device->wait_total_us / device->waits) : 0;
+        out[count].bus_avg_us = device->stats.transactions > 0 ?
+            (uint32_t)(device->bus_total_us / device->stats.transactions) : 0;
+        count++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return count;
+}
+
+void i2c_sched_reset_stats(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < s_device_count; i++) {
+        sched_device_t *device = &s_devices[i];
+        device->wait_total_us = 0;
+        device->bus_total_us = 0;
+        device->waits = 0;
+        device->stats.transactions = 0;
+        device->stats.errors = 0;
+        device->stats.wait_max_us = 0;
+        device->stats.bus_max_us = 0;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,232 @@
+/*
+ * Priority-scheduled access to a shared I2C master bus
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file i2c_scheduler.h
+ * @brief Priority-scheduled access to a shared I2C master bus
+ *
+ * All transactions on the bus are executed by one worker task. Callers submit
+ * a transaction, or a batch of transactions that run back-to-back, and block
+ * until it completes. Pending work is served by priority class:
+ *
+ *   REALTIME (acquisition) > IO (I/O expanders) > DIAG (REST, diagnostics)
+ *
+ * A batch of a lower class yields to higher-class work between its
+ * transactions, so a REALTIME request waits for at most the one transaction
+ * already on the bus. REALTIME batches are never split.
+ *
+ * The class is picked per calling task: tasks registered with
+ * i2c_sched_set_task_class() use their class, all other tasks use DIAG.
+ * Per-device queue wait and bus time statistics are kept for devices
+ * registered with i2c_sched_register_device().
+ *
+ * Devices behind an I2C multiplexer (TCA9548A style: one control byte with a
+ * bit per downstream port) are given a route with i2c_sched_set_mux_route().
+ * The scheduler selects the port before each transaction to a routed device
+ * and skips the selection when the port is already active, so devices with
+ * the same address on different ports can be used from different tasks.
+ *
+ * A registered device can be given its own transport with
+ * i2c_sched_set_device_transport(). Its transactions are then handed to the
+ * transport instead of the I2C master driver, while scheduling, routing and
+ * statistics stay the same. This is used to attach simulated devices.
+ *
+ * Before i2c_sched_init() (and from the worker task itself) transactions are
+ * executed directly in the calling task.
+ */
+
+#ifndef I2C_SCHEDULER_H
+#define I2C_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/i2c_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define I2C_SCHED_MAX_DEVICES 8        /**< Devices with statistics */
+#define I2C_SCHED_MAX_TASKS 4          /**< Tasks with an explicit class */
+#define I2C_SCHED_QUEUE_DEPTH 8        /**< Pending requests per class */
+
+/**
+ * @brief Priority classes, highest first
+ */
+typedef enum {
+    I2C_SCHED_CLASS_REALTIME = 0,   /**< Sample acquisition */
+    I2C_SCHED_CLASS_IO,             /**< I/O expanders */
+    I2C_SCHED_CLASS_DIAG,           /**< REST handlers, diagnostics, calibration */
+    I2C_SCHED_CLASS_COUNT
+} i2c_sched_class_t;
+
+/**
+ * @brief One bus transaction
+ *
+ * With read_len == 0 the transaction is a write of write_buf. Otherwise
+ * write_buf (if any) is sent first and read_len bytes are read after a
+ * repeated start.
+ */
+typedef struct {
+    i2c_master_dev_handle_t dev;    /**< Target device */
+    const uint8_t *write_buf;       /**< Bytes to send (register address first) */
+    size_t write_len;               /**< Number of bytes to send */
+    uint8_t *read_buf;              /**< Receive buffer */
+    size_t read_len;                /**< Number of bytes to receive (0 = write only) */
+    int timeout_ms;                 /**< Driver timeout for this transaction */
+} i2c_sched_op_t;
+
+/**
+ * @brief Transfer function of a device transport
+ *
+ * Called with the same semantics as one i2c_sched_op_t: write_len bytes are
+ * sent first (if any), then read_len bytes are read (if any).
+ *
+ * @param ctx Context given to i2c_sched_set_device_transport()
+ * @return ESP_OK, or a driver-style error (e.g. ESP_ERR_INVALID_STATE for a NACK)
+ */
+typedef esp_err_t (*i2c_sched_transfer_fn_t)(void *ctx, const uint8_t *write_buf, size_t write_len,
+                                             uint8_t *read_buf, size_t read_len, int timeout_ms);
+
+/**
+ * @brief Statistics for one registered device
+ */
+typedef struct {
+    char name[16];                  /**< Name given at registration */
+    uint16_t address;               /**< 7-bit I2C address */
+    uint32_t transactions;          /**< Transactions executed */
+    uint32_t errors;                /**< Transactions that failed */
+    uint32_t wait_avg_us;           /**< Mean time from submit to first transaction on the bus */
+    uint32_t wait_max_us;           /**< Longest time from submit to first transaction on the bus */
+    uint32_t bus_avg_us;            /**< Mean time of one transaction on the bus */
+    uint32_t bus_max_us;            /**< Longest transaction on the bus */
+} i2c_sched_device_stats_t;
+
+/**
+ * @brief Start the scheduler worker task
+ *
+ * @param priority FreeRTOS priority of the worker; should be above every task that uses the bus
+ * @return ESP_OK on success (also if already running), ESP_ERR_NO_MEM if the task or queues could not be created
+ */
+esp_err_t i2c_sched_init(UBaseType_t priority);
+
+/**
+ * @brief Register a device for statistics
+ *
+ * @param dev Device handle from i2c_master_bus_add_device()
+ * @param address 7-bit address (for reporting only)
+ * @param name Short name for reporting
+ * @return ESP_OK, or ESP_ERR_NO_MEM if I2C_SCHED_MAX_DEVICES are already registered
+ */
+esp_err_t i2c_sched_register_device(i2c_master_dev_handle_t dev, uint16_t address, const char *name);
+
+/**
+ * @brief Route a device through a port of an I2C multiplexer
+ *
+ * Both devices must be registered first. Port selections are counted in the
+ * statistics of the multiplexer device.
+ *
+ * @param dev Device behind the multiplexer
+ * @param mux_dev Multiplexer device handle
+ * @param port Downstream port (0-7)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a bad port, ESP_ERR_NOT_FOUND if a device is not registered
+ */
+esp_err_t i2c_sched_set_mux_route(i2c_master_dev_handle_t dev, i2c_master_dev_handle_t mux_dev,
+                                  uint8_t port);
+
+/**
+ * @brief Execute a device's transactions with a custom transfer function
+ *
+ * The device handle is only used as a key, so a transport-backed device does
+ * not have to be added to an I2C master bus.
+ *
+ * @param dev Registered device handle
+ * @param transfer Transfer function, or NULL to go back to the I2C master driver
+ * @param ctx Passed to @p transfer
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if the device is not registered
+ */
+esp_err_t i2c_sched_set_device_transport(i2c_master_dev_handle_t dev, i2c_sched_transfer_fn_t transfer,
+                                         void *ctx);
+
+/**
+ * @brief Set the class used for transactions submitted by a task
+ *
+ * @param task Task handle, or NULL for the calling task
+ * @param cls Priority class
+ * @return ESP_OK, or ESP_ERR_NO_MEM if I2C_SCHED_MAX_TASKS are already registered
+ */
+esp_err_t i2c_sched_set_task_class(TaskHandle_t task, i2c_sched_class_t cls);
+
+/**
+ * @brief Execute a batch of transactions and wait for completion
+ *
+ * The batch stops at the first failing transaction.
+ *
+ * @param ops Transactions, executed in order
+ * @param count Number of transactions
+ * @param cls Priority class
+ * @return ESP_OK, ESP_ERR_TIMEOUT if the class queue stayed full, or the first driver error
+ */
+esp_err_t i2c_sched_submit(const i2c_sched_op_t *ops, size_t count, i2c_sched_class_t cls);
+
+/**
+ * @brief Write bytes to a device with the calling task's class
+ */
+esp_err_t i2c_sched_transmit(i2c_master_dev_handle_t dev, const uint8_t *write_buf,
+                             size_t write_len, int timeout_ms);
+
+/**
+ * @brief Write then read (repeated start) with the calling task's class
+ */
+esp_err_t i2c_sched_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *write_buf,
+                                     size_t write_len, uint8_t *read_buf, size_t read_len,
+                                     int timeout_ms);
+
+/**
+ * @brief Class used for transactions of the calling task
+ */
+i2c_sched_class_t i2c_sched_task_class(void);
+
+/**
+ * @brief Copy the statistics of all registered devices
+ *
+ * @param out Output array
+ * @param max_devices Capacity of @p out
+ * @return Number of entries written
+ */
+size_t i2c_sched_get_stats(i2c_sched_device_stats_t *out, size_t max_devices);
+
+/**
+ * @brief Reset all statistics counters
+ */
+void i2c_sched_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2C_SCHEDULER_H
@@ -0,0 +1,164 @@
+/*
+ * Hot-path latency probes
+ *
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file latency_probe.h
+ * @brief Hot-path latency probes
+ *
+ * A probe times one stretch of code with the CPU cycle counter (clock_gettime
+ * on a host build) and adds the duration to a log-linear histogram: eight
+ * buckets per power of two, so a percentile read from it is within 12.5% of
+ * the exact value. Count, min, max and mean are exact.
+ *
+ *     LATENCY_PROBE_BEGIN(mark);
+ *     ...
+ *     LATENCY_PROBE_END(LATENCY_PROBE_SEND_CONNECTED_DATA, mark);
+ *
+ * Each probe is meant to be fed by one task at a time. The cycle counters of
+ * the two cores are not synchronized, so a sample whose task moved to the
+ * other core in between is dropped and counted in migrated.
+ *
+ * Without CONFIG_OPENER_LATENCY_PROBES the macros expand to nothing.
+ */
+
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#include "esp_cpu.h"
+#else
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Probes, in the order they are reported
+ */
+typedef enum {
+    LATENCY_PROBE_NETWORK_CYCLIC,          /**< NetworkHandlerProcessCyclic() after select() returns */
+    LATENCY_PROBE_RECEIVED_CONNECTED_DATA, /**< HandleReceivedConnectedData() */
+    LATENCY_PROBE_SEND_CONNECTED_DATA,     /**< SendConnectedData() */
+    LATENCY_PROBE_NOTIFY_MESSAGE_ROUTER,   /**< NotifyMessageRouter() */
+    LATENCY_PROBE_SCALE_CAPTURE,           /**< Scale task I2C read of one channel */
+    LATENCY_PROBE_COUNT
+} latency_probe_id_t;
+
+#define LATENCY_PROBE_SUB_BUCKETS 8    /**< Buckets per power of two */
+#define LATENCY_PROBE_BUCKETS     240  /**< Buckets covering the whole 32-bit cycle range */
+
+/**
+ * @brief Summary of one probe, in nanoseconds
+ */
+typedef struct {
+    uint32_t count;      /**< Samples since boot or the last reset */
+    uint32_t migrated;   /**< Samples dropped because the task changed core */
+    uint32_t min_ns;     /**< Shortest sample (0 if count is 0) */
+    uint32_t max_ns;     /**< Longest sample */
+    uint32_t mean_ns;    /**< Average */
+    uint32_t p50_ns;     /**< Median (upper bound of its bucket) */
+    uint32_t p99_ns;     /**< 99th percentile (upper bound of its bucket) */
+} latency_probe_stats_t;
+
+/**
+ * @brief Start of a timed stretch
+ */
+typedef struct {
+    uint32_t cycles;
+    uint32_t core;
+} latency_probe_mark_t;
+
+static inline latency_probe_mark_t latency_probe_begin(void)
+{
+    latency_probe_mark_t mark;
+#ifdef ESP_PLATFORM
+    mark.core = (uint32_t)esp_cpu_get_core_id();
+    mark.cycles = (uint32_t)esp_cpu_get_cycle_count();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    mark.core = 0;
+    mark.cycles = (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+#endif
+    return mark;
+}
+
+/**
+ * @brief Record the time since mark (use LATENCY_PROBE_END instead)
+ */
+void latency_probe_end(latency_probe_id_t id, const latency_probe_mark_t *mark);
+
+/**
+ * @brief Whether the probes are compiled in
+ */
+bool latency_probe_enabled(void);
+
+/**
+ * @brief Name of a probe ("network_cyclic", ...), or NULL if id is out of range
+ */
+const char *latency_probe_name(latency_probe_id_t id);
+
+/**
+ * @brief Get the summary of a probe
+ *
+ * @param id Probe
+ * @param stats Output
+ * @param buckets Optional copy of the histogram (LATENCY_PROBE_BUCKETS counts), or NULL
+ * @return false if id is out of range or the probes are not compiled in
+ */
+bool latency_probe_get_stats(latency_probe_id_t id, latency_probe_stats_t *stats, uint32_t *buckets);
+
+/**
+ * @brief Upper bound of a histogram bucket in nanoseconds
+ */
+uint32_t latency_probe_bucket_upper_ns(unsigned bucket);
+
+/**
+ * @brief Discard the samples of a probe
+ *
+ * The histogram is cleared by the task feeding the probe on its next sample;
+ * until then the probe reads as empty.
+ */
+void latency_probe_reset(latency_probe_id_t id);
+
+#ifdef CONFIG_OPENER_LATENCY_PROBES
+#define LATENCY_PROBE_BEGIN(mark) latency_probe_mark_t mark = latency_probe_begin()
+#define LATENCY_PROBE_END(id, mark) latency_probe_end((id), &(mark))
+#else
+#define LATENCY_PROBE_BEGIN(mark) do { } while (0)
+#define LATENCY_PROBE_END(id, mark) do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LATENCY_PROBE_H
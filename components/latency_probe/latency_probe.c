@@ -0,0 +1,227 @@
+/*
+ * Hot-path latency probes
+ *
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "latency_probe.h"
+#include <stdatomic.h>
+#include <string.h>
+#ifdef ESP_PLATFORM
+#include "esp_rom_sys.h"
+#endif
+
+static const char *const s_probe_names[LATENCY_PROBE_COUNT] = {
+    [LATENCY_PROBE_NETWORK_CYCLIC] = "network_cyclic",
+    [LATENCY_PROBE_RECEIVED_CONNECTED_DATA] = "received_connected_data",
+    [LATENCY_PROBE_SEND_CONNECTED_DATA] = "send_connected_data",
+    [LATENCY_PROBE_NOTIFY_MESSAGE_ROUTER] = "notify_message_router",
+    [LATENCY_PROBE_SCALE_CAPTURE] = "scale_capture",
+};
+
+const char *latency_probe_name(latency_probe_id_t id)
+{
+    return ((unsigned)id < LATENCY_PROBE_COUNT) ? s_probe_names[id] : NULL;
+}
+
+static uint64_t cycles_to_ns(uint64_t cycles)
+{
+#ifdef ESP_PLATFORM
+    return cycles * 1000u / esp_rom_get_cpu_ticks_per_us();
+#else
+    return cycles;  // The host clock counts nanoseconds
+#endif
+}
+
+static uint32_t clamp_ns(uint64_t ns)
+{
+    return (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+}
+
+// Largest cycle count that falls in the bucket
+static uint64_t bucket_upper_cycles(unsigned bucket)
+{
+    if (bucket < LATENCY_PROBE_SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned shift = bucket / LATENCY_PROBE_SUB_BUCKETS - 1;
+    uint64_t lower = (uint64_t)(LATENCY_PROBE_SUB_BUCKETS + bucket % LATENCY_PROBE_SUB_BUCKETS) << shift;
+    return lower + (1ull << shift) - 1;
+}
+
+uint32_t latency_probe_bucket_upper_ns(unsigned bucket)
+{
+    return clamp_ns(cycles_to_ns(bucket_upper_cycles(bucket)));
+}
+
+#ifdef CONFIG_OPENER_LATENCY_PROBES
+
+typedef struct {
+    uint32_t count;
+    uint32_t migrated;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    atomic_bool reset_pending;
+    uint32_t buckets[LATENCY_PROBE_BUCKETS];
+} probe_t;
+
+static probe_t s_probes[LATENCY_PROBE_COUNT];
+
+// Eight buckets per power of two: values below 8 get their own bucket, larger
+// ones are bucketed by their top four significant bits
+static inline unsigned bucket_of(uint32_t cycles)
+{
+    if (cycles < LATENCY_PROBE_SUB_BUCKETS) {
+        return cycles;
+    }
+    unsigned msb = 31 - (unsigned)__builtin_clz(cycles);
+    return (msb - 2) * LATENCY_PROBE_SUB_BUCKETS + ((cycles >> (msb - 3)) & (LATENCY_PROBE_SUB_BUCKETS - 1));
+}
+
+static void clear_probe(probe_t *probe)
+{
+    probe->count = 0;
+    probe->migrated = 0;
+    probe->min = 0;
+    probe->max = 0;
+    probe->sum = 0;
+    memset(probe->buckets, 0, sizeof(probe->buckets));
+}
+
+void latency_probe_end(latency_probe_id_t id, const latency_probe_mark_t *mark)
+{
+    latency_probe_mark_t now = latency_probe_begin();
+    probe_t *probe = &s_probes[id];
+    if (atomic_load_explicit(&probe->reset_pending, memory_order_relaxed)) {
+        clear_probe(probe);
+        atomic_store_explicit(&probe->reset_pending, false, memory_order_release);
+    }
+    if (now.core != mark->core) {
+        probe->migrated++;
+        return;
+    }
+    uint32_t cycles = now.cycles - mark->cycles;
+    if (probe->count == 0 || cycles < probe->min) {
+        probe->min = cycles;
+    }
+    probe->count++;
+    probe->sum += cycles;
+    if (cycles > probe->max) {
+        probe->max = cycles;
+    }
+    probe->buckets[bucket_of(cycles)]++;
+}
+
+bool latency_probe_enabled(void)
+{
+    return true;
+}
+
+// Upper bound of the first bucket at which per_mille of the samples are reached
+static uint64_t percentile_cycles(const uint32_t *buckets, uint32_t count, uint32_t per_mille)
+{
+    uint64_t target = ((uint64_t)count * per_mille + 999) / 1000;
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < LATENCY_PROBE_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= target) {
+            return bucket_upper_cycles(b);
+        }
+    }
+    return bucket_upper_cycles(LATENCY_PROBE_BUCKETS - 1);
+}
+
+bool latency_probe_get_stats(latency_probe_id_t id, latency_probe_stats_t *stats, uint32_t *buckets)
+{
+    if ((unsigned)id >= LATENCY_PROBE_COUNT) {
+        return false;
+    }
+    memset(stats, 0, sizeof(*stats));
+    const probe_t *probe = &s_probes[id];
+    if (atomic_load_explicit(&probe->reset_pending, memory_order_acquire)) {
+        if (buckets != NULL) {
+            memset(buckets, 0, LATENCY_PROBE_BUCKETS * sizeof(uint32_t));
+        }
+        return true;
+    }
+
+    // The feeding task may add samples while this copies; the summary is then
+    // off by those few samples, which does not matter for statistics
+    uint32_t local[LATENCY_PROBE_BUCKETS];
+    uint32_t *copy = (buckets != NULL) ? buckets : local;
+    memcpy(copy, probe->buckets, sizeof(local));
+    uint32_t count = 0;
+    for (unsigned b = 0; b < LATENCY_PROBE_BUCKETS; b++) {
+        count += copy[b];
+    }
+    uint32_t max = probe->max;
+
+    stats->count = count;
+    stats->migrated = probe->migrated;
+    if (count == 0) {
+        return true;
+    }
+    stats->min_ns = clamp_ns(cycles_to_ns(probe->min));
+    stats->max_ns = clamp_ns(cycles_to_ns(max));
+    stats->mean_ns = clamp_ns(cycles_to_ns(probe->sum / (probe->count ? probe->count : 1)));
+    uint64_t p50 = percentile_cycles(copy, count, 500);
+    uint64_t p99 = percentile_cycles(copy, count, 990);
+    stats->p50_ns = clamp_ns(cycles_to_ns(p50 < max ? p50 : max));
+    stats->p99_ns = clamp_ns(cycles_to_ns(p99 < max ? p99 : max));
+    return true;
+}
+
+void latency_probe_reset(latency_probe_id_t id)
+{
+    if ((unsigned)id < LATENCY_PROBE_COUNT) {
+        atomic_store_explicit(&s_probes[id].reset_pending, true, memory_order_release);
+    }
+}
+
+#else // CONFIG_OPENER_LATENCY_PROBES
+
+void latency_probe_end(latency_probe_id_t id, const latency_probe_mark_t *mark)
+{
+    (void)id;
+    (void)mark;
+}
+
+bool latency_probe_enabled(void)
+{
+    return false;
+}
+
+bool latency_probe_get_stats(latency_probe_id_t id, latency_probe_stats_t *stats, uint32_t *buckets)
+{
+    (void)id;
+    (void)buckets;
+    memset(stats, 0, sizeof(*stats));
+    return false;
+}
+
+void latency_probe_reset(latency_probe_id_t id)
+{
+    (void)id;
+}
+
+#endif // CONFIG_OPENER_LATENCY_PROBES
@@ -33,6 +33,15 @@
  * This module handles receiving and processing LLDP frames from neighbors.
  */
 
+/**
+ * Reception counters since boot
+ */
+typedef struct {
+    uint32_t frames_received;   /**< Frames read from the raw socket */
+    uint32_t frames_discarded;  /**< Received frames that could not be processed */
+    uint32_t receive_errors;    /**< Failed reads from the raw socket */
+} lldp_reception_stats_t;
+
 /**
  * Initialize LLDP reception
  * @return 0 on success, -1 on failure
@@ -52,5 +61,11 @@ void lldp_reception_deinit(void);
  */
 int lldp_reception_process_frame(const uint8_t *frame, size_t frame_len);
 
+/**
+ * Get the reception counters
+ * @param stats Output
+ */
+void lldp_reception_get_stats(lldp_reception_stats_t *stats);
+
 #endif /* LLDP_RECEPTION_H_ */
 
@@ -300,7 +300,7 @@ int lldp_raw_socket_recv(uint8_t *frame, size_t max_len) {
     
     if (received > 0) {
         // Log first few bytes for debugging
-        OPENER_TRACE_WARN("LLDP: Raw socket read %d bytes, MAC: %02x:%02x:%02x:%02x:%02x:%02x -> %02x:%02x:%02x:%02x:%02x:%02x\n",
+        OPENER_TRACE_INFO("LLDP: Raw socket read %d bytes, MAC: %02x:%02x:%02x:%02x:%02x:%02x -> %02x:%02x:%02x:%02x:%02x:%02x\n",
                           (int)received,
                           frame[0], frame[1], frame[2], frame[3], frame[4], frame[5],
                           frame[6], frame[7], frame[8], frame[9], frame[10], frame[11]);
@@ -35,6 +35,7 @@
 #define LLDP_ETHERTYPE 0x88CC
 
 static bool s_reception_enabled = false;
+static lldp_reception_stats_t s_stats;  // Written by the reception task only
 
 /**
  * Process a single received Ethernet frame
@@ -234,15 +235,20 @@ static void lldp_reception_task(void *pvParameters) {
         int received = lldp_raw_socket_recv(frame_buffer, sizeof(frame_buffer));
         if (received > 0) {
             frame_count++;
+            s_stats.frames_received++;
             error_count = 0;  // Reset error count on success
             // Frame received - no logging needed for normal operation
             int result = lldp_reception_process_frame(frame_buffer, (size_t)received);
+            if (result != 0) {
+                s_stats.frames_discarded++;
+            }
             if (result != 0 && (frame_count <= 3 || (frame_count % 10) == 0)) {
                 OPENER_TRACE_WARN("LLDP: Frame #%d processing failed (returned %d)\n", frame_count, result);
             }
         } else if (received < 0) {
             // Error occurred
             error_count++;
+            s_stats.receive_errors++;
             if ((error_count % 100) == 0) {  // Log every 100 errors
                 OPENER_TRACE_WARN("LLDP: Reception error (count=%d), continuing...\n", error_count);
             }
@@ -363,3 +369,11 @@ void lldp_reception_deinit(void) {
     lldp_neighbor_db_deinit();
 }
 
+/**
+ * Get the reception counters
+ */
+void lldp_reception_get_stats(lldp_reception_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = s_stats;
+    }
+}
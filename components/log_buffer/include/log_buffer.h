@@ -9,10 +9,23 @@
 extern "C" {
 #endif
 
+#define LOG_BUFFER_RECORD_DATA 122  /**< Text bytes per record; longer lines use several records */
+
+/**
+ * @brief Log capture counters
+ */
+typedef struct {
+    uint32_t lines;          /**< Lines captured */
+    uint32_t truncated;      /**< Lines cut to the 511-byte line limit */
+    uint32_t overrun;        /**< Lines overwritten by newer lines before they were complete */
+    uint32_t records;        /**< Records in the ring */
+} log_buffer_stats_t;
+
 /**
  * @brief Initialize the log buffer system
  * 
- * @param buffer_size Size of the circular buffer in bytes
+ * @param buffer_size Size of the circular buffer in bytes (rounded down to a
+ *                    power-of-two number of records)
  * @return true if initialization successful, false otherwise
  */
 bool log_buffer_init(size_t buffer_size);
@@ -26,6 +39,46 @@ bool log_buffer_init(size_t buffer_size);
  */
 size_t log_buffer_get(char *buffer, size_t buffer_size);
 
+/**
+ * @brief Copy logged text starting at a record position
+ *
+ * Lines are stored in fixed-size records. Positions number the records from
+ * boot and wrap at 2^32, so a reader can keep a cursor and fetch only what was
+ * logged since its last call. No lock is taken by readers or by tasks that log;
+ * a record that is still being written ends the read and is returned by the
+ * next call.
+ *
+ * @param position In: position of the first record wanted. Out: position after
+ *                 the last record returned. If the records at *position have
+ *                 already been overwritten, reading starts at the oldest record
+ *                 still stored.
+ * @param buffer Output buffer (not NUL-terminated)
+ * @param buffer_size Size of buffer, at least LOG_BUFFER_RECORD_DATA
+ * @param end Do not read the record at this position or later (a head from
+ *            log_buffer_get_range())
+ * @param skipped Output: records that were overwritten before they could be
+ *                read (may be NULL). They all come before the returned text,
+ *                so a gap never falls inside it.
+ * @return Number of bytes copied (0 when there is nothing new)
+ */
+size_t log_buffer_read(uint32_t *position, char *buffer, size_t buffer_size, uint32_t end,
+                       uint32_t *skipped);
+
+/**
+ * @brief Get the range of record positions currently stored
+ *
+ * @param tail Output: position of the oldest stored record (may be NULL)
+ * @param head Output: position after the newest record (may be NULL)
+ */
+void log_buffer_get_range(uint32_t *tail, uint32_t *head);
+
+/**
+ * @brief Get the log capture counters (cumulative since boot)
+ *
+ * @param stats Output
+ */
+void log_buffer_get_stats(log_buffer_stats_t *stats);
+
 /**
  * @brief Get the total number of bytes in the log buffer
  * 
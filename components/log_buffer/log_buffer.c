@@ -22,8 +22,8 @@
 
 #include "log_buffer.h"
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -32,49 +32,99 @@ static const char *TAG = "log_buffer";
 
 #define DEFAULT_BUFFER_SIZE (16 * 1024) // 16KB default
 
-static char *s_log_buffer = NULL;
-static size_t s_buffer_size = 0;
-static size_t s_write_pos = 0;
-static size_t s_total_written = 0;
-static bool s_wrapped = false;
-static SemaphoreHandle_t s_buffer_mutex = NULL;
+// Longest line that is kept in full; longer lines are cut and counted
+#define LOG_LINE_MAX 512
+
+/*
+ * The ring is an array of fixed-size records. A producer reserves the records
+ * for its line with one atomic add on s_reserve, which gives it positions that
+ * no other producer can get, and then fills them without any lock. Positions
+ * count up from 0 and wrap at 2^32; the record for a position is at
+ * position % s_record_count (a power of two, so the mapping survives the wrap).
+ *
+ * Each record carries the position it holds in seq, written last with release
+ * ordering. A reader accepts a record only if seq matches the position it
+ * wants both before and after copying it, and if the position has not been
+ * lapped by newer reservations in the meantime (the same idea as a seqlock).
+ * A record that is reserved but not yet committed stops the reader until the
+ * producer finishes; nobody ever waits for a reader.
+ */
+typedef struct {
+    atomic_uint_least32_t seq;      // Position held by this record (valid once committed)
+    uint16_t len;                   // Bytes used in data
+    char data[LOG_BUFFER_RECORD_DATA];
+} log_record_t;
+
+static log_record_t *s_records = NULL;
+static uint32_t s_record_count = 0;
+static atomic_uint_least32_t s_reserve = 0;    // Next position to hand out (head)
+static atomic_uint_least32_t s_clear_pos = 0;  // Positions before this were cleared
+static atomic_uint_least32_t s_lines = 0;
+static atomic_uint_least32_t s_truncated = 0;
+static atomic_uint_least32_t s_overrun = 0;
 static bool s_enabled = false;
 static int (*s_original_vprintf)(const char *fmt, va_list args) = NULL;
 
+static inline log_record_t *record_at(uint32_t position)
+{
+    return &s_records[position & (s_record_count - 1)];
+}
+
+// True if position has been overwritten by newer reservations
+static inline bool is_lapped(uint32_t position, uint32_t head)
+{
+    return (uint32_t)(head - position) > s_record_count;
+}
+
+// Copy a line into the ring: reserve, fill, commit. Never blocks.
+static void log_buffer_append(const char *text, size_t len)
+{
+    uint32_t count = (uint32_t)((len + LOG_BUFFER_RECORD_DATA - 1) / LOG_BUFFER_RECORD_DATA);
+    uint32_t first = atomic_fetch_add_explicit(&s_reserve, count, memory_order_relaxed);
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t position = first + i;
+        log_record_t *rec = record_at(position);
+        size_t n = (len > LOG_BUFFER_RECORD_DATA) ? LOG_BUFFER_RECORD_DATA : len;
+        
+        // Mark the record as in progress before touching its contents
+        atomic_store_explicit(&rec->seq, position - s_record_count, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        rec->len = (uint16_t)n;
+        memcpy(rec->data, text, n);
+        atomic_store_explicit(&rec->seq, position, memory_order_release);
+        
+        text += n;
+        len -= n;
+    }
+    
+    // Preempted for so long that newer lines wrapped around onto ours
+    if (is_lapped(first, atomic_load_explicit(&s_reserve, memory_order_relaxed))) {
+        atomic_fetch_add_explicit(&s_overrun, 1, memory_order_relaxed);
+    }
+}
+
 // Custom vprintf that captures logs to buffer
 static int log_buffer_vprintf(const char *fmt, va_list args)
 {
-    // Capture to buffer first (before args is consumed)
-    if (s_enabled && s_log_buffer && s_buffer_mutex) {
-        if (xSemaphoreTake(s_buffer_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            // Format log message to temporary buffer
-            va_list args_copy;
-            va_copy(args_copy, args);
-            char temp_buffer[512];
-            int len = vsnprintf(temp_buffer, sizeof(temp_buffer), fmt, args_copy);
-            va_end(args_copy);
-            
-            if (len > 0) {
-                size_t bytes_to_write = (len < (int)sizeof(temp_buffer)) ? len : sizeof(temp_buffer) - 1;
-                
-                // Write to circular buffer
-                if (s_write_pos + bytes_to_write <= s_buffer_size) {
-                    // Simple case: fits in remaining buffer
-                    memcpy(&s_log_buffer[s_write_pos], temp_buffer, bytes_to_write);
-                    s_write_pos += bytes_to_write;
-                } else {
-                    // Wraps around
-                    size_t first_part = s_buffer_size - s_write_pos;
-                    memcpy(&s_log_buffer[s_write_pos], temp_buffer, first_part);
-                    memcpy(s_log_buffer, &temp_buffer[first_part], bytes_to_write - first_part);
-                    s_write_pos = bytes_to_write - first_part;
-                    s_wrapped = true;
-                }
-                
-                s_total_written += bytes_to_write;
+    // Capture to buffer first (before args is consumed). Formatting happens on
+    // the caller's stack and the copy into the ring takes no lock, so a task
+    // that logs is never held up by another task logging or by a reader.
+    if (s_enabled) {
+        va_list args_copy;
+        va_copy(args_copy, args);
+        char temp_buffer[LOG_LINE_MAX];
+        int len = vsnprintf(temp_buffer, sizeof(temp_buffer), fmt, args_copy);
+        va_end(args_copy);
+        
+        if (len > 0) {
+            size_t bytes_to_write = (size_t)len;
+            if (bytes_to_write >= sizeof(temp_buffer)) {
+                bytes_to_write = sizeof(temp_buffer) - 1;
+                atomic_fetch_add_explicit(&s_truncated, 1, memory_order_relaxed);
             }
-            
-            xSemaphoreGive(s_buffer_mutex);
+            log_buffer_append(temp_buffer, bytes_to_write);
+            atomic_fetch_add_explicit(&s_lines, 1, memory_order_relaxed);
         }
     }
     
@@ -98,138 +148,196 @@ bool log_buffer_init(size_t buffer_size)
         buffer_size = DEFAULT_BUFFER_SIZE;
     }
     
-    // Create mutex
-    s_buffer_mutex = xSemaphoreCreateMutex();
-    if (s_buffer_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create log buffer mutex");
+    // Record count must be a power of two (see record_at)
+    uint32_t count = 1;
+    while (count * 2 * sizeof(log_record_t) <= buffer_size) {
+        count *= 2;
+    }
+    if (count < 2) {
+        ESP_LOGE(TAG, "Log buffer size %zu is too small", buffer_size);
         return false;
     }
     
     // Allocate buffer
-    s_log_buffer = (char *)malloc(buffer_size);
-    if (s_log_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate log buffer (%zu bytes)", buffer_size);
-        vSemaphoreDelete(s_buffer_mutex);
-        s_buffer_mutex = NULL;
+    s_records = (log_record_t *)malloc(count * sizeof(log_record_t));
+    if (s_records == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate log buffer (%zu bytes)", count * sizeof(log_record_t));
         return false;
     }
     
-    s_buffer_size = buffer_size;
-    s_write_pos = 0;
-    s_total_written = 0;
-    s_wrapped = false;
-    memset(s_log_buffer, 0, buffer_size);
+    // Every record starts out holding a position from "before" position 0,
+    // which readers treat as already overwritten
+    s_record_count = count;
+    for (uint32_t i = 0; i < count; i++) {
+        atomic_init(&s_records[i].seq, i - count);
+        s_records[i].len = 0;
+    }
+    atomic_store(&s_reserve, 0);
+    atomic_store(&s_clear_pos, 0);
+    
+    s_enabled = true;
     
     // Install custom vprintf
     s_original_vprintf = esp_log_set_vprintf(log_buffer_vprintf);
     
-    s_enabled = true;
-    ESP_LOGI(TAG, "Log buffer initialized (%zu bytes)", buffer_size);
+    ESP_LOGI(TAG, "Log buffer initialized (%lu records of %u bytes)",
+             (unsigned long)count, (unsigned)LOG_BUFFER_RECORD_DATA);
     
     return true;
 }
 
-size_t log_buffer_get(char *buffer, size_t buffer_size)
+void log_buffer_get_range(uint32_t *tail, uint32_t *head)
 {
-    if (!s_enabled || !s_log_buffer || !buffer || buffer_size == 0) {
-        return 0;
+    uint32_t newest = 0;
+    uint32_t oldest = 0;
+    if (s_enabled) {
+        newest = atomic_load_explicit(&s_reserve, memory_order_acquire);
+        oldest = newest - s_record_count;
+        uint32_t cleared = atomic_load_explicit(&s_clear_pos, memory_order_relaxed);
+        if ((uint32_t)(newest - cleared) < s_record_count) {
+            oldest = cleared;
+        }
     }
-    
-    if (s_buffer_mutex == NULL) {
-        return 0;
+    if (tail) {
+        *tail = oldest;
     }
-    
-    if (xSemaphoreTake(s_buffer_mutex, portMAX_DELAY) != pdTRUE) {
+    if (head) {
+        *head = newest;
+    }
+}
+
+size_t log_buffer_read(uint32_t *position, char *buffer, size_t buffer_size, uint32_t end,
+                       uint32_t *skipped)
+{
+    if (skipped) {
+        *skipped = 0;
+    }
+    if (!s_enabled || !position || !buffer || buffer_size < LOG_BUFFER_RECORD_DATA) {
         return 0;
     }
     
-    size_t bytes_to_copy = 0;
+    uint32_t tail;
+    uint32_t head;
+    uint32_t lost = 0;
+    log_buffer_get_range(&tail, &head);
+    if ((int32_t)(end - head) > 0) {
+        end = head;
+    }
+    if ((uint32_t)(head - *position) > (uint32_t)(head - tail)) {
+        // Overwritten (or cleared) since the caller last read: skip ahead.
+        // A position ahead of head is not a loss, just a stale cursor.
+        if ((int32_t)(tail - *position) > 0) {
+            lost += (uint32_t)(tail - *position);
+        }
+        *position = tail;
+    }
     
-    if (s_wrapped) {
-        // Buffer has wrapped - copy from write_pos to end, then from start to write_pos
-        size_t first_part = s_buffer_size - s_write_pos;
-        size_t second_part = s_write_pos;
-        
-        if (buffer_size >= s_buffer_size) {
-            // Can copy entire buffer
-            memcpy(buffer, &s_log_buffer[s_write_pos], first_part);
-            memcpy(&buffer[first_part], s_log_buffer, second_part);
-            bytes_to_copy = s_buffer_size;
-        } else {
-            // Copy what fits, starting from oldest data
-            if (buffer_size <= first_part) {
-                memcpy(buffer, &s_log_buffer[s_write_pos], buffer_size);
-                bytes_to_copy = buffer_size;
-            } else {
-                memcpy(buffer, &s_log_buffer[s_write_pos], first_part);
-                size_t remaining = buffer_size - first_part;
-                if (remaining <= second_part) {
-                    memcpy(&buffer[first_part], s_log_buffer, remaining);
-                    bytes_to_copy = buffer_size;
-                } else {
-                    memcpy(&buffer[first_part], s_log_buffer, second_part);
-                    bytes_to_copy = first_part + second_part;
+    size_t copied = 0;
+    while ((int32_t)(end - *position) > 0) {
+        log_record_t *rec = record_at(*position);
+        if (atomic_load_explicit(&rec->seq, memory_order_acquire) != *position) {
+            if (is_lapped(*position, atomic_load_explicit(&s_reserve, memory_order_relaxed))) {
+                if (copied > 0) {
+                    break;  // Report the gap at the start of the next call, not inside this text
                 }
+                (*position)++;
+                lost++;
+                continue;
+            }
+            break;  // Still being written; picked up by the next call
+        }
+        
+        size_t n = rec->len;
+        if (n > LOG_BUFFER_RECORD_DATA) {
+            n = LOG_BUFFER_RECORD_DATA;
+        }
+        if (n > buffer_size - copied) {
+            break;  // Does not fit; left for the next call
+        }
+        memcpy(buffer + copied, rec->data, n);
+        
+        // Discard the copy if a producer started on this record meanwhile
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&rec->seq, memory_order_relaxed) != *position ||
+            is_lapped(*position, atomic_load_explicit(&s_reserve, memory_order_relaxed))) {
+            if (copied > 0) {
+                break;  // Lapped now; skipped by the next call
             }
+            (*position)++;
+            lost++;
+            continue;
         }
-    } else {
-        // Buffer hasn't wrapped - simple copy
-        bytes_to_copy = (s_write_pos < buffer_size) ? s_write_pos : buffer_size;
-        memcpy(buffer, s_log_buffer, bytes_to_copy);
+        copied += n;
+        (*position)++;
     }
     
-    // Ensure null termination
-    if (bytes_to_copy < buffer_size) {
-        buffer[bytes_to_copy] = '\0';
-    } else {
-        buffer[buffer_size - 1] = '\0';
-        bytes_to_copy = buffer_size - 1;
+    if (skipped) {
+        *skipped = lost;
     }
-    
-    xSemaphoreGive(s_buffer_mutex);
-    
-    return bytes_to_copy;
+    return copied;
 }
 
-size_t log_buffer_get_size(void)
+size_t log_buffer_get(char *buffer, size_t buffer_size)
 {
-    if (!s_enabled || !s_log_buffer) {
+    if (!buffer || buffer_size == 0) {
         return 0;
     }
     
-    if (s_buffer_mutex == NULL) {
-        return 0;
+    // Oldest data first, leaving room for the terminator
+    uint32_t tail;
+    uint32_t head;
+    log_buffer_get_range(&tail, &head);
+    size_t bytes_read = 0;
+    size_t n;
+    while (buffer_size - 1 - bytes_read >= LOG_BUFFER_RECORD_DATA &&
+           (n = log_buffer_read(&tail, buffer + bytes_read, buffer_size - 1 - bytes_read, head, NULL)) > 0) {
+        bytes_read += n;
     }
+    buffer[bytes_read] = '\0';
     
-    if (xSemaphoreTake(s_buffer_mutex, portMAX_DELAY) != pdTRUE) {
-        return 0;
-    }
-    
-    size_t size = s_wrapped ? s_buffer_size : s_write_pos;
-    
-    xSemaphoreGive(s_buffer_mutex);
+    return bytes_read;
+}
+
+size_t log_buffer_get_size(void)
+{
+    uint32_t tail;
+    uint32_t head;
+    log_buffer_get_range(&tail, &head);
     
+    size_t size = 0;
+    for (uint32_t position = tail; position != head; position++) {
+        const log_record_t *rec = record_at(position);
+        if (atomic_load_explicit(&rec->seq, memory_order_acquire) == position) {
+            size += rec->len;
+        }
+    }
     return size;
 }
 
+void log_buffer_get_stats(log_buffer_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->lines = atomic_load_explicit(&s_lines, memory_order_relaxed);
+    stats->truncated = atomic_load_explicit(&s_truncated, memory_order_relaxed);
+    stats->overrun = atomic_load_explicit(&s_overrun, memory_order_relaxed);
+    stats->records = s_record_count;
+}
+
 void log_buffer_clear(void)
 {
-    if (!s_enabled || !s_log_buffer || !s_buffer_mutex) {
+    if (!s_enabled) {
         return;
     }
     
-    if (xSemaphoreTake(s_buffer_mutex, portMAX_DELAY) == pdTRUE) {
-        s_write_pos = 0;
-        s_total_written = 0;
-        s_wrapped = false;
-        memset(s_log_buffer, 0, s_buffer_size);
-        xSemaphoreGive(s_buffer_mutex);
-        ESP_LOGI(TAG, "Log buffer cleared");
-    }
+    // Positions keep counting so readers holding a cursor are not confused
+    atomic_store_explicit(&s_clear_pos, atomic_load_explicit(&s_reserve, memory_order_relaxed),
+                          memory_order_relaxed);
+    ESP_LOGI(TAG, "Log buffer cleared");
 }
 
 bool log_buffer_is_enabled(void)
 {
     return s_enabled;
 }
-
@@ -1,23 +1,128 @@
+
 #ifndef MODBUS_PROTOCOL_H
 #define MODBUS_PROTOCOL_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define MODBUS_TCP_MBAP_SIZE     6     /**< MBAP header without the unit identifier */
+#define MODBUS_TCP_MAX_ADU_SIZE  260   /**< MBAP header + unit identifier + 253 byte PDU */
+#define MODBUS_TCP_RX_BUFFER_SIZE 512  /**< Per-connection receive buffer */
+#define MODBUS_TCP_TX_BUFFER_SIZE 1040 /**< Per-connection response buffer (4 maximum size responses) */
+
+/**
+ * @brief State of one Modbus TCP client connection
+ *
+ * TCP does not preserve message boundaries: one segment may carry several
+ * pipelined requests, and one request may be split across segments. Received
+ * bytes are kept in rx_buf until a complete ADU is available; responses are
+ * collected in tx_buf and sent together. Sends never block: what a client
+ * does not take stays at the front of tx_buf, and the client is not served
+ * again until its socket is writable and the tail is sent.
+ */
+typedef struct {
+    int socket;                                   /**< Client socket */
+    size_t rx_len;                                /**< Bytes buffered in rx_buf */
+    size_t tx_len;                                /**< Bytes buffered in tx_buf */
+    bool tx_blocked;                              /**< send() would block; tx_buf holds an unsent tail */
+    uint8_t rx_buf[MODBUS_TCP_RX_BUFFER_SIZE];    /**< Received bytes not yet framed */
+    uint8_t tx_buf[MODBUS_TCP_TX_BUFFER_SIZE];    /**< Responses not yet sent */
+} modbus_tcp_conn_t;
+
+/**
+ * @brief Request counters of all connections since boot
+ */
+typedef struct {
+    uint32_t requests;        /**< Requests answered, exception responses included */
+    uint32_t exceptions;      /**< Requests answered with an exception response */
+    uint32_t framing_errors;  /**< Connections closed for an invalid MBAP header */
+} modbus_protocol_stats_t;
+
+/**
+ * @brief Get the request counters
+ *
+ * The counters are written by the server task only.
+ *
+ * @param stats Output
+ */
+void modbus_protocol_get_stats(modbus_protocol_stats_t *stats);
+
 /**
- * @brief Handle ModbusTCP request from client
- * 
+ * @brief Reset a connection for a newly accepted socket
+ *
+ * @param conn Connection state
  * @param client_socket Client socket file descriptor
+ */
+void modbus_tcp_conn_init(modbus_tcp_conn_t *conn, int client_socket);
+
+/**
+ * @brief Read available data from a client and answer complete requests
+ *
+ * Call when the socket is readable or modbus_tcp_conn_has_request() is true,
+ * and not while modbus_tcp_conn_send_blocked() is true; never blocks. At most
+ * @p max_requests requests are answered, buffered ones first. Responses are
+ * sent with as few send() calls as possible; a partial request and requests
+ * beyond the budget stay buffered for the next call. If the client stops
+ * taking responses, answering stops with the unsent tail kept in tx_buf.
+ *
+ * @param conn Connection state
+ * @param max_requests Request budget for this call (at least 1)
  * @return true if connection should remain open, false to close
  */
-bool modbus_tcp_handle_request(int client_socket);
+bool modbus_tcp_handle_request(modbus_tcp_conn_t *conn, unsigned max_requests);
+
+/**
+ * @brief Check for a complete request left in the receive buffer
+ *
+ * Such a request does not make the socket readable again, so the caller
+ * has to call modbus_tcp_handle_request() without waiting for readiness.
+ *
+ * @param conn Connection state
+ * @return true if a complete (or malformed) ADU is buffered
+ */
+bool modbus_tcp_conn_has_request(const modbus_tcp_conn_t *conn);
+
+/**
+ * @brief Check for responses the client has not taken yet
+ *
+ * While true, wait for the socket to become writable and call
+ * modbus_tcp_conn_flush() instead of serving requests.
+ *
+ * @param conn Connection state
+ * @return true if the last send() would have blocked
+ */
+bool modbus_tcp_conn_send_blocked(const modbus_tcp_conn_t *conn);
+
+/**
+ * @brief Send the unsent responses without blocking
+ *
+ * @param conn Connection state
+ * @return true if the connection should remain open (whether or not the
+ *         whole tail was sent), false on a send error
+ */
+bool modbus_tcp_conn_flush(modbus_tcp_conn_t *conn);
+
+/**
+ * @brief Frame and execute the complete requests in the receive buffer
+ *
+ * Consumes complete ADUs from rx_buf and appends the responses to tx_buf,
+ * stopping early when the budget is used up or tx_buf cannot hold another
+ * maximum size response. Does no socket I/O.
+ *
+ * @param conn Connection state
+ * @param budget In: requests that may be answered. Out: decremented per request
+ * @return true on success, false if the stream is malformed and the
+ *         connection should be closed
+ */
+bool modbus_tcp_process_buffer(modbus_tcp_conn_t *conn, unsigned *budget);
 
 #ifdef __cplusplus
 }
 #endif
 
 #endif // MODBUS_PROTOCOL_H
-
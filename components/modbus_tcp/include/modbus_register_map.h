@@ -8,10 +8,82 @@
 extern "C" {
 #endif
 
+/** Assembly instances mirrored into Modbus registers */
+#define MODBUS_ASSEMBLY_INPUT   100  /**< Input Registers 0-15 */
+#define MODBUS_ASSEMBLY_OUTPUT  150  /**< Holding Registers 100-115 */
+#define MODBUS_ASSEMBLY_CONFIG  151  /**< Holding Registers 150-154 */
+
+/**
+ * @brief Refresh the Modbus register image of an assembly
+ *
+ * Register reads are served from a copy of each assembly that is already in
+ * Modbus byte order, so they neither take the assembly mutex nor swap bytes.
+ * Whoever writes an assembly calls this afterwards, while the assembly data
+ * is still stable (e.g. before releasing the assembly mutex).
+ *
+ * @param assembly_instance MODBUS_ASSEMBLY_INPUT, MODBUS_ASSEMBLY_OUTPUT or
+ *        MODBUS_ASSEMBLY_CONFIG; other instances are ignored
+ */
+void modbus_register_map_assembly_updated(uint16_t assembly_instance);
+
+/** Scale values as 32-bit registers at 200 + 16 * channel, readable as input
+ *  and (read-only) holding registers */
+#define MODBUS_SCALE_REG_START          200
+#define MODBUS_SCALE_REGS_PER_CHANNEL   16
+#define MODBUS_SCALE_CHANNEL_MAX        4
+
+/** Word order of 32-bit values (int32 and float) in two registers */
+#define MODBUS_WORD_ORDER_HIGH_FIRST    0   /**< Register N holds bits 31-16 (ABCD) */
+#define MODBUS_WORD_ORDER_LOW_FIRST     1   /**< Register N holds bits 15-0 (CDAB) */
+
 /**
- * @brief Read input registers (read-only, maps to Input Assembly 100)
+ * @brief Values of one scale channel for the 32-bit register block
+ *
+ * Register layout relative to MODBUS_SCALE_REG_START + 16 * channel:
+ *   0-1   weight x100 in the configured unit (int32)
+ *   2-3   weight in the configured unit (float)
+ *   4-5   latest raw ADC conversion (int32)
+ *   6-7   latest raw ADC conversion (float)
+ *   8-9   filtered (moving average) raw reading (int32)
+ *   10-11 filtered raw reading including the fraction (float)
+ *   12    unit code (0=grams, 1=lbs, 2=kg)
+ *   13    status flags, same bits as the assembly status byte
+ *   14-15 reserved
+ */
+typedef struct {
+    int32_t weight_scaled;  /**< Weight x100 in the configured unit */
+    float weight;           /**< Weight in the configured unit */
+    int32_t raw;            /**< Latest raw conversion */
+    int32_t filtered;       /**< Moving average of the raw conversions */
+    float filtered_exact;   /**< Moving average without rounding */
+    uint16_t unit;          /**< Unit code */
+    uint16_t status;        /**< Status flags */
+} modbus_scale_values_t;
+
+/**
+ * @brief Publish the values of a scale channel to the 32-bit register block
+ *
+ * Call from the task that produces the scale values. Values are encoded in
+ * the word order currently set.
+ *
+ * @param channel Scale channel (0 to MODBUS_SCALE_CHANNEL_MAX - 1)
+ * @param values Channel values
+ */
+void modbus_register_map_set_scale_values(uint8_t channel, const modbus_scale_values_t *values);
+
+/**
+ * @brief Set the word order of the 32-bit register block
+ *
+ * Takes effect with the next modbus_register_map_set_scale_values().
+ *
+ * @param word_order MODBUS_WORD_ORDER_HIGH_FIRST or MODBUS_WORD_ORDER_LOW_FIRST
+ */
+void modbus_register_map_set_word_order(uint8_t word_order);
+
+/**
+ * @brief Read input registers (read-only, maps to Input Assembly 100 and the scale values)
  * 
- * @param start_addr Starting register address (0-15)
+ * @param start_addr Starting register address (0-15, or within the scale value block)
  * @param quantity Number of registers to read (1-125)
  * @param data Buffer to store register values (big-endian, 2 bytes per register)
  * @return true on success, false on invalid address/quantity
@@ -28,6 +100,17 @@ bool modbus_read_input_registers(uint16_t start_addr, uint16_t quantity, uint8_t
  */
 bool modbus_read_holding_registers(uint16_t start_addr, uint16_t quantity, uint8_t *data);
 
+/**
+ * @brief Check that a holding register range can be read, without reading it
+ *
+ * FC 0x17 checks its read range with this before performing the write.
+ *
+ * @param start_addr Starting register address
+ * @param quantity Number of registers
+ * @return true if modbus_read_holding_registers() would succeed for the range
+ */
+bool modbus_holding_registers_readable(uint16_t start_addr, uint16_t quantity);
+
 /**
  * @brief Write single holding register
  * 
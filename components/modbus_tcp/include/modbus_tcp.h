@@ -2,11 +2,25 @@
 #define MODBUS_TCP_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief ModbusTCP server counters since boot
+ */
+typedef struct {
+    uint32_t requests;               /**< Requests answered, exception responses included */
+    uint32_t exceptions;             /**< Requests answered with an exception response */
+    uint32_t framing_errors;         /**< Connections closed for an invalid MBAP header */
+    uint32_t connections_active;     /**< Clients currently connected */
+    uint32_t connections_accepted;   /**< Clients accepted */
+    uint32_t connections_evicted;    /**< Clients closed to make room for a new one */
+    uint32_t connections_timed_out;  /**< Clients closed after the idle timeout */
+} modbus_tcp_stats_t;
+
 /**
  * @brief Initialize ModbusTCP server
  * 
@@ -26,6 +40,15 @@ bool modbus_tcp_start(void);
  */
 void modbus_tcp_stop(void);
 
+/**
+ * @brief Get the server counters
+ *
+ * Safe to call from any task; the counters are written by the server task.
+ *
+ * @param stats Output
+ */
+void modbus_tcp_get_stats(modbus_tcp_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
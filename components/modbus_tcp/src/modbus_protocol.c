@@ -28,22 +28,14 @@
 #include <errno.h>
 
 static const char *TAG = "modbus_protocol";
-
-// ModbusTCP ADU structure
-typedef struct {
-    uint16_t transaction_id;
-    uint16_t protocol_id;      // Always 0 for Modbus
-    uint16_t length;           // Length of unit identifier + PDU
-    uint8_t unit_id;           // Slave address
-    uint8_t function_code;
-    uint8_t data[256];         // PDU data
-} modbus_tcp_adu_t;
+static modbus_protocol_stats_t s_stats;
 
 // Modbus function codes
 #define MODBUS_FC_READ_HOLDING_REGISTERS   0x03
 #define MODBUS_FC_READ_INPUT_REGISTERS     0x04
 #define MODBUS_FC_WRITE_SINGLE_REGISTER    0x06
 #define MODBUS_FC_WRITE_MULTIPLE_REGISTERS 0x10
+#define MODBUS_FC_READ_WRITE_MULTIPLE_REGISTERS 0x17
 
 // Exception codes
 #define MODBUS_EX_ILLEGAL_FUNCTION          0x01
@@ -51,310 +43,373 @@ typedef struct {
 #define MODBUS_EX_ILLEGAL_DATA_VALUE        0x03
 #define MODBUS_EX_SLAVE_DEVICE_FAILURE      0x04
 
+// MBAP length field covers the unit identifier and the PDU
+#define MODBUS_TCP_MAX_LENGTH (MODBUS_TCP_MAX_ADU_SIZE - MODBUS_TCP_MBAP_SIZE)
+
 
-static void send_exception(int client_socket, uint16_t transaction_id, uint8_t unit_id, 
-                          uint8_t function_code, uint8_t exception_code)
+// Write the MBAP header, unit identifier and function code; pdu_len counts the function code
+static void write_header(uint8_t *response, uint16_t transaction_id, uint8_t unit_id,
+                         uint8_t function_code, size_t pdu_len)
 {
-    uint8_t response[9];
+    uint16_t length = pdu_len + 1; // Unit identifier + PDU
     response[0] = (transaction_id >> 8) & 0xFF;
     response[1] = transaction_id & 0xFF;
     response[2] = 0x00; // Protocol ID
     response[3] = 0x00;
-    response[4] = 0x00; // Length
-    response[5] = 0x03;
+    response[4] = (length >> 8) & 0xFF;
+    response[5] = length & 0xFF;
     response[6] = unit_id;
-    response[7] = function_code | 0x80; // Exception flag
-    response[8] = exception_code;
-    
-    send(client_socket, response, sizeof(response), 0);
+    response[7] = function_code;
 }
 
-static bool handle_read_holding_registers(int client_socket, uint16_t transaction_id, 
-                                         uint8_t unit_id, const uint8_t *pdu, int pdu_len)
+static size_t build_exception(uint8_t *response, uint16_t transaction_id, uint8_t unit_id,
+                              uint8_t function_code, uint8_t exception_code)
 {
-    // Read Holding Registers requires: start_addr (2 bytes) + quantity (2 bytes) = 4 bytes
-    if (pdu_len < 4) {
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_READ_HOLDING_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
-    }
-    
-    uint16_t start_addr = (pdu[0] << 8) | pdu[1];
-    uint16_t quantity = (pdu[2] << 8) | pdu[3];
-    
-    // Validate quantity (Modbus spec: 1-125 registers)
-    if (quantity == 0 || quantity > 125) {
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_READ_HOLDING_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
-    }
-    
-    // Check response buffer size
-    size_t response_data_size = quantity * 2;
-    if (response_data_size > 250) { // Max 125 registers * 2 bytes = 250 bytes
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_READ_HOLDING_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
-    }
-    
-    uint8_t response[256];
-    int response_len = 9 + response_data_size;
-    response[0] = (transaction_id >> 8) & 0xFF;
-    response[1] = transaction_id & 0xFF;
-    response[2] = 0x00; // Protocol ID
-    response[3] = 0x00;
-    response[4] = ((response_len - 6) >> 8) & 0xFF; // Length
-    response[5] = (response_len - 6) & 0xFF;
-    response[6] = unit_id;
-    response[7] = MODBUS_FC_READ_HOLDING_REGISTERS;
-    response[8] = response_data_size; // Byte count
-    
-    // Read registers from map
-    if (!modbus_read_holding_registers(start_addr, quantity, &response[9])) {
-        ESP_LOGE(TAG, "Failed to read holding registers: start_addr=%d, quantity=%d", 
-                 start_addr, quantity);
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_READ_HOLDING_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_ADDRESS);
-        return true;
-    }
-    
-    int sent = send(client_socket, response, response_len, 0);
-    if (sent != response_len) {
-        ESP_LOGE(TAG, "Failed to send full response: sent %d of %d bytes", sent, response_len);
-    }
-    return true;
+    write_header(response, transaction_id, unit_id, function_code | 0x80, 2); // Exception flag
+    response[8] = exception_code;
+    return 9;
 }
 
-static bool handle_read_input_registers(int client_socket, uint16_t transaction_id, 
-                                        uint8_t unit_id, const uint8_t *pdu, int pdu_len)
+typedef bool (*register_read_fn_t)(uint16_t start_addr, uint16_t quantity, uint8_t *data);
+
+static size_t handle_read_registers(uint8_t *response, uint16_t transaction_id, uint8_t unit_id,
+                                    uint8_t function_code, register_read_fn_t read_fn,
+                                    const uint8_t *pdu, int pdu_len)
 {
-    // Read Input Registers requires: start_addr (2 bytes) + quantity (2 bytes) = 4 bytes
+    // Read requests require: start_addr (2 bytes) + quantity (2 bytes) = 4 bytes
     if (pdu_len < 4) {
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_READ_INPUT_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
+        return build_exception(response, transaction_id, unit_id, function_code,
+                               MODBUS_EX_ILLEGAL_DATA_VALUE);
     }
-    
+
     uint16_t start_addr = (pdu[0] << 8) | pdu[1];
     uint16_t quantity = (pdu[2] << 8) | pdu[3];
-    
-    // Validate quantity (Modbus spec: 1-125 registers)
+
+    // Validate quantity (Modbus spec: 1-125 registers, 250 bytes of data)
     if (quantity == 0 || quantity > 125) {
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_READ_INPUT_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
+        return build_exception(response, transaction_id, unit_id, function_code,
+                               MODBUS_EX_ILLEGAL_DATA_VALUE);
     }
-    
-    // Check response buffer size
+
     size_t response_data_size = quantity * 2;
-    if (response_data_size > 250) { // Max 125 registers * 2 bytes = 250 bytes
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_READ_INPUT_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
+
+    // Read registers from map straight into the response
+    if (!read_fn(start_addr, quantity, &response[9])) {
+        ESP_LOGE(TAG, "Failed to read registers (FC 0x%02X): start_addr=%d, quantity=%d",
+                 function_code, start_addr, quantity);
+        return build_exception(response, transaction_id, unit_id, function_code,
+                               MODBUS_EX_ILLEGAL_DATA_ADDRESS);
     }
-    
-    uint8_t response[256];
-    int response_len = 9 + response_data_size;
-    response[0] = (transaction_id >> 8) & 0xFF;
-    response[1] = transaction_id & 0xFF;
-    response[2] = 0x00; // Protocol ID
-    response[3] = 0x00;
-    response[4] = ((response_len - 6) >> 8) & 0xFF; // Length
-    response[5] = (response_len - 6) & 0xFF;
-    response[6] = unit_id;
-    response[7] = MODBUS_FC_READ_INPUT_REGISTERS;
+
+    write_header(response, transaction_id, unit_id, function_code, 2 + response_data_size);
     response[8] = response_data_size; // Byte count
-    
-    // Read registers from map
-    if (!modbus_read_input_registers(start_addr, quantity, &response[9])) {
-        ESP_LOGE(TAG, "Failed to read input registers: start_addr=%d, quantity=%d", 
-                 start_addr, quantity);
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_READ_INPUT_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_ADDRESS);
-        return true;
-    }
-    
-    int sent = send(client_socket, response, response_len, 0);
-    if (sent != response_len) {
-        ESP_LOGE(TAG, "Failed to send full response: sent %d of %d bytes", sent, response_len);
-    }
-    return true;
+    return 9 + response_data_size;
 }
 
-static bool handle_write_single_register(int client_socket, uint16_t transaction_id, 
-                                         uint8_t unit_id, const uint8_t *pdu, int pdu_len)
+static size_t handle_write_single_register(uint8_t *response, uint16_t transaction_id,
+                                           uint8_t unit_id, const uint8_t *pdu, int pdu_len)
 {
     // Write Single Register requires: address (2 bytes) + value (2 bytes) = 4 bytes
     if (pdu_len < 4) {
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_WRITE_SINGLE_REGISTER, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
+        return build_exception(response, transaction_id, unit_id, MODBUS_FC_WRITE_SINGLE_REGISTER,
+                               MODBUS_EX_ILLEGAL_DATA_VALUE);
     }
-    
+
     uint16_t address = (pdu[0] << 8) | pdu[1];
     uint16_t value = (pdu[2] << 8) | pdu[3];
-    
+
     // Write register to map
     if (!modbus_write_holding_register(address, value)) {
         ESP_LOGE(TAG, "Failed to write holding register: address=%d, value=%d", address, value);
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_WRITE_SINGLE_REGISTER, 
-                      MODBUS_EX_ILLEGAL_DATA_ADDRESS);
-        return true;
+        return build_exception(response, transaction_id, unit_id, MODBUS_FC_WRITE_SINGLE_REGISTER,
+                               MODBUS_EX_ILLEGAL_DATA_ADDRESS);
     }
-    
+
     // Echo back the request
-    uint8_t response[12];
-    response[0] = (transaction_id >> 8) & 0xFF;
-    response[1] = transaction_id & 0xFF;
-    response[2] = 0x00; // Protocol ID
-    response[3] = 0x00;
-    response[4] = 0x00; // Length
-    response[5] = 0x06;
-    response[6] = unit_id;
-    response[7] = MODBUS_FC_WRITE_SINGLE_REGISTER;
-    response[8] = (address >> 8) & 0xFF;
-    response[9] = address & 0xFF;
-    response[10] = (value >> 8) & 0xFF;
-    response[11] = value & 0xFF;
-    
-    int sent = send(client_socket, response, sizeof(response), 0);
-    if (sent != sizeof(response)) {
-        ESP_LOGE(TAG, "Failed to send write response: sent %d of %d bytes", sent, sizeof(response));
-    }
-    return true;
+    write_header(response, transaction_id, unit_id, MODBUS_FC_WRITE_SINGLE_REGISTER, 5);
+    memcpy(&response[8], pdu, 4);
+    return 12;
 }
 
-static bool handle_write_multiple_registers(int client_socket, uint16_t transaction_id, 
-                                           uint8_t unit_id, const uint8_t *pdu, int pdu_len)
+static size_t handle_write_multiple_registers(uint8_t *response, uint16_t transaction_id,
+                                              uint8_t unit_id, const uint8_t *pdu, int pdu_len)
 {
     // Write Multiple Registers requires: start_addr (2) + quantity (2) + byte_count (1) + data (N) = at least 6 bytes
     if (pdu_len < 6) {
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
+        return build_exception(response, transaction_id, unit_id, MODBUS_FC_WRITE_MULTIPLE_REGISTERS,
+                               MODBUS_EX_ILLEGAL_DATA_VALUE);
     }
-    
+
     uint16_t start_addr = (pdu[0] << 8) | pdu[1];
     uint16_t quantity = (pdu[2] << 8) | pdu[3];
     uint8_t byte_count = pdu[4];
-    
+
     // Validate parameters
     if (quantity == 0 || quantity > 123 || byte_count != quantity * 2 || pdu_len < 5 + byte_count) {
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_VALUE);
-        return true;
+        return build_exception(response, transaction_id, unit_id, MODBUS_FC_WRITE_MULTIPLE_REGISTERS,
+                               MODBUS_EX_ILLEGAL_DATA_VALUE);
     }
-    
+
     // Write registers to map
     if (!modbus_write_holding_registers(start_addr, quantity, &pdu[5])) {
         ESP_LOGE(TAG, "Failed to write holding registers: start_addr=%d, quantity=%d", start_addr, quantity);
-        send_exception(client_socket, transaction_id, unit_id, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, 
-                      MODBUS_EX_ILLEGAL_DATA_ADDRESS);
-        return true;
+        return build_exception(response, transaction_id, unit_id, MODBUS_FC_WRITE_MULTIPLE_REGISTERS,
+                               MODBUS_EX_ILLEGAL_DATA_ADDRESS);
     }
-    
-    // Response
-    uint8_t response[12];
-    response[0] = (transaction_id >> 8) & 0xFF;
-    response[1] = transaction_id & 0xFF;
-    response[2] = 0x00; // Protocol ID
-    response[3] = 0x00;
-    response[4] = 0x00; // Length
-    response[5] = 0x06;
-    response[6] = unit_id;
-    response[7] = MODBUS_FC_WRITE_MULTIPLE_REGISTERS;
-    response[8] = (start_addr >> 8) & 0xFF;
-    response[9] = start_addr & 0xFF;
-    response[10] = (quantity >> 8) & 0xFF;
-    response[11] = quantity & 0xFF;
-    
-    int sent = send(client_socket, response, sizeof(response), 0);
-    if (sent != sizeof(response)) {
-        ESP_LOGE(TAG, "Failed to send write response: sent %d of %d bytes", sent, sizeof(response));
+
+    // Response: start address and quantity
+    write_header(response, transaction_id, unit_id, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, 5);
+    memcpy(&response[8], pdu, 4);
+    return 12;
+}
+
+static size_t handle_read_write_multiple_registers(uint8_t *response, uint16_t transaction_id,
+                                                  uint8_t unit_id, const uint8_t *pdu, int pdu_len)
+{
+    const uint8_t fc = MODBUS_FC_READ_WRITE_MULTIPLE_REGISTERS;
+
+    // Requires: read_start (2) + read_quantity (2) + write_start (2) + write_quantity (2) +
+    // byte_count (1) + data (N) = at least 11 bytes
+    if (pdu_len < 11) {
+        return build_exception(response, transaction_id, unit_id, fc, MODBUS_EX_ILLEGAL_DATA_VALUE);
     }
-    return true;
+
+    uint16_t read_addr = (pdu[0] << 8) | pdu[1];
+    uint16_t read_quantity = (pdu[2] << 8) | pdu[3];
+    uint16_t write_addr = (pdu[4] << 8) | pdu[5];
+    uint16_t write_quantity = (pdu[6] << 8) | pdu[7];
+    uint8_t byte_count = pdu[8];
+
+    // Validate parameters (Modbus spec: read 1-125, write 1-121 registers)
+    if (read_quantity == 0 || read_quantity > 125 || write_quantity == 0 || write_quantity > 121 ||
+        byte_count != write_quantity * 2 || pdu_len < 9 + byte_count) {
+        return build_exception(response, transaction_id, unit_id, fc, MODBUS_EX_ILLEGAL_DATA_VALUE);
+    }
+
+    // A request that cannot be answered must not change anything, so the read
+    // range is checked before the write is performed
+    if (!modbus_holding_registers_readable(read_addr, read_quantity)) {
+        ESP_LOGE(TAG, "Invalid read range for FC 0x17: start_addr=%d, quantity=%d", read_addr, read_quantity);
+        return build_exception(response, transaction_id, unit_id, fc, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+    }
+
+    // The write is performed before the read; pdu starts with the read request
+    if (!modbus_write_holding_registers(write_addr, write_quantity, &pdu[9])) {
+        ESP_LOGE(TAG, "Failed to write holding registers: start_addr=%d, quantity=%d", write_addr, write_quantity);
+        return build_exception(response, transaction_id, unit_id, fc, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+    }
+
+    return handle_read_registers(response, transaction_id, unit_id, fc, modbus_read_holding_registers,
+                                 pdu, 4);
 }
 
-bool modbus_tcp_handle_request(int client_socket)
+// Execute one complete ADU and write the response; returns the response length
+static size_t execute_adu(const uint8_t *adu, size_t adu_len, uint8_t *response)
 {
-    uint8_t mbap_header[6];
-    
-    // Read MBAP header (6 bytes)
-    int received = recv(client_socket, mbap_header, sizeof(mbap_header), 0);
-    
-    if (received <= 0) {
-        if (received == 0 || errno == ECONNRESET) {
-            return false; // Connection closed
-        }
-        return true; // Try again
+    uint16_t transaction_id = (adu[0] << 8) | adu[1];
+    uint8_t unit_id = adu[6];
+    uint8_t function_code = adu[7];
+    const uint8_t *pdu_data = &adu[8];
+    int pdu_data_len = adu_len - 8; // Data portion after unit_id and function_code
+
+    switch (function_code) {
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            return handle_read_registers(response, transaction_id, unit_id, function_code,
+                                         modbus_read_holding_registers, pdu_data, pdu_data_len);
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            return handle_read_registers(response, transaction_id, unit_id, function_code,
+                                         modbus_read_input_registers, pdu_data, pdu_data_len);
+        case MODBUS_FC_WRITE_SINGLE_REGISTER:
+            return handle_write_single_register(response, transaction_id, unit_id, pdu_data, pdu_data_len);
+        case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+            return handle_write_multiple_registers(response, transaction_id, unit_id, pdu_data, pdu_data_len);
+        case MODBUS_FC_READ_WRITE_MULTIPLE_REGISTERS:
+            return handle_read_write_multiple_registers(response, transaction_id, unit_id, pdu_data, pdu_data_len);
+        default:
+            return build_exception(response, transaction_id, unit_id, function_code,
+                                   MODBUS_EX_ILLEGAL_FUNCTION);
     }
-    
-    if (received < 6) {
-        return true; // Wait for more data
+}
+
+void modbus_protocol_get_stats(modbus_protocol_stats_t *stats)
+{
+    *stats = s_stats;
+}
+
+void modbus_tcp_conn_init(modbus_tcp_conn_t *conn, int client_socket)
+{
+    conn->socket = client_socket;
+    conn->rx_len = 0;
+    conn->tx_len = 0;
+    conn->tx_blocked = false;
+}
+
+// Size of the complete ADU at the start of buf, 0 if incomplete, -1 if the header is invalid
+static int framed_adu_size(const uint8_t *buf, size_t len)
+{
+    if (len < MODBUS_TCP_MBAP_SIZE) {
+        return 0;
     }
-    
-    uint16_t transaction_id = (mbap_header[0] << 8) | mbap_header[1];
-    uint16_t protocol_id = (mbap_header[2] << 8) | mbap_header[3];
-    uint16_t length = (mbap_header[4] << 8) | mbap_header[5];
-    
-    if (protocol_id != 0 || length < 2 || length > 253) {
-        return false;
+    uint16_t protocol_id = (buf[2] << 8) | buf[3];
+    uint16_t length = (buf[4] << 8) | buf[5];
+
+    // A bad header means we have lost framing; there is no way to resynchronize
+    if (protocol_id != 0 || length < 2 || length > MODBUS_TCP_MAX_LENGTH) {
+        return -1;
     }
-    
-    // Read PDU (unit_id + function_code + data)
-    // MBAP length field includes unit_id byte, so PDU is length bytes total
-    uint8_t pdu[256];
-    if (length > sizeof(pdu)) {
-        return false;
+    size_t adu_len = MODBUS_TCP_MBAP_SIZE + length;
+    return len < adu_len ? 0 : (int)adu_len;
+}
+
+bool modbus_tcp_process_buffer(modbus_tcp_conn_t *conn, unsigned *budget)
+{
+    size_t offset = 0;
+    bool ok = true;
+
+    // Answer every complete ADU within the budget; a trailing partial ADU stays buffered
+    while (*budget > 0 && MODBUS_TCP_TX_BUFFER_SIZE - conn->tx_len >= MODBUS_TCP_MAX_ADU_SIZE) {
+        const uint8_t *adu = &conn->rx_buf[offset];
+        int adu_len = framed_adu_size(adu, conn->rx_len - offset);
+        if (adu_len < 0) {
+            ESP_LOGW(TAG, "Invalid MBAP header (protocol %u, length %u), closing connection",
+                     (adu[2] << 8) | adu[3], (adu[4] << 8) | adu[5]);
+            s_stats.framing_errors++;
+            ok = false;
+            break;
+        }
+        if (adu_len == 0) {
+            break; // Wait for the rest of the ADU
+        }
+
+        uint8_t *response = &conn->tx_buf[conn->tx_len];
+        conn->tx_len += execute_adu(adu, adu_len, response);
+        s_stats.requests++;
+        if (response[7] & 0x80) {
+            s_stats.exceptions++;
+        }
+        offset += adu_len;
+        (*budget)--;
     }
-    
-    // Read the full PDU - may need multiple recv calls for large PDUs
-    size_t total_received = 0;
-    while (total_received < length) {
-        received = recv(client_socket, pdu + total_received, length - total_received, 0);
-        if (received <= 0) {
-            if (received == 0 || errno == ECONNRESET) {
-                return false;
+
+    if (offset > 0) {
+        conn->rx_len -= offset;
+        memmove(conn->rx_buf, &conn->rx_buf[offset], conn->rx_len);
+    }
+    return ok;
+}
+
+// Send the buffered responses without blocking; what the client does not
+// take moves to the front of tx_buf and tx_blocked is set
+static bool flush_responses(modbus_tcp_conn_t *conn)
+{
+    size_t sent_total = 0;
+    conn->tx_blocked = false;
+    while (sent_total < conn->tx_len) {
+        int sent = send(conn->socket, &conn->tx_buf[sent_total], conn->tx_len - sent_total, MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
             }
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Would block, try again
-                continue;
+                conn->tx_blocked = true; // Client is not reading; wait until the socket is writable
+                break;
             }
-            ESP_LOGE(TAG, "Error reading PDU: %s", strerror(errno));
+            ESP_LOGE(TAG, "Failed to send responses: %s", strerror(errno));
             return false;
         }
-        total_received += received;
+        sent_total += sent;
     }
-    
-    if (total_received != length || length < 2) {
-        return false;
+    if (sent_total > 0) {
+        conn->tx_len -= sent_total;
+        memmove(conn->tx_buf, &conn->tx_buf[sent_total], conn->tx_len);
     }
-    
-    uint8_t unit_id = pdu[0];
-    uint8_t function_code = pdu[1];
-    const uint8_t *pdu_data = &pdu[2];
-    int pdu_data_len = length - 2; // Data portion after unit_id and function_code
-    
-    bool result = true;
-    switch (function_code) {
-        case MODBUS_FC_READ_HOLDING_REGISTERS:
-            result = handle_read_holding_registers(client_socket, transaction_id, unit_id, pdu_data, pdu_data_len);
-            break;
-        case MODBUS_FC_READ_INPUT_REGISTERS:
-            result = handle_read_input_registers(client_socket, transaction_id, unit_id, pdu_data, pdu_data_len);
-            break;
-        case MODBUS_FC_WRITE_SINGLE_REGISTER:
-            result = handle_write_single_register(client_socket, transaction_id, unit_id, pdu_data, pdu_data_len);
-            break;
-        case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
-            result = handle_write_multiple_registers(client_socket, transaction_id, unit_id, pdu_data, pdu_data_len);
-            break;
-        default:
-            send_exception(client_socket, transaction_id, unit_id, function_code, MODBUS_EX_ILLEGAL_FUNCTION);
-            result = true;
-            break;
+    return true;
+}
+
+bool modbus_tcp_conn_send_blocked(const modbus_tcp_conn_t *conn)
+{
+    return conn->tx_blocked;
+}
+
+bool modbus_tcp_conn_flush(modbus_tcp_conn_t *conn)
+{
+    return flush_responses(conn);
+}
+
+bool modbus_tcp_conn_has_request(const modbus_tcp_conn_t *conn)
+{
+    return framed_adu_size(conn->rx_buf, conn->rx_len) != 0;
+}
+
+// Answer the complete requests in the receive buffer (up to the budget),
+// sending only when the response buffer fills up
+static bool answer_buffered_requests(modbus_tcp_conn_t *conn, unsigned *budget)
+{
+    for (;;) {
+        if (!modbus_tcp_process_buffer(conn, budget)) {
+            flush_responses(conn); // Answer what came before the bad header
+            return false;
+        }
+        if (MODBUS_TCP_TX_BUFFER_SIZE - conn->tx_len >= MODBUS_TCP_MAX_ADU_SIZE) {
+            return true; // Stopped at a partial request or the budget, not at a full response buffer
+        }
+        if (!flush_responses(conn)) {
+            return false;
+        }
+        if (conn->tx_blocked) {
+            return true; // Answer the rest once the client takes the responses
+        }
     }
-    
-    return result;
 }
 
+bool modbus_tcp_handle_request(modbus_tcp_conn_t *conn, unsigned max_requests)
+{
+    unsigned budget = max_requests;
+
+    // Responses the client has not taken yet go out before anything else
+    if (conn->tx_len > 0) {
+        if (!flush_responses(conn)) {
+            return false;
+        }
+        if (conn->tx_blocked) {
+            return true;
+        }
+    }
+
+    // Requests left over from the previous call come first
+    if (!answer_buffered_requests(conn, &budget)) {
+        return false;
+    }
+
+    // Read without blocking while the buffer fills up so that a burst of
+    // pipelined requests is answered in one pass
+    while (budget > 0 && !conn->tx_blocked) {
+        size_t space = sizeof(conn->rx_buf) - conn->rx_len;
+        int received = recv(conn->socket, &conn->rx_buf[conn->rx_len], space, MSG_DONTWAIT);
+
+        if (received == 0) {
+            flush_responses(conn); // Half-closed: still answer what was received
+            return false;
+        }
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                break; // Nothing more for now
+            }
+            if (errno != ECONNRESET) {
+                ESP_LOGE(TAG, "Error reading request: %s", strerror(errno));
+            }
+            return false;
+        }
+        conn->rx_len += received;
+
+        if (!answer_buffered_requests(conn, &budget)) {
+            return false;
+        }
+
+        if ((size_t)received < space) {
+            break; // Socket drained
+        }
+    }
+
+    return flush_responses(conn);
+}
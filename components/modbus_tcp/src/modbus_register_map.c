@@ -24,6 +24,7 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include <stdatomic.h>
 #include <string.h>
 
 // Forward declarations for assembly buffers
@@ -43,6 +44,28 @@ static const char *TAG = "modbus_regmap";
 #define HOLDING_REG_OUTPUT_END   115
 #define HOLDING_REG_CONFIG_START  150
 #define HOLDING_REG_CONFIG_END    154
+#define INPUT_REG_SCALE_END      (MODBUS_SCALE_REG_START + \
+                                  MODBUS_SCALE_CHANNEL_MAX * MODBUS_SCALE_REGS_PER_CHANNEL - 1)
+
+#define SCALE_IMAGE_SIZE (MODBUS_SCALE_CHANNEL_MAX * MODBUS_SCALE_REGS_PER_CHANNEL * 2)
+
+// Copy of one assembly in Modbus byte order, guarded by a sequence counter.
+// The writer makes seq odd while it updates regs and even again afterwards;
+// a reader retries if seq was odd or changed while it copied.
+typedef struct {
+    atomic_uint seq;
+    uint8_t regs[SCALE_IMAGE_SIZE];
+} register_image_t;
+
+static register_image_t s_input_image;    // Input Registers 0-15 (Assembly 100)
+static register_image_t s_output_image;   // Holding Registers 100-115 (Assembly 150)
+static register_image_t s_config_image;   // Holding Registers 150-154 (Assembly 151)
+static register_image_t s_scale_image;    // Input Registers 200+ (32-bit scale values)
+
+static atomic_uint s_word_order = MODBUS_WORD_ORDER_HIGH_FIRST;
+
+// Serializes writers and keeps a writer from being preempted while seq is odd
+static portMUX_TYPE s_image_lock = portMUX_INITIALIZER_UNLOCKED;
 
 static uint16_t bytes_to_big_endian_uint16(const uint8_t *bytes)
 {
@@ -55,133 +78,176 @@ static void uint16_to_big_endian_bytes(uint16_t value, uint8_t *bytes)
     bytes[1] = value & 0xFF;
 }
 
-static uint16_t big_endian_to_little_endian(uint16_t be_value)
-{
-    return ((be_value & 0xFF) << 8) | ((be_value >> 8) & 0xFF);
-}
-
 static SemaphoreHandle_t get_assembly_mutex(void)
 {
     return scale_application_get_assembly_mutex();
 }
 
-bool modbus_read_input_registers(uint16_t start_addr, uint16_t quantity, uint8_t *data)
+// Store registers (already in Modbus byte order) at a byte offset of the image
+static void image_write(register_image_t *image, size_t offset, const uint8_t *regs, size_t size)
 {
-    // Check bounds: start_addr must be within range and quantity must not overflow
-    if (start_addr > INPUT_REG_END || quantity == 0 || start_addr + quantity > INPUT_REG_END + 1) {
-        ESP_LOGE(TAG, "Invalid input register range: %d-%d", start_addr, start_addr + quantity - 1);
-        return false;
-    }
-    
-    SemaphoreHandle_t assembly_mutex = get_assembly_mutex();
-    if (assembly_mutex == NULL) {
-        ESP_LOGE(TAG, "Assembly mutex not initialized");
-        return false;
+    portENTER_CRITICAL(&s_image_lock);
+    if (memcmp(&image->regs[offset], regs, size) != 0) {
+        unsigned seq = atomic_load_explicit(&image->seq, memory_order_relaxed);
+        atomic_store_explicit(&image->seq, seq + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        memcpy(&image->regs[offset], regs, size);
+        atomic_store_explicit(&image->seq, seq + 2, memory_order_release);
     }
-    
-    xSemaphoreTake(assembly_mutex, portMAX_DELAY);
-    
-    // Map Input Assembly 100 (32 bytes = 16 registers) to Modbus Input Registers 0-15
+    portEXIT_CRITICAL(&s_image_lock);
+}
+
+static void image_update(register_image_t *image, const uint8_t *assembly, size_t size)
+{
     // Assembly data is stored as little-endian bytes [low_byte, high_byte]
     // Modbus requires big-endian bytes [high_byte, low_byte]
-    for (uint16_t i = 0; i < quantity; i++) {
-        uint16_t reg_addr = start_addr + i;
-        uint16_t byte_offset = reg_addr * 2;
-        
-        if (byte_offset + 1 < sizeof(g_assembly_data064)) {
-            // Read little-endian from assembly: [low_byte, high_byte]
-            uint8_t low_byte = g_assembly_data064[byte_offset];
-            uint8_t high_byte = g_assembly_data064[byte_offset + 1];
-            
-            // Write as big-endian for Modbus: [high_byte, low_byte]
-            data[i * 2] = high_byte;
-            data[i * 2 + 1] = low_byte;
-            
-        } else {
-            // Out of range, return zero
-            data[i * 2] = 0;
-            data[i * 2 + 1] = 0;
-        }
+    uint8_t swapped[sizeof(image->regs)];
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        swapped[i] = assembly[i + 1];
+        swapped[i + 1] = assembly[i];
     }
-    
-    xSemaphoreGive(assembly_mutex);
-    return true;
+    image_write(image, 0, swapped, size);
 }
 
-bool modbus_read_holding_registers(uint16_t start_addr, uint16_t quantity, uint8_t *data)
+// Two registers holding a 32-bit value, each register big-endian
+static void put_uint32(uint8_t *regs, uint32_t value, unsigned word_order)
 {
-    // Check if address is in output assembly range (100-115)
-    if (start_addr >= HOLDING_REG_OUTPUT_START && start_addr + quantity <= HOLDING_REG_OUTPUT_END + 1) {
-        SemaphoreHandle_t assembly_mutex = get_assembly_mutex();
-        if (assembly_mutex == NULL) {
-            return false;
+    uint16_t high = value >> 16;
+    uint16_t low = value & 0xFFFF;
+    if (word_order == MODBUS_WORD_ORDER_LOW_FIRST) {
+        uint16_to_big_endian_bytes(low, &regs[0]);
+        uint16_to_big_endian_bytes(high, &regs[2]);
+    } else {
+        uint16_to_big_endian_bytes(high, &regs[0]);
+        uint16_to_big_endian_bytes(low, &regs[2]);
+    }
+}
+
+static void put_float(uint8_t *regs, float value, unsigned word_order)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_uint32(regs, bits, word_order);
+}
+
+static void image_read(register_image_t *image, uint16_t reg_offset, uint16_t quantity, uint8_t *data)
+{
+    for (;;) {
+        unsigned seq = atomic_load_explicit(&image->seq, memory_order_acquire);
+        if (seq & 1) {
+            continue; // Writer is mid-update on the other core
         }
-        
-        xSemaphoreTake(assembly_mutex, portMAX_DELAY);
-        
-        // Map Output Assembly 150 (32 bytes = 16 registers) to Modbus Holding Registers 100-115
-        // Assembly data is stored as little-endian bytes [low_byte, high_byte]
-        // Modbus requires big-endian bytes [high_byte, low_byte]
-        uint16_t reg_offset = start_addr - HOLDING_REG_OUTPUT_START;
-        for (uint16_t i = 0; i < quantity; i++) {
-            uint16_t byte_offset = (reg_offset + i) * 2;
-            
-            if (byte_offset + 1 < sizeof(g_assembly_data096)) {
-                // Read little-endian from assembly: [low_byte, high_byte]
-                uint8_t low_byte = g_assembly_data096[byte_offset];
-                uint8_t high_byte = g_assembly_data096[byte_offset + 1];
-                
-                // Write as big-endian for Modbus: [high_byte, low_byte]
-                data[i * 2] = high_byte;
-                data[i * 2 + 1] = low_byte;
-                
-            } else {
-                // Out of range, return zero
-                data[i * 2] = 0;
-                data[i * 2 + 1] = 0;
-            }
+        memcpy(data, &image->regs[reg_offset * 2], quantity * 2);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&image->seq, memory_order_relaxed) == seq) {
+            return;
         }
-        
-        xSemaphoreGive(assembly_mutex);
+    }
+}
+
+void modbus_register_map_assembly_updated(uint16_t assembly_instance)
+{
+    switch (assembly_instance) {
+        case MODBUS_ASSEMBLY_INPUT:
+            image_update(&s_input_image, g_assembly_data064, sizeof(g_assembly_data064));
+            break;
+        case MODBUS_ASSEMBLY_OUTPUT:
+            image_update(&s_output_image, g_assembly_data096, sizeof(g_assembly_data096));
+            break;
+        case MODBUS_ASSEMBLY_CONFIG:
+            image_update(&s_config_image, g_assembly_data097, sizeof(g_assembly_data097));
+            break;
+        default:
+            break;
+    }
+}
+
+void modbus_register_map_set_word_order(uint8_t word_order)
+{
+    atomic_store(&s_word_order, word_order == MODBUS_WORD_ORDER_LOW_FIRST ?
+                 MODBUS_WORD_ORDER_LOW_FIRST : MODBUS_WORD_ORDER_HIGH_FIRST);
+}
+
+void modbus_register_map_set_scale_values(uint8_t channel, const modbus_scale_values_t *values)
+{
+    if (channel >= MODBUS_SCALE_CHANNEL_MAX || values == NULL) {
+        return;
+    }
+
+    unsigned word_order = atomic_load(&s_word_order);
+    uint8_t regs[MODBUS_SCALE_REGS_PER_CHANNEL * 2] = {0};
+    put_uint32(&regs[0], (uint32_t)values->weight_scaled, word_order);
+    put_float(&regs[4], values->weight, word_order);
+    put_uint32(&regs[8], (uint32_t)values->raw, word_order);
+    put_float(&regs[12], (float)values->raw, word_order);
+    put_uint32(&regs[16], (uint32_t)values->filtered, word_order);
+    put_float(&regs[20], values->filtered_exact, word_order);
+    uint16_to_big_endian_bytes(values->unit, &regs[24]);
+    uint16_to_big_endian_bytes(values->status, &regs[26]);
+    // Registers 14-15 of the block are reserved (zero)
+
+    image_write(&s_scale_image, channel * sizeof(regs), regs, sizeof(regs));
+}
+
+bool modbus_read_input_registers(uint16_t start_addr, uint16_t quantity, uint8_t *data)
+{
+    // Input Assembly 100 (32 bytes = 16 registers) maps to Modbus Input Registers 0-15
+    if (start_addr <= INPUT_REG_END && quantity > 0 && start_addr + quantity <= INPUT_REG_END + 1) {
+        image_read(&s_input_image, start_addr - INPUT_REG_START, quantity, data);
         return true;
     }
-    
-    // Check if address is in config assembly range (150-154)
+
+    // 32-bit scale values, MODBUS_SCALE_REGS_PER_CHANNEL registers per channel
+    if (start_addr >= MODBUS_SCALE_REG_START && quantity > 0 && start_addr + quantity <= INPUT_REG_SCALE_END + 1) {
+        image_read(&s_scale_image, start_addr - MODBUS_SCALE_REG_START, quantity, data);
+        return true;
+    }
+
+    ESP_LOGE(TAG, "Invalid input register range: %d-%d", start_addr, start_addr + quantity - 1);
+    return false;
+}
+
+// Image and register offset behind a holding register range, NULL if the range is not mapped
+static register_image_t *holding_image(uint16_t start_addr, uint16_t quantity, uint16_t *reg_offset)
+{
+    // Output Assembly 150 (32 bytes = 16 registers) maps to Modbus Holding Registers 100-115
+    if (start_addr >= HOLDING_REG_OUTPUT_START && start_addr + quantity <= HOLDING_REG_OUTPUT_END + 1) {
+        *reg_offset = start_addr - HOLDING_REG_OUTPUT_START;
+        return &s_output_image;
+    }
+
+    // Config Assembly 151 (10 bytes = 5 registers) maps to Modbus Holding Registers 150-154
     if (start_addr >= HOLDING_REG_CONFIG_START && start_addr + quantity <= HOLDING_REG_CONFIG_END + 1) {
-        SemaphoreHandle_t assembly_mutex = get_assembly_mutex();
-        if (assembly_mutex == NULL) {
-            return false;
-        }
-        
-        xSemaphoreTake(assembly_mutex, portMAX_DELAY);
-        
-        // Map Config Assembly 151 (10 bytes = 5 registers) to Modbus Holding Registers 150-154
-        // Assembly data is stored as little-endian bytes [low_byte, high_byte]
-        // Modbus requires big-endian bytes [high_byte, low_byte]
-        uint16_t reg_offset = start_addr - HOLDING_REG_CONFIG_START;
-        for (uint16_t i = 0; i < quantity; i++) {
-            uint16_t byte_offset = (reg_offset + i) * 2;
-            
-            if (byte_offset + 1 < sizeof(g_assembly_data097)) {
-                // Read little-endian from assembly: [low_byte, high_byte]
-                uint8_t low_byte = g_assembly_data097[byte_offset];
-                uint8_t high_byte = g_assembly_data097[byte_offset + 1];
-                
-                // Write as big-endian for Modbus: [high_byte, low_byte]
-                data[i * 2] = high_byte;
-                data[i * 2 + 1] = low_byte;
-            } else {
-                // Out of range, return zero
-                data[i * 2] = 0;
-                data[i * 2 + 1] = 0;
-            }
-        }
-        
-        xSemaphoreGive(assembly_mutex);
+        *reg_offset = start_addr - HOLDING_REG_CONFIG_START;
+        return &s_config_image;
+    }
+
+    // The 32-bit scale values are also readable as holding registers, so FC 0x17
+    // can write the outputs and read the weight in one transaction
+    if (start_addr >= MODBUS_SCALE_REG_START && start_addr + quantity <= INPUT_REG_SCALE_END + 1) {
+        *reg_offset = start_addr - MODBUS_SCALE_REG_START;
+        return &s_scale_image;
+    }
+
+    return NULL;
+}
+
+bool modbus_holding_registers_readable(uint16_t start_addr, uint16_t quantity)
+{
+    uint16_t reg_offset;
+    return quantity > 0 && holding_image(start_addr, quantity, &reg_offset) != NULL;
+}
+
+bool modbus_read_holding_registers(uint16_t start_addr, uint16_t quantity, uint8_t *data)
+{
+    uint16_t reg_offset;
+    register_image_t *image = holding_image(start_addr, quantity, &reg_offset);
+    if (image != NULL) {
+        image_read(image, reg_offset, quantity, data);
         return true;
     }
-    
-        ESP_LOGE(TAG, "Invalid holding register range: %d-%d", start_addr, start_addr + quantity - 1);
+
+    ESP_LOGE(TAG, "Invalid holding register range: %d-%d", start_addr, start_addr + quantity - 1);
     return false;
 }
 
@@ -210,13 +276,13 @@ bool modbus_write_holding_registers(uint16_t start_addr, uint16_t quantity, cons
             
             if (byte_offset + 1 < sizeof(g_assembly_data096)) {
                 // Convert big-endian from Modbus to little-endian for assembly
-                uint16_t be_value = bytes_to_big_endian_uint16(&data[i * 2]);
-                uint16_t le_value = big_endian_to_little_endian(be_value);
-                g_assembly_data096[byte_offset] = le_value & 0xFF;
-                g_assembly_data096[byte_offset + 1] = (le_value >> 8) & 0xFF;
+                uint16_t value = bytes_to_big_endian_uint16(&data[i * 2]);
+                g_assembly_data096[byte_offset] = value & 0xFF;
+                g_assembly_data096[byte_offset + 1] = (value >> 8) & 0xFF;
             }
         }
         
+        modbus_register_map_assembly_updated(MODBUS_ASSEMBLY_OUTPUT);
         xSemaphoreGive(assembly_mutex);
         
         return true;
@@ -237,13 +303,13 @@ bool modbus_write_holding_registers(uint16_t start_addr, uint16_t quantity, cons
             uint16_t byte_offset = (reg_offset + i) * 2;
             
             if (byte_offset + 1 < sizeof(g_assembly_data097)) {
-                uint16_t be_value = bytes_to_big_endian_uint16(&data[i * 2]);
-                uint16_t le_value = big_endian_to_little_endian(be_value);
-                g_assembly_data097[byte_offset] = le_value & 0xFF;
-                g_assembly_data097[byte_offset + 1] = (le_value >> 8) & 0xFF;
+                uint16_t value = bytes_to_big_endian_uint16(&data[i * 2]);
+                g_assembly_data097[byte_offset] = value & 0xFF;
+                g_assembly_data097[byte_offset + 1] = (value >> 8) & 0xFF;
             }
         }
         
+        modbus_register_map_assembly_updated(MODBUS_ASSEMBLY_CONFIG);
         xSemaphoreGive(assembly_mutex);
         return true;
     }
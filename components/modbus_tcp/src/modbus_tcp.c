@@ -23,115 +23,298 @@
 #include "modbus_tcp.h"
 #include "modbus_protocol.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "lwip/sockets.h"
 #include "lwip/netdb.h"
 #include "lwip/inet.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "sdkconfig.h"
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
 static const char *TAG = "modbus_tcp";
 static int s_listen_socket = -1;
 static TaskHandle_t s_server_task_handle = NULL;
-static bool s_running = false;
+static atomic_bool s_running = false;
 static SemaphoreHandle_t s_modbus_mutex = NULL;
+static modbus_tcp_stats_t s_stats;  // Connection counters; written by the server task only
 
-#define MODBUS_TCP_PORT 502
-#define MODBUS_TCP_MAX_CONNECTIONS 20
+#ifndef MODBUS_TCP_PORT
+  #define MODBUS_TCP_PORT 502
+#endif
 
-static void modbus_tcp_server_task(void *pvParameters)
+#ifdef CONFIG_OPENER_MODBUS_MAX_CONNECTIONS
+  #define MODBUS_TCP_MAX_CONNECTIONS CONFIG_OPENER_MODBUS_MAX_CONNECTIONS
+#else
+  #define MODBUS_TCP_MAX_CONNECTIONS 20
+#endif
+
+#ifdef CONFIG_OPENER_MODBUS_IDLE_TIMEOUT_S
+  #define MODBUS_TCP_IDLE_TIMEOUT_S CONFIG_OPENER_MODBUS_IDLE_TIMEOUT_S
+#else
+  #define MODBUS_TCP_IDLE_TIMEOUT_S 60
+#endif
+
+#ifdef CONFIG_OPENER_MODBUS_REQUEST_BUDGET
+  #define MODBUS_TCP_REQUEST_BUDGET CONFIG_OPENER_MODBUS_REQUEST_BUDGET
+#else
+  #define MODBUS_TCP_REQUEST_BUDGET 4
+#endif
+
+#define MODBUS_TCP_MAX_WAIT_US   1000000  // Longest select() wait, bounds the reaction to modbus_tcp_stop()
+
+typedef struct {
+    modbus_tcp_conn_t *conn;      // NULL if the slot is free
+    int64_t last_activity_us;     // Last time the client sent data
+} modbus_tcp_client_t;
+
+// Server state, owned by the server task
+typedef struct {
+    int listen_fd;                // Copy of s_listen_socket, which modbus_tcp_stop() may reset at any time
+    modbus_tcp_client_t clients[MODBUS_TCP_MAX_CONNECTIONS];
+    int8_t fd_slot[FD_SETSIZE];   // Client slot of each socket, -1 if none
+    fd_set active_fds;            // Listen socket and all client sockets
+    int max_fd;
+    int count;
+    int next_slot;                // First slot served in the next pass (round robin)
+} modbus_tcp_server_t;
+
+static void server_recompute_max_fd(modbus_tcp_server_t *server)
+{
+    server->max_fd = server->listen_fd;
+    for (int i = 0; i < MODBUS_TCP_MAX_CONNECTIONS; i++) {
+        if (server->clients[i].conn != NULL && server->clients[i].conn->socket > server->max_fd) {
+            server->max_fd = server->clients[i].conn->socket;
+        }
+    }
+}
+
+static void server_close_client(modbus_tcp_server_t *server, int slot)
+{
+    modbus_tcp_client_t *client = &server->clients[slot];
+    int fd = client->conn->socket;
+
+    FD_CLR(fd, &server->active_fds);
+    server->fd_slot[fd] = -1;
+    close(fd);
+    free(client->conn);
+    client->conn = NULL;
+    server->count--;
+    s_stats.connections_active = server->count;
+    if (fd == server->max_fd) {
+        server_recompute_max_fd(server);
+    }
+}
+
+// Least recently active client, evicted to make room for a new connection
+static int server_lru_slot(const modbus_tcp_server_t *server)
+{
+    int lru = -1;
+    for (int i = 0; i < MODBUS_TCP_MAX_CONNECTIONS; i++) {
+        if (server->clients[i].conn != NULL &&
+            (lru < 0 || server->clients[i].last_activity_us < server->clients[lru].last_activity_us)) {
+            lru = i;
+        }
+    }
+    return lru;
+}
+
+static void server_accept(modbus_tcp_server_t *server, int64_t now_us)
 {
     struct sockaddr_in client_addr;
     socklen_t client_addr_len = sizeof(client_addr);
-    int client_sockets[MODBUS_TCP_MAX_CONNECTIONS];
-    int max_fd;
-    fd_set read_fds;
-    bool running = true;
-    
-    memset(client_sockets, -1, sizeof(client_sockets));
-    
-    while (running) {
-        // Check running flag with mutex protection
-        if (s_modbus_mutex != NULL) {
-            xSemaphoreTake(s_modbus_mutex, portMAX_DELAY);
-            running = s_running;
-            xSemaphoreGive(s_modbus_mutex);
-        }
-        
-        if (!running) {
+    int new_socket = accept(server->listen_fd, (struct sockaddr *)&client_addr, &client_addr_len);
+    if (new_socket < 0) {
+        return;
+    }
+    if (new_socket >= FD_SETSIZE) {
+        ESP_LOGE(TAG, "Socket %d outside select() range, closing new connection", new_socket);
+        close(new_socket);
+        return;
+    }
+
+    // Disable Nagle's algorithm for low latency
+    int flag = 1;
+    if (setsockopt(new_socket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) < 0) {
+        ESP_LOGW(TAG, "Failed to set TCP_NODELAY on new connection: %s", strerror(errno));
+    }
+
+    modbus_tcp_conn_t *conn = malloc(sizeof(modbus_tcp_conn_t));
+    if (conn == NULL) {
+        ESP_LOGE(TAG, "Out of memory, closing new connection");
+        close(new_socket);
+        return;
+    }
+
+    if (server->count == MODBUS_TCP_MAX_CONNECTIONS) {
+        int lru = server_lru_slot(server);
+        ESP_LOGW(TAG, "Max connections reached, closing least recently active client (idle %lld ms)",
+                 (long long)((now_us - server->clients[lru].last_activity_us) / 1000));
+        server_close_client(server, lru);
+        s_stats.connections_evicted++;
+    }
+
+    for (int i = 0; i < MODBUS_TCP_MAX_CONNECTIONS; i++) {
+        if (server->clients[i].conn == NULL) {
+            modbus_tcp_conn_init(conn, new_socket);
+            server->clients[i].conn = conn;
+            server->clients[i].last_activity_us = now_us;
+            server->fd_slot[new_socket] = i;
+            FD_SET(new_socket, &server->active_fds);
+            if (new_socket > server->max_fd) {
+                server->max_fd = new_socket;
+            }
+            server->count++;
+            s_stats.connections_active = server->count;
+            s_stats.connections_accepted++;
             break;
         }
-        FD_ZERO(&read_fds);
-        FD_SET(s_listen_socket, &read_fds);
-        max_fd = s_listen_socket;
-        
-        // Add client sockets to set
+    }
+}
+
+static void modbus_tcp_server_task(void *pvParameters)
+{
+    (void)pvParameters;
+    // The fd map and fd_set are sized by FD_SETSIZE; keep them off the task stack
+    modbus_tcp_server_t *server = calloc(1, sizeof(modbus_tcp_server_t));
+    int64_t wait_us = MODBUS_TCP_MAX_WAIT_US;
+
+    if (server == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate ModbusTCP server state");
+        atomic_store(&s_running, false);
+    } else {
+        xSemaphoreTake(s_modbus_mutex, portMAX_DELAY);
+        server->listen_fd = s_listen_socket;
+        xSemaphoreGive(s_modbus_mutex);
+        if (server->listen_fd < 0) {
+            atomic_store(&s_running, false); // Stopped before the task got to run
+        } else {
+            memset(server->fd_slot, -1, sizeof(server->fd_slot));
+            FD_ZERO(&server->active_fds);
+            FD_SET(server->listen_fd, &server->active_fds);
+            server->max_fd = server->listen_fd;
+        }
+    }
+
+    while (atomic_load(&s_running)) {
+        // A client that is not taking its responses is waited on for
+        // writability only; its requests stay in the socket until then
+        fd_set read_fds = server->active_fds;
+        fd_set write_fds;
+        FD_ZERO(&write_fds);
         for (int i = 0; i < MODBUS_TCP_MAX_CONNECTIONS; i++) {
-            if (client_sockets[i] >= 0) {
-                FD_SET(client_sockets[i], &read_fds);
-                if (client_sockets[i] > max_fd) {
-                    max_fd = client_sockets[i];
-                }
+            modbus_tcp_conn_t *conn = server->clients[i].conn;
+            if (conn != NULL && modbus_tcp_conn_send_blocked(conn)) {
+                FD_CLR(conn->socket, &read_fds);
+                FD_SET(conn->socket, &write_fds);
             }
         }
+        struct timeval timeout = {
+            .tv_sec = wait_us / 1000000,
+            .tv_usec = wait_us % 1000000,
+        };
+        int activity = select(server->max_fd + 1, &read_fds, &write_fds, NULL, &timeout);
         
-        struct timeval timeout = {.tv_sec = 1, .tv_usec = 0};
-        int activity = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
-        
-        if (activity < 0 && errno != EINTR) {
-            ESP_LOGE(TAG, "Select error: %s", strerror(errno));
+        if (activity < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (atomic_load(&s_running)) {
+                ESP_LOGE(TAG, "Select error: %s", strerror(errno));
+            }
             break;
         }
+        if (!atomic_load(&s_running)) {
+            break; // Stopped during select(); the listen socket is already closed
+        }
+        int64_t now_us = esp_timer_get_time();
         
         // Check for new connections
-        if (FD_ISSET(s_listen_socket, &read_fds)) {
-            int new_socket = accept(s_listen_socket, (struct sockaddr *)&client_addr, &client_addr_len);
-            if (new_socket >= 0) {
-                // New ModbusTCP connection
-                
-                // Disable Nagle's algorithm for low latency
-                int flag = 1;
-                if (setsockopt(new_socket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) < 0) {
-                    ESP_LOGW(TAG, "Failed to set TCP_NODELAY on new connection: %s", strerror(errno));
-                }
-                
-                // Find empty slot
-                bool added = false;
-                for (int i = 0; i < MODBUS_TCP_MAX_CONNECTIONS; i++) {
-                    if (client_sockets[i] < 0) {
-                        client_sockets[i] = new_socket;
-                        added = true;
-                        break;
-                    }
-                }
-                
-                if (!added) {
-                    ESP_LOGE(TAG, "Max connections reached, closing new connection");
-                    close(new_socket);
-                }
+        if (FD_ISSET(server->listen_fd, &read_fds)) {
+            server_accept(server, now_us);
+            activity--;
+        }
+        
+        // Mark readable and writable clients, found through the fd map
+        bool ready[MODBUS_TCP_MAX_CONNECTIONS] = {false};
+        bool writable[MODBUS_TCP_MAX_CONNECTIONS] = {false};
+        for (int fd = 0; fd <= server->max_fd && activity > 0; fd++) {
+            if (fd == server->listen_fd || server->fd_slot[fd] < 0) {
+                continue;
+            }
+            if (FD_ISSET(fd, &read_fds)) {
+                activity--;
+                ready[server->fd_slot[fd]] = true;
+            }
+            if (FD_ISSET(fd, &write_fds)) {
+                activity--;
+                writable[server->fd_slot[fd]] = true;
             }
         }
         
-        // Check client sockets for data
-        for (int i = 0; i < MODBUS_TCP_MAX_CONNECTIONS; i++) {
-            if (client_sockets[i] >= 0 && FD_ISSET(client_sockets[i], &read_fds)) {
-                if (!modbus_tcp_handle_request(client_sockets[i])) {
+        // Serve each client at most its request budget per pass, starting at a
+        // different slot each time so no client is always first. Requests left
+        // over from the budget do not make the socket readable again, so they
+        // are served in the next pass without waiting.
+        wait_us = MODBUS_TCP_MAX_WAIT_US;
+        int first = server->next_slot;
+        server->next_slot = (server->next_slot + 1) % MODBUS_TCP_MAX_CONNECTIONS;
+        for (int n = 0; n < MODBUS_TCP_MAX_CONNECTIONS; n++) {
+            int i = (first + n) % MODBUS_TCP_MAX_CONNECTIONS;
+            modbus_tcp_client_t *client = &server->clients[i];
+            if (client->conn == NULL) {
+                continue;
+            }
+            
+            // A client with unsent responses is only flushed until it takes them
+            if (writable[i] && !modbus_tcp_conn_flush(client->conn)) {
+                server_close_client(server, i);
+                continue;
+            }
+            
+            if (!modbus_tcp_conn_send_blocked(client->conn) &&
+                (ready[i] || modbus_tcp_conn_has_request(client->conn))) {
+                if (ready[i]) {
+                    client->last_activity_us = now_us;
+                }
+                if (!modbus_tcp_handle_request(client->conn, MODBUS_TCP_REQUEST_BUDGET)) {
                     // Connection closed or error
-                    // Closing ModbusTCP connection
-                    close(client_sockets[i]);
-                    client_sockets[i] = -1;
+                    server_close_client(server, i);
+                    continue;
                 }
+                if (!modbus_tcp_conn_send_blocked(client->conn) && modbus_tcp_conn_has_request(client->conn)) {
+                    wait_us = 0;
+                }
+            }
+            
+#if MODBUS_TCP_IDLE_TIMEOUT_S > 0
+            // Dead HMIs never close their connection; free the slot
+            int64_t idle_deadline_us = client->last_activity_us + (int64_t)MODBUS_TCP_IDLE_TIMEOUT_S * 1000000;
+            if (now_us >= idle_deadline_us) {
+                ESP_LOGI(TAG, "Closing client idle for %d s", MODBUS_TCP_IDLE_TIMEOUT_S);
+                server_close_client(server, i);
+                s_stats.connections_timed_out++;
+            } else if (idle_deadline_us - now_us < wait_us) {
+                wait_us = idle_deadline_us - now_us;
             }
+#endif
         }
     }
     
     // Cleanup
-    for (int i = 0; i < MODBUS_TCP_MAX_CONNECTIONS; i++) {
-        if (client_sockets[i] >= 0) {
-            close(client_sockets[i]);
+    s_stats.connections_active = 0;
+    if (server != NULL) {
+        for (int i = 0; i < MODBUS_TCP_MAX_CONNECTIONS; i++) {
+            if (server->clients[i].conn != NULL) {
+                close(server->clients[i].conn->socket);
+                free(server->clients[i].conn);
+            }
         }
+        free(server);
     }
     
     if (s_modbus_mutex != NULL) {
@@ -224,10 +407,10 @@ bool modbus_tcp_start(void)
         return true;
     }
     
-    s_running = true;
+    atomic_store(&s_running, true);
     BaseType_t result = xTaskCreate(modbus_tcp_server_task, "modbus_tcp", 8192, NULL, 5, &s_server_task_handle);
     if (result != pdPASS) {
-        s_running = false;
+        atomic_store(&s_running, false);
         xSemaphoreGive(s_modbus_mutex);
         ESP_LOGE(TAG, "Failed to create ModbusTCP server task");
         return false;
@@ -245,7 +428,7 @@ void modbus_tcp_stop(void)
     }
     
     xSemaphoreTake(s_modbus_mutex, portMAX_DELAY);
-    s_running = false;
+    atomic_store(&s_running, false);
     TaskHandle_t task_handle = s_server_task_handle;
     
     // Close socket with mutex protection
@@ -267,3 +450,12 @@ void modbus_tcp_stop(void)
     // ModbusTCP server stopped
 }
 
+void modbus_tcp_get_stats(modbus_tcp_stats_t *stats)
+{
+    modbus_protocol_stats_t protocol;
+    modbus_protocol_get_stats(&protocol);
+    *stats = s_stats;
+    stats->requests = protocol.requests;
+    stats->exceptions = protocol.exceptions;
+    stats->framing_errors = protocol.framing_errors;
+}
@@ -101,16 +101,15 @@ void app_main(void)
     
     // Step 6: Main loop - continuously read weight values
     while (1) {
-        // Check if a new reading is available
-        if (nau7802_available(&scale)) {
-            // Get raw ADC reading (24-bit signed integer)
-            int32_t reading = nau7802_get_reading(&scale);
-            
+        // Read status and, if a conversion is ready, the raw ADC value (24-bit
+        // signed integer); ESP_OK means a new conversion was read
+        nau7802_sample_t sample;
+        if (nau7802_read_sample(&scale, &sample) == ESP_OK) {
             // Get calibrated weight with averaging (multiple samples) for stability
             // Parameters: allow_negative=false, sample_count=READING_SAMPLE_COUNT, timeout=READING_TIMEOUT_MS
             float weight = nau7802_get_weight(&scale, false, READING_SAMPLE_COUNT, READING_TIMEOUT_MS);
             
-            ESP_LOGI(TAG, "Reading: %ld, Weight: %.2f", reading, weight);
+            ESP_LOGI(TAG, "Reading: %ld, Weight: %.2f", sample.raw, weight);
         }
         
         // Small delay to avoid busy-waiting
@@ -77,12 +77,11 @@ static void gpio_task(void* arg)
         // Wait for interrupt event from queue
         if (xQueueReceive(gpio_evt_queue, &io_num, portMAX_DELAY)) {
             if (io_num == CRDY_GPIO) {
-                // CRDY interrupt occurred - check if data is ready
-                if (nau7802_available(scale)) {
-                    // Read the data
-                    int32_t reading = nau7802_get_reading(scale);
-                    float weight = nau7802_get_weight(scale, false, 1, 0);
-                    ESP_LOGI(TAG, "Interrupt! Reading: %ld, Weight: %.2f", reading, weight);
+                // CRDY interrupt occurred - read status, then the data it announces
+                nau7802_sample_t sample;
+                if (nau7802_read_sample(scale, &sample) == ESP_OK) {
+                    float weight = ((float)sample.raw - scale->zero_offset) / scale->calibration_factor;
+                    ESP_LOGI(TAG, "Interrupt! Reading: %ld, Weight: %.2f", sample.raw, weight);
                 }
             }
         }
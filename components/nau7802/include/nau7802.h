@@ -84,6 +84,9 @@
 #define NAU7802_REGISTER_POWER 0x1C
 #define NAU7802_REGISTER_REVISION_ID 0x1F
 
+/** Number of registers mirrored in the register shadow (0x00 through POWER) */
+#define NAU7802_SHADOW_SIZE (NAU7802_REGISTER_POWER + 1)
+
 #define NAU7802_PU_CTRL_RR 0
 #define NAU7802_PU_CTRL_PUD 1
 #define NAU7802_PU_CTRL_PUA 2
@@ -146,7 +149,10 @@ typedef struct {
     uint8_t address;                   /**< I2C device address */
     float calibration_factor;          /**< Calibration factor for weight calculation */
     float zero_offset;                 /**< Zero offset (tare value) */
-    uint32_t ldo_ramp_delay;           /**< LDO ramp delay in milliseconds (default: 250) */
+    uint32_t ldo_ramp_delay;           /**< Upper bound for the LDO settle wait in milliseconds (default: 250) */
+    uint8_t shadow[NAU7802_SHADOW_SIZE]; /**< Last value written to / read from each configuration register */
+    uint32_t shadow_valid;             /**< Bit n set when shadow[n] is known to match the device */
+    int32_t last_raw;                  /**< Last conversion read by nau7802_read_sample() */
 } nau7802_t;
 
 /**
@@ -195,6 +201,29 @@ typedef enum {
     NAU7802_CALMOD_GAIN = 3      /**< External gain calibration */
 } nau7802_cal_mode_t;
 
+/**
+ * @brief One conversion as returned by nau7802_read_sample()
+ *
+ * pu_ctrl is read just before the ADC data, so it describes the device state
+ * at the moment the sample was read.
+ */
+typedef struct {
+    int32_t raw;           /**< 24-bit signed ADC reading (last conversion, see return code for freshness) */
+    int64_t timestamp_us;  /**< esp_timer time the data was read, microseconds since boot */
+    uint8_t pu_ctrl;       /**< PU_CTRL register (CR, PUR, AVDDS, ...) */
+    uint8_t ctrl2;         /**< CTRL2 as last written (register shadow); not read from the device */
+} nau7802_sample_t;
+
+/**
+ * @brief Analog front-end configuration applied by nau7802_configure()
+ */
+typedef struct {
+    uint8_t ldo;                   /**< LDO voltage (0b000=4.5V ... 0b100=3.3V ... 0b111=2.4V) */
+    nau7802_gain_t gain;           /**< PGA gain */
+    nau7802_sps_t sample_rate;     /**< Conversion rate */
+    nau7802_channel_t channel;     /**< Active input channel */
+} nau7802_config_t;
+
 /** @} */
 
 /** @defgroup NAU7802_Initialization Initialization Functions
@@ -216,6 +245,21 @@ typedef enum {
  */
 esp_err_t nau7802_init(nau7802_t *dev, i2c_master_bus_handle_t i2c_bus, uint8_t address);
 
+/**
+ * @brief Initialize the NAU7802 device structure on an existing device handle
+ * 
+ * Like nau7802_init(), but the caller provides the device handle, e.g. one
+ * already added to the bus or a simulated device (see nau7802_sim.h).
+ * The handle is registered with the I2C scheduler.
+ * 
+ * @param dev Pointer to NAU7802 device structure
+ * @param i2c_dev Device handle
+ * @param address I2C device address (typically NAU7802_I2C_ADDRESS)
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG if dev or i2c_dev is NULL
+ */
+esp_err_t nau7802_init_device(nau7802_t *dev, i2c_master_dev_handle_t i2c_dev, uint8_t address);
+
 /**
  * @brief Check if the NAU7802 device is connected and responding
  * 
@@ -246,6 +290,41 @@ bool nau7802_is_connected(nau7802_t *dev);
  */
 esp_err_t nau7802_begin(nau7802_t *dev);
 
+/**
+ * @brief Complete initialization with an explicit front-end configuration
+ * 
+ * Same sequence as nau7802_begin(), but programs @p config instead of the
+ * defaults so the AFE is calibrated once for the final settings. All register
+ * setup is written as one batch (see nau7802_configure()), and the LDO, AFE
+ * calibration and first conversion waits poll the status bits instead of
+ * sleeping for fixed times. The time to the first conversion is logged.
+ * 
+ * @param dev Pointer to NAU7802 device structure (must be initialized with nau7802_init())
+ * @param config Front-end configuration to apply
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_RESPONSE on calibration failure
+ * @return ESP_ERR_TIMEOUT if the device did not power up or convert in time
+ */
+esp_err_t nau7802_begin_config(nau7802_t *dev, const nau7802_config_t *config);
+
+/**
+ * @brief Apply a front-end configuration as one batch of register writes
+ * 
+ * The target register values are computed from the register shadow and only
+ * registers whose value changes are written, without per-write delays. One
+ * burst read afterwards verifies every written register and refreshes the
+ * shadow. If the LDO, gain or sample rate changed, the function waits for the
+ * LDO to settle (first complete conversion after the change, bounded by the
+ * LDO ramp delay) and recalibrates the AFE.
+ * 
+ * @param dev Pointer to NAU7802 device structure
+ * @param config Front-end configuration to apply
+ * @return ESP_OK on success (also when nothing changed)
+ * @return ESP_ERR_INVALID_RESPONSE on calibration failure
+ * @return Other error codes from the I2C driver
+ */
+esp_err_t nau7802_configure(nau7802_t *dev, const nau7802_config_t *config);
+
 /** @} */
 
 /** @defgroup NAU7802_Configuration Configuration Functions
@@ -292,11 +371,12 @@ esp_err_t nau7802_set_ldo(nau7802_t *dev, uint8_t ldo_value);
 /**
  * @brief Set the LDO ramp delay
  * 
- * The LDO takes approximately 200ms to ramp up. This delay is used during
- * initialization before performing AFE calibration.
+ * The LDO has no ready flag, so after an LDO change the driver waits for the
+ * first conversion started after the change before calibrating the AFE. This
+ * value bounds that wait.
  * 
  * @param dev Pointer to NAU7802 device structure
- * @param delay_ms Delay in milliseconds (default: 250)
+ * @param delay_ms Maximum wait in milliseconds (default: 250)
  * @return ESP_OK on success
  */
 esp_err_t nau7802_set_ldo_ramp_delay(nau7802_t *dev, uint32_t delay_ms);
@@ -420,6 +500,27 @@ bool nau7802_available(nau7802_t *dev);
  */
 int32_t nau7802_get_reading(nau7802_t *dev);
 
+/**
+ * @brief Read a conversion if one is ready
+ * 
+ * Reads PU_CTRL (4 bytes on the bus) and, only when CR is set, the three ADC
+ * data bytes (6 bytes on the bus). A poll that finds no new conversion costs
+ * a single 1-byte register read.
+ * 
+ * @p sample is filled whenever the status read succeeded, including when no
+ * new conversion is ready (raw then holds the previous conversion read by
+ * this function).
+ * 
+ * @param dev Pointer to NAU7802 device structure
+ * @param sample Receives the reading, timestamp and status registers
+ * @return ESP_OK if a new conversion was read (CR bit set)
+ * @return ESP_ERR_NOT_FINISHED if no new conversion was ready
+ * @return ESP_ERR_INVALID_STATE if the device is not powered up (PUR clear, e.g. after a brown-out)
+ * @return ESP_ERR_INVALID_ARG if dev or sample is NULL
+ * @return Other error codes from the I2C driver if the transaction failed
+ */
+esp_err_t nau7802_read_sample(nau7802_t *dev, nau7802_sample_t *sample);
+
 /**
  * @brief Get the average of multiple readings
  * 
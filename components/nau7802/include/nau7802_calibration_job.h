@@ -0,0 +1,126 @@
+/*
+ * Background calibration jobs for NAU7802 scales
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file nau7802_calibration_job.h
+ * @brief Tare, span and AFE calibration as background jobs
+ *
+ * Callers submit a job and get an ID back immediately; progress and the
+ * result are polled with nau7802_cal_job_get(). Tare and span jobs average
+ * the raw conversions the acquisition task records in the channel's history
+ * ring (see nau7802_history.h), starting with the first conversion after the
+ * job was submitted, so they never read the device themselves. The device
+ * mutex is only taken to apply the result; the record is then saved with
+ * nau7802_calibration_save_channel(). AFE jobs run nau7802_calibrate_af()
+ * with the device mutex held.
+ *
+ * Jobs are executed by one worker task, created on the first submission.
+ * One job per channel can run at a time. The last NAU7802_CAL_JOB_SLOTS jobs
+ * are kept for polling.
+ */
+
+#ifndef NAU7802_CALIBRATION_JOB_H
+#define NAU7802_CALIBRATION_JOB_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "nau7802.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NAU7802_CAL_JOB_SLOTS 8              /**< Jobs kept for polling */
+#define NAU7802_CAL_JOB_MAX_SAMPLES 1024     /**< Largest sample count per job */
+
+/**
+ * @brief Job type
+ */
+typedef enum {
+    NAU7802_CAL_JOB_TARE = 0,    /**< Set the zero offset to the average reading */
+    NAU7802_CAL_JOB_SPAN,        /**< Derive the calibration factor from a known weight */
+    NAU7802_CAL_JOB_AFE,         /**< Analog front-end calibration of the chip */
+} nau7802_cal_job_type_t;
+
+/**
+ * @brief Job state
+ */
+typedef enum {
+    NAU7802_CAL_JOB_RUNNING = 0,
+    NAU7802_CAL_JOB_DONE,
+    NAU7802_CAL_JOB_FAILED,
+} nau7802_cal_job_state_t;
+
+/**
+ * @brief Progress and result of a job
+ */
+typedef struct {
+    uint32_t id;                     /**< Job ID (never 0) */
+    uint8_t channel;                 /**< Scale channel */
+    nau7802_cal_job_type_t type;
+    nau7802_cal_job_state_t state;
+    uint16_t samples_needed;         /**< Conversions to average (0 for AFE jobs) */
+    uint16_t samples_collected;      /**< Conversions averaged so far */
+    float known_weight_g;            /**< Span jobs: reference weight in grams */
+    float zero_offset;               /**< Zero offset after the job (DONE only) */
+    float calibration_factor;        /**< Calibration factor after the job (DONE only) */
+    esp_err_t error;                 /**< Failure reason (FAILED only) */
+    uint32_t elapsed_ms;             /**< Time since submission, or job duration once finished */
+} nau7802_cal_job_info_t;
+
+/**
+ * @brief Start a calibration job
+ *
+ * @param dev Device of the channel
+ * @param dev_mutex Mutex held for multi-step operations on @p dev
+ * @param channel Scale channel (selects the history ring and calibration record)
+ * @param type Job type
+ * @param known_weight_g Span jobs: reference weight on the scale in grams (> 0)
+ * @param samples Tare and span jobs: conversions to average (1 to NAU7802_CAL_JOB_MAX_SAMPLES)
+ * @param job_id Receives the job ID
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for bad parameters, ESP_ERR_NOT_SUPPORTED if
+ *         the sample history is not available, ESP_ERR_INVALID_STATE if a job is
+ *         already running on the channel, ESP_ERR_NO_MEM if the worker cannot be started
+ */
+esp_err_t nau7802_cal_job_submit(nau7802_t *dev, SemaphoreHandle_t dev_mutex, uint8_t channel,
+                                 nau7802_cal_job_type_t type, float known_weight_g, uint16_t samples,
+                                 uint32_t *job_id);
+
+/**
+ * @brief Get the progress or result of a job
+ *
+ * @param job_id Job ID from nau7802_cal_job_submit()
+ * @param info Receives the job state
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if the job is unknown or was recycled
+ */
+esp_err_t nau7802_cal_job_get(uint32_t job_id, nau7802_cal_job_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NAU7802_CALIBRATION_JOB_H
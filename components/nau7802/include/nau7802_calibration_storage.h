@@ -43,5 +43,13 @@ esp_err_t nau7802_calibration_apply(nau7802_t *scale, const nau7802_calibration_
 esp_err_t nau7802_calibration_read_from_device(nau7802_t *scale, nau7802_calibration_data_t *cal_data);
 esp_err_t nau7802_calibration_erase(void);
 
+/*
+ * Per-channel records for devices with several scales. Channel 0 is the
+ * record used by the functions above.
+ */
+esp_err_t nau7802_calibration_load_channel(uint8_t channel, nau7802_calibration_data_t *cal_data);
+esp_err_t nau7802_calibration_save_channel(uint8_t channel, const nau7802_calibration_data_t *cal_data);
+esp_err_t nau7802_calibration_erase_channel(uint8_t channel);
+
 #endif
 
@@ -0,0 +1,121 @@
+/*
+ * Sample history ring for NAU7802 scales
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file nau7802_history.h
+ * @brief Fixed-size history of timestamped samples with cursor-based reads
+ *
+ * One writer (the acquisition task) appends samples without taking any lock.
+ * Every sample gets a monotonically increasing 32-bit index. Readers keep the
+ * index of the next sample they want (a cursor) and fetch everything since then.
+ * Each slot carries its own sequence number, so a reader that races with the
+ * writer detects an overwritten slot and reports it as lost, never as torn data.
+ *
+ * Each scale channel has its own ring and its own index sequence; all rings
+ * have the same capacity. They are allocated in PSRAM when available and fall
+ * back to smaller rings in internal RAM otherwise.
+ */
+
+#ifndef NAU7802_HISTORY_H
+#define NAU7802_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NAU7802_HISTORY_MAX_CHANNELS 4   /**< Maximum number of scale channels */
+
+/**
+ * @brief One history sample as returned to readers
+ */
+typedef struct {
+    uint32_t index;          /**< Sample index (monotonic, wraps at 2^32) */
+    uint32_t timestamp_us;   /**< Capture time, microseconds since boot (wraps) */
+    int32_t raw;             /**< Raw ADC reading */
+    float weight_g;          /**< Calibrated weight in grams */
+} nau7802_history_sample_t;
+
+/**
+ * @brief Allocate the history rings
+ *
+ * @param channels Number of scale channels (1 to NAU7802_HISTORY_MAX_CHANNELS)
+ * @param capacity Requested number of samples per channel (rounded down to a power of two)
+ * @param fallback_capacity Number of samples per channel to allocate in internal RAM if PSRAM is not available
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad channel count,
+ *         ESP_ERR_NO_MEM if neither allocation succeeded
+ */
+esp_err_t nau7802_history_init(uint8_t channels, uint32_t capacity, uint32_t fallback_capacity);
+
+/**
+ * @brief Append a sample (single writer per channel only)
+ *
+ * @param channel Scale channel
+ * @param timestamp_us Capture time in microseconds
+ * @param raw Raw ADC reading
+ * @param weight_g Calibrated weight in grams
+ */
+void nau7802_history_append(uint8_t channel, uint32_t timestamp_us, int32_t raw, float weight_g);
+
+/**
+ * @brief Read samples starting at a cursor
+ *
+ * If the cursor points at samples that were already overwritten, reading starts
+ * at the oldest retained sample and the skipped samples are reported in @p lost.
+ * A cursor ahead of the writer (e.g. from before a reboot) also restarts at the
+ * oldest retained sample.
+ *
+ * @param channel Scale channel (an unknown channel reads nothing)
+ * @param cursor In: index of the first wanted sample. Out: index to pass next time
+ * @param out Output array
+ * @param max_samples Capacity of @p out
+ * @param lost Optional, receives the number of samples skipped
+ * @return Number of samples written to @p out
+ */
+size_t nau7802_history_read(uint8_t channel, uint32_t *cursor, nau7802_history_sample_t *out,
+                            size_t max_samples, uint32_t *lost);
+
+/**
+ * @brief Index the next sample appended to a channel will get
+ */
+uint32_t nau7802_history_head(uint8_t channel);
+
+/**
+ * @brief Number of samples each ring can hold (0 if not initialized)
+ */
+uint32_t nau7802_history_capacity(void);
+
+/**
+ * @brief Number of channels with a ring (0 if not initialized)
+ */
+uint8_t nau7802_history_channels(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NAU7802_HISTORY_H
@@ -0,0 +1,168 @@
+/*
+ * Acquisition and publishing for one NAU7802 scale channel
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file nau7802_scale.h
+ * @brief Capture and publish step of one scale channel
+ *
+ * A channel is one NAU7802 with its stability filter and a moving average of
+ * its conversions. The acquisition task calls nau7802_scale_capture() when a
+ * conversion may be ready; every conversion goes into the channel's history
+ * ring and the moving average. At the publish rate nau7802_scale_publish()
+ * turns the average into the 10-byte scale record (the layout of Assemblies
+ * 100 and 102) and the same values as numbers, for Modbus and the web UI.
+ *
+ * Neither function touches the assemblies; the caller copies the record.
+ */
+
+#ifndef NAU7802_SCALE_H
+#define NAU7802_SCALE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nau7802.h"
+#include "nau7802_stability.h"
+#include "nau7802_history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NAU7802_SCALE_RECORD_SIZE  10   /**< Bytes per scale record */
+#define NAU7802_SCALE_AVERAGE_MAX  50   /**< Largest moving average window */
+
+/** Status byte of the scale record */
+#define NAU7802_SCALE_STATUS_AVAILABLE      0x01  /**< A conversion arrived since the last publish */
+#define NAU7802_SCALE_STATUS_CONNECTED      0x02
+#define NAU7802_SCALE_STATUS_INITIALIZED    0x04
+#define NAU7802_SCALE_STATUS_STABLE         0x08
+#define NAU7802_SCALE_STATUS_MOTION         0x10
+#define NAU7802_SCALE_STATUS_CENTER_OF_ZERO 0x20
+
+/**
+ * @brief One scale channel
+ *
+ * device, mutex and initialized are set up by the owner; the rest is the
+ * acquisition state, owned by the task that captures and publishes.
+ */
+typedef struct {
+    nau7802_t device;
+    SemaphoreHandle_t mutex;          /**< Held for multi-step device operations (configuration, calibration, tare) */
+    bool initialized;                 /**< Device brought up; guarded by the owner */
+    uint8_t index;                    /**< Channel number, selects the history ring */
+    nau7802_stability_t stability;
+    int32_t avg_window[NAU7802_SCALE_AVERAGE_MAX];  /**< Most recent conversions */
+    uint8_t avg_head;
+    uint8_t avg_count;
+    int64_t avg_sum;
+    int32_t raw_reading;              /**< Last averaged reading */
+    int32_t last_raw;                 /**< Most recent conversion */
+    bool new_sample;                  /**< A conversion arrived since the last publish */
+    uint32_t read_errors;             /**< Failed sample reads since the owner last cleared this */
+    int64_t next_poll_us;             /**< Earliest time the next conversion can be ready */
+} nau7802_scale_t;
+
+/**
+ * @brief Values of one publish, as numbers
+ */
+typedef struct {
+    int32_t weight_scaled;    /**< Weight x100 in the selected unit (record bytes 0-3) */
+    float weight;             /**< Weight in the selected unit */
+    int32_t raw;              /**< Most recent conversion */
+    int32_t filtered;         /**< Moving average (record bytes 4-7) */
+    float filtered_exact;     /**< Moving average without rounding */
+    uint8_t unit;             /**< Unit code: 0=grams, 1=lbs, 2=kg (record byte 8) */
+    uint8_t status;           /**< NAU7802_SCALE_STATUS_* bits (record byte 9) */
+} nau7802_scale_values_t;
+
+/**
+ * @brief Reset the acquisition state and set up the stability filter
+ *
+ * Leaves device, mutex and initialized alone.
+ *
+ * @param ch Channel
+ * @param index Channel number (history ring)
+ * @param stability Stability filter configuration
+ */
+void nau7802_scale_init(nau7802_scale_t *ch, uint8_t index, const nau7802_stability_config_t *stability);
+
+/**
+ * @brief Discard the moving average (after a change of window or analog settings)
+ */
+void nau7802_scale_reset_average(nau7802_scale_t *ch);
+
+/**
+ * @brief Read a conversion if one is ready
+ *
+ * Skips the poll if the device mutex is held by a multi-step operation. A new
+ * conversion is appended to the history ring and the moving average, and
+ * next_poll_us is set three quarters of a period after it.
+ *
+ * @param ch Channel
+ * @param period_us Conversion period
+ * @param average_samples Moving average window (1 to NAU7802_SCALE_AVERAGE_MAX)
+ * @param captured Optional, receives the conversion as stored in the history ring
+ * @return true if a new conversion was captured
+ */
+bool nau7802_scale_capture(nau7802_scale_t *ch, uint32_t period_us, uint8_t average_samples,
+                             nau7802_history_sample_t *captured);
+
+/**
+ * @brief Build the scale record from the moving average
+ *
+ * Updates the stability filter (and auto-zero tracking) if a conversion
+ * arrived since the last publish. The caller has checked that the device is
+ * initialized and connected; both bits are always set.
+ *
+ * Record layout (little-endian):
+ *   bytes 0-3  weight x100 in the selected unit (int32)
+ *   bytes 4-7  averaged raw reading (int32)
+ *   byte 8     unit code
+ *   byte 9     status (NAU7802_SCALE_STATUS_*)
+ *
+ * @param ch Channel
+ * @param unit Unit code: 0=grams, 1=lbs, 2=kg
+ * @param record Output, NAU7802_SCALE_RECORD_SIZE bytes
+ * @param values Optional, receives the same values as numbers
+ */
+void nau7802_scale_publish(nau7802_scale_t *ch, uint8_t unit, uint8_t *record,
+                             nau7802_scale_values_t *values);
+
+/**
+ * @brief Convert grams to the selected unit
+ */
+float nau7802_scale_convert_weight(float weight_grams, uint8_t unit);
+
+/**
+ * @brief Convert grams to the selected unit, scaled by 100, rounded and clamped to int32
+ */
+int32_t nau7802_scale_weight_scaled(float weight_grams, uint8_t unit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NAU7802_SCALE_H
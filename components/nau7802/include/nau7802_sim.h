@@ -0,0 +1,141 @@
+/*
+ * Simulated NAU7802 for bench and pipeline testing
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file nau7802_sim.h
+ * @brief Register-level NAU7802 model behind the I2C scheduler
+ *
+ * A simulated device answers the same I2C transactions as the chip: register
+ * pointer with auto-increment, reset, power-up (PUR), conversion start (CS),
+ * data ready (CR, cleared by reading the ADC data) at the configured output
+ * data rate, gain, and AFE calibration (CALS clears after two conversion
+ * periods). It is attached to the I2C scheduler as a device transport, so the
+ * unmodified driver, acquisition task and assembly code run against it.
+ *
+ * Conversions are generated from a signal description: a load with optional
+ * periodic steps, white noise, linear drift and mains hum, or a recorded
+ * trace of raw readings that is replayed in a loop. The noise of conversion n
+ * depends only on the seed and n, so equal configurations produce equal
+ * sample sequences.
+ */
+
+#ifndef NAU7802_SIM_H
+#define NAU7802_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/i2c_master.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NAU7802_SIM_REGISTERS 32   /**< Register address space of the model */
+
+/**
+ * @brief Input signal of a simulated device
+ *
+ * Counts are given at gain x128 and scaled with the programmed gain.
+ */
+typedef struct {
+    int32_t zero_counts;           /**< Reading with no load */
+    float counts_per_gram;         /**< Load cell sensitivity */
+    float load_g;                  /**< Load on the cell (grams) */
+    float step_g;                  /**< Load added during every other step period (0 = no steps) */
+    uint32_t step_period_ms;       /**< Length of one step period */
+    float noise_counts;            /**< RMS of the white noise */
+    float drift_counts_per_s;      /**< Linear drift since nau7802_sim_init() */
+    float hum_counts;              /**< Amplitude of the mains interference */
+    float hum_hz;                  /**< Mains frequency (50 or 60) */
+    const int32_t *trace;          /**< Raw readings to replay instead of the generator (NULL = generate) */
+    size_t trace_len;              /**< Number of readings in @p trace */
+    uint32_t seed;                 /**< Noise seed */
+} nau7802_sim_signal_t;
+
+/**
+ * @brief Activity counters of a simulated device
+ */
+typedef struct {
+    uint32_t transactions;         /**< I2C transactions answered */
+    uint32_t bus_bytes;            /**< Bytes on the wire: address byte per direction plus data */
+    uint32_t conversions;          /**< Conversions completed */
+    uint32_t reads;                /**< Conversions read by the host */
+    uint32_t missed;               /**< Conversions overwritten before they were read */
+} nau7802_sim_stats_t;
+
+/**
+ * @brief Simulated device state
+ */
+typedef struct {
+    nau7802_sim_signal_t signal;
+    uint8_t regs[NAU7802_SIM_REGISTERS];
+    uint8_t pointer;               /**< Register address pointer */
+    bool connected;                /**< false: every transaction is NACKed */
+    int64_t init_us;               /**< Reference time for drift and steps */
+    int64_t start_us;              /**< Start of conversion 0 (0 = not converting) */
+    int64_t cal_done_us;           /**< End of the running AFE calibration */
+    uint32_t completed;            /**< Conversions completed at the last update */
+    uint32_t consumed;             /**< Conversions completed when the data was last read */
+    nau7802_sim_stats_t stats;
+    portMUX_TYPE lock;
+} nau7802_sim_t;
+
+/**
+ * @brief Initialize a simulated device and attach it to the I2C scheduler
+ *
+ * @param sim Device state (must stay valid while the device is used)
+ * @param signal Input signal
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for NULL arguments, or the scheduler error
+ */
+esp_err_t nau7802_sim_init(nau7802_sim_t *sim, const nau7802_sim_signal_t *signal);
+
+/**
+ * @brief Device handle to pass to nau7802_init_device()
+ */
+i2c_master_dev_handle_t nau7802_sim_get_handle(nau7802_sim_t *sim);
+
+/**
+ * @brief Change the load on the cell (takes effect with the next conversion)
+ */
+void nau7802_sim_set_load(nau7802_sim_t *sim, float load_g);
+
+/**
+ * @brief Connect or disconnect the device (a disconnected device NACKs)
+ */
+void nau7802_sim_set_connected(nau7802_sim_t *sim, bool connected);
+
+/**
+ * @brief Copy the activity counters
+ */
+void nau7802_sim_get_stats(nau7802_sim_t *sim, nau7802_sim_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NAU7802_SIM_H
@@ -0,0 +1,135 @@
+/*
+ * Weight stability, motion detection and auto-zero tracking for NAU7802 scales
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file nau7802_stability.h
+ * @brief Incremental stability / motion detection and auto-zero tracking
+ *
+ * Raw ADC samples are pushed into a fixed-size window. Sum, sum of squares and
+ * the index-weighted sum are maintained incrementally in 64-bit integers, so
+ * each update is O(1) and free of floating point drift. From these the filter
+ * derives the standard deviation and least-squares drift across the window and
+ * classifies the reading as stable, in motion, or neither.
+ *
+ * When the reading is stable and within the configured band around zero, auto-zero
+ * tracking (AZT) slowly moves the device zero offset toward the current reading.
+ * The total correction is limited so a slowly applied load is never tracked away.
+ */
+
+#ifndef NAU7802_STABILITY_H
+#define NAU7802_STABILITY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nau7802.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of samples in the stability window */
+#define NAU7802_STABILITY_MAX_WINDOW 64
+
+/**
+ * @brief Stability filter configuration
+ *
+ * Bands are expressed in grams and converted to ADC counts with the device
+ * calibration factor on every update, so they stay valid across recalibration.
+ */
+typedef struct {
+    uint8_t window;            /**< Samples in the rolling window (2..NAU7802_STABILITY_MAX_WINDOW) */
+    float stable_band_g;       /**< Max std deviation and drift for a stable reading (grams) */
+    float motion_band_g;       /**< Std deviation or drift above which the scale is in motion (grams) */
+    bool azt_enabled;          /**< Enable auto-zero tracking */
+    float azt_band_g;          /**< Reading must be within +/- this band of zero for AZT (grams) */
+    float azt_rate;            /**< Fraction of the zero error corrected per stable update (0..1) */
+    float azt_limit_g;         /**< Max accumulated AZT correction since the last tare (grams) */
+} nau7802_stability_config_t;
+
+/**
+ * @brief Stability filter state
+ */
+typedef struct {
+    nau7802_stability_config_t config;
+    int32_t samples[NAU7802_STABILITY_MAX_WINDOW];
+    uint8_t head;              /**< Index of the oldest sample once the window is full */
+    uint8_t count;             /**< Number of valid samples in the window */
+    int64_t sum;               /**< Sum of samples */
+    int64_t sum_sq;            /**< Sum of squared samples */
+    int64_t sum_xy;            /**< Sum of (position * sample), position 0 = oldest */
+    float last_zero_offset;    /**< Zero offset after the last AZT step (detects external tare) */
+    float azt_total;           /**< Accumulated AZT correction in counts since the last tare */
+    bool stable;
+    bool in_motion;
+    bool center_of_zero;
+} nau7802_stability_t;
+
+/**
+ * @brief Initialize the stability filter
+ *
+ * @param st Filter state
+ * @param config Configuration (window is clamped to the supported range)
+ */
+void nau7802_stability_init(nau7802_stability_t *st, const nau7802_stability_config_t *config);
+
+/**
+ * @brief Discard the sample window and AZT accumulator
+ *
+ * @param st Filter state
+ */
+void nau7802_stability_reset(nau7802_stability_t *st);
+
+/**
+ * @brief Push a new raw sample and update stability / motion flags
+ *
+ * Must be called with exclusive access to @p dev, since auto-zero tracking
+ * may adjust the device zero offset.
+ *
+ * @param st Filter state
+ * @param dev NAU7802 device (provides calibration factor and zero offset)
+ * @param raw New raw ADC reading
+ */
+void nau7802_stability_update(nau7802_stability_t *st, nau7802_t *dev, int32_t raw);
+
+/**
+ * @brief Get the standard deviation of the current window in ADC counts
+ *
+ * @param st Filter state
+ * @return Standard deviation (0 if fewer than two samples)
+ */
+float nau7802_stability_get_stddev(const nau7802_stability_t *st);
+
+/**
+ * @brief Get the least-squares drift across the current window in ADC counts
+ *
+ * @param st Filter state
+ * @return Slope multiplied by (window length - 1); 0 if fewer than two samples
+ */
+float nau7802_stability_get_drift(const nau7802_stability_t *st);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NAU7802_STABILITY_H
@@ -32,55 +32,256 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
+#include "i2c_scheduler.h"
 #include <string.h>
 
 static const char *TAG = "NAU7802";
 
+// Bits the device changes on its own; they are never cached or compared
+static uint8_t nau7802_volatile_bits(uint8_t reg)
+{
+    switch (reg) {
+    case NAU7802_REGISTER_PU_CTRL:
+        return (1 << NAU7802_PU_CTRL_PUR) | (1 << NAU7802_PU_CTRL_CR);
+    case NAU7802_REGISTER_CTRL2:
+        return NAU7802_CTRL2_CALS | NAU7802_CTRL2_CAL_ERROR;
+    default:
+        return 0;
+    }
+}
+
+// Calibration registers are rewritten by the AFE calibration, so only the
+// control registers are mirrored
+static bool nau7802_is_shadowed(uint8_t reg)
+{
+    return reg <= NAU7802_REGISTER_CTRL2 || reg == NAU7802_REGISTER_I2C_CONTROL ||
+           (reg >= NAU7802_REGISTER_ADC && reg < NAU7802_SHADOW_SIZE);
+}
+
+static void nau7802_shadow_store(nau7802_t *dev, uint8_t reg, uint8_t value)
+{
+    if (nau7802_is_shadowed(reg)) {
+        dev->shadow[reg] = value & ~nau7802_volatile_bits(reg);
+        dev->shadow_valid |= (1u << reg);
+    }
+}
+
+// Plain reads never touch the shadow, so diagnostic readers that do not hold
+// the device lock cannot race with a configuration change
 static esp_err_t nau7802_read_register(nau7802_t *dev, uint8_t reg, uint8_t *data)
 {
     uint8_t write_data = reg;
-    esp_err_t ret = i2c_master_transmit_receive(dev->i2c_dev, &write_data, 1, data, 1, 100);
+    return i2c_sched_transmit_receive(dev->i2c_dev, &write_data, 1, data, 1, 100);
+}
+
+// Control register value for read-modify-write, from the shadow when known
+static esp_err_t nau7802_cached_register(nau7802_t *dev, uint8_t reg, uint8_t *data)
+{
+    if (nau7802_is_shadowed(reg) && (dev->shadow_valid & (1u << reg))) {
+        *data = dev->shadow[reg];
+        return ESP_OK;
+    }
+    esp_err_t ret = nau7802_read_register(dev, reg, data);
+    if (ret == ESP_OK) {
+        nau7802_shadow_store(dev, reg, *data);
+    }
     return ret;
 }
 
 static esp_err_t nau7802_write_register(nau7802_t *dev, uint8_t reg, uint8_t data)
 {
     uint8_t write_data[2] = {reg, data};
-    esp_err_t ret = i2c_master_transmit(dev->i2c_dev, write_data, 2, 100);
+    esp_err_t ret = i2c_sched_transmit(dev->i2c_dev, write_data, 2, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Write register 0x%02X=0x%02X failed: %s (0x%x)", reg, data, esp_err_to_name(ret), ret);
+        dev->shadow_valid &= ~(1u << reg);
         return ret;
     }
     
-    vTaskDelay(pdMS_TO_TICKS(1));
-    
-    uint8_t verify;
-    ret = nau7802_read_register(dev, reg, &verify);
-    if (ret == ESP_OK && verify != data && reg != NAU7802_REGISTER_PU_CTRL) {
-        ESP_LOGW(TAG, "Register 0x%02X write verification failed: wrote 0x%02X, read 0x%02X", reg, data, verify);
-    }
-    
+    nau7802_shadow_store(dev, reg, data);
     return ESP_OK;
 }
 
-static esp_err_t nau7802_set_register_bit(nau7802_t *dev, uint8_t reg, uint8_t bit)
+// Replace the bits in mask; the bus write is skipped if nothing changes
+static esp_err_t nau7802_update_register(nau7802_t *dev, uint8_t reg, uint8_t mask, uint8_t value)
 {
-    uint8_t value;
-    esp_err_t ret = nau7802_read_register(dev, reg, &value);
+    uint8_t current;
+    esp_err_t ret = nau7802_cached_register(dev, reg, &current);
     if (ret != ESP_OK) return ret;
     
-    value |= (1 << bit);
-    return nau7802_write_register(dev, reg, value);
+    uint8_t updated = (current & ~mask) | (value & mask);
+    if (updated == current && (mask & nau7802_volatile_bits(reg)) == 0) {
+        return ESP_OK;
+    }
+    return nau7802_write_register(dev, reg, updated);
+}
+
+static esp_err_t nau7802_set_register_bit(nau7802_t *dev, uint8_t reg, uint8_t bit)
+{
+    return nau7802_update_register(dev, reg, 1 << bit, 1 << bit);
 }
 
 static esp_err_t nau7802_clear_register_bit(nau7802_t *dev, uint8_t reg, uint8_t bit)
 {
+    return nau7802_update_register(dev, reg, 1 << bit, 0);
+}
+
+// Read every shadowed register in one burst and refresh the shadow
+static esp_err_t nau7802_read_shadow(nau7802_t *dev, uint8_t *regs)
+{
+    uint8_t reg = NAU7802_REGISTER_PU_CTRL;
+    esp_err_t ret = i2c_sched_transmit_receive(dev->i2c_dev, &reg, 1, regs, NAU7802_SHADOW_SIZE, 100);
+    if (ret != ESP_OK) {
+        dev->shadow_valid = 0;
+        return ret;
+    }
+    for (uint8_t r = 0; r < NAU7802_SHADOW_SIZE; r++) {
+        nau7802_shadow_store(dev, r, regs[r]);
+    }
+    return ESP_OK;
+}
+
+typedef struct {
+    uint8_t reg;
+    uint8_t mask;
     uint8_t value;
-    esp_err_t ret = nau7802_read_register(dev, reg, &value);
-    if (ret != ESP_OK) return ret;
+} nau7802_reg_update_t;
+
+#define NAU7802_MAX_BATCH 8
+
+/*
+ * Apply a list of register updates (one entry per register, written in list
+ * order), skipping registers that already hold the target value. The writes
+ * go to the bus scheduler as one batch, then a single burst read verifies
+ * all written registers. Returns the set of written registers in *written.
+ */
+static esp_err_t nau7802_apply_updates(nau7802_t *dev, const nau7802_reg_update_t *updates,
+                                       size_t count, uint32_t *written)
+{
+    uint8_t buffers[NAU7802_MAX_BATCH][2];
+    i2c_sched_op_t ops[NAU7802_MAX_BATCH];
+    size_t op_count = 0;
+    uint32_t written_mask = 0;
+    esp_err_t ret = ESP_OK;
+    
+    if (written != NULL) {
+        *written = 0;
+    }
+    if (count > NAU7802_MAX_BATCH) {
+        return ESP_ERR_INVALID_SIZE;
+    }
     
-    value &= ~(1 << bit);
-    return nau7802_write_register(dev, reg, value);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t current;
+        ret = nau7802_cached_register(dev, updates[i].reg, &current);
+        if (ret != ESP_OK) return ret;
+        
+        uint8_t updated = (current & ~updates[i].mask) | (updates[i].value & updates[i].mask);
+        if (updated == current) {
+            continue;
+        }
+        buffers[op_count][0] = updates[i].reg;
+        buffers[op_count][1] = updated;
+        ops[op_count] = (i2c_sched_op_t) {
+            .dev = dev->i2c_dev,
+            .write_buf = buffers[op_count],
+            .write_len = 2,
+            .timeout_ms = 100,
+        };
+        op_count++;
+        written_mask |= (1u << updates[i].reg);
+    }
+    
+    if (op_count == 0) {
+        return ESP_OK;
+    }
+    ret = i2c_sched_submit(ops, op_count, i2c_sched_task_class());
+    if (ret != ESP_OK) {
+        // Unknown how far the batch got
+        ESP_LOGE(TAG, "Register batch write failed: %s", esp_err_to_name(ret));
+        dev->shadow_valid &= ~written_mask;
+        return ret;
+    }
+    for (size_t i = 0; i < op_count; i++) {
+        nau7802_shadow_store(dev, buffers[i][0], buffers[i][1]);
+    }
+    if (written != NULL) {
+        *written = written_mask;
+    }
+    
+    uint8_t expected[NAU7802_SHADOW_SIZE];
+    uint8_t actual[NAU7802_SHADOW_SIZE];
+    memcpy(expected, dev->shadow, sizeof(expected));
+    ret = nau7802_read_shadow(dev, actual);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Register verify read failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    for (uint8_t reg = 0; reg < NAU7802_SHADOW_SIZE; reg++) {
+        if ((written_mask & (1u << reg)) == 0) {
+            continue;
+        }
+        uint8_t stable = ~nau7802_volatile_bits(reg);
+        if ((expected[reg] & stable) != (actual[reg] & stable) && reg != NAU7802_REGISTER_PU_CTRL) {
+            ESP_LOGW(TAG, "Register 0x%02X write verification failed: wrote 0x%02X, read 0x%02X",
+                     reg, expected[reg], actual[reg]);
+        }
+    }
+    return ESP_OK;
+}
+
+// Wait for the CR bit, i.e. a completed conversion. Reading the data clears CR.
+static esp_err_t nau7802_wait_for_conversion(nau7802_t *dev, uint32_t timeout_ms)
+{
+    int64_t deadline = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    nau7802_sample_t sample;
+    
+    while (1) {
+        esp_err_t ret = nau7802_read_sample(dev, &sample);
+        if (ret != ESP_ERR_NOT_FINISHED) {
+            return ret;
+        }
+        if (esp_timer_get_time() >= deadline) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+}
+
+// Conversion period for a CTRL2 CRS setting, in milliseconds (rounded up)
+static uint32_t nau7802_conversion_period_ms(uint8_t ctrl2)
+{
+    switch ((ctrl2 & NAU7802_CTRL2_CRS_MASK) >> 4) {
+    case NAU7802_SPS_10:  return 100;
+    case NAU7802_SPS_20:  return 50;
+    case NAU7802_SPS_40:  return 25;
+    case NAU7802_SPS_80:  return 13;
+    default:              return 4;
+    }
+}
+
+/*
+ * The LDO has no ready flag. A conversion may already be running when the
+ * supply changes, so discard it and wait for the next one; by then the
+ * analog supply is up. Bounded by ldo_ramp_delay.
+ */
+static esp_err_t nau7802_wait_for_ldo(nau7802_t *dev)
+{
+    uint32_t period = nau7802_conversion_period_ms(dev->shadow[NAU7802_REGISTER_CTRL2]);
+    uint32_t timeout = dev->ldo_ramp_delay > 2 * period ? dev->ldo_ramp_delay : 2 * period;
+    int64_t start = esp_timer_get_time();
+    
+    esp_err_t ret = nau7802_wait_for_conversion(dev, timeout);
+    if (ret == ESP_OK) {
+        uint32_t elapsed = (uint32_t)((esp_timer_get_time() - start) / 1000);
+        ret = nau7802_wait_for_conversion(dev, timeout > elapsed ? timeout - elapsed : 1);
+    }
+    if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "No conversion within %lu ms after LDO change", (unsigned long)timeout);
+        return ESP_OK;  // Same as the old fixed delay: carry on and let calibration decide
+    }
+    return ret;
 }
 
 /**
@@ -102,25 +303,38 @@ esp_err_t nau7802_init(nau7802_t *dev, i2c_master_bus_handle_t i2c_bus, uint8_t
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(dev, 0, sizeof(nau7802_t));
-    dev->i2c_bus = i2c_bus;
-    dev->address = address;
-    dev->calibration_factor = 1.0f;
-    dev->zero_offset = 0.0f;
-    dev->ldo_ramp_delay = 250;
-    
     i2c_device_config_t dev_cfg = {
         .dev_addr_length = I2C_ADDR_BIT_LEN_7,
         .device_address = address,
         .scl_speed_hz = 400000,
     };
     
-    esp_err_t ret = i2c_master_bus_add_device(i2c_bus, &dev_cfg, &dev->i2c_dev);
+    i2c_master_dev_handle_t i2c_dev;
+    esp_err_t ret = i2c_master_bus_add_device(i2c_bus, &dev_cfg, &i2c_dev);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to add I2C device");
         return ret;
     }
     
+    ret = nau7802_init_device(dev, i2c_dev, address);
+    dev->i2c_bus = i2c_bus;
+    return ret;
+}
+
+esp_err_t nau7802_init_device(nau7802_t *dev, i2c_master_dev_handle_t i2c_dev, uint8_t address)
+{
+    if (dev == NULL || i2c_dev == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    memset(dev, 0, sizeof(nau7802_t));
+    dev->i2c_dev = i2c_dev;
+    dev->address = address;
+    dev->calibration_factor = 1.0f;
+    dev->zero_offset = 0.0f;
+    dev->ldo_ramp_delay = 250;
+    
+    i2c_sched_register_device(i2c_dev, address, "nau7802");
     return ESP_OK;
 }
 
@@ -129,6 +343,8 @@ esp_err_t nau7802_reset(nau7802_t *dev)
     esp_err_t ret = nau7802_set_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_RR);
     if (ret != ESP_OK) return ret;
     
+    // Every register is back at its power-on default
+    dev->shadow_valid = 0;
     vTaskDelay(pdMS_TO_TICKS(1));
     
     ret = nau7802_clear_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_RR);
@@ -140,10 +356,8 @@ esp_err_t nau7802_reset(nau7802_t *dev)
 
 esp_err_t nau7802_power_up(nau7802_t *dev)
 {
-    esp_err_t ret = nau7802_set_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_PUD);
-    if (ret != ESP_OK) return ret;
-    
-    ret = nau7802_set_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_PUA);
+    const uint8_t power_bits = (1 << NAU7802_PU_CTRL_PUD) | (1 << NAU7802_PU_CTRL_PUA);
+    esp_err_t ret = nau7802_update_register(dev, NAU7802_REGISTER_PU_CTRL, power_bits, power_bits);
     if (ret != ESP_OK) return ret;
     
     uint8_t counter = 0;
@@ -165,27 +379,15 @@ esp_err_t nau7802_power_up(nau7802_t *dev)
 
 esp_err_t nau7802_power_down(nau7802_t *dev)
 {
-    esp_err_t ret = nau7802_clear_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_PUD);
-    if (ret != ESP_OK) return ret;
-    
-    ret = nau7802_clear_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_PUA);
-    if (ret != ESP_OK) return ret;
-    
-    ret = nau7802_clear_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_AVDDS);
-    if (ret != ESP_OK) return ret;
-    
-    ret = nau7802_clear_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_OSCS);
-    return ret;
+    const uint8_t power_bits = (1 << NAU7802_PU_CTRL_PUD) | (1 << NAU7802_PU_CTRL_PUA) |
+                               (1 << NAU7802_PU_CTRL_AVDDS) | (1 << NAU7802_PU_CTRL_OSCS);
+    return nau7802_update_register(dev, NAU7802_REGISTER_PU_CTRL, power_bits, 0);
 }
 
 esp_err_t nau7802_set_ldo(nau7802_t *dev, uint8_t ldo_value)
 {
-    uint8_t ctrl1;
-    esp_err_t ret = nau7802_read_register(dev, NAU7802_REGISTER_CTRL1, &ctrl1);
-    if (ret != ESP_OK) return ret;
-    ctrl1 &= 0xC7;
-    ctrl1 |= (ldo_value & 0x07) << 3;
-    ret = nau7802_write_register(dev, NAU7802_REGISTER_CTRL1, ctrl1);
+    esp_err_t ret = nau7802_update_register(dev, NAU7802_REGISTER_CTRL1, NAU7802_CTRL1_VLDO_MASK,
+                                            (ldo_value & 0x07) << 3);
     if (ret != ESP_OK) return ret;
     return nau7802_set_register_bit(dev, NAU7802_REGISTER_PU_CTRL, NAU7802_PU_CTRL_AVDDS);
 }
@@ -194,7 +396,8 @@ esp_err_t nau7802_set_ldo(nau7802_t *dev, uint8_t ldo_value)
  * @brief Complete initialization and configure the NAU7802 device
  * 
  * Performs the full initialization sequence including reset, power-up,
- * configuration, and AFE calibration. This function should be called
+ * configuration, and AFE calibration with the default front-end settings
+ * (LDO 3.3V, gain x128, 80 SPS, channel 1). This function should be called
  * after nau7802_init().
  * 
  * @param dev Pointer to NAU7802 device structure (must be initialized with nau7802_init())
@@ -203,6 +406,22 @@ esp_err_t nau7802_set_ldo(nau7802_t *dev, uint8_t ldo_value)
  */
 esp_err_t nau7802_begin(nau7802_t *dev)
 {
+    const nau7802_config_t defaults = {
+        .ldo = 4,
+        .gain = NAU7802_GAIN_128,
+        .sample_rate = NAU7802_SPS_80,
+        .channel = NAU7802_CHANNEL_1,
+    };
+    return nau7802_begin_config(dev, &defaults);
+}
+
+esp_err_t nau7802_begin_config(nau7802_t *dev, const nau7802_config_t *config)
+{
+    if (dev == NULL || config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    int64_t start = esp_timer_get_time();
     esp_err_t ret = nau7802_reset(dev);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Reset failed");
@@ -215,101 +434,113 @@ esp_err_t nau7802_begin(nau7802_t *dev)
         return ret;
     }
     
-    ret = nau7802_set_ldo(dev, 4);
+    // Power-on defaults of all control registers in one transaction
+    uint8_t regs[NAU7802_SHADOW_SIZE];
+    ret = nau7802_read_shadow(dev, regs);
+    if (ret != ESP_OK) return ret;
+    
+    // Front-end settings plus the fixed setup from the power-on sequence:
+    // CLK_CHP off (ADC 0x30), PGA output cap on (POWER bit 7), LDOMODE cleared
+    const nau7802_reg_update_t setup[] = {
+        { NAU7802_REGISTER_CTRL1, NAU7802_CTRL1_VLDO_MASK | NAU7802_CTRL1_GAIN_MASK,
+          (uint8_t)(((config->ldo & 0x07) << 3) | (config->gain & NAU7802_CTRL1_GAIN_MASK)) },
+        { NAU7802_REGISTER_PU_CTRL, 1 << NAU7802_PU_CTRL_AVDDS, 1 << NAU7802_PU_CTRL_AVDDS },
+        { NAU7802_REGISTER_CTRL2, NAU7802_CTRL2_CRS_MASK, (uint8_t)((config->sample_rate & 0x07) << 4) },
+        { NAU7802_REGISTER_ADC, NAU7802_ADC_CHANNEL_MASK | 0x30,
+          (uint8_t)((config->channel == NAU7802_CHANNEL_2 ? NAU7802_ADC_CHANNEL_MASK : 0) | 0x30) },
+        { NAU7802_REGISTER_POWER, 0x80, 0x80 },
+        { NAU7802_REGISTER_PGA, 1 << 5, 0 },
+    };
+    ret = nau7802_apply_updates(dev, setup, sizeof(setup) / sizeof(setup[0]), NULL);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Set LDO failed");
+        ESP_LOGE(TAG, "Register setup failed");
         return ret;
     }
     
-    ret = nau7802_set_gain(dev, NAU7802_GAIN_128);
+    ret = nau7802_wait_for_ldo(dev);
+    if (ret != ESP_OK) return ret;
+    
+    ret = nau7802_calibrate_af(dev);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Set gain failed");
+        ESP_LOGE(TAG, "AFE calibration failed");
         return ret;
     }
     
-    ret = nau7802_set_sample_rate(dev, NAU7802_SPS_80);
+    uint32_t period = nau7802_conversion_period_ms(dev->shadow[NAU7802_REGISTER_CTRL2]);
+    ret = nau7802_wait_for_conversion(dev, 4 * period);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Set sample rate failed");
+        ESP_LOGE(TAG, "No conversion after calibration: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    uint8_t adc;
-    ret = nau7802_read_register(dev, NAU7802_REGISTER_ADC, &adc);
-    if (ret != ESP_OK) return ret;
-    adc |= 0x30;
-    ret = nau7802_write_register(dev, NAU7802_REGISTER_ADC, adc);
-    if (ret != ESP_OK) return ret;
-    
-    ret = nau7802_set_register_bit(dev, NAU7802_REGISTER_POWER, 7);
-    if (ret != ESP_OK) return ret;
+    int64_t now = esp_timer_get_time();
+    ESP_LOGI(TAG, "NAU7802 initialized successfully, first conversion after %lu ms (%lu ms since boot)",
+             (unsigned long)((now - start) / 1000), (unsigned long)(now / 1000));
+    return ESP_OK;
+}
+
+esp_err_t nau7802_configure(nau7802_t *dev, const nau7802_config_t *config)
+{
+    if (dev == NULL || config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    uint8_t pga_value;
-    ret = nau7802_read_register(dev, NAU7802_REGISTER_PGA, &pga_value);
-    if (ret != ESP_OK) return ret;
-    pga_value &= ~(1 << 5);
-    ret = nau7802_write_register(dev, NAU7802_REGISTER_PGA, pga_value);
+    uint8_t ctrl1;
+    uint8_t pu_ctrl;
+    uint8_t ctrl2;
+    esp_err_t ret = nau7802_cached_register(dev, NAU7802_REGISTER_CTRL1, &ctrl1);
+    if (ret == ESP_OK) ret = nau7802_cached_register(dev, NAU7802_REGISTER_PU_CTRL, &pu_ctrl);
+    if (ret == ESP_OK) ret = nau7802_cached_register(dev, NAU7802_REGISTER_CTRL2, &ctrl2);
     if (ret != ESP_OK) return ret;
     
-    vTaskDelay(pdMS_TO_TICKS(250));
-    
-    for (int i = 0; i < 10; i++) {
-        uint8_t pwr;
-        ret = nau7802_read_register(dev, NAU7802_REGISTER_PU_CTRL, &pwr);
-        if (ret == ESP_OK && (pwr & (1 << NAU7802_PU_CTRL_CR))) {
-            uint8_t adc_reg = NAU7802_REGISTER_ADC_DATA;
-            uint8_t adc_data[3];
-            i2c_master_transmit_receive(dev->i2c_dev, &adc_reg, 1, adc_data, 3, 100);
-        }
-        vTaskDelay(pdMS_TO_TICKS(10));
-    }
-    
-    ret = nau7802_calibrate_af(dev);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "AFE calibration failed");
+    uint8_t vldo = (config->ldo & 0x07) << 3;
+    uint8_t gain = config->gain & NAU7802_CTRL1_GAIN_MASK;
+    uint8_t crs = (config->sample_rate & 0x07) << 4;
+    bool ldo_changed = (ctrl1 & NAU7802_CTRL1_VLDO_MASK) != vldo ||
+                       (pu_ctrl & (1 << NAU7802_PU_CTRL_AVDDS)) == 0;
+    bool need_recal = ldo_changed ||
+                      (ctrl1 & NAU7802_CTRL1_GAIN_MASK) != gain ||
+                      (ctrl2 & NAU7802_CTRL2_CRS_MASK) != crs;
+    
+    const nau7802_reg_update_t updates[] = {
+        { NAU7802_REGISTER_CTRL1, NAU7802_CTRL1_VLDO_MASK | NAU7802_CTRL1_GAIN_MASK, (uint8_t)(vldo | gain) },
+        { NAU7802_REGISTER_PU_CTRL, 1 << NAU7802_PU_CTRL_AVDDS, 1 << NAU7802_PU_CTRL_AVDDS },
+        { NAU7802_REGISTER_CTRL2, NAU7802_CTRL2_CRS_MASK, crs },
+        { NAU7802_REGISTER_ADC, NAU7802_ADC_CHANNEL_MASK,
+          config->channel == NAU7802_CHANNEL_2 ? NAU7802_ADC_CHANNEL_MASK : 0 },
+    };
+    uint32_t written = 0;
+    ret = nau7802_apply_updates(dev, updates, sizeof(updates) / sizeof(updates[0]), &written);
+    if (ret != ESP_OK || written == 0) {
         return ret;
     }
     
-    ESP_LOGI(TAG, "NAU7802 initialized successfully");
-    return ESP_OK;
+    if (ldo_changed) {
+        ret = nau7802_wait_for_ldo(dev);
+        if (ret != ESP_OK) return ret;
+    }
+    if (need_recal) {
+        ret = nau7802_calibrate_af(dev);
+    }
+    return ret;
 }
 
 esp_err_t nau7802_set_gain(nau7802_t *dev, nau7802_gain_t gain)
 {
-    uint8_t ctrl1;
-    esp_err_t ret = nau7802_read_register(dev, NAU7802_REGISTER_CTRL1, &ctrl1);
-    if (ret != ESP_OK) return ret;
-    
-    ctrl1 &= ~NAU7802_CTRL1_GAIN_MASK;
-    ctrl1 |= (gain & NAU7802_CTRL1_GAIN_MASK);
-    
-    return nau7802_write_register(dev, NAU7802_REGISTER_CTRL1, ctrl1);
+    return nau7802_update_register(dev, NAU7802_REGISTER_CTRL1, NAU7802_CTRL1_GAIN_MASK,
+                                   gain & NAU7802_CTRL1_GAIN_MASK);
 }
 
 esp_err_t nau7802_set_sample_rate(nau7802_t *dev, nau7802_sps_t rate)
 {
-    uint8_t ctrl2;
-    esp_err_t ret = nau7802_read_register(dev, NAU7802_REGISTER_CTRL2, &ctrl2);
-    if (ret != ESP_OK) return ret;
-    
-    ctrl2 &= ~NAU7802_CTRL2_CRS_MASK;
-    ctrl2 |= ((rate & 0x07) << 4);
-    
-    return nau7802_write_register(dev, NAU7802_REGISTER_CTRL2, ctrl2);
+    return nau7802_update_register(dev, NAU7802_REGISTER_CTRL2, NAU7802_CTRL2_CRS_MASK,
+                                   (rate & 0x07) << 4);
 }
 
 esp_err_t nau7802_set_channel(nau7802_t *dev, nau7802_channel_t channel)
 {
-    uint8_t adc;
-    esp_err_t ret = nau7802_read_register(dev, NAU7802_REGISTER_ADC, &adc);
-    if (ret != ESP_OK) return ret;
-    
-    if (channel == NAU7802_CHANNEL_1) {
-        adc &= ~NAU7802_ADC_CHANNEL_MASK;
-    } else {
-        adc |= NAU7802_ADC_CHANNEL_MASK;
-    }
-    
-    return nau7802_write_register(dev, NAU7802_REGISTER_ADC, adc);
+    return nau7802_update_register(dev, NAU7802_REGISTER_ADC, NAU7802_ADC_CHANNEL_MASK,
+                                   channel == NAU7802_CHANNEL_1 ? 0 : NAU7802_ADC_CHANNEL_MASK);
 }
 
 esp_err_t nau7802_calibrate_af(nau7802_t *dev)
@@ -319,63 +550,41 @@ esp_err_t nau7802_calibrate_af(nau7802_t *dev)
 
 esp_err_t nau7802_calibrate_af_mode(nau7802_t *dev, nau7802_cal_mode_t mode)
 {
-    uint8_t ctrl2;
-    esp_err_t ret = nau7802_read_register(dev, NAU7802_REGISTER_CTRL2, &ctrl2);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to read CTRL2 before calibration");
-        return ret;
-    }
-    
-    ctrl2 &= ~NAU7802_CTRL2_CALMOD_MASK;
-    ctrl2 |= (mode & NAU7802_CTRL2_CALMOD_MASK);
-    ret = nau7802_write_register(dev, NAU7802_REGISTER_CTRL2, ctrl2);
+    esp_err_t ret = nau7802_update_register(dev, NAU7802_REGISTER_CTRL2, NAU7802_CTRL2_CALMOD_MASK,
+                                            mode & NAU7802_CTRL2_CALMOD_MASK);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set calibration mode");
         return ret;
     }
     
-    ESP_LOGI(TAG, "Starting AF calibration mode %d, CTRL2=0x%02X", mode, ctrl2);
-    ctrl2 |= NAU7802_CTRL2_CALS;
-    ret = nau7802_write_register(dev, NAU7802_REGISTER_CTRL2, ctrl2);
+    ESP_LOGI(TAG, "Starting AF calibration mode %d", mode);
+    ret = nau7802_set_register_bit(dev, NAU7802_REGISTER_CTRL2, 2);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write CALS bit");
         return ret;
     }
     
-    vTaskDelay(pdMS_TO_TICKS(10));
-    
-    ret = nau7802_read_register(dev, NAU7802_REGISTER_CTRL2, &ctrl2);
-    if (ret != ESP_OK) return ret;
-    
-    if ((ctrl2 & NAU7802_CTRL2_CALS) == 0) {
-        ESP_LOGW(TAG, "CALS bit not set after write, CTRL2=0x%02X", ctrl2);
-    }
-    
-    for (int i = 0; i < 100; i++) {
-        vTaskDelay(pdMS_TO_TICKS(10));
+    // CALS clears itself when the calibration is done
+    int64_t start = esp_timer_get_time();
+    uint8_t ctrl2 = 0;
+    while (esp_timer_get_time() - start < 1000000) {
+        vTaskDelay(1);
         ret = nau7802_read_register(dev, NAU7802_REGISTER_CTRL2, &ctrl2);
         if (ret != ESP_OK) return ret;
         
         if ((ctrl2 & NAU7802_CTRL2_CALS) == 0) {
             if (ctrl2 & NAU7802_CTRL2_CAL_ERROR) {
                 ESP_LOGE(TAG, "Calibration error, CTRL2=0x%02X", ctrl2);
-                ctrl2 &= ~NAU7802_CTRL2_CALS;
-                nau7802_write_register(dev, NAU7802_REGISTER_CTRL2, ctrl2);
                 return ESP_ERR_INVALID_RESPONSE;
             }
-            ESP_LOGI(TAG, "Calibration completed successfully");
+            ESP_LOGI(TAG, "Calibration completed in %lu ms",
+                     (unsigned long)((esp_timer_get_time() - start) / 1000));
             return ESP_OK;
         }
-        
-        if (i % 10 == 0) {
-            ESP_LOGI(TAG, "Calibration in progress, CTRL2=0x%02X (iteration %d)", ctrl2, i);
-        }
     }
     
-    ret = nau7802_read_register(dev, NAU7802_REGISTER_CTRL2, &ctrl2);
     ESP_LOGW(TAG, "Calibration timeout, clearing CALS bit. Final CTRL2=0x%02X", ctrl2);
-    ctrl2 &= ~NAU7802_CTRL2_CALS;
-    nau7802_write_register(dev, NAU7802_REGISTER_CTRL2, ctrl2);
+    nau7802_clear_register_bit(dev, NAU7802_REGISTER_CTRL2, 2);
     return ESP_ERR_TIMEOUT;
 }
 
@@ -426,7 +635,7 @@ int32_t nau7802_get_reading(nau7802_t *dev)
     uint8_t data[3];
     uint8_t reg = NAU7802_REGISTER_ADC_DATA;
     
-    esp_err_t ret = i2c_master_transmit_receive(dev->i2c_dev, &reg, 1, data, 3, 100);
+    esp_err_t ret = i2c_sched_transmit_receive(dev->i2c_dev, &reg, 1, data, 3, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read ADC data: %d", ret);
         return 0;
@@ -441,12 +650,58 @@ int32_t nau7802_get_reading(nau7802_t *dev)
     return value;
 }
 
+esp_err_t nau7802_read_sample(nau7802_t *dev, nau7802_sample_t *sample)
+{
+    if (dev == NULL || sample == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Status first: most polls find no new conversion, and then PU_CTRL is
+    // all that crosses the bus (4 bytes). The 3 data bytes are only fetched
+    // once CR is set; a burst from PU_CTRL to ADC_DATA would be 21 bytes on
+    // every poll.
+    uint8_t pu_ctrl;
+    uint8_t reg = NAU7802_REGISTER_PU_CTRL;
+    esp_err_t ret = i2c_sched_transmit_receive(dev->i2c_dev, &reg, 1, &pu_ctrl, 1, 100);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    sample->timestamp_us = esp_timer_get_time();
+    sample->pu_ctrl = pu_ctrl;
+    sample->ctrl2 = dev->shadow[NAU7802_REGISTER_CTRL2];
+    sample->raw = dev->last_raw;
+    
+    if ((pu_ctrl & (1 << NAU7802_PU_CTRL_PUR)) == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if ((pu_ctrl & (1 << NAU7802_PU_CTRL_CR)) == 0) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    
+    uint8_t adc[3];
+    reg = NAU7802_REGISTER_ADC_DATA;
+    ret = i2c_sched_transmit_receive(dev->i2c_dev, &reg, 1, adc, sizeof(adc), 100);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    int32_t value = ((int32_t)adc[0] << 16) | ((int32_t)adc[1] << 8) | adc[2];
+    if (value & 0x00800000) {
+        value |= 0xFF000000;
+    }
+    dev->last_raw = value;
+    sample->raw = value;
+    sample->timestamp_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
 int32_t nau7802_get_channel1_offset(nau7802_t *dev)
 {
     uint8_t data[3];
     uint8_t reg = NAU7802_REGISTER_OCAL1_BP2;
     
-    esp_err_t ret = i2c_master_transmit_receive(dev->i2c_dev, &reg, 1, data, 3, 100);
+    esp_err_t ret = i2c_sched_transmit_receive(dev->i2c_dev, &reg, 1, data, 3, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read channel 1 offset: %d", ret);
         return 0;
@@ -471,7 +726,7 @@ esp_err_t nau7802_set_channel1_offset(nau7802_t *dev, int32_t offset)
     data[2] = (uint8_t)((offset >> 8) & 0xFF);
     data[3] = (uint8_t)(offset & 0xFF);
     
-    esp_err_t ret = i2c_master_transmit(dev->i2c_dev, data, 4, 100);
+    esp_err_t ret = i2c_sched_transmit(dev->i2c_dev, data, 4, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write channel 1 offset: %d", ret);
         return ret;
@@ -482,12 +737,19 @@ esp_err_t nau7802_set_channel1_offset(nau7802_t *dev, int32_t offset)
 
 float nau7802_get_weight(nau7802_t *dev, bool allow_negative, uint8_t sample_count, uint32_t timeout_ms)
 {
-    int32_t reading;
+    int32_t reading = 0;
     
     if (sample_count > 1) {
         reading = nau7802_get_average(dev, sample_count, timeout_ms);
     } else {
-        reading = nau7802_get_reading(dev);
+        // A stale conversion is still the latest weight; only a bus error loses it
+        nau7802_sample_t sample;
+        esp_err_t ret = nau7802_read_sample(dev, &sample);
+        if (ret == ESP_OK || ret == ESP_ERR_NOT_FINISHED) {
+            reading = sample.raw;
+        } else {
+            ESP_LOGE(TAG, "Failed to read ADC data: %s", esp_err_to_name(ret));
+        }
     }
     
     float weight = ((float)reading - dev->zero_offset) / dev->calibration_factor;
@@ -517,9 +779,9 @@ int32_t nau7802_get_average(nau7802_t *dev, uint8_t sample_count, uint32_t timeo
     uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
     
     while (samples_acquired < sample_count) {
-        if (nau7802_available(dev)) {
-            int32_t reading = nau7802_get_reading(dev);
-            total += reading;
+        nau7802_sample_t sample;
+        if (nau7802_read_sample(dev, &sample) == ESP_OK) {
+            total += sample.raw;
             samples_acquired++;
         }
         
@@ -782,7 +1044,7 @@ int32_t nau7802_get_channel2_offset(nau7802_t *dev)
     uint8_t data[3];
     uint8_t reg = NAU7802_REGISTER_OCAL2_BP2;
     
-    esp_err_t ret = i2c_master_transmit_receive(dev->i2c_dev, &reg, 1, data, 3, 100);
+    esp_err_t ret = i2c_sched_transmit_receive(dev->i2c_dev, &reg, 1, data, 3, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read channel 2 offset: %d", ret);
         return 0;
@@ -807,7 +1069,7 @@ esp_err_t nau7802_set_channel2_offset(nau7802_t *dev, int32_t offset)
     data[2] = (uint8_t)((offset >> 8) & 0xFF);
     data[3] = (uint8_t)(offset & 0xFF);
     
-    esp_err_t ret = i2c_master_transmit(dev->i2c_dev, data, 4, 100);
+    esp_err_t ret = i2c_sched_transmit(dev->i2c_dev, data, 4, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write channel 2 offset: %d", ret);
         return ret;
@@ -864,7 +1126,7 @@ esp_err_t nau7802_clear_bit(nau7802_t *dev, uint8_t reg, uint8_t bit)
 int32_t nau7802_get_24bit_register(nau7802_t *dev, uint8_t reg)
 {
     uint8_t data[3];
-    esp_err_t ret = i2c_master_transmit_receive(dev->i2c_dev, &reg, 1, data, 3, 100);
+    esp_err_t ret = i2c_sched_transmit_receive(dev->i2c_dev, &reg, 1, data, 3, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read 24-bit register 0x%02X: %d", reg, ret);
         return 0;
@@ -888,7 +1150,7 @@ esp_err_t nau7802_set_24bit_register(nau7802_t *dev, uint8_t reg, int32_t value)
     data[2] = (uint8_t)((value >> 8) & 0xFF);
     data[3] = (uint8_t)(value & 0xFF);
     
-    esp_err_t ret = i2c_master_transmit(dev->i2c_dev, data, 4, 100);
+    esp_err_t ret = i2c_sched_transmit(dev->i2c_dev, data, 4, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write 24-bit register 0x%02X: %d", reg, ret);
         return ret;
@@ -900,7 +1162,7 @@ esp_err_t nau7802_set_24bit_register(nau7802_t *dev, uint8_t reg, int32_t value)
 uint32_t nau7802_get_32bit_register(nau7802_t *dev, uint8_t reg)
 {
     uint8_t data[4];
-    esp_err_t ret = i2c_master_transmit_receive(dev->i2c_dev, &reg, 1, data, 4, 100);
+    esp_err_t ret = i2c_sched_transmit_receive(dev->i2c_dev, &reg, 1, data, 4, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read 32-bit register 0x%02X: %d", reg, ret);
         return 0;
@@ -922,7 +1184,7 @@ esp_err_t nau7802_set_32bit_register(nau7802_t *dev, uint8_t reg, uint32_t value
     data[3] = (uint8_t)((value >> 8) & 0xFF);
     data[4] = (uint8_t)(value & 0xFF);
     
-    esp_err_t ret = i2c_master_transmit(dev->i2c_dev, data, 5, 100);
+    esp_err_t ret = i2c_sched_transmit(dev->i2c_dev, data, 5, 100);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write 32-bit register 0x%02X: %d", reg, ret);
         return ret;
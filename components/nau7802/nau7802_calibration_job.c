@@ -0,0 +1,282 @@
+/*
+ * Background calibration jobs for NAU7802 scales
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "nau7802_calibration_job.h"
+#include "nau7802_calibration_storage.h"
+#include "nau7802_history.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *TAG = "nau7802_job";
+
+#define CAL_JOB_POLL_MS 20
+#define CAL_JOB_BASE_TIMEOUT_MS 5000     // Plus one 10 SPS conversion period per sample
+#define CAL_JOB_MUTEX_TIMEOUT_MS 1000
+#define CAL_JOB_READ_CHUNK 32
+
+typedef struct {
+    nau7802_cal_job_info_t info;
+    nau7802_t *dev;
+    SemaphoreHandle_t dev_mutex;
+    uint32_t cursor;                 // Next history index to consume
+    int64_t sum;                     // Sum of the consumed raw readings
+    int64_t submitted_us;
+} cal_job_t;
+
+static cal_job_t s_jobs[NAU7802_CAL_JOB_SLOTS];
+static uint32_t s_next_id = 1;
+static TaskHandle_t s_worker = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *job_type_name(nau7802_cal_job_type_t type)
+{
+    switch (type) {
+    case NAU7802_CAL_JOB_TARE: return "Tare";
+    case NAU7802_CAL_JOB_SPAN: return "Span calibration";
+    default:                   return "AFE calibration";
+    }
+}
+
+static void job_finish(cal_job_t *job, esp_err_t err)
+{
+    job->info.state = (err == ESP_OK) ? NAU7802_CAL_JOB_DONE : NAU7802_CAL_JOB_FAILED;
+    job->info.error = err;
+    job->info.elapsed_ms = (uint32_t)((esp_timer_get_time() - job->submitted_us) / 1000);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "%s on scale %u completed in %lu ms (offset %.2f, factor %.6f)",
+                 job_type_name(job->info.type), job->info.channel, (unsigned long)job->info.elapsed_ms,
+                 job->info.zero_offset, job->info.calibration_factor);
+    } else {
+        ESP_LOGW(TAG, "%s on scale %u failed: %s", job_type_name(job->info.type), job->info.channel,
+                 esp_err_to_name(err));
+    }
+}
+
+// Apply the averaged reading to the device and store the channel's record
+static esp_err_t job_apply(cal_job_t *job)
+{
+    float average = (float)job->sum / (float)job->info.samples_collected;
+    nau7802_calibration_data_t cal_data;
+
+    if (xSemaphoreTake(job->dev_mutex, pdMS_TO_TICKS(CAL_JOB_MUTEX_TIMEOUT_MS)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (job->info.type == NAU7802_CAL_JOB_TARE) {
+        nau7802_set_zero_offset(job->dev, average);
+    } else {
+        float factor = (average - nau7802_get_zero_offset(job->dev)) / job->info.known_weight_g;
+        if (factor == 0.0f) {
+            xSemaphoreGive(job->dev_mutex);
+            return ESP_ERR_INVALID_RESPONSE;  // Reading did not move from zero
+        }
+        nau7802_set_calibration_factor(job->dev, factor);
+    }
+    nau7802_calibration_read_from_device(job->dev, &cal_data);
+    xSemaphoreGive(job->dev_mutex);
+
+    job->info.zero_offset = cal_data.zero_offset;
+    job->info.calibration_factor = cal_data.calibration_factor;
+    return nau7802_calibration_save_channel(job->info.channel, &cal_data);
+}
+
+static esp_err_t job_run_afe(cal_job_t *job)
+{
+    if (xSemaphoreTake(job->dev_mutex, pdMS_TO_TICKS(CAL_JOB_MUTEX_TIMEOUT_MS)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = nau7802_calibrate_af(job->dev);
+    job->info.zero_offset = nau7802_get_zero_offset(job->dev);
+    job->info.calibration_factor = nau7802_get_calibration_factor(job->dev);
+    xSemaphoreGive(job->dev_mutex);
+    return err;
+}
+
+// Advance one running job; returns true while it is still running
+static bool job_step(cal_job_t *job)
+{
+    if (job->info.type == NAU7802_CAL_JOB_AFE) {
+        job_finish(job, job_run_afe(job));
+        return false;
+    }
+
+    nau7802_history_sample_t samples[CAL_JOB_READ_CHUNK];
+    while (job->info.samples_collected < job->info.samples_needed) {
+        size_t wanted = job->info.samples_needed - job->info.samples_collected;
+        if (wanted > CAL_JOB_READ_CHUNK) {
+            wanted = CAL_JOB_READ_CHUNK;
+        }
+        size_t count = nau7802_history_read(job->info.channel, &job->cursor, samples, wanted, NULL);
+        if (count == 0) {
+            break;
+        }
+        for (size_t i = 0; i < count; i++) {
+            job->sum += samples[i].raw;
+        }
+        job->info.samples_collected += count;
+    }
+
+    if (job->info.samples_collected >= job->info.samples_needed) {
+        job_finish(job, job_apply(job));
+        return false;
+    }
+
+    uint32_t timeout_ms = CAL_JOB_BASE_TIMEOUT_MS + 100u * job->info.samples_needed;
+    job->info.elapsed_ms = (uint32_t)((esp_timer_get_time() - job->submitted_us) / 1000);
+    if (job->info.elapsed_ms > timeout_ms) {
+        job_finish(job, ESP_ERR_TIMEOUT);  // Acquisition stopped delivering conversions
+        return false;
+    }
+    return true;
+}
+
+static void cal_job_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        bool running = false;
+        for (size_t i = 0; i < NAU7802_CAL_JOB_SLOTS; i++) {
+            // Work on a copy; only the worker modifies a running job
+            cal_job_t job;
+            taskENTER_CRITICAL(&s_lock);
+            job = s_jobs[i];
+            taskEXIT_CRITICAL(&s_lock);
+            if (job.info.id == 0 || job.info.state != NAU7802_CAL_JOB_RUNNING) {
+                continue;
+            }
+
+            running |= job_step(&job);
+
+            taskENTER_CRITICAL(&s_lock);
+            s_jobs[i] = job;
+            taskEXIT_CRITICAL(&s_lock);
+        }
+
+        // Sleep until the next submission once nothing is running
+        if (running) {
+            vTaskDelay(pdMS_TO_TICKS(CAL_JOB_POLL_MS));
+        } else {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+}
+
+esp_err_t nau7802_cal_job_submit(nau7802_t *dev, SemaphoreHandle_t dev_mutex, uint8_t channel,
+                                 nau7802_cal_job_type_t type, float known_weight_g, uint16_t samples,
+                                 uint32_t *job_id)
+{
+    if (dev == NULL || dev_mutex == NULL || job_id == NULL || type > NAU7802_CAL_JOB_AFE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (type == NAU7802_CAL_JOB_SPAN && !(known_weight_g > 0.0f)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (type != NAU7802_CAL_JOB_AFE) {
+        if (samples == 0 || samples > NAU7802_CAL_JOB_MAX_SAMPLES) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (channel >= nau7802_history_channels()) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    } else {
+        samples = 0;
+    }
+
+    if (s_worker == NULL) {
+        if (xTaskCreate(cal_job_task, "nau7802_cal", 4096, NULL, 3, &s_worker) != pdPASS) {
+            s_worker = NULL;
+            ESP_LOGE(TAG, "Failed to create calibration worker");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    esp_err_t ret = ESP_OK;
+    cal_job_t *slot = NULL;
+    taskENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < NAU7802_CAL_JOB_SLOTS; i++) {
+        cal_job_t *job = &s_jobs[i];
+        if (job->info.id != 0 && job->info.state == NAU7802_CAL_JOB_RUNNING) {
+            if (job->info.channel == channel) {
+                ret = ESP_ERR_INVALID_STATE;
+                break;
+            }
+            continue;
+        }
+        // Free slot, or the oldest finished job
+        if (slot == NULL || job->info.id < slot->info.id) {
+            slot = job;
+        }
+    }
+    if (ret == ESP_OK && slot == NULL) {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    if (ret == ESP_OK) {
+        memset(slot, 0, sizeof(*slot));
+        slot->info.id = s_next_id++;
+        if (s_next_id == 0) {
+            s_next_id = 1;
+        }
+        slot->info.channel = channel;
+        slot->info.type = type;
+        slot->info.state = NAU7802_CAL_JOB_RUNNING;
+        slot->info.samples_needed = samples;
+        slot->info.known_weight_g = known_weight_g;
+        slot->dev = dev;
+        slot->dev_mutex = dev_mutex;
+        slot->cursor = (type != NAU7802_CAL_JOB_AFE) ? nau7802_history_head(channel) : 0;
+        slot->submitted_us = esp_timer_get_time();
+        *job_id = slot->info.id;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (ret == ESP_OK) {
+        xTaskNotifyGive(s_worker);
+    }
+    return ret;
+}
+
+esp_err_t nau7802_cal_job_get(uint32_t job_id, nau7802_cal_job_info_t *info)
+{
+    if (job_id == 0 || info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < NAU7802_CAL_JOB_SLOTS; i++) {
+        if (s_jobs[i].info.id == job_id) {
+            *info = s_jobs[i].info;
+            if (info->state == NAU7802_CAL_JOB_RUNNING) {
+                info->elapsed_ms = (uint32_t)((now - s_jobs[i].submitted_us) / 1000);
+            }
+            ret = ESP_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ret;
+}
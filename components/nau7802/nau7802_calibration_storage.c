@@ -26,6 +26,7 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_log.h"
+#include <stdio.h>
 
 static const char *TAG = "cal_storage";
 
@@ -34,12 +35,29 @@ static const char *TAG = "cal_storage";
 #define NVS_KEY_CH1_OFFSET "ch1_offset"
 #define NVS_KEY_IS_VALID "is_valid"
 
+// Channel 0 uses the plain key names, so records written by single-scale
+// firmware are read as channel 0; other channels append "_<channel>"
+static const char *channel_key(char *key, size_t size, const char *base, uint8_t channel)
+{
+    if (channel == 0) {
+        return base;
+    }
+    snprintf(key, size, "%s_%u", base, channel);
+    return key;
+}
+
 esp_err_t nau7802_calibration_load(nau7802_calibration_data_t *cal_data)
+{
+    return nau7802_calibration_load_channel(0, cal_data);
+}
+
+esp_err_t nau7802_calibration_load_channel(uint8_t channel, nau7802_calibration_data_t *cal_data)
 {
     if (cal_data == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    char key[16];
     nvs_handle_t nvs_handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
     if (ret != ESP_OK) {
@@ -49,7 +67,8 @@ esp_err_t nau7802_calibration_load(nau7802_calibration_data_t *cal_data)
     }
 
     size_t required_size = sizeof(float);
-    ret = nvs_get_blob(nvs_handle, NVS_KEY_CAL_FACTOR, &cal_data->calibration_factor, &required_size);
+    ret = nvs_get_blob(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_CAL_FACTOR, channel),
+                       &cal_data->calibration_factor, &required_size);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Calibration factor not found in NVS");
         nvs_close(nvs_handle);
@@ -58,7 +77,8 @@ esp_err_t nau7802_calibration_load(nau7802_calibration_data_t *cal_data)
     }
 
     required_size = sizeof(float);
-    ret = nvs_get_blob(nvs_handle, NVS_KEY_ZERO_OFFSET, &cal_data->zero_offset, &required_size);
+    ret = nvs_get_blob(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_ZERO_OFFSET, channel),
+                       &cal_data->zero_offset, &required_size);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Zero offset not found in NVS");
         nvs_close(nvs_handle);
@@ -67,7 +87,8 @@ esp_err_t nau7802_calibration_load(nau7802_calibration_data_t *cal_data)
     }
 
     required_size = sizeof(int32_t);
-    ret = nvs_get_blob(nvs_handle, NVS_KEY_CH1_OFFSET, &cal_data->channel1_offset, &required_size);
+    ret = nvs_get_blob(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_CH1_OFFSET, channel),
+                       &cal_data->channel1_offset, &required_size);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Channel 1 offset not found in NVS, defaulting to 0");
         cal_data->channel1_offset = 0;
@@ -75,7 +96,8 @@ esp_err_t nau7802_calibration_load(nau7802_calibration_data_t *cal_data)
 
     uint8_t is_valid = 0;
     required_size = sizeof(uint8_t);
-    ret = nvs_get_blob(nvs_handle, NVS_KEY_IS_VALID, &is_valid, &required_size);
+    ret = nvs_get_blob(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_IS_VALID, channel),
+                       &is_valid, &required_size);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "is_valid flag not found in NVS");
         cal_data->is_valid = false;
@@ -90,19 +112,25 @@ esp_err_t nau7802_calibration_load(nau7802_calibration_data_t *cal_data)
         cal_data->is_valid = false;
     }
 
-    ESP_LOGI(TAG, "Loaded calibration: factor=%.6f, offset=%.2f, ch1_offset=%ld, valid=%d",
-             cal_data->calibration_factor, cal_data->zero_offset, 
+    ESP_LOGI(TAG, "Loaded calibration for channel %u: factor=%.6f, offset=%.2f, ch1_offset=%ld, valid=%d",
+             channel, cal_data->calibration_factor, cal_data->zero_offset, 
              cal_data->channel1_offset, cal_data->is_valid);
 
     return ESP_OK;
 }
 
 esp_err_t nau7802_calibration_save(const nau7802_calibration_data_t *cal_data)
+{
+    return nau7802_calibration_save_channel(0, cal_data);
+}
+
+esp_err_t nau7802_calibration_save_channel(uint8_t channel, const nau7802_calibration_data_t *cal_data)
 {
     if (cal_data == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    char key[16];
     nvs_handle_t nvs_handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (ret != ESP_OK) {
@@ -110,21 +138,24 @@ esp_err_t nau7802_calibration_save(const nau7802_calibration_data_t *cal_data)
         return ret;
     }
 
-    ret = nvs_set_blob(nvs_handle, NVS_KEY_CAL_FACTOR, &cal_data->calibration_factor, sizeof(float));
+    ret = nvs_set_blob(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_CAL_FACTOR, channel),
+                       &cal_data->calibration_factor, sizeof(float));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to save calibration factor: %s", esp_err_to_name(ret));
         nvs_close(nvs_handle);
         return ret;
     }
 
-    ret = nvs_set_blob(nvs_handle, NVS_KEY_ZERO_OFFSET, &cal_data->zero_offset, sizeof(float));
+    ret = nvs_set_blob(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_ZERO_OFFSET, channel),
+                       &cal_data->zero_offset, sizeof(float));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to save zero offset: %s", esp_err_to_name(ret));
         nvs_close(nvs_handle);
         return ret;
     }
 
-    ret = nvs_set_blob(nvs_handle, NVS_KEY_CH1_OFFSET, &cal_data->channel1_offset, sizeof(int32_t));
+    ret = nvs_set_blob(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_CH1_OFFSET, channel),
+                       &cal_data->channel1_offset, sizeof(int32_t));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to save channel 1 offset: %s", esp_err_to_name(ret));
         nvs_close(nvs_handle);
@@ -132,7 +163,8 @@ esp_err_t nau7802_calibration_save(const nau7802_calibration_data_t *cal_data)
     }
 
     uint8_t is_valid = cal_data->is_valid ? 1 : 0;
-    ret = nvs_set_blob(nvs_handle, NVS_KEY_IS_VALID, &is_valid, sizeof(uint8_t));
+    ret = nvs_set_blob(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_IS_VALID, channel),
+                       &is_valid, sizeof(uint8_t));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to save is_valid flag: %s", esp_err_to_name(ret));
         nvs_close(nvs_handle);
@@ -143,7 +175,7 @@ esp_err_t nau7802_calibration_save(const nau7802_calibration_data_t *cal_data)
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(ret));
     } else {
-        ESP_LOGI(TAG, "Calibration saved successfully");
+        ESP_LOGI(TAG, "Calibration saved for channel %u", channel);
     }
 
     nvs_close(nvs_handle);
@@ -200,6 +232,12 @@ esp_err_t nau7802_calibration_read_from_device(nau7802_t *scale, nau7802_calibra
 
 esp_err_t nau7802_calibration_erase(void)
 {
+    return nau7802_calibration_erase_channel(0);
+}
+
+esp_err_t nau7802_calibration_erase_channel(uint8_t channel)
+{
+    char key[16];
     nvs_handle_t nvs_handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (ret != ESP_OK) {
@@ -207,16 +245,16 @@ esp_err_t nau7802_calibration_erase(void)
         return ret;
     }
 
-    nvs_erase_key(nvs_handle, NVS_KEY_CAL_FACTOR);
-    nvs_erase_key(nvs_handle, NVS_KEY_ZERO_OFFSET);
-    nvs_erase_key(nvs_handle, NVS_KEY_CH1_OFFSET);
-    nvs_erase_key(nvs_handle, NVS_KEY_IS_VALID);
+    nvs_erase_key(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_CAL_FACTOR, channel));
+    nvs_erase_key(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_ZERO_OFFSET, channel));
+    nvs_erase_key(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_CH1_OFFSET, channel));
+    nvs_erase_key(nvs_handle, channel_key(key, sizeof(key), NVS_KEY_IS_VALID, channel));
 
     ret = nvs_commit(nvs_handle);
     nvs_close(nvs_handle);
 
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Calibration data erased from NVS");
+        ESP_LOGI(TAG, "Calibration data for channel %u erased from NVS", channel);
     }
 
     return ret;
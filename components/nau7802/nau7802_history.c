@@ -0,0 +1,196 @@
+/*
+ * Sample history ring for NAU7802 scales
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "nau7802_history.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "nau7802_hist";
+
+typedef struct {
+    atomic_uint seq;         // index + 1 once the slot is complete, 0 while being written
+    uint32_t timestamp_us;
+    int32_t raw;
+    float weight_g;
+} history_slot_t;
+
+typedef struct {
+    history_slot_t *slots;
+    atomic_uint head;        // Index of the next sample to be written
+} history_ring_t;
+
+static history_ring_t s_rings[NAU7802_HISTORY_MAX_CHANNELS];
+static uint8_t s_channels = 0;
+static uint32_t s_capacity = 0;
+static uint32_t s_mask = 0;
+
+static uint32_t round_down_pow2(uint32_t value)
+{
+    uint32_t result = 1;
+    while (value >= result * 2 && result < 0x80000000u) {
+        result *= 2;
+    }
+    return result;
+}
+
+static history_ring_t *get_ring(uint8_t channel)
+{
+    return (channel < s_channels) ? &s_rings[channel] : NULL;
+}
+
+static history_slot_t *alloc_rings(uint8_t channels, uint32_t capacity, uint32_t caps)
+{
+    history_slot_t *slots = heap_caps_calloc((size_t)capacity * channels, sizeof(history_slot_t), caps);
+    if (slots != NULL) {
+        for (uint8_t ch = 0; ch < channels; ch++) {
+            s_rings[ch].slots = slots + (size_t)ch * capacity;
+            atomic_store(&s_rings[ch].head, 0);
+        }
+    }
+    return slots;
+}
+
+esp_err_t nau7802_history_init(uint8_t channels, uint32_t capacity, uint32_t fallback_capacity)
+{
+    if (s_channels != 0) {
+        return ESP_OK;
+    }
+    if (channels == 0 || channels > NAU7802_HISTORY_MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // One allocation for all channels, split into equal rings
+    capacity = round_down_pow2(capacity);
+    history_slot_t *slots = alloc_rings(channels, capacity, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (slots == NULL) {
+        ESP_LOGW(TAG, "PSRAM not available for %u x %lu samples, using internal RAM",
+                 channels, (unsigned long)capacity);
+        capacity = round_down_pow2(fallback_capacity);
+        slots = alloc_rings(channels, capacity, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (slots == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate history rings (%u x %lu samples)", channels, (unsigned long)capacity);
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_capacity = capacity;
+    s_mask = capacity - 1;
+    s_channels = channels;
+    ESP_LOGI(TAG, "History ring: %u x %lu samples (%lu bytes)", channels, (unsigned long)capacity,
+             (unsigned long)(channels * capacity * sizeof(history_slot_t)));
+    return ESP_OK;
+}
+
+void nau7802_history_append(uint8_t channel, uint32_t timestamp_us, int32_t raw, float weight_g)
+{
+    history_ring_t *ring = get_ring(channel);
+    if (ring == NULL) {
+        return;
+    }
+
+    uint32_t index = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    history_slot_t *slot = &ring->slots[index & s_mask];
+
+    // Mark the slot busy before touching the payload so readers discard it
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->timestamp_us = timestamp_us;
+    slot->raw = raw;
+    slot->weight_g = weight_g;
+    atomic_store_explicit(&slot->seq, index + 1, memory_order_release);
+    atomic_store_explicit(&ring->head, index + 1, memory_order_release);
+}
+
+size_t nau7802_history_read(uint8_t channel, uint32_t *cursor, nau7802_history_sample_t *out,
+                            size_t max_samples, uint32_t *lost)
+{
+    uint32_t skipped = 0;
+    size_t count = 0;
+
+    if (lost != NULL) {
+        *lost = 0;
+    }
+    history_ring_t *ring = get_ring(channel);
+    if (cursor == NULL || ring == NULL) {
+        return 0;
+    }
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t retained = head < s_capacity ? head : s_capacity;
+    uint32_t oldest = head - retained;
+    uint32_t index = *cursor;
+
+    if ((int32_t)(head - index) < 0) {
+        // Cursor from the future (e.g. before a reboot): restart at the oldest sample
+        index = oldest;
+    } else if (head - index > retained) {
+        skipped = (head - index) - retained;
+        index = oldest;
+    }
+
+    while (index != head && count < max_samples) {
+        const history_slot_t *slot = &ring->slots[index & s_mask];
+        uint32_t seq_before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        nau7802_history_sample_t sample = {
+            .index = index,
+            .timestamp_us = slot->timestamp_us,
+            .raw = slot->raw,
+            .weight_g = slot->weight_g,
+        };
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t seq_after = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+        if (seq_before == index + 1 && seq_after == seq_before) {
+            out[count++] = sample;
+        } else {
+            // Overwritten while we were reading
+            skipped++;
+        }
+        index++;
+    }
+
+    *cursor = index;
+    if (lost != NULL) {
+        *lost = skipped;
+    }
+    return count;
+}
+
+uint32_t nau7802_history_head(uint8_t channel)
+{
+    history_ring_t *ring = get_ring(channel);
+    return ring != NULL ? atomic_load_explicit(&ring->head, memory_order_acquire) : 0;
+}
+
+uint32_t nau7802_history_capacity(void)
+{
+    return s_capacity;
+}
+
+uint8_t nau7802_history_channels(void)
+{
+    return s_channels;
+}
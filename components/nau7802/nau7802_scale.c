@@ -0,0 +1,181 @@
+/*
+ * Acquisition and publishing for one NAU7802 scale channel
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "nau7802_scale.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "nau7802_scale";
+
+void nau7802_scale_init(nau7802_scale_t *ch, uint8_t index, const nau7802_stability_config_t *stability)
+{
+    ch->index = index;
+    nau7802_stability_init(&ch->stability, stability);
+    nau7802_scale_reset_average(ch);
+    ch->raw_reading = 0;
+    ch->last_raw = 0;
+    ch->new_sample = false;
+    ch->read_errors = 0;
+    ch->next_poll_us = 0;
+}
+
+void nau7802_scale_reset_average(nau7802_scale_t *ch)
+{
+    ch->avg_head = 0;
+    ch->avg_count = 0;
+    ch->avg_sum = 0;
+}
+
+float nau7802_scale_convert_weight(float weight_grams, uint8_t unit)
+{
+    if (unit == 1) {
+        // Convert grams to lbs: 1 lb = 453.592 grams
+        return weight_grams / 453.592f;
+    } else if (unit == 2) {
+        // Convert grams to kg: 1 kg = 1000 grams
+        return weight_grams / 1000.0f;
+    }
+    // unit == 0 means grams, no conversion needed
+    return weight_grams;
+}
+
+int32_t nau7802_scale_weight_scaled(float weight_grams, uint8_t unit)
+{
+    float weight_converted = nau7802_scale_convert_weight(weight_grams, unit);
+
+    // Clamp weight to prevent integer overflow (int32_t range: -2147483648 to 2147483647)
+    // Scaled range: -21474836.48 to 21474836.47
+    const float max_weight = 21474836.47f;
+    const float min_weight = -21474836.48f;
+    if (weight_converted > max_weight) {
+        weight_converted = max_weight;
+        ESP_LOGW(TAG, "Weight clamped to maximum (overflow protection)");
+    } else if (weight_converted < min_weight) {
+        weight_converted = min_weight;
+        ESP_LOGW(TAG, "Weight clamped to minimum (overflow protection)");
+    }
+
+    // Scale by 100 and convert to int32_t (e.g., 100.24 lbs = 10024)
+    return (int32_t)(weight_converted * 100.0f + 0.5f);  // Round to nearest
+}
+
+// The device mutex is only held for multi-step operations (configuration,
+// calibration, tare); skip the poll while one runs instead of waiting for it
+bool nau7802_scale_capture(nau7802_scale_t *ch, uint32_t period_us, uint8_t average_samples,
+                             nau7802_history_sample_t *captured)
+{
+    if (ch->mutex == NULL || xSemaphoreTake(ch->mutex, 0) != pdTRUE) {
+        return false;
+    }
+    nau7802_sample_t reading;
+    esp_err_t read_ret = nau7802_read_sample(&ch->device, &reading);
+    bool ready = (read_ret == ESP_OK);
+    int32_t raw = 0;
+    float weight_grams = 0.0f;
+    if (ready) {
+        raw = reading.raw;
+        weight_grams = ((float)raw - ch->device.zero_offset) / ch->device.calibration_factor;
+    }
+    xSemaphoreGive(ch->mutex);
+
+    if (read_ret != ESP_OK && read_ret != ESP_ERR_NOT_FINISHED) {
+        ch->read_errors++;
+    }
+    if (!ready) {
+        return false;
+    }
+
+    // This conversion finished within the last poll interval (a quarter period),
+    // so the next one cannot be ready before three quarters of a period from now
+    ch->next_poll_us = reading.timestamp_us + period_us - period_us / 4;
+
+    if (captured != NULL) {
+        captured->index = nau7802_history_head(ch->index);
+        captured->timestamp_us = (uint32_t)reading.timestamp_us;
+        captured->raw = raw;
+        captured->weight_g = weight_grams;
+    }
+    nau7802_history_append(ch->index, (uint32_t)reading.timestamp_us, raw, weight_grams);
+
+    if (ch->avg_count == average_samples) {
+        ch->avg_sum -= ch->avg_window[ch->avg_head];
+    } else {
+        ch->avg_count++;
+    }
+    ch->avg_window[ch->avg_head] = raw;
+    ch->avg_sum += raw;
+    ch->last_raw = raw;
+    ch->avg_head = (ch->avg_head + 1) % average_samples;
+    ch->new_sample = true;
+    return true;
+}
+
+void nau7802_scale_publish(nau7802_scale_t *ch, uint8_t unit, uint8_t *record,
+                             nau7802_scale_values_t *values)
+{
+    bool available = ch->new_sample;
+    ch->new_sample = false;
+    if (ch->avg_count > 0) {
+        ch->raw_reading = (int32_t)(ch->avg_sum / ch->avg_count);
+    }
+    int32_t raw_reading = ch->raw_reading;
+
+    float weight_grams = 0.0f;
+    if (ch->mutex != NULL && xSemaphoreTake(ch->mutex, 0) == pdTRUE) {
+        // Update stability / motion and run auto-zero tracking before
+        // the weight is computed so AZT applies to this reading
+        if (available) {
+            nau7802_stability_update(&ch->stability, &ch->device, raw_reading);
+        }
+        weight_grams = ((float)raw_reading - ch->device.zero_offset) / ch->device.calibration_factor;
+        xSemaphoreGive(ch->mutex);
+    } else {
+        // Calibration or tare in progress: report the weight, skip AZT this cycle
+        weight_grams = ((float)raw_reading - ch->device.zero_offset) / ch->device.calibration_factor;
+    }
+
+    int32_t weight_scaled = nau7802_scale_weight_scaled(weight_grams, unit);
+
+    // Connected and initialized are checked by the caller
+    uint8_t status = NAU7802_SCALE_STATUS_CONNECTED | NAU7802_SCALE_STATUS_INITIALIZED;
+    if (available) status |= NAU7802_SCALE_STATUS_AVAILABLE;
+    if (ch->stability.stable) status |= NAU7802_SCALE_STATUS_STABLE;
+    if (ch->stability.in_motion) status |= NAU7802_SCALE_STATUS_MOTION;
+    if (ch->stability.center_of_zero) status |= NAU7802_SCALE_STATUS_CENTER_OF_ZERO;
+
+    memcpy(&record[0], &weight_scaled, sizeof(int32_t));
+    memcpy(&record[4], &raw_reading, sizeof(int32_t));
+    record[8] = unit;
+    record[9] = status;
+
+    if (values != NULL) {
+        values->weight_scaled = weight_scaled;
+        values->weight = nau7802_scale_convert_weight(weight_grams, unit);
+        values->raw = ch->last_raw;
+        values->filtered = raw_reading;
+        values->filtered_exact = ch->avg_count > 0 ? (float)ch->avg_sum / ch->avg_count : (float)raw_reading;
+        values->unit = unit;
+        values->status = status;
+    }
+}
@@ -0,0 +1,313 @@
+/*
+ * Simulated NAU7802 for bench and pipeline testing
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "nau7802_sim.h"
+#include "nau7802.h"
+#include "i2c_scheduler.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG = "nau7802_sim";
+
+#define SIM_REVISION_ID 0x0F
+#define SIM_ADC_MAX 0x7FFFFF
+#define SIM_ADC_MIN (-0x800000)
+
+// Conversion period for the programmed CRS setting, in microseconds
+static uint32_t sim_period_us(const nau7802_sim_t *sim)
+{
+    switch ((sim->regs[NAU7802_REGISTER_CTRL2] & NAU7802_CTRL2_CRS_MASK) >> 4) {
+    case NAU7802_SPS_10:  return 100000;
+    case NAU7802_SPS_20:  return 50000;
+    case NAU7802_SPS_40:  return 25000;
+    case NAU7802_SPS_80:  return 12500;
+    default:              return 3125;
+    }
+}
+
+static void sim_restart(nau7802_sim_t *sim, int64_t now)
+{
+    sim->start_us = now;
+    sim->completed = 0;
+    sim->consumed = 0;
+}
+
+static void sim_reset_registers(nau7802_sim_t *sim)
+{
+    memset(sim->regs, 0, sizeof(sim->regs));
+    sim->regs[NAU7802_REGISTER_REVISION_ID] = SIM_REVISION_ID;
+    sim->start_us = 0;
+    sim->cal_done_us = 0;
+    sim->completed = 0;
+    sim->consumed = 0;
+}
+
+static bool sim_converting(const nau7802_sim_t *sim)
+{
+    const uint8_t running = (1 << NAU7802_PU_CTRL_PUD) | (1 << NAU7802_PU_CTRL_PUA) |
+                            (1 << NAU7802_PU_CTRL_PUR) | (1 << NAU7802_PU_CTRL_CS);
+    return (sim->regs[NAU7802_REGISTER_PU_CTRL] & running) == running &&
+           (sim->regs[NAU7802_REGISTER_CTRL2] & NAU7802_CTRL2_CALS) == 0 &&
+           sim->start_us != 0;
+}
+
+static uint32_t sim_hash(uint32_t x)
+{
+    x += 0x9E3779B9u;
+    x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+    x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+    return x ^ (x >> 16);
+}
+
+// Standard normal deviate for conversion n (Box-Muller on two hashed uniforms)
+static float sim_gauss(uint32_t seed, uint32_t n)
+{
+    uint32_t base = sim_hash(seed);
+    uint32_t a = sim_hash(base + 2u * n);
+    uint32_t b = sim_hash(base + 2u * n + 1u);
+    float u1 = ((a >> 8) + 1.0f) / 16777217.0f;
+    float u2 = (b >> 8) / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+// Value of conversion n, which completed at t_us
+static int32_t sim_conversion(const nau7802_sim_t *sim, uint32_t n, int64_t t_us)
+{
+    const nau7802_sim_signal_t *sig = &sim->signal;
+    if (sig->trace != NULL && sig->trace_len > 0) {
+        return sig->trace[n % sig->trace_len];
+    }
+
+    double elapsed_s = (double)(t_us - sim->init_us) / 1e6;
+    float value = 0.0f;
+    // Channel 2 is modelled as a shorted input: noise and hum only
+    if ((sim->regs[NAU7802_REGISTER_ADC] & NAU7802_ADC_CHANNEL_MASK) == 0) {
+        float load = sig->load_g;
+        if (sig->step_period_ms > 0 && ((t_us - sim->init_us) / 1000 / sig->step_period_ms) % 2 == 1) {
+            load += sig->step_g;
+        }
+        value = (float)sig->zero_counts + load * sig->counts_per_gram +
+                sig->drift_counts_per_s * (float)elapsed_s;
+    }
+    if (sig->hum_counts != 0.0f) {
+        double cycles = fmod(elapsed_s * sig->hum_hz, 1.0);
+        value += sig->hum_counts * sinf(2.0f * (float)M_PI * (float)cycles);
+    }
+    if (sig->noise_counts != 0.0f) {
+        value += sig->noise_counts * sim_gauss(sig->seed, n);
+    }
+
+    // Signal counts are given at gain x128
+    value *= (float)(1 << (sim->regs[NAU7802_REGISTER_CTRL1] & NAU7802_CTRL1_GAIN_MASK)) / 128.0f;
+    if (value > SIM_ADC_MAX) {
+        return SIM_ADC_MAX;
+    }
+    if (value < SIM_ADC_MIN) {
+        return SIM_ADC_MIN;
+    }
+    return (int32_t)lrintf(value);
+}
+
+// Advance calibration and conversions to now
+static void sim_update(nau7802_sim_t *sim, int64_t now)
+{
+    uint8_t *ctrl2 = &sim->regs[NAU7802_REGISTER_CTRL2];
+    if ((*ctrl2 & NAU7802_CTRL2_CALS) && now >= sim->cal_done_us) {
+        *ctrl2 &= ~NAU7802_CTRL2_CALS;
+        sim_restart(sim, sim->cal_done_us);
+    }
+
+    uint8_t *pu_ctrl = &sim->regs[NAU7802_REGISTER_PU_CTRL];
+    if (!sim_converting(sim)) {
+        *pu_ctrl &= ~(1 << NAU7802_PU_CTRL_CR);
+        return;
+    }
+
+    uint32_t period = sim_period_us(sim);
+    uint32_t completed = (uint32_t)((now - sim->start_us) / period);
+    if (completed != sim->completed) {
+        sim->stats.conversions += completed - sim->completed;
+        sim->completed = completed;
+        int32_t value = sim_conversion(sim, completed - 1, sim->start_us + (int64_t)completed * period);
+        sim->regs[NAU7802_REGISTER_ADC_DATA] = (uint8_t)(value >> 16);
+        sim->regs[NAU7802_REGISTER_ADC_DATA + 1] = (uint8_t)(value >> 8);
+        sim->regs[NAU7802_REGISTER_ADC_DATA + 2] = (uint8_t)value;
+    }
+    if (sim->completed != sim->consumed) {
+        *pu_ctrl |= (1 << NAU7802_PU_CTRL_CR);
+    } else {
+        *pu_ctrl &= ~(1 << NAU7802_PU_CTRL_CR);
+    }
+}
+
+// Reading the last ADC byte hands the conversion to the host and clears CR
+static void sim_consume(nau7802_sim_t *sim)
+{
+    if (sim->completed != sim->consumed) {
+        sim->stats.reads++;
+        sim->stats.missed += sim->completed - sim->consumed - 1;
+        sim->consumed = sim->completed;
+    }
+    sim->regs[NAU7802_REGISTER_PU_CTRL] &= ~(1 << NAU7802_PU_CTRL_CR);
+}
+
+static void sim_write_register(nau7802_sim_t *sim, uint8_t reg, uint8_t value, int64_t now)
+{
+    uint8_t old = sim->regs[reg];
+
+    switch (reg) {
+    case NAU7802_REGISTER_PU_CTRL:
+        if (value & (1 << NAU7802_PU_CTRL_RR)) {
+            sim_reset_registers(sim);
+            sim->regs[reg] = 1 << NAU7802_PU_CTRL_RR;
+            return;
+        }
+        // PUR and CR are status bits; power-up is immediate
+        value = (value & ~((1 << NAU7802_PU_CTRL_PUR) | (1 << NAU7802_PU_CTRL_CR))) |
+                (old & (1 << NAU7802_PU_CTRL_CR));
+        if (value & (1 << NAU7802_PU_CTRL_PUD)) {
+            value |= (1 << NAU7802_PU_CTRL_PUR);
+        }
+        sim->regs[reg] = value;
+        if ((value & (1 << NAU7802_PU_CTRL_CS)) && !(old & (1 << NAU7802_PU_CTRL_CS))) {
+            sim_restart(sim, now);
+        }
+        return;
+    case NAU7802_REGISTER_CTRL2:
+        value = (value & ~NAU7802_CTRL2_CAL_ERROR) | (old & NAU7802_CTRL2_CAL_ERROR);
+        sim->regs[reg] = value;
+        if ((value ^ old) & NAU7802_CTRL2_CRS_MASK) {
+            sim_restart(sim, now);
+        }
+        if ((value & NAU7802_CTRL2_CALS) && !(old & NAU7802_CTRL2_CALS)) {
+            sim->cal_done_us = now + 2 * (int64_t)sim_period_us(sim);
+        }
+        return;
+    case NAU7802_REGISTER_ADC_DATA:
+    case NAU7802_REGISTER_ADC_DATA + 1:
+    case NAU7802_REGISTER_ADC_DATA + 2:
+    case NAU7802_REGISTER_REVISION_ID:
+        return;
+    default:
+        sim->regs[reg] = value;
+        return;
+    }
+}
+
+static esp_err_t sim_transfer(void *ctx, const uint8_t *write_buf, size_t write_len,
+                              uint8_t *read_buf, size_t read_len, int timeout_ms)
+{
+    nau7802_sim_t *sim = (nau7802_sim_t *)ctx;
+    int64_t now = esp_timer_get_time();
+    esp_err_t ret = ESP_OK;
+    (void)timeout_ms;
+
+    taskENTER_CRITICAL(&sim->lock);
+    if (!sim->connected) {
+        ret = ESP_ERR_INVALID_STATE;  // What the driver reports for a NACK
+    } else {
+        sim->stats.transactions++;
+        // A write phase and a read phase (after a repeated start) each carry the address byte
+        sim->stats.bus_bytes += (write_len > 0 ? 1 + write_len : 0) + (read_len > 0 ? 1 + read_len : 0);
+        sim_update(sim, now);
+
+        if (write_len > 0) {
+            sim->pointer = write_buf[0] % NAU7802_SIM_REGISTERS;
+            for (size_t i = 1; i < write_len; i++) {
+                sim_write_register(sim, sim->pointer, write_buf[i], now);
+                sim->pointer = (sim->pointer + 1) % NAU7802_SIM_REGISTERS;
+            }
+            sim_update(sim, now);
+        }
+
+        bool data_read = false;
+        for (size_t i = 0; i < read_len; i++) {
+            read_buf[i] = sim->regs[sim->pointer];
+            data_read |= (sim->pointer == NAU7802_REGISTER_ADC_DATA + 2);
+            sim->pointer = (sim->pointer + 1) % NAU7802_SIM_REGISTERS;
+        }
+        if (data_read) {
+            sim_consume(sim);
+        }
+    }
+    taskEXIT_CRITICAL(&sim->lock);
+    return ret;
+}
+
+esp_err_t nau7802_sim_init(nau7802_sim_t *sim, const nau7802_sim_signal_t *signal)
+{
+    if (sim == NULL || signal == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(sim, 0, sizeof(*sim));
+    sim->signal = *signal;
+    sim->connected = true;
+    sim->init_us = esp_timer_get_time();
+    portMUX_INITIALIZE(&sim->lock);
+    sim_reset_registers(sim);
+
+    i2c_master_dev_handle_t handle = nau7802_sim_get_handle(sim);
+    esp_err_t ret = i2c_sched_register_device(handle, NAU7802_I2C_ADDRESS, "nau7802_sim");
+    if (ret == ESP_OK) {
+        ret = i2c_sched_set_device_transport(handle, sim_transfer, sim);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to attach simulated NAU7802: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "Simulated NAU7802 attached (%s)",
+             signal->trace != NULL ? "trace replay" : "generated signal");
+    return ESP_OK;
+}
+
+i2c_master_dev_handle_t nau7802_sim_get_handle(nau7802_sim_t *sim)
+{
+    // Only used as a key by the I2C scheduler, never passed to the I2C driver
+    return (i2c_master_dev_handle_t)sim;
+}
+
+void nau7802_sim_set_load(nau7802_sim_t *sim, float load_g)
+{
+    taskENTER_CRITICAL(&sim->lock);
+    sim->signal.load_g = load_g;
+    taskEXIT_CRITICAL(&sim->lock);
+}
+
+void nau7802_sim_set_connected(nau7802_sim_t *sim, bool connected)
+{
+    taskENTER_CRITICAL(&sim->lock);
+    sim->connected = connected;
+    taskEXIT_CRITICAL(&sim->lock);
+}
+
+void nau7802_sim_get_stats(nau7802_sim_t *sim, nau7802_sim_stats_t *stats)
+{
+    taskENTER_CRITICAL(&sim->lock);
+    *stats = sim->stats;
+    taskEXIT_CRITICAL(&sim->lock);
+}
@@ -0,0 +1,176 @@
+/*
+ * Weight stability, motion detection and auto-zero tracking for NAU7802 scales
+ *
+ * Copyright (c) 2025 Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "nau7802_stability.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG = "nau7802_stab";
+
+void nau7802_stability_init(nau7802_stability_t *st, const nau7802_stability_config_t *config)
+{
+    if (st == NULL || config == NULL) {
+        return;
+    }
+
+    memset(st, 0, sizeof(*st));
+    st->config = *config;
+    if (st->config.window < 2) {
+        st->config.window = 2;
+    } else if (st->config.window > NAU7802_STABILITY_MAX_WINDOW) {
+        st->config.window = NAU7802_STABILITY_MAX_WINDOW;
+    }
+    if (st->config.azt_rate < 0.0f) {
+        st->config.azt_rate = 0.0f;
+    } else if (st->config.azt_rate > 1.0f) {
+        st->config.azt_rate = 1.0f;
+    }
+    st->last_zero_offset = NAN;
+}
+
+void nau7802_stability_reset(nau7802_stability_t *st)
+{
+    if (st == NULL) {
+        return;
+    }
+
+    st->head = 0;
+    st->count = 0;
+    st->sum = 0;
+    st->sum_sq = 0;
+    st->sum_xy = 0;
+    st->azt_total = 0.0f;
+    st->last_zero_offset = NAN;
+    st->stable = false;
+    st->in_motion = false;
+    st->center_of_zero = false;
+}
+
+float nau7802_stability_get_stddev(const nau7802_stability_t *st)
+{
+    if (st == NULL || st->count < 2) {
+        return 0.0f;
+    }
+
+    // n^2 * variance = n * sum(x^2) - (sum x)^2, exact in 64-bit for 24-bit samples
+    int64_t n = st->count;
+    int64_t scaled_var = n * st->sum_sq - st->sum * st->sum;
+    if (scaled_var <= 0) {
+        return 0.0f;
+    }
+    return sqrtf((float)scaled_var) / (float)n;
+}
+
+float nau7802_stability_get_drift(const nau7802_stability_t *st)
+{
+    if (st == NULL || st->count < 2) {
+        return 0.0f;
+    }
+
+    // Least-squares slope with positions 0..n-1:
+    //   slope = (n * Sxy - Sx * Sy) / (n * Sxx - Sx^2), n * Sxx - Sx^2 = n^2 (n^2 - 1) / 12
+    int64_t n = st->count;
+    int64_t sx = n * (n - 1) / 2;
+    int64_t num = n * st->sum_xy - sx * st->sum;
+    int64_t den = n * n * (n * n - 1) / 12;
+    return ((float)num / (float)den) * (float)(n - 1);
+}
+
+static void nau7802_stability_push(nau7802_stability_t *st, int32_t raw)
+{
+    int64_t y = raw;
+
+    if (st->count < st->config.window) {
+        // Window still filling: new sample takes position count
+        st->samples[(st->head + st->count) % st->config.window] = raw;
+        st->sum_xy += (int64_t)st->count * y;
+        st->sum += y;
+        st->sum_sq += y * y;
+        st->count++;
+        return;
+    }
+
+    // Window full: drop the oldest sample, shift all positions down by one and
+    // append the new sample at position n-1
+    int64_t n = st->count;
+    int64_t oldest = st->samples[st->head];
+    st->sum_xy = st->sum_xy - (st->sum - oldest) + (n - 1) * y;
+    st->sum = st->sum - oldest + y;
+    st->sum_sq = st->sum_sq - oldest * oldest + y * y;
+    st->samples[st->head] = raw;
+    st->head = (st->head + 1) % st->config.window;
+}
+
+void nau7802_stability_update(nau7802_stability_t *st, nau7802_t *dev, int32_t raw)
+{
+    if (st == NULL || dev == NULL) {
+        return;
+    }
+
+    nau7802_stability_push(st, raw);
+
+    float counts_per_gram = fabsf(dev->calibration_factor);
+    if (counts_per_gram == 0.0f) {
+        counts_per_gram = 1.0f;
+    }
+
+    float stddev = nau7802_stability_get_stddev(st);
+    float drift = fabsf(nau7802_stability_get_drift(st));
+    float stable_band = st->config.stable_band_g * counts_per_gram;
+    float motion_band = st->config.motion_band_g * counts_per_gram;
+
+    st->in_motion = (stddev > motion_band) || (drift > motion_band);
+    st->stable = (st->count >= st->config.window) && !st->in_motion &&
+                 (stddev <= stable_band) && (drift <= stable_band);
+
+    // A zero offset that changed outside this filter means the user tared or
+    // recalibrated: restart the AZT accumulator from the new zero
+    if (isnan(st->last_zero_offset) || dev->zero_offset != st->last_zero_offset) {
+        st->azt_total = 0.0f;
+        st->last_zero_offset = dev->zero_offset;
+    }
+
+    float mean = (float)st->sum / (float)st->count;
+    float zero_error = mean - dev->zero_offset;
+    float azt_band = st->config.azt_band_g * counts_per_gram;
+    st->center_of_zero = st->stable && (fabsf(zero_error) <= azt_band);
+
+    if (st->config.azt_enabled && st->center_of_zero) {
+        float step = zero_error * st->config.azt_rate;
+        float limit = st->config.azt_limit_g * counts_per_gram;
+        float new_total = st->azt_total + step;
+        if (new_total > limit) {
+            step = limit - st->azt_total;
+        } else if (new_total < -limit) {
+            step = -limit - st->azt_total;
+        }
+        if (step != 0.0f) {
+            dev->zero_offset += step;
+            st->azt_total += step;
+            st->last_zero_offset = dev->zero_offset;
+            ESP_LOGD(TAG, "AZT: step %.2f counts, total %.2f counts", step, st->azt_total);
+        }
+    }
+}
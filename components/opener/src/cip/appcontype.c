@@ -223,6 +223,25 @@ CipConnectionObject *GetExclusiveOwnerConnection(
   return NULL;
 }
 
+/** @brief Check if a new Input Only connection would produce its input
+ * assembly a second time
+ *
+ * A multicast connection joins an existing multicast production and sends
+ * nothing itself; any other connection adds a producer if the input assembly
+ * is already produced.
+ */
+static bool InputOnlyConnectionStartsNewProducer(
+  const CipConnectionObject *const RESTRICT connection_object) {
+  const EipUint32 input_point = connection_object->produced_path.instance_id;
+
+  if (kConnectionObjectConnectionTypeMulticast ==
+      ConnectionObjectGetTToOConnectionType(connection_object)
+      && NULL != GetExistingProducerIoConnection(true, input_point) ) {
+    return false;
+  }
+  return NULL != GetExistingProducerIoConnection(false, input_point);
+}
+
 CipConnectionObject *GetInputOnlyConnection(
   const CipConnectionObject *const RESTRICT connection_object,
   EipUint16 *const extended_error) {
@@ -258,6 +277,13 @@ CipConnectionObject *GetInputOnlyConnection(
         }
       }
 
+      if (!InputAssemblyAllowsMultipleProducers(
+            connection_object->produced_path.instance_id)
+          && InputOnlyConnectionStartsNewProducer(connection_object) ) {
+        err = kConnectionManagerExtendedStatusCodeTargetObjectOutOfConnections;
+        break;
+      }
+
       for (size_t j = 0; j < OPENER_CIP_NUM_INPUT_ONLY_CONNS_PER_CON_PATH;
            ++j) {
         if (kConnectionObjectStateNonExistent
@@ -445,6 +471,47 @@ bool ConnectionWithSameConfigPointExists(const EipUint32 config_point) {
   return false;
 }
 
+static void AddIoConnectionCounters(const CipConnectionObject *const connection,
+                                    IoConnectionCounters *const counters,
+                                    const size_t max_count,
+                                    size_t *const count) {
+  if(*count >= max_count ||
+     kConnectionObjectStateEstablished != ConnectionObjectGetState(connection) ) {
+    return;
+  }
+  IoConnectionCounters *const entry = &counters[(*count)++];
+  entry->instance_type = ConnectionObjectGetInstanceType(connection);
+  entry->connection_serial_number = connection->connection_serial_number;
+  entry->originator_address = connection->originator_address.sin_addr.s_addr;
+  entry->produced_point = (CipUint)connection->produced_path.instance_id;
+  entry->consumed = connection->io_packets_consumed;
+  entry->late = connection->io_packets_late;
+  entry->lost = connection->io_packets_lost;
+  entry->produced = connection->io_packets_produced;
+}
+
+size_t GetIoConnectionCounters(IoConnectionCounters *const counters,
+                               const size_t max_count) {
+  size_t count = 0;
+  for(size_t i = 0; i < OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS; ++i) {
+    AddIoConnectionCounters(&g_exlusive_owner_connections[i].connection_data,
+                            counters, max_count, &count);
+  }
+  for(size_t i = 0; i < OPENER_CIP_NUM_INPUT_ONLY_CONNS; ++i) {
+    for(size_t j = 0; j < OPENER_CIP_NUM_INPUT_ONLY_CONNS_PER_CON_PATH; ++j) {
+      AddIoConnectionCounters(&g_input_only_connections[i].connection_data[j],
+                              counters, max_count, &count);
+    }
+  }
+  for(size_t i = 0; i < OPENER_CIP_NUM_LISTEN_ONLY_CONNS; ++i) {
+    for(size_t j = 0; j < OPENER_CIP_NUM_LISTEN_ONLY_CONNS_PER_CON_PATH; ++j) {
+      AddIoConnectionCounters(&g_listen_only_connections[i].connection_data[j],
+                              counters, max_count, &count);
+    }
+  }
+  return count;
+}
+
 void InitializeIoConnectionData(void) {
   memset( g_exlusive_owner_connections, 0,
           OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS *
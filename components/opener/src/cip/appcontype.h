@@ -73,4 +73,29 @@ void CloseAllConnections(void);
  */
 bool ConnectionWithSameConfigPointExists(const EipUint32 config_point);
 
+/** @brief I/O packet counters of one established I/O connection */
+typedef struct {
+  ConnectionObjectInstanceType instance_type; /**< Exclusive owner, input only or listen only */
+  CipUint connection_serial_number; /**< Serial number from the forward open */
+  CipUdint originator_address; /**< IPv4 address of the originator, network byte order */
+  CipUint produced_point; /**< Input assembly produced by the connection */
+  CipUdint consumed; /**< Packets with new data */
+  CipUdint late; /**< Packets dropped for an old sequence count */
+  CipUdint lost; /**< Sequence counts skipped between consumed packets */
+  CipUdint produced; /**< Packets sent */
+} IoConnectionCounters;
+
+/** @brief Get the packet counters of the established I/O connections
+ *
+ * Reads the static I/O connection slots directly, so it may be called from
+ * other tasks than the OpENer task: a counter may be one packet behind, and a
+ * connection that is being opened or closed at that moment may be left out.
+ *
+ * @param counters Output, one entry per established I/O connection
+ * @param max_count Entries available in counters
+ * @return Number of entries written
+ */
+size_t GetIoConnectionCounters(IoConnectionCounters *const counters,
+                               const size_t max_count);
+
 #endif /* OPENER_APPCONTYPE_H_ */
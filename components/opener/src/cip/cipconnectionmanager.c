@@ -61,21 +61,6 @@ CipConnectionObject g_dummy_connection_object;
 /** @brief Holds the connection ID's "incarnation ID" in the upper 16 bits */
 EipUint32 g_incarnation_id;
 
-/** @brief Connection Manager instance statistics */
-typedef struct {
-  CipUint open_requests;              /* Attribute 1 */
-  CipUint open_format_rejects;        /* Attribute 2 */
-  CipUint open_resource_rejects;      /* Attribute 3 */
-  CipUint open_other_rejects;         /* Attribute 4 */
-  CipUint close_requests;             /* Attribute 5 */
-  CipUint close_format_requests;       /* Attribute 6 */
-  CipUint close_other_requests;       /* Attribute 7 */
-  CipUint connection_timeouts;        /* Attribute 8 */
-  CipUint cpu_utilization;            /* Attribute 11 (0-100, percentage) */
-  CipUint max_buff_size;              /* Attribute 12 */
-  CipUint buff_size_remaining;       /* Attribute 13 */
-} ConnectionManagerStatistics;
-
 static ConnectionManagerStatistics g_connection_manager_stats = {0};
 
 /* Dummy data pointer for attribute 9 (Connection Entry List) - dynamically encoded, not used */
@@ -430,6 +415,10 @@ EipStatus ConnectionManagerInit(EipUint16 unique_connection_id) {
   return kEipStatusOk;
 }
 
+const ConnectionManagerStatistics *ConnectionManagerGetStatistics(void) {
+  return &g_connection_manager_stats;
+}
+
 EipStatus HandleReceivedConnectedData(const EipUint8 *const data,
                                       int data_length,
                                       struct sockaddr_in *from_address) {
@@ -465,6 +454,14 @@ EipStatus HandleReceivedConnectedData(const EipUint8 *const data,
             /* reset the watchdog timer */
             ConnectionObjectResetInactivityWatchdogTimerValue(connection_object);
 
+            if(connection_object->eip_first_level_sequence_count_received) {
+              connection_object->io_packets_lost +=
+                g_common_packet_format_data_item.address_item.data.
+                sequence_number -
+                connection_object->eip_level_sequence_count_consuming - 1;
+            }
+            connection_object->io_packets_consumed++;
+
             /* only inform assembly object if the sequence counter is greater or equal */
             connection_object->eip_level_sequence_count_consuming =
               g_common_packet_format_data_item.address_item.data.sequence_number;
@@ -476,6 +473,8 @@ EipStatus HandleReceivedConnectedData(const EipUint8 *const data,
                 g_common_packet_format_data_item.data_item.data,
                 g_common_packet_format_data_item.data_item.length);
             }
+          } else {
+            connection_object->io_packets_late++;
           }
         } else {
           OPENER_TRACE_WARN(
@@ -162,6 +162,21 @@ typedef enum {
 /** @brief Connection Manager class code */
 static const CipUint kCipConnectionManagerClassCode = 0x06U;
 
+/** @brief Connection Manager instance statistics */
+typedef struct {
+  CipUint open_requests;              /* Attribute 1 */
+  CipUint open_format_rejects;        /* Attribute 2 */
+  CipUint open_resource_rejects;      /* Attribute 3 */
+  CipUint open_other_rejects;         /* Attribute 4 */
+  CipUint close_requests;             /* Attribute 5 */
+  CipUint close_format_requests;       /* Attribute 6 */
+  CipUint close_other_requests;       /* Attribute 7 */
+  CipUint connection_timeouts;        /* Attribute 8 */
+  CipUint cpu_utilization;            /* Attribute 11 (0-100, percentage) */
+  CipUint max_buff_size;              /* Attribute 12 */
+  CipUint buff_size_remaining;       /* Attribute 13 */
+} ConnectionManagerStatistics;
+
 /* public functions */
 
 /** @brief Initialize the data of the connection manager object
@@ -171,6 +186,15 @@ static const CipUint kCipConnectionManagerClassCode = 0x06U;
  */
 EipStatus ConnectionManagerInit(EipUint16 unique_connection_id);
 
+/** @brief Get the Connection Manager instance statistics
+ *
+ *  The counters are written by the OpENer task only; other tasks may read
+ *  them at any time.
+ *
+ *  @return Statistics of instance 1
+ */
+const ConnectionManagerStatistics *ConnectionManagerGetStatistics(void);
+
 /** @brief Get a connected object dependent on requested ConnectionID.
  *
  *   @param connection_id Connection ID of the Connection Object to get
@@ -908,6 +908,10 @@ void ConnectionObjectResetSequenceCounts(
   connection_object->eip_level_sequence_count_consuming = 0;
   connection_object->eip_first_level_sequence_count_received = false;
   connection_object->sequence_count_consuming = 0;
+  connection_object->io_packets_consumed = 0;
+  connection_object->io_packets_late = 0;
+  connection_object->io_packets_lost = 0;
+  connection_object->io_packets_produced = 0;
 }
 
 void ConnectionObjectResetProductionInhibitTimer(
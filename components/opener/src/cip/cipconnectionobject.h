@@ -170,6 +170,13 @@ struct cip_connection_object {
   CipBool eip_first_level_sequence_count_received; /**< False if eip_level_sequence_count_consuming
                                                    hasn't been initialized with a sequence
                                                    count yet, true otherwise */
+  CipUdint io_packets_consumed; /**< I/O packets with new data since the connection
+                                   was opened */
+  CipUdint io_packets_late; /**< I/O packets dropped because a newer sequence count
+                               had already been received */
+  CipUdint io_packets_lost; /**< Sequence counts skipped between consumed I/O
+                               packets */
+  CipUdint io_packets_produced; /**< I/O packets sent */
   CipInt correct_originator_to_target_size;
   CipInt correct_target_to_originator_size;
 
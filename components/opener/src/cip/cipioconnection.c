@@ -21,6 +21,7 @@
 #include "trace.h"
 #include "endianconv.h"
 #include "opener_error.h"
+#include "latency_probe.h"
 
 /* producing multicast connection have to consider the rules that apply for
  * application connection types.
@@ -851,6 +852,7 @@ void HandleIoConnectionTimeOut(CipConnectionObject *connection_object) {
 }
 
 EipStatus SendConnectedData(CipConnectionObject *connection_object) {
+  LATENCY_PROBE_BEGIN(send_mark);
 
   /* TODO think of adding an own send buffer to each connection object in order to preset up the whole message on connection opening and just change the variable data items e.g., sequence number */
 
@@ -925,8 +927,13 @@ EipStatus SendConnectedData(CipConnectionObject *connection_object) {
     producing_instance_attributes->length;
   outgoing_message.used_message_length += producing_instance_attributes->length;
 
-  return SendUdpData(&connection_object->remote_address,
-                     &outgoing_message);
+  EipStatus eip_status = SendUdpData(&connection_object->remote_address,
+                                     &outgoing_message);
+  if(kEipStatusOk == eip_status) {
+    connection_object->io_packets_produced++;
+  }
+  LATENCY_PROBE_END(LATENCY_PROBE_SEND_CONNECTED_DATA, send_mark);
+  return eip_status;
 }
 
 EipStatus HandleReceivedIoConnectionData(CipConnectionObject *connection_object,
@@ -9,6 +9,7 @@
 #include "ciperror.h"
 #include "trace.h"
 #include "enipmessage.h"
+#include "latency_probe.h"
 
 #include "cipmessagerouter.h"
 
@@ -333,6 +334,7 @@ EipStatus NotifyMessageRouter(EipUint8 *data,
                               CipMessageRouterResponse *message_router_response,
                               const struct sockaddr *const originator_address,
                               const CipSessionHandle encapsulation_session) {
+  LATENCY_PROBE_BEGIN(notify_mark);
   EipStatus eip_status = kEipStatusOkSend;
   CipError status = kCipErrorSuccess;
 
@@ -390,6 +392,7 @@ EipStatus NotifyMessageRouter(EipUint8 *data,
 #endif
     }
   }
+  LATENCY_PROBE_END(LATENCY_PROBE_NOTIFY_MESSAGE_ROUTER, notify_mark);
   return eip_status;
 }
 
@@ -878,6 +878,20 @@ void CheckIoConnectionEvent(unsigned int output_assembly_id,
                             unsigned int input_assembly_id,
                             IoConnectionEvent io_connection_event);
 
+/** @ingroup CIP_CALLBACK_API
+ * @brief Ask the application whether an input assembly may be produced by
+ * more than one connection
+ *
+ * Consulted when an Input Only connection would start a new production of an
+ * input assembly that is already produced by another connection. Connections
+ * that join an existing multicast production are always accepted.
+ *
+ * @param input_assembly_id the input assembly connection point
+ * @return true if an additional producing connection may be opened, false to
+ *     refuse it with "target object out of connections"
+ */
+EipBool8 InputAssemblyAllowsMultipleProducers(unsigned int input_assembly_id);
+
 /** @ingroup CIP_CALLBACK_API
  * @brief Call back function to inform application on received data for an
  * assembly object.
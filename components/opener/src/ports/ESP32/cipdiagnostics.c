@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+#include "cipdiagnostics.h"
+#include "opener_api.h"
+#include "cipcommon.h"
+#include "trace.h"
+#include "tracecontrol.h"
+
+/* Copy of the trace mask that the attribute encodes from and decodes into */
+static CipUdint s_trace_mask_attr;
+
+static EipStatus DiagnosticsPreAccessCallback(CipInstance *instance,
+                                              CipAttributeStruct *attribute,
+                                              CipByte service) {
+  (void)instance;
+  (void)attribute;
+  (void)service;
+  s_trace_mask_attr = TraceControlGetMask();
+  return kEipStatusOk;
+}
+
+static EipStatus DiagnosticsPostSetCallback(CipInstance *instance,
+                                            CipAttributeStruct *attribute,
+                                            CipByte service) {
+  (void)instance;
+  (void)service;
+  if (attribute->attribute_number == 1) {
+    TraceControlSetMask(s_trace_mask_attr);
+    OPENER_TRACE_INFO("Diagnostics: trace mask set to 0x%08" PRIx32 "\n",
+                      s_trace_mask_attr);
+  }
+  return kEipStatusOk;
+}
+
+EipStatus DiagnosticsObjectInit(void) {
+  CipClass *diagnostics_class = CreateCipClass(kDiagnosticsClassCode,
+                                               0, /* # of non-default class attributes */
+                                               7, /* # highest class attribute number */
+                                               2, /* # of class services */
+                                               1, /* # of instance attributes */
+                                               1, /* # highest instance attribute number */
+                                               3, /* # of instance services */
+                                               1, /* # of instances */
+                                               "diagnostics", /* # class name (for debug) */
+                                               1, /* # class revision */
+                                               NULL); /* # function pointer for initialization */
+  if (NULL == diagnostics_class) {
+    OPENER_TRACE_ERR("Diagnostics: CreateCipClass failed\n");
+    return kEipStatusError;
+  }
+
+  CipInstance *instance = GetCipInstance(diagnostics_class, 1);
+  InsertAttribute(instance, 1, kCipUdint, EncodeCipUdint,
+                  (CipAttributeDecodeFromMessage)DecodeCipUdint,
+                  &s_trace_mask_attr,
+                  kSetAndGetAble | kPreGetFunc | kPreSetFunc | kPostSetFunc);
+  InsertGetSetCallback(diagnostics_class, DiagnosticsPreAccessCallback,
+                       kPreGetFunc | kPreSetFunc);
+  InsertGetSetCallback(diagnostics_class, DiagnosticsPostSetCallback,
+                       kPostSetFunc);
+
+  InsertService(diagnostics_class, kGetAttributeSingle, &GetAttributeSingle,
+                "GetAttributeSingle");
+  InsertService(diagnostics_class, kGetAttributeAll, &GetAttributeAll,
+                "GetAttributeAll");
+  InsertService(diagnostics_class, kSetAttributeSingle, &SetAttributeSingle,
+                "SetAttributeSingle");
+
+  return kEipStatusOk;
+}
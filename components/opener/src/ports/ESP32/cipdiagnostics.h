@@ -0,0 +1,32 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file cipdiagnostics.h
+ *  @brief Vendor-specific Diagnostics object
+ *
+ *  Lets an engineering tool change what the device traces without a reflash
+ *  or a connection to the web UI.
+ *
+ *  Instance 1 attributes (Get Attribute Single / All, Set Attribute Single):
+ *    1  Trace Mask       UDINT  four level bits per trace module
+ *                               (see tracecontrol.h), not saved across reboots
+ */
+
+#ifndef CIPDIAGNOSTICS_H
+#define CIPDIAGNOSTICS_H
+
+#include "ciptypes.h"
+
+/** @brief Diagnostics object class code (vendor-specific range) */
+static const CipUint kDiagnosticsClassCode = 0x71U;
+
+/** @brief Create the Diagnostics class with its single instance
+ *
+ *  @return kEipStatusOk on success, kEipStatusError otherwise
+ */
+EipStatus DiagnosticsObjectInit(void);
+
+#endif /* CIPDIAGNOSTICS_H */
@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "ciplatencyprobe.h"
+#include "opener_api.h"
+#include "cipcommon.h"
+#include "ciperror.h"
+#include "trace.h"
+#include "latency_probe.h"
+
+/* Instance N serves probe N - 1 */
+static CipShortString s_name_attr[LATENCY_PROBE_COUNT];
+static latency_probe_stats_t s_stats_attr[LATENCY_PROBE_COUNT];
+
+static EipStatus LatencyProbePreGetCallback(CipInstance *instance,
+                                            CipAttributeStruct *attribute,
+                                            CipByte service) {
+  (void)attribute;
+  (void)service;
+  latency_probe_id_t id = (latency_probe_id_t)(instance->instance_number - 1);
+  if (!latency_probe_get_stats(id, &s_stats_attr[id], NULL) ) {
+    memset(&s_stats_attr[id], 0, sizeof(s_stats_attr[id]) );
+  }
+  return kEipStatusOk;
+}
+
+static EipStatus LatencyProbeResetService(
+  CipInstance *RESTRICT const instance,
+  CipMessageRouterRequest *const message_router_request,
+  CipMessageRouterResponse *const message_router_response,
+  const struct sockaddr *originator_address,
+  const CipSessionHandle encapsulation_session) {
+  (void)originator_address;
+  (void)encapsulation_session;
+
+  InitializeENIPMessage(&message_router_response->message);
+  message_router_response->reply_service =
+    (0x80 | message_router_request->service);
+  message_router_response->reserved = 0;
+  message_router_response->size_of_additional_status = 0;
+
+  if (message_router_request->request_data_size > 0) {
+    message_router_response->general_status = kCipErrorTooMuchData;
+    return kEipStatusOkSend;
+  }
+
+  latency_probe_reset( (latency_probe_id_t)(instance->instance_number - 1) );
+  message_router_response->general_status = kCipErrorSuccess;
+  return kEipStatusOkSend;
+}
+
+EipStatus LatencyProbeObjectInit(void) {
+  CipClass *probe_class = CreateCipClass(kLatencyProbeClassCode,
+                                         0, /* # of non-default class attributes */
+                                         7, /* # highest class attribute number */
+                                         2, /* # of class services */
+                                         8, /* # of instance attributes */
+                                         8, /* # highest instance attribute number */
+                                         3, /* # of instance services */
+                                         LATENCY_PROBE_COUNT, /* # of instances */
+                                         "latency probe", /* # class name (for debug) */
+                                         1, /* # class revision */
+                                         NULL); /* # function pointer for initialization */
+  if (NULL == probe_class) {
+    OPENER_TRACE_ERR("Latency Probe: CreateCipClass failed\n");
+    return kEipStatusError;
+  }
+
+  for (CipInstanceNum i = 1; i <= LATENCY_PROBE_COUNT; ++i) {
+    CipInstance *instance = GetCipInstance(probe_class, i);
+    const char *name = latency_probe_name( (latency_probe_id_t)(i - 1) );
+    latency_probe_stats_t *stats = &s_stats_attr[i - 1];
+
+    s_name_attr[i - 1].length = (EipUint8)strlen(name);
+    s_name_attr[i - 1].string = (EipByte *)name;
+    InsertAttribute(instance, 1, kCipShortString, EncodeCipShortString,
+                    NULL, &s_name_attr[i - 1], kGetableSingleAndAll);
+    InsertAttribute(instance, 2, kCipUdint, EncodeCipUdint,
+                    NULL, &stats->count, kGetableSingleAndAll | kPreGetFunc);
+    InsertAttribute(instance, 3, kCipUdint, EncodeCipUdint,
+                    NULL, &stats->min_ns, kGetableSingleAndAll | kPreGetFunc);
+    InsertAttribute(instance, 4, kCipUdint, EncodeCipUdint,
+                    NULL, &stats->max_ns, kGetableSingleAndAll | kPreGetFunc);
+    InsertAttribute(instance, 5, kCipUdint, EncodeCipUdint,
+                    NULL, &stats->mean_ns, kGetableSingleAndAll | kPreGetFunc);
+    InsertAttribute(instance, 6, kCipUdint, EncodeCipUdint,
+                    NULL, &stats->p50_ns, kGetableSingleAndAll | kPreGetFunc);
+    InsertAttribute(instance, 7, kCipUdint, EncodeCipUdint,
+                    NULL, &stats->p99_ns, kGetableSingleAndAll | kPreGetFunc);
+    InsertAttribute(instance, 8, kCipUdint, EncodeCipUdint,
+                    NULL, &stats->migrated, kGetableSingleAndAll | kPreGetFunc);
+  }
+  InsertGetSetCallback(probe_class, LatencyProbePreGetCallback, kPreGetFunc);
+
+  InsertService(probe_class, kGetAttributeSingle, &GetAttributeSingle,
+                "GetAttributeSingle");
+  InsertService(probe_class, kGetAttributeAll, &GetAttributeAll,
+                "GetAttributeAll");
+  InsertService(probe_class, kLatencyProbeResetServiceCode,
+                &LatencyProbeResetService, "Reset");
+
+  return kEipStatusOk;
+}
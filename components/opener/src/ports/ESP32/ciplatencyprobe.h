@@ -0,0 +1,45 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file ciplatencyprobe.h
+ *  @brief Vendor-specific Latency Probe object
+ *
+ *  Reports the hot-path latency histograms of latency_probe.h over explicit
+ *  messaging. Instance N serves probe N - 1 (LATENCY_PROBE_NETWORK_CYCLIC is
+ *  instance 1). The attributes read 0 unless the firmware was built with
+ *  CONFIG_OPENER_LATENCY_PROBES.
+ *
+ *  Instance attributes (Get Attribute Single / All):
+ *    1  Name             SHORT_STRING  probe name, as in /api/latency
+ *    2  Count            UDINT  samples since boot or the last reset
+ *    3  Min              UDINT  shortest sample (ns)
+ *    4  Max              UDINT  longest sample (ns)
+ *    5  Mean             UDINT  average (ns)
+ *    6  P50              UDINT  median (ns, upper bound of its bucket)
+ *    7  P99              UDINT  99th percentile (ns, upper bound of its bucket)
+ *    8  Migrated         UDINT  samples dropped because the task changed core
+ *
+ *  Service 0x4B Reset (per instance, no request data) discards the samples.
+ */
+
+#ifndef CIPLATENCYPROBE_H
+#define CIPLATENCYPROBE_H
+
+#include "ciptypes.h"
+
+/** @brief Latency Probe object class code (vendor-specific range) */
+static const CipUint kLatencyProbeClassCode = 0x72U;
+
+/** @brief Reset service code (object-specific range) */
+static const CipUint kLatencyProbeResetServiceCode = 0x4BU;
+
+/** @brief Create the Latency Probe class with one instance per probe
+ *
+ *  @return kEipStatusOk on success, kEipStatusError otherwise
+ */
+EipStatus LatencyProbeObjectInit(void);
+
+#endif /* CIPLATENCYPROBE_H */
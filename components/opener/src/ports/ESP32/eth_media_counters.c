@@ -15,6 +15,8 @@
 #include "eth_media_counters.h"
 #include "trace.h"
 #include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include <string.h>
 #include <inttypes.h>
 #include <stdint.h>
@@ -80,6 +82,11 @@ static esp_eth_mac_t *s_mac = NULL;
 static uint8_t s_phy_addr = 0;
 static bool s_ip101_detected = false;
 
+// Page selection and counter read must not interleave: the counters are read
+// by the OpENer task (Ethernet Link attribute 5) and by the /metrics handler
+static StaticSemaphore_t s_phy_lock_buffer;
+static SemaphoreHandle_t s_phy_lock = NULL;
+
 // Forward declarations
 static bool ip101_select_page(uint8_t page);
 static uint32_t read_ip101_counter_reg(uint8_t page, uint8_t reg_addr);
@@ -113,6 +120,9 @@ bool EthMediaCountersInit(esp_eth_mac_t *mac, uint8_t phy_addr) {
         return false;
     }
 
+    if (s_phy_lock == NULL) {
+        s_phy_lock = xSemaphoreCreateMutexStatic(&s_phy_lock_buffer);
+    }
     s_mac = mac;
     s_phy_addr = phy_addr;
     s_ip101_detected = false;
@@ -215,14 +225,18 @@ static uint32_t read_ip101_counter_reg(uint8_t page, uint8_t reg_addr) {
         return 0;
     }
 
+    xSemaphoreTake(s_phy_lock, portMAX_DELAY);
+
     // Select the correct page
     if (!ip101_select_page(page)) {
+        xSemaphoreGive(s_phy_lock);
         OPENER_TRACE_ERR("Failed to select IP101 page %d\n", page);
         return 0;
     }
     
     uint32_t reg_value = 0;
     esp_err_t ret = s_mac->read_phy_reg(s_mac, s_phy_addr, reg_addr, &reg_value);
+    xSemaphoreGive(s_phy_lock);
     if (ret != ESP_OK) {
         OPENER_TRACE_ERR("Failed to read IP101 page %d register 0x%02X: %d\n", page, reg_addr, ret);
         return 0;
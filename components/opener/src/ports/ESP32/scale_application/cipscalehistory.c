@@ -0,0 +1,135 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "cipscalehistory.h"
+#include "opener_api.h"
+#include "cipcommon.h"
+#include "ciperror.h"
+#include "endianconv.h"
+#include "trace.h"
+#include "nau7802_history.h"
+#include "scalechannels.h"
+
+#define SCALE_HISTORY_RECORD_SIZE 16U
+
+/* Instance N serves scale channel N - 1 */
+static CipUdint s_capacity_attr[SCALE_CHANNEL_COUNT];
+static CipUdint s_next_index_attr[SCALE_CHANNEL_COUNT];
+static CipUint s_record_size_attr = SCALE_HISTORY_RECORD_SIZE;
+
+static EipStatus ScaleHistoryPreGetCallback(CipInstance *instance,
+                                            CipAttributeStruct *attribute,
+                                            CipByte service) {
+  (void)attribute;
+  (void)service;
+  EipUint8 channel = (EipUint8)(instance->instance_number - 1);
+  s_capacity_attr[channel] = nau7802_history_capacity();
+  s_next_index_attr[channel] = nau7802_history_head(channel);
+  return kEipStatusOk;
+}
+
+static EipStatus ScaleHistoryReadService(
+  CipInstance *RESTRICT const instance,
+  CipMessageRouterRequest *const message_router_request,
+  CipMessageRouterResponse *const message_router_response,
+  const struct sockaddr *originator_address,
+  const CipSessionHandle encapsulation_session) {
+  (void)originator_address;
+  (void)encapsulation_session;
+
+  InitializeENIPMessage(&message_router_response->message);
+  message_router_response->reply_service =
+    (0x80 | message_router_request->service);
+  message_router_response->reserved = 0;
+  message_router_response->size_of_additional_status = 0;
+
+  if (message_router_request->request_data_size < 4) {
+    message_router_response->general_status = kCipErrorNotEnoughData;
+    return kEipStatusOkSend;
+  }
+  if (message_router_request->request_data_size > 6) {
+    message_router_response->general_status = kCipErrorTooMuchData;
+    return kEipStatusOkSend;
+  }
+
+  const CipOctet *data = message_router_request->data;
+  EipUint32 cursor = GetUdintFromMessage(&data);
+  size_t max_records = SCALE_HISTORY_MAX_RECORDS_PER_READ;
+  if (message_router_request->request_data_size == 6) {
+    CipUint requested = GetUintFromMessage(&data);
+    if (requested == 0) {
+      message_router_response->general_status = kCipErrorInvalidParameter;
+      return kEipStatusOkSend;
+    }
+    if (requested < max_records) {
+      max_records = requested;
+    }
+  }
+
+  nau7802_history_sample_t records[SCALE_HISTORY_MAX_RECORDS_PER_READ];
+  EipUint32 lost = 0;
+  size_t count = nau7802_history_read(
+    (EipUint8)(instance->instance_number - 1), &cursor, records, max_records,
+    &lost);
+
+  message_router_response->general_status = kCipErrorSuccess;
+  ENIPMessage *message = &message_router_response->message;
+  AddDintToMessage(cursor, message);
+  AddDintToMessage(lost, message);
+  AddIntToMessage((EipUint16)count, message);
+  for (size_t i = 0; i < count; ++i) {
+    EipUint32 weight_bits;
+    memcpy(&weight_bits, &records[i].weight_g, sizeof(weight_bits));
+    AddDintToMessage(records[i].index, message);
+    AddDintToMessage(records[i].timestamp_us, message);
+    AddDintToMessage((EipUint32)records[i].raw, message);
+    AddDintToMessage(weight_bits, message);
+  }
+
+  return kEipStatusOkSend;
+}
+
+EipStatus ScaleHistoryObjectInit(void) {
+  CipClass *history_class = CreateCipClass(kScaleHistoryClassCode,
+                                           0, /* # of non-default class attributes */
+                                           7, /* # highest class attribute number */
+                                           2, /* # of class services */
+                                           3, /* # of instance attributes */
+                                           3, /* # highest instance attribute number */
+                                           3, /* # of instance services */
+                                           SCALE_CHANNEL_COUNT, /* # of instances */
+                                           "scale history", /* # class name (for debug) */
+                                           1, /* # class revision */
+                                           NULL); /* # function pointer for initialization */
+  if (NULL == history_class) {
+    OPENER_TRACE_ERR("Scale History: CreateCipClass failed\n");
+    return kEipStatusError;
+  }
+
+  for (CipInstanceNum i = 1; i <= SCALE_CHANNEL_COUNT; ++i) {
+    CipInstance *instance = GetCipInstance(history_class, i);
+    InsertAttribute(instance, 1, kCipUdint, EncodeCipUdint,
+                    NULL, &s_capacity_attr[i - 1],
+                    kGetableSingleAndAll | kPreGetFunc);
+    InsertAttribute(instance, 2, kCipUdint, EncodeCipUdint,
+                    NULL, &s_next_index_attr[i - 1],
+                    kGetableSingleAndAll | kPreGetFunc);
+    InsertAttribute(instance, 3, kCipUint, EncodeCipUint,
+                    NULL, &s_record_size_attr, kGetableSingleAndAll);
+  }
+  InsertGetSetCallback(history_class, ScaleHistoryPreGetCallback, kPreGetFunc);
+
+  InsertService(history_class, kGetAttributeSingle, &GetAttributeSingle,
+                "GetAttributeSingle");
+  InsertService(history_class, kGetAttributeAll, &GetAttributeAll,
+                "GetAttributeAll");
+  InsertService(history_class, kScaleHistoryReadServiceCode,
+                &ScaleHistoryReadService, "ReadHistory");
+
+  return kEipStatusOk;
+}
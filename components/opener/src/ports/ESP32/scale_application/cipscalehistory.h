@@ -0,0 +1,49 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file cipscalehistory.h
+ *  @brief Vendor-specific Scale History object
+ *
+ *  Exposes the NAU7802 sample history ring over explicit messaging so a
+ *  historian can backfill recent samples without polling at the sample rate.
+ *
+ *  Instance N serves scale channel N - 1 (see scalechannels.h); a
+ *  single-scale device has instance 1 only.
+ *
+ *  Instance attributes (Get Attribute Single / All):
+ *    1  Capacity         UDINT  samples held by the ring
+ *    2  Next Index       UDINT  index the next captured sample will get
+ *    3  Record Size      UINT   bytes per record in a Read History response
+ *
+ *  Service 0x4B Read History (per instance):
+ *    Request:  UDINT cursor, optional UINT max samples
+ *    Response: UDINT next cursor, UDINT lost, UINT count, then count records of
+ *              UDINT index, UDINT timestamp (us), DINT raw, REAL weight (g)
+ *  Repeat with the returned cursor until count is 0 to drain the backlog.
+ */
+
+#ifndef CIPSCALEHISTORY_H
+#define CIPSCALEHISTORY_H
+
+#include "ciptypes.h"
+
+/** @brief Scale History object class code (vendor-specific range) */
+static const CipUint kScaleHistoryClassCode = 0x70U;
+
+/** @brief Read History service code (object-specific range) */
+static const CipUint kScaleHistoryReadServiceCode = 0x4BU;
+
+/** @brief Records returned per Read History call, sized to fit the explicit
+ *  message buffer (PC_OPENER_ETHERNET_BUFFER_SIZE) */
+#define SCALE_HISTORY_MAX_RECORDS_PER_READ 24U
+
+/** @brief Create the Scale History class with one instance per scale channel
+ *
+ *  @return kEipStatusOk on success, kEipStatusError otherwise
+ */
+EipStatus ScaleHistoryObjectInit(void);
+
+#endif /* CIPSCALEHISTORY_H */
@@ -74,7 +74,7 @@
 
 #define OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS 1
 
-#define OPENER_CIP_NUM_INPUT_ONLY_CONNS 1
+#define OPENER_CIP_NUM_INPUT_ONLY_CONNS 3
 
 #define OPENER_CIP_NUM_INPUT_ONLY_CONNS_PER_CON_PATH 3
 
@@ -98,14 +98,32 @@
 static const MilliSeconds kOpenerTimerTickInMilliSeconds = 10;
 
 #define OPENER_WITH_TRACES
+
+#ifndef OPENER_UNIT_TEST
+/* Every level is compiled in; which ones are printed is decided per module at
+ * run time by g_opener_trace_mask (see tracecontrol.h) */
+#define OPENER_TRACE_LEVEL (OPENER_TRACE_LEVEL_ERROR | OPENER_TRACE_LEVEL_WARNING | \
+                            OPENER_TRACE_LEVEL_STATE | OPENER_TRACE_LEVEL_INFO)
+
+extern uint32_t g_opener_trace_mask;
+#define OPENER_TRACE_RUNTIME_MASK g_opener_trace_mask
+#else
 #define OPENER_TRACE_LEVEL (OPENER_TRACE_LEVEL_ERROR | OPENER_TRACE_LEVEL_WARNING)
+#endif
 
 #ifndef OPENER_UNIT_TEST
 
 #ifdef OPENER_WITH_TRACES
     #include <stdio.h>
 
+  #ifdef CONFIG_OPENER_BINARY_TRACE
+    #include "binary_trace.h"
+
+    /* Recorded unformatted; expand with tools/trace_decode.py */
+    #define LOG_TRACE(...)  BINARY_TRACE(__VA_ARGS__)
+  #else
     #define LOG_TRACE(...)  fprintf(stderr,__VA_ARGS__)
+  #endif
 
      #ifdef IDLING_ASSERT
         #define OPENER_ASSERT(assertion)                                    \
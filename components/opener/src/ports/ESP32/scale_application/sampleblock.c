@@ -0,0 +1,99 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include <stdatomic.h>
+
+#include "sampleblock.h"
+#include "trace.h"
+
+_Static_assert((SCALE_SAMPLE_RING_SIZE & (SCALE_SAMPLE_RING_SIZE - 1)) == 0,
+               "SCALE_SAMPLE_RING_SIZE must be a power of two");
+_Static_assert(SCALE_SAMPLE_RING_SIZE >= 4 * SCALE_SAMPLE_BLOCK_SIZE,
+               "SCALE_SAMPLE_RING_SIZE too small for SCALE_SAMPLE_BLOCK_SIZE");
+
+static ScaleSample s_ring[SCALE_SAMPLE_RING_SIZE];
+/* Free-running indices: head is written only by the producer, tail only by
+ * the consumer. Acquire/release ordering publishes the sample contents. */
+static atomic_uint s_head;
+static atomic_uint s_tail;
+static atomic_uint s_dropped;
+static EipUint32 s_block_sequence;
+
+static void PutUint16(EipUint8 *dst, EipUint16 value) {
+  dst[0] = (EipUint8)(value & 0xFF);
+  dst[1] = (EipUint8)(value >> 8);
+}
+
+static void PutUint32(EipUint8 *dst, EipUint32 value) {
+  dst[0] = (EipUint8)(value & 0xFF);
+  dst[1] = (EipUint8)(value >> 8);
+  dst[2] = (EipUint8)(value >> 16);
+  dst[3] = (EipUint8)(value >> 24);
+}
+
+bool ScaleSampleBlockPush(const ScaleSample *sample) {
+  unsigned int head = atomic_load_explicit(&s_head, memory_order_relaxed);
+  unsigned int tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+
+  if (head - tail >= SCALE_SAMPLE_RING_SIZE) {
+    atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+    return false;
+  }
+
+  s_ring[head & (SCALE_SAMPLE_RING_SIZE - 1)] = *sample;
+  atomic_store_explicit(&s_head, head + 1, memory_order_release);
+  return true;
+}
+
+void ScaleSampleBlockFlush(void) {
+  unsigned int head = atomic_load_explicit(&s_head, memory_order_acquire);
+  atomic_store_explicit(&s_tail, head, memory_order_release);
+  atomic_store_explicit(&s_dropped, 0, memory_order_relaxed);
+}
+
+bool ScaleSampleBlockFill(EipUint8 *data, size_t size) {
+  if (data == NULL || size < SCALE_SAMPLE_BLOCK_ASSEMBLY_SIZE) {
+    return false;
+  }
+
+  unsigned int tail = atomic_load_explicit(&s_tail, memory_order_relaxed);
+  unsigned int head = atomic_load_explicit(&s_head, memory_order_acquire);
+  unsigned int available = head - tail;
+  if (available == 0) {
+    return false;
+  }
+
+  unsigned int count = available > SCALE_SAMPLE_BLOCK_SIZE ?
+                       SCALE_SAMPLE_BLOCK_SIZE : available;
+  EipUint8 *record = data + SCALE_SAMPLE_BLOCK_HEADER_SIZE;
+  for (unsigned int i = 0; i < count; ++i) {
+    const ScaleSample *sample =
+      &s_ring[(tail + i) & (SCALE_SAMPLE_RING_SIZE - 1)];
+    PutUint32(record, sample->timestamp_us);
+    PutUint32(record + 4, (EipUint32)sample->raw);
+    PutUint32(record + 8, (EipUint32)sample->weight_scaled);
+    record += SCALE_SAMPLE_RECORD_SIZE;
+  }
+  atomic_store_explicit(&s_tail, tail + count, memory_order_release);
+
+  /* Unused records are zeroed so stale samples are never mistaken for data */
+  memset(record, 0,
+         (SCALE_SAMPLE_BLOCK_SIZE - count) * SCALE_SAMPLE_RECORD_SIZE);
+
+  unsigned int dropped = atomic_exchange_explicit(&s_dropped, 0,
+                                                  memory_order_relaxed);
+  if (dropped > 0) {
+    OPENER_TRACE_WARN("Sample block: %u samples dropped (RPI too slow)\n",
+                      dropped);
+  }
+
+  s_block_sequence++;
+  PutUint32(data, s_block_sequence);
+  PutUint16(data + 4, (EipUint16)count);
+  PutUint16(data + 6, dropped > 0xFFFF ? 0xFFFF : (EipUint16)dropped);
+  return true;
+}
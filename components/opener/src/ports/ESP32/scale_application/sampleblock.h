@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file sampleblock.h
+ *  @brief High-rate scale sample block for Input Assembly 101
+ *
+ *  The scale acquisition task pushes every ADC conversion into a lock-free
+ *  single-producer / single-consumer ring. Each time Assembly 101 is produced
+ *  the OpENer task drains up to SCALE_SAMPLE_BLOCK_SIZE samples into the
+ *  assembly, so consecutive blocks carry every sample without gaps as long as
+ *  the RPI keeps up with the sample rate.
+ *
+ *  The ring has a single consumer, so Assembly 101 may only have one
+ *  producing connection: further Input Only connections must join its
+ *  multicast production (see InputAssemblyAllowsMultipleProducers()).
+ *
+ *  Assembly 101 layout (little-endian):
+ *    0-3   block sequence number (increments for each new block)
+ *    4-5   number of valid samples in this block
+ *    6-7   samples dropped by the ring since the previous block (saturating)
+ *    8..   SCALE_SAMPLE_BLOCK_SIZE records of 12 bytes:
+ *            timestamp (uint32, microseconds since boot, wraps)
+ *            raw ADC reading (int32)
+ *            weight scaled by 100 in the configured unit (int32)
+ */
+
+#ifndef SAMPLEBLOCK_H
+#define SAMPLEBLOCK_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "typedefs.h"
+#include "sdkconfig.h"
+
+#ifdef CONFIG_OPENER_NAU7802_SAMPLE_BLOCK_SIZE
+  #define SCALE_SAMPLE_BLOCK_SIZE CONFIG_OPENER_NAU7802_SAMPLE_BLOCK_SIZE
+#else
+  #define SCALE_SAMPLE_BLOCK_SIZE 16
+#endif
+
+#define SCALE_SAMPLE_BLOCK_HEADER_SIZE 8
+#define SCALE_SAMPLE_RECORD_SIZE       12
+#define SCALE_SAMPLE_BLOCK_ASSEMBLY_SIZE \
+  (SCALE_SAMPLE_BLOCK_HEADER_SIZE + \
+   SCALE_SAMPLE_BLOCK_SIZE * SCALE_SAMPLE_RECORD_SIZE)
+
+/** Ring capacity, power of two and at least four blocks deep */
+#define SCALE_SAMPLE_RING_SIZE 256
+
+typedef struct {
+  EipUint32 timestamp_us;
+  EipInt32 raw;
+  EipInt32 weight_scaled;
+} ScaleSample;
+
+/**
+ * @brief Queue one sample for the sample block assembly (producer side)
+ *
+ * Must only be called from the scale acquisition task. Never blocks; if the
+ * ring is full the sample is dropped and counted.
+ *
+ * @param sample Sample to queue
+ * @return true if queued, false if dropped
+ */
+bool ScaleSampleBlockPush(const ScaleSample *sample);
+
+/**
+ * @brief Discard all queued samples (consumer side)
+ *
+ * Called when the first sample block connection opens so the first block
+ * starts with fresh data instead of whatever accumulated while nobody was
+ * consuming.
+ */
+void ScaleSampleBlockFlush(void);
+
+/**
+ * @brief Build the next block into the assembly buffer (consumer side)
+ *
+ * Called from BeforeAssemblyDataSend() in the OpENer task. If no new samples
+ * are queued the buffer is left unchanged so the sequence number repeats.
+ *
+ * @param data Assembly buffer
+ * @param size Assembly buffer size (SCALE_SAMPLE_BLOCK_ASSEMBLY_SIZE)
+ * @return true if a new block was written
+ */
+bool ScaleSampleBlockFill(EipUint8 *data, size_t size);
+
+#endif /* SAMPLEBLOCK_H */
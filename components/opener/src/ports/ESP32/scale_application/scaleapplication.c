@@ -27,6 +27,12 @@
 #include "eth_media_counters.h"
 #include "sdkconfig.h"
 #include "system_config.h"
+#include "sampleblock.h"
+#include "scalechannels.h"
+#include "cipscalehistory.h"
+#include "cipdiagnostics.h"
+#include "ciplatencyprobe.h"
+#include "modbus_register_map.h"
 
 struct netif;
 
@@ -37,13 +43,18 @@ static void ConfigureStatusLed(void);
 #define DEMO_APP_INPUT_ASSEMBLY_NUM                100
 #define DEMO_APP_OUTPUT_ASSEMBLY_NUM               150
 #define DEMO_APP_CONFIG_ASSEMBLY_NUM               151
+#define DEMO_APP_SAMPLE_BLOCK_ASSEMBLY_NUM         101
+#define DEMO_APP_SCALE_CHANNELS_ASSEMBLY_NUM       102
 EipUint8 g_assembly_data064[32];
 EipUint8 g_assembly_data096[32];
 EipUint8 g_assembly_data097[10];
+EipUint8 g_assembly_data065[SCALE_SAMPLE_BLOCK_ASSEMBLY_SIZE];
+EipUint8 g_assembly_data066[SCALE_CHANNEL_ASSEMBLY_SIZE];
 
 static const gpio_num_t kStatusLedGpio = GPIO_NUM_33;
 static bool restart_pending = false;
 static EipUint32 s_active_io_connections = 0;
+static EipUint32 s_sample_block_connections = 0;
 static bool s_io_activity_seen = false;
 
 /* Mutexes for thread-safe access */
@@ -160,15 +171,37 @@ EipStatus ApplicationInitialization(void) {
   CreateAssemblyObject( DEMO_APP_CONFIG_ASSEMBLY_NUM, g_assembly_data097,
                        sizeof(g_assembly_data097));
 
+  CreateAssemblyObject( DEMO_APP_SAMPLE_BLOCK_ASSEMBLY_NUM, g_assembly_data065,
+                       sizeof(g_assembly_data065));
+
+  CreateAssemblyObject( DEMO_APP_SCALE_CHANNELS_ASSEMBLY_NUM, g_assembly_data066,
+                       sizeof(g_assembly_data066));
+
   ConfigureExclusiveOwnerConnectionPoint(0, DEMO_APP_OUTPUT_ASSEMBLY_NUM,
   DEMO_APP_INPUT_ASSEMBLY_NUM,
                                          DEMO_APP_CONFIG_ASSEMBLY_NUM);
   ConfigureInputOnlyConnectionPoint(0, DEMO_APP_OUTPUT_ASSEMBLY_NUM,
                                     DEMO_APP_INPUT_ASSEMBLY_NUM,
                                     DEMO_APP_CONFIG_ASSEMBLY_NUM);
+  ConfigureInputOnlyConnectionPoint(1, DEMO_APP_OUTPUT_ASSEMBLY_NUM,
+                                    DEMO_APP_SAMPLE_BLOCK_ASSEMBLY_NUM,
+                                    DEMO_APP_CONFIG_ASSEMBLY_NUM);
+  ConfigureInputOnlyConnectionPoint(2, DEMO_APP_OUTPUT_ASSEMBLY_NUM,
+                                    DEMO_APP_SCALE_CHANNELS_ASSEMBLY_NUM,
+                                    DEMO_APP_CONFIG_ASSEMBLY_NUM);
   ConfigureListenOnlyConnectionPoint(0, DEMO_APP_OUTPUT_ASSEMBLY_NUM,
                                      DEMO_APP_INPUT_ASSEMBLY_NUM,
                                      DEMO_APP_CONFIG_ASSEMBLY_NUM);
+  if (ScaleHistoryObjectInit() != kEipStatusOk) {
+    OPENER_TRACE_ERR("Failed to create Scale History object\n");
+  }
+  if (DiagnosticsObjectInit() != kEipStatusOk) {
+    OPENER_TRACE_ERR("Failed to create Diagnostics object\n");
+  }
+  if (LatencyProbeObjectInit() != kEipStatusOk) {
+    OPENER_TRACE_ERR("Failed to create Latency Probe object\n");
+  }
+
   CipRunIdleHeaderSetO2T(false);
   CipRunIdleHeaderSetT2O(false);
   ConfigureStatusLed();
@@ -220,10 +253,15 @@ void CheckIoConnectionEvent(unsigned int output_assembly_id,
                             IoConnectionEvent io_connection_event) {
 
   (void) output_assembly_id;
-  (void) input_assembly_id;
 
   switch (io_connection_event) {
     case kIoConnectionEventOpened:
+      if (input_assembly_id == DEMO_APP_SAMPLE_BLOCK_ASSEMBLY_NUM &&
+          s_sample_block_connections++ == 0) {
+        /* Only the first consumer starts from a fresh ring; later ones join
+         * its multicast production and must not discard unsent samples */
+        ScaleSampleBlockFlush();
+      }
       if (s_active_io_connections++ == 0) {
         IdentityEnter(kStateStandby,
                       kAtLeastOneIoConnectionEstablishedAllInIdleMode);
@@ -231,6 +269,10 @@ void CheckIoConnectionEvent(unsigned int output_assembly_id,
       break;
     case kIoConnectionEventTimedOut:
     case kIoConnectionEventClosed:
+      if (input_assembly_id == DEMO_APP_SAMPLE_BLOCK_ASSEMBLY_NUM &&
+          s_sample_block_connections > 0) {
+        s_sample_block_connections--;
+      }
       if (s_active_io_connections > 0) {
         s_active_io_connections--;
       }
@@ -244,6 +286,13 @@ void CheckIoConnectionEvent(unsigned int output_assembly_id,
   }
 }
 
+EipBool8 InputAssemblyAllowsMultipleProducers(unsigned int input_assembly_id) {
+  /* Producing the sample block drains the ring, so two producers would split
+   * the samples between their scanners. Further scanners must use multicast
+   * and share the single production. */
+  return input_assembly_id != DEMO_APP_SAMPLE_BLOCK_ASSEMBLY_NUM;
+}
+
 EipStatus AfterAssemblyDataReceived(CipInstance *instance) {
   EipStatus status = kEipStatusOk;
 
@@ -252,9 +301,11 @@ EipStatus AfterAssemblyDataReceived(CipInstance *instance) {
       /* Process output assembly data (LED control only) */
       gpio_set_level(kStatusLedGpio,
                      (g_assembly_data096[0] & 0x01) ? 1 : 0);
+      modbus_register_map_assembly_updated(MODBUS_ASSEMBLY_OUTPUT);
       IdentityNoteIoActivity();
       break;
     case DEMO_APP_CONFIG_ASSEMBLY_NUM:
+      modbus_register_map_assembly_updated(MODBUS_ASSEMBLY_CONFIG);
       status = kEipStatusOk;
       break;
     default:
@@ -266,7 +317,10 @@ EipStatus AfterAssemblyDataReceived(CipInstance *instance) {
 }
 
 EipBool8 BeforeAssemblyDataSend(CipInstance *instance) {
-  (void) instance;
+  if (instance->instance_number == DEMO_APP_SAMPLE_BLOCK_ASSEMBLY_NUM) {
+    /* Ship every sample queued since the previous production */
+    ScaleSampleBlockFill(g_assembly_data065, sizeof(g_assembly_data065));
+  }
   IdentityNoteIoActivity();
   return true;
 }
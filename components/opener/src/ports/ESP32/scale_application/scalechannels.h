@@ -0,0 +1,46 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file scalechannels.h
+ *  @brief Scale channel count and the multi-scale input assembly layout
+ *
+ *  A device can acquire up to SCALE_CHANNEL_MAX load cells, one NAU7802 per
+ *  channel. Channel N sits on port N of a TCA9548A I2C multiplexer when
+ *  CONFIG_OPENER_NAU7802_MUX_ADDRESS is set.
+ *
+ *  Assembly 102 carries one 10-byte record per channel, channel N at byte
+ *  N * SCALE_CHANNEL_RECORD_SIZE, in the same layout as the scale block of
+ *  Assembly 100 (little-endian):
+ *    0-3   weight scaled by 100 in the configured unit (int32)
+ *    4-7   raw ADC reading (int32)
+ *    8     unit code (0=grams, 1=lbs, 2=kg)
+ *    9     status flags (bit 0 available, bit 1 connected, bit 2 initialized,
+ *          bit 3 stable, bit 4 in motion, bit 5 center of zero)
+ *  The assembly always has SCALE_CHANNEL_MAX records so its size does not
+ *  depend on the build; records of absent channels stay zero.
+ *
+ *  Channel 0 is additionally mapped into Assembly 100 at the configured byte
+ *  offset, as on single-scale devices.
+ */
+
+#ifndef SCALECHANNELS_H
+#define SCALECHANNELS_H
+
+#include "sdkconfig.h"
+
+#define SCALE_CHANNEL_MAX 4
+
+#ifdef CONFIG_OPENER_NAU7802_SCALE_COUNT
+  #define SCALE_CHANNEL_COUNT CONFIG_OPENER_NAU7802_SCALE_COUNT
+#else
+  #define SCALE_CHANNEL_COUNT 1
+#endif
+
+#define SCALE_CHANNEL_RECORD_SIZE 10
+#define SCALE_CHANNEL_ASSEMBLY_SIZE \
+  (SCALE_CHANNEL_MAX * SCALE_CHANNEL_RECORD_SIZE)
+
+#endif /* SCALECHANNELS_H */
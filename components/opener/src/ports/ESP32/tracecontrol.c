@@ -0,0 +1,139 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file tracecontrol.c
+ *  @brief Runtime trace levels per module
+ */
+
+#include <string.h>
+
+#include "tracecontrol.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+/* Read by every OPENER_TRACE_* call (OPENER_TRACE_RUNTIME_MASK). An aligned
+ * 32-bit store is atomic, so readers never see a torn mask. */
+uint32_t g_opener_trace_mask = TRACE_CONTROL_MASK_DEFAULT;
+
+static portMUX_TYPE s_trace_mask_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const kTraceModuleNames[OPENER_TRACE_MODULE_COUNT] = {
+  [OPENER_TRACE_MODULE_CIP] = "cip",
+  [OPENER_TRACE_MODULE_NETWORK] = "network",
+  [OPENER_TRACE_MODULE_ENCAP] = "encap",
+  [OPENER_TRACE_MODULE_CONNECTION] = "connection",
+  [OPENER_TRACE_MODULE_IO] = "io",
+  [OPENER_TRACE_MODULE_LLDP] = "lldp",
+  [OPENER_TRACE_MODULE_MODBUS] = "modbus",
+  [OPENER_TRACE_MODULE_SCALE] = "scale",
+};
+
+/* ESP_LOG tags of the modules that do not use OPENER_TRACE_* */
+static const char *const kModbusLogTags[] = {
+  "modbus_tcp", "modbus_protocol", "modbus_regmap", NULL
+};
+static const char *const kScaleLogTags[] = {
+  "NAU7802", "nau7802_hist", "nau7802_stab", "nau7802_job", "nau7802_sim",
+  "cal_storage", NULL
+};
+
+/* Info maps to ESP_LOG_DEBUG only when debug logs are compiled in; with
+ * CONFIG_LOG_MAXIMUM_LEVEL at info (the default) it is the same as state */
+static esp_log_level_t EspLogLevelFor(uint8_t levels) {
+  if (levels & OPENER_TRACE_LEVEL_INFO) {
+#if CONFIG_LOG_MAXIMUM_LEVEL >= 4 /* ESP_LOG_DEBUG */
+    return ESP_LOG_DEBUG;
+#else
+    return ESP_LOG_INFO;
+#endif
+  }
+  if (levels & OPENER_TRACE_LEVEL_STATE) {
+    return ESP_LOG_INFO;
+  }
+  if (levels & OPENER_TRACE_LEVEL_WARNING) {
+    return ESP_LOG_WARN;
+  }
+  if (levels & OPENER_TRACE_LEVEL_ERROR) {
+    return ESP_LOG_ERROR;
+  }
+  return ESP_LOG_NONE;
+}
+
+static void ApplyEspLogLevels(const char *const *tags, uint8_t levels) {
+  esp_log_level_t level = EspLogLevelFor(levels);
+  for (; *tags != NULL; ++tags) {
+    esp_log_level_set(*tags, level);
+  }
+}
+
+static uint8_t ModuleLevels(uint32_t mask, unsigned module) {
+  return (uint8_t)( (mask >> (4 * module) ) & TRACE_CONTROL_MODULE_LEVELS );
+}
+
+/* Replaces the bits outside keep with set, then follows up on the ESP log
+ * levels of the modules whose levels changed */
+static void UpdateMask(uint32_t keep, uint32_t set) {
+  portENTER_CRITICAL(&s_trace_mask_lock);
+  uint32_t old_mask = g_opener_trace_mask;
+  uint32_t mask = (old_mask & keep) | set;
+  g_opener_trace_mask = mask;
+  portEXIT_CRITICAL(&s_trace_mask_lock);
+
+  uint8_t modbus = ModuleLevels(mask, OPENER_TRACE_MODULE_MODBUS);
+  if (modbus != ModuleLevels(old_mask, OPENER_TRACE_MODULE_MODBUS) ) {
+    ApplyEspLogLevels(kModbusLogTags, modbus);
+  }
+  uint8_t scale = ModuleLevels(mask, OPENER_TRACE_MODULE_SCALE);
+  if (scale != ModuleLevels(old_mask, OPENER_TRACE_MODULE_SCALE) ) {
+    ApplyEspLogLevels(kScaleLogTags, scale);
+  }
+}
+
+void TraceControlInit(void) {
+  uint32_t mask = g_opener_trace_mask;
+  ApplyEspLogLevels(kModbusLogTags, ModuleLevels(mask, OPENER_TRACE_MODULE_MODBUS) );
+  ApplyEspLogLevels(kScaleLogTags, ModuleLevels(mask, OPENER_TRACE_MODULE_SCALE) );
+}
+
+uint32_t TraceControlGetMask(void) {
+  return g_opener_trace_mask;
+}
+
+void TraceControlSetMask(uint32_t mask) {
+  UpdateMask(0, mask);
+}
+
+uint8_t TraceControlGetModuleLevels(unsigned module) {
+  if (module >= OPENER_TRACE_MODULE_COUNT) {
+    return 0;
+  }
+  return ModuleLevels(g_opener_trace_mask, module);
+}
+
+void TraceControlSetModuleLevels(unsigned module, uint8_t levels) {
+  if (module >= OPENER_TRACE_MODULE_COUNT) {
+    return;
+  }
+  uint32_t shift = 4 * module;
+  UpdateMask(~(TRACE_CONTROL_MODULE_LEVELS << shift),
+             (uint32_t)(levels & TRACE_CONTROL_MODULE_LEVELS) << shift);
+}
+
+const char *TraceControlModuleName(unsigned module) {
+  if (module >= OPENER_TRACE_MODULE_COUNT) {
+    return NULL;
+  }
+  return kTraceModuleNames[module];
+}
+
+int TraceControlModuleFromName(const char *name) {
+  for (unsigned i = 0; i < OPENER_TRACE_MODULE_COUNT; ++i) {
+    if (strcmp(name, kTraceModuleNames[i]) == 0) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
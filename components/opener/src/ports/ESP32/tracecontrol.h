@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * Copyright (c) 2025, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file tracecontrol.h
+ *  @brief Runtime trace levels per module
+ *
+ *  g_opener_trace_mask holds four bits per module (OPENER_TRACE_MODULE_* in
+ *  trace.h, module N at bit 4 * N): bit 0 error, bit 1 warning, bit 2 state,
+ *  bit 3 info. Every OPENER_TRACE_* call tests its module's bit with one load
+ *  of the mask, so a disabled trace point costs a branch and nothing more.
+ *
+ *  Modbus TCP and the NAU7802 driver log with ESP_LOG rather than
+ *  OPENER_TRACE_*. Changing the levels of those modules also sets the ESP log
+ *  level of their tags: state maps to ESP_LOG_INFO, and info to ESP_LOG_DEBUG
+ *  when CONFIG_LOG_MAXIMUM_LEVEL compiles debug logs in. With the default
+ *  maximum (info), info adds nothing over state for these modules.
+ *
+ *  The mask starts at TRACE_CONTROL_MASK_DEFAULT and is not kept across
+ *  reboots. It can be changed through /api/trace/levels and attribute 1 of
+ *  the Diagnostics object (cipdiagnostics.h).
+ */
+
+#ifndef TRACECONTROL_H
+#define TRACECONTROL_H
+
+#include <stdint.h>
+#include "opener_user_conf.h"
+#include "trace.h"
+#include "sdkconfig.h"
+
+/** @brief Levels of one module (bits of OPENER_TRACE_LEVEL_*) */
+#define TRACE_CONTROL_MODULE_LEVELS 0x0FU
+
+/** @brief Mask at boot: error and warning for every module, or every level
+ *  when traces are recorded by the binary trace */
+#ifdef CONFIG_OPENER_BINARY_TRACE
+#define TRACE_CONTROL_MASK_DEFAULT 0xFFFFFFFFU
+#else
+#define TRACE_CONTROL_MASK_DEFAULT 0x33333333U
+#endif
+
+/** @brief Apply the boot mask to the ESP log levels of the Modbus and scale
+ *  tags
+ *
+ *  Call once at boot, before the Modbus server and the scale task start.
+ */
+void TraceControlInit(void);
+
+/** @brief Get the trace mask
+ *
+ *  @return Four level bits per module
+ */
+uint32_t TraceControlGetMask(void);
+
+/** @brief Set the trace mask
+ *
+ *  Takes effect on the next trace call of every task. Also updates the ESP
+ *  log level of the Modbus and scale tags whose module levels changed.
+ *
+ *  @param mask Four level bits per module
+ */
+void TraceControlSetMask(uint32_t mask);
+
+/** @brief Get the levels of one module
+ *
+ *  @param module OPENER_TRACE_MODULE_*
+ *  @return OPENER_TRACE_LEVEL_* bits, 0 for an unknown module
+ */
+uint8_t TraceControlGetModuleLevels(unsigned module);
+
+/** @brief Set the levels of one module
+ *
+ *  @param module OPENER_TRACE_MODULE_*
+ *  @param levels OPENER_TRACE_LEVEL_* bits
+ */
+void TraceControlSetModuleLevels(unsigned module, uint8_t levels);
+
+/** @brief Name of a module as used by the REST API ("network", "encap", ...)
+ *
+ *  @param module OPENER_TRACE_MODULE_*
+ *  @return Name, or NULL for an unknown module
+ */
+const char *TraceControlModuleName(unsigned module);
+
+/** @brief Look up a module by name
+ *
+ *  @param name Module name
+ *  @return OPENER_TRACE_MODULE_*, or -1 if the name is unknown
+ */
+int TraceControlModuleFromName(const char *name);
+
+#endif /* TRACECONTROL_H */
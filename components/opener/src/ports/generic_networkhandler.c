@@ -23,6 +23,7 @@
 #include "ciptcpipinterface.h"
 #include "opener_user_conf.h"
 #include "cipqos.h"
+#include "latency_probe.h"
 
 #define MAX_NO_OF_TCP_SOCKETS 10
 
@@ -457,7 +458,7 @@ void CheckAndHandleTcpListenerSocket(void) {
   int new_socket = kEipInvalidSocket;
   /* see if this is a connection request to the TCP listener*/
   if( true == CheckSocketSet(g_network_status.tcp_listener) ) {
-    // OPENER_TRACE_INFO("networkhandler: new TCP connection\n"); // Disabled for less noise
+    OPENER_TRACE_INFO("networkhandler: new TCP connection\n");
 
     new_socket = accept(g_network_status.tcp_listener, NULL, NULL);
     if(new_socket == kEipInvalidSocket) {
@@ -467,7 +468,8 @@ void CheckAndHandleTcpListenerSocket(void) {
                        error_code, error_message);
       FreeErrorMessage(error_message);
       return;
-    } // OPENER_TRACE_INFO(">>> network handler: accepting new TCP socket: %d \n", new_socket); // Disabled for less noise
+    }
+    OPENER_TRACE_INFO(">>> network handler: accepting new TCP socket: %d \n", new_socket);
 
     /* MODIFICATION: Disable Nagle's algorithm for low latency EtherNet/IP explicit messaging
      * Added by: Adam G. Sweeney <agsweeney@gmail.com>
@@ -541,6 +543,9 @@ EipStatus NetworkHandlerProcessCyclic(void) {
     }
   }
 
+  /* Time the work done in this cycle, not the wait in select() */
+  LATENCY_PROBE_BEGIN(cyclic_mark);
+
   if(ready_socket > 0) {
 
     CheckAndHandleTcpListenerSocket();
@@ -588,6 +593,7 @@ EipStatus NetworkHandlerProcessCyclic(void) {
 
     g_network_status.elapsed_time = 0;
   }
+  LATENCY_PROBE_END(LATENCY_PROBE_NETWORK_CYCLIC, cyclic_mark);
   return kEipStatusOk;
 }
 
@@ -713,7 +719,7 @@ void CheckAndHandleUdpUnicastSocket(void) {
     if (received_size > 0) {
       NetworkCountersRecordRx((size_t)received_size, false);
     }
-    // OPENER_TRACE_INFO("Data received on UDP unicast:\n"); // Disabled for less noise
+    OPENER_TRACE_INFO("Data received on UDP unicast:\n");
 
     EipUint8 *receive_buffer = &incoming_message[0];
     int remaining_bytes = 0;
@@ -732,7 +738,7 @@ void CheckAndHandleUdpUnicastSocket(void) {
     received_size = remaining_bytes;
 
     if(need_to_send > 0) {
-      // OPENER_TRACE_INFO("UDP unicast reply sent:\n"); // Disabled for less noise
+      OPENER_TRACE_INFO("UDP unicast reply sent:\n");
 
       /* if the active socket matches a registered UDP callback, handle a UDP packet */
       if(sendto( g_network_status.udp_unicast_listener,
@@ -799,7 +805,7 @@ EipStatus SendUdpData(const struct sockaddr_in *const address,
 }
 
 EipStatus HandleDataOnTcpSocket(int socket) {
-  // OPENER_TRACE_INFO("Entering HandleDataOnTcpSocket for socket: %d\n", socket); // Disabled for less noise
+  OPENER_TRACE_INFO("Entering HandleDataOnTcpSocket for socket: %d\n", socket);
   int remaining_bytes = 0;
   long data_sent = PC_OPENER_ETHERNET_BUFFER_SIZE;
 
@@ -932,7 +938,7 @@ EipStatus HandleDataOnTcpSocket(int socket) {
     /*we got the right amount of data */
     data_size += 4;
     /*TODO handle partial packets*/
-    // OPENER_TRACE_INFO("Data received on TCP: %" PRIuSZT "\n", data_size); // Disabled for less noise
+    OPENER_TRACE_INFO("Data received on TCP: %" PRIuSZT "\n", data_size);
     NetworkCountersRecordRx(data_size, false);
 
     g_current_active_tcp_socket = socket;
@@ -970,8 +976,8 @@ EipStatus HandleDataOnTcpSocket(int socket) {
     }
 
     if(need_to_send > 0) {
-      // OPENER_TRACE_INFO("TCP reply: send %" PRIuSZT " bytes on %d\n",
-      //                   outgoing_message.used_message_length, socket); // Disabled for less noise
+      OPENER_TRACE_INFO("TCP reply: send %" PRIuSZT " bytes on %d\n",
+                        outgoing_message.used_message_length, socket);
 
       data_sent = send(socket,
                        (char *) outgoing_message.message_buffer,
@@ -1206,8 +1212,10 @@ void CheckAndHandleConsumingUdpSocket(void) {
       }
 
       NetworkCountersRecordRx((size_t)received_size, false);
+      LATENCY_PROBE_BEGIN(received_mark);
       HandleReceivedConnectedData(incoming_message, received_size,
                                   &from_address);
+      LATENCY_PROBE_END(LATENCY_PROBE_RECEIVED_CONNECTED_DATA, received_mark);
 
     }
   }
@@ -10,12 +10,6 @@
  * @brief Tracing infrastructure for OpENer
  */
 
-#ifdef OPENER_WITH_TRACES
-
-#ifndef OPENER_INSTALL_AS_LIB
-#include "opener_user_conf.h"
-#endif
-
 /** @def OPENER_TRACE_LEVEL_ERROR Enable tracing of error messages. This is the
  *  default if no trace level is given.
  */
@@ -30,6 +24,32 @@
 /** @def OPENER_TRACE_LEVEL_INFO Enable tracing of info messages*/
 #define OPENER_TRACE_LEVEL_INFO 0x08
 
+/** @def OPENER_TRACE_MODULE_CIP Trace modules for the runtime trace mask.
+ *  Each module owns four bits of the mask (one per trace level), module N at
+ *  bit 4 * N. A source file is assigned to a module by defining
+ *  OPENER_TRACE_MODULE when compiling it; files without one belong to
+ *  OPENER_TRACE_MODULE_CIP.
+ */
+#define OPENER_TRACE_MODULE_CIP        0 /**< CIP objects and everything else */
+#define OPENER_TRACE_MODULE_NETWORK    1 /**< Network handler and socket timers */
+#define OPENER_TRACE_MODULE_ENCAP      2 /**< Encapsulation and common packet format */
+#define OPENER_TRACE_MODULE_CONNECTION 3 /**< Connection manager and connection objects */
+#define OPENER_TRACE_MODULE_IO         4 /**< I/O connections and assemblies */
+#define OPENER_TRACE_MODULE_LLDP       5 /**< LLDP */
+#define OPENER_TRACE_MODULE_MODBUS     6 /**< Modbus TCP */
+#define OPENER_TRACE_MODULE_SCALE      7 /**< Scale application */
+#define OPENER_TRACE_MODULE_COUNT      8
+
+#ifndef OPENER_TRACE_MODULE
+#define OPENER_TRACE_MODULE OPENER_TRACE_MODULE_CIP
+#endif
+
+#ifdef OPENER_WITH_TRACES
+
+#ifndef OPENER_INSTALL_AS_LIB
+#include "opener_user_conf.h"
+#endif
+
 #ifndef OPENER_TRACE_LEVEL
 #ifdef WIN32
 #pragma message( \
@@ -45,13 +65,26 @@
 /* @def OPENER_TRACE_ENABLED Can be used for conditional code compilation */
 #define OPENER_TRACE_ENABLED
 
+/** @def OPENER_TRACE_ON(level) True if messages of this level are traced.
+ *  OPENER_TRACE_LEVEL selects the levels compiled in. If the port defines
+ *  OPENER_TRACE_RUNTIME_MASK (a 32-bit variable), each trace point also
+ *  checks its module's bits in it, which costs one load and one branch.
+ */
+#ifdef OPENER_TRACE_RUNTIME_MASK
+#define OPENER_TRACE_ON(level)                                                 \
+  ( (OPENER_TRACE_LEVEL & (level) ) &&                                         \
+    (OPENER_TRACE_RUNTIME_MASK & ( (uint32_t)(level) << (4 * OPENER_TRACE_MODULE) ) ) )
+#else
+#define OPENER_TRACE_ON(level) (OPENER_TRACE_LEVEL & (level) )
+#endif
+
 /** @def OPENER_TRACE_ERR(...) Trace error messages.
  *  In order to activate this trace level set the OPENER_TRACE_LEVEL_ERROR flag
  *  in OPENER_TRACE_LEVEL.
  */
 #define OPENER_TRACE_ERR(...)                                                  \
   do {                                                                         \
-    if (OPENER_TRACE_LEVEL_ERROR & OPENER_TRACE_LEVEL) {LOG_TRACE(__VA_ARGS__);} \
+    if (OPENER_TRACE_ON(OPENER_TRACE_LEVEL_ERROR) ) {LOG_TRACE(__VA_ARGS__);} \
   } while (0)
 
 /** @def OPENER_TRACE_WARN(...) Trace warning messages.
@@ -60,7 +93,7 @@
  */
 #define OPENER_TRACE_WARN(...)                           \
   do {                                                   \
-    if (OPENER_TRACE_LEVEL_WARNING & OPENER_TRACE_LEVEL) { \
+    if (OPENER_TRACE_ON(OPENER_TRACE_LEVEL_WARNING) ) { \
       LOG_TRACE(__VA_ARGS__);}                            \
   } while (0)
 
@@ -70,7 +103,7 @@
  */
 #define OPENER_TRACE_STATE(...)                                                \
   do {                                                                         \
-    if (OPENER_TRACE_LEVEL_STATE & OPENER_TRACE_LEVEL) {LOG_TRACE(__VA_ARGS__);} \
+    if (OPENER_TRACE_ON(OPENER_TRACE_LEVEL_STATE) ) {LOG_TRACE(__VA_ARGS__);} \
   } while (0)
 
 /** @def OPENER_TRACE_INFO(...) Trace information messages.
@@ -79,7 +112,7 @@
  */
 #define OPENER_TRACE_INFO(...)                                                \
   do {                                                                        \
-    if (OPENER_TRACE_LEVEL_INFO & OPENER_TRACE_LEVEL) {LOG_TRACE(__VA_ARGS__);} \
+    if (OPENER_TRACE_ON(OPENER_TRACE_LEVEL_INFO) ) {LOG_TRACE(__VA_ARGS__);} \
   } while (0)
 
 #else
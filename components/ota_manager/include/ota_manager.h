@@ -18,6 +18,8 @@
 extern "C" {
 #endif
 
+#define OTA_PIPELINE_BUFFER_SIZE (16 * 1024)  /**< Size of each of the two pipelined update buffers */
+
 /**
  * @brief OTA update status enumeration
  */
@@ -106,6 +108,53 @@ bool ota_manager_write_streaming_chunk(esp_ota_handle_t ota_handle, const uint8_
  */
 bool ota_manager_finish_streaming_update(esp_ota_handle_t ota_handle);
 
+/**
+ * @brief Start a pipelined streaming OTA update
+ * 
+ * Like ota_manager_start_streaming_update(), but flash writes happen in a
+ * separate writer task. Data passed to ota_manager_pipeline_write() is copied
+ * into one of two OTA_PIPELINE_BUFFER_SIZE buffers; a full buffer is handed to
+ * the writer while the caller fills the other one. The caller only waits when
+ * both buffers are full.
+ * 
+ * Flash erase and program disable the cache on both cores, so the caller
+ * (running from flash) makes progress only between flash operations; how much
+ * receiving overlaps programming depends on that and is not measured. The
+ * writer's busy time and the caller's wait time are logged at the end.
+ * 
+ * Only one pipelined update can run at a time. End it with
+ * ota_manager_pipeline_end() or ota_manager_pipeline_abort().
+ * 
+ * @param expected_size Expected firmware size in bytes (for validation)
+ * @return true on success, false on error
+ */
+bool ota_manager_pipeline_begin(size_t expected_size);
+
+/**
+ * @brief Queue firmware data for the writer task
+ * 
+ * @param data Pointer to data
+ * @param len Length of data in bytes
+ * @return true on success, false if a flash write failed (the update has
+ *         already been aborted) or the writer stopped taking buffers
+ */
+bool ota_manager_pipeline_write(const uint8_t *data, size_t len);
+
+/**
+ * @brief Write the remaining data and stop the writer task
+ * 
+ * Waits until every queued byte is in flash. The returned handle is then
+ * passed to ota_manager_finish_streaming_update().
+ * 
+ * @return OTA handle on success, 0 if a write failed
+ */
+esp_ota_handle_t ota_manager_pipeline_end(void);
+
+/**
+ * @brief Discard queued data, stop the writer task and abort the update
+ */
+void ota_manager_pipeline_abort(void);
+
 /**
  * @brief Get current OTA status
  * 
@@ -29,6 +29,8 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -40,6 +42,28 @@ static const esp_partition_t *s_update_partition = NULL; // Store partition bein
 static size_t s_streaming_total_bytes = 0; // Total bytes written during streaming update
 static size_t s_streaming_expected_size = 0; // Expected total size for streaming update
 
+#define OTA_PIPELINE_WAIT_MS 30000  // Longest wait for the writer to free a buffer
+
+// Pipelined streaming update: two buffers cycle between the caller, which
+// fills one, and the writer task, which programs the other into flash
+typedef struct {
+    uint8_t index;
+    size_t len;  // 0 tells the writer to stop
+} ota_pipeline_block_t;
+
+static uint8_t *s_pipeline_buf[2] = {NULL, NULL};
+static QueueHandle_t s_pipeline_free = NULL;     // Indexes of empty buffers
+static QueueHandle_t s_pipeline_full = NULL;     // Filled buffers for the writer
+static SemaphoreHandle_t s_pipeline_done = NULL; // Given by the writer when it exits
+static esp_ota_handle_t s_pipeline_handle = 0;
+static int s_pipeline_fill_index = -1;           // Buffer being filled, -1 if none
+static size_t s_pipeline_fill_len = 0;
+static volatile bool s_pipeline_failed = false;  // A write failed and aborted the update
+static volatile bool s_pipeline_discard = false; // Writer drops buffers (abort)
+static size_t s_pipeline_total_bytes = 0;
+static int64_t s_pipeline_wait_us = 0;           // Caller time spent waiting for a free buffer
+static int64_t s_pipeline_write_us = 0;          // Writer time spent in esp_ota_write()
+
 static void ota_task(void *pvParameters)
 {
     const char *url = (const char *)pvParameters;
@@ -640,3 +664,190 @@ bool ota_manager_finish_streaming_update(esp_ota_handle_t ota_handle)
     return true;
 }
 
+static void ota_pipeline_writer_task(void *pvParameters)
+{
+    (void)pvParameters;
+    ota_pipeline_block_t block;
+    
+    while (xQueueReceive(s_pipeline_full, &block, portMAX_DELAY) == pdTRUE && block.len > 0) {
+        if (!s_pipeline_failed && !s_pipeline_discard) {
+            int64_t start = esp_timer_get_time();
+            if (!ota_manager_write_streaming_chunk(s_pipeline_handle, s_pipeline_buf[block.index], block.len)) {
+                s_pipeline_failed = true;
+            }
+            s_pipeline_write_us += esp_timer_get_time() - start;
+        }
+        xQueueSend(s_pipeline_free, &block.index, portMAX_DELAY);
+    }
+    
+    xSemaphoreGive(s_pipeline_done);
+    vTaskDelete(NULL);
+}
+
+static void ota_pipeline_release(void)
+{
+    for (int i = 0; i < 2; i++) {
+        free(s_pipeline_buf[i]);
+        s_pipeline_buf[i] = NULL;
+    }
+    if (s_pipeline_free != NULL) {
+        vQueueDelete(s_pipeline_free);
+        s_pipeline_free = NULL;
+    }
+    if (s_pipeline_full != NULL) {
+        vQueueDelete(s_pipeline_full);
+        s_pipeline_full = NULL;
+    }
+    if (s_pipeline_done != NULL) {
+        vSemaphoreDelete(s_pipeline_done);
+        s_pipeline_done = NULL;
+    }
+    s_pipeline_fill_index = -1;
+    s_pipeline_fill_len = 0;
+}
+
+// Hand the buffer being filled to the writer. Never blocks: the full queue
+// has room for both buffers.
+static void ota_pipeline_submit(void)
+{
+    ota_pipeline_block_t block = {
+        .index = (uint8_t)s_pipeline_fill_index,
+        .len = s_pipeline_fill_len,
+    };
+    xQueueSend(s_pipeline_full, &block, portMAX_DELAY);
+    s_pipeline_fill_index = -1;
+    s_pipeline_fill_len = 0;
+}
+
+// Queue the partly filled buffer (unless discarding), stop the writer once it
+// has drained the queue, and free the pipeline
+static bool ota_pipeline_stop(void)
+{
+    if (s_pipeline_fill_index >= 0 && s_pipeline_fill_len > 0 && !s_pipeline_discard) {
+        ota_pipeline_submit();
+    }
+    ota_pipeline_block_t stop = { .index = 0, .len = 0 };
+    xQueueSend(s_pipeline_full, &stop, portMAX_DELAY);
+    xSemaphoreTake(s_pipeline_done, portMAX_DELAY);
+    
+    ESP_LOGI(TAG, "Pipelined update: %lu bytes queued, writer busy %lld ms, receiver waited %lld ms for a buffer",
+             (unsigned long)s_pipeline_total_bytes, s_pipeline_write_us / 1000, s_pipeline_wait_us / 1000);
+    ota_pipeline_release();
+    return !s_pipeline_failed;
+}
+
+bool ota_manager_pipeline_begin(size_t expected_size)
+{
+    if (s_pipeline_full != NULL) {
+        ESP_LOGW(TAG, "Pipelined OTA update already in progress");
+        return false;
+    }
+    
+    s_pipeline_buf[0] = malloc(OTA_PIPELINE_BUFFER_SIZE);
+    s_pipeline_buf[1] = malloc(OTA_PIPELINE_BUFFER_SIZE);
+    s_pipeline_free = xQueueCreate(2, sizeof(uint8_t));
+    s_pipeline_full = xQueueCreate(2 + 1, sizeof(ota_pipeline_block_t)); // Both buffers and the stop marker
+    s_pipeline_done = xSemaphoreCreateBinary();
+    if (s_pipeline_buf[0] == NULL || s_pipeline_buf[1] == NULL || s_pipeline_free == NULL ||
+        s_pipeline_full == NULL || s_pipeline_done == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate OTA pipeline buffers");
+        ota_pipeline_release();
+        return false;
+    }
+    
+    s_pipeline_handle = ota_manager_start_streaming_update(expected_size);
+    if (s_pipeline_handle == 0) {
+        ota_pipeline_release();
+        return false;
+    }
+    
+    for (uint8_t i = 0; i < 2; i++) {
+        xQueueSend(s_pipeline_free, &i, 0);
+    }
+    s_pipeline_failed = false;
+    s_pipeline_discard = false;
+    s_pipeline_total_bytes = 0;
+    s_pipeline_wait_us = 0;
+    s_pipeline_write_us = 0;
+    
+    // Same priority as the HTTP server task, so the two share the CPUs while
+    // either one waits on the network or the flash
+    if (xTaskCreate(ota_pipeline_writer_task, "ota_writer", 4096, NULL, 5, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create OTA writer task");
+        esp_ota_abort(s_pipeline_handle);
+        s_pipeline_handle = 0;
+        ota_pipeline_release();
+        return false;
+    }
+    return true;
+}
+
+bool ota_manager_pipeline_write(const uint8_t *data, size_t len)
+{
+    if (s_pipeline_full == NULL) {
+        return false;
+    }
+    
+    while (len > 0) {
+        if (s_pipeline_failed) {
+            return false;
+        }
+        if (s_pipeline_fill_index < 0) {
+            uint8_t index;
+            int64_t start = esp_timer_get_time();
+            if (xQueueReceive(s_pipeline_free, &index, pdMS_TO_TICKS(OTA_PIPELINE_WAIT_MS)) != pdTRUE) {
+                ESP_LOGE(TAG, "OTA writer did not free a buffer within %d ms", OTA_PIPELINE_WAIT_MS);
+                return false;
+            }
+            s_pipeline_wait_us += esp_timer_get_time() - start;
+            s_pipeline_fill_index = index;
+            s_pipeline_fill_len = 0;
+        }
+        
+        size_t room = OTA_PIPELINE_BUFFER_SIZE - s_pipeline_fill_len;
+        size_t n = (len < room) ? len : room;
+        memcpy(s_pipeline_buf[s_pipeline_fill_index] + s_pipeline_fill_len, data, n);
+        s_pipeline_fill_len += n;
+        s_pipeline_total_bytes += n;
+        data += n;
+        len -= n;
+        
+        if (s_pipeline_fill_len == OTA_PIPELINE_BUFFER_SIZE) {
+            ota_pipeline_submit();
+        }
+    }
+    return !s_pipeline_failed;
+}
+
+esp_ota_handle_t ota_manager_pipeline_end(void)
+{
+    if (s_pipeline_full == NULL) {
+        return 0;
+    }
+    bool ok = ota_pipeline_stop();
+    esp_ota_handle_t handle = s_pipeline_handle;
+    s_pipeline_handle = 0;
+    return ok ? handle : 0;
+}
+
+void ota_manager_pipeline_abort(void)
+{
+    if (s_pipeline_full == NULL) {
+        return;
+    }
+    s_pipeline_discard = true;
+    bool ok = ota_pipeline_stop();
+    esp_ota_handle_t handle = s_pipeline_handle;
+    s_pipeline_handle = 0;
+    if (ok) {
+        // A failed write has already aborted the handle and set the status
+        esp_ota_abort(handle);
+        xSemaphoreTake(s_ota_mutex, portMAX_DELAY);
+        s_ota_status.status = OTA_STATUS_ERROR;
+        strcpy(s_ota_status.message, "Upload aborted");
+        s_update_partition = NULL;
+        s_streaming_total_bytes = 0;
+        s_streaming_expected_size = 0;
+        xSemaphoreGive(s_ota_mutex);
+    }
+}
@@ -53,6 +53,19 @@ bool system_modbus_enabled_load(void);
  */
 bool system_modbus_enabled_save(bool enabled);
 
+/**
+ * @brief Load the word order of 32-bit Modbus register values
+ * @return 0 = high word first (default), 1 = low word first
+ */
+uint8_t system_modbus_word_order_load(void);
+
+/**
+ * @brief Save the word order of 32-bit Modbus register values
+ * @param word_order 0 = high word first, 1 = low word first
+ * @return true on success, false on error or invalid value
+ */
+bool system_modbus_word_order_save(uint8_t word_order);
+
 /**
  * @brief Load VL53L1x sensor enabled state from NVS
  * @return true if sensor is enabled, false if disabled or not set
@@ -262,6 +275,141 @@ uint8_t system_nau7802_average_load(void);
  */
 bool system_nau7802_average_save(uint8_t average);
 
+/*
+ * Configuration cache
+ *
+ * All settings above are stored together as one CRC-protected, schema-versioned
+ * record (a single NVS blob). system_config_init() reads it once at boot,
+ * migrating the per-key layout of older firmware on first use, and keeps it in
+ * RAM. The *_load() functions return the cached value without touching flash
+ * or taking a lock, so they are safe to call from periodic tasks.
+ *
+ * Each *_save() is a one-field transaction. To change several settings with a
+ * single flash write, use system_config_begin() / system_config_commit().
+ * A commit that changes nothing does not write to flash; otherwise the record
+ * is rewritten, the cache updated and subscribers notified once per changed
+ * field.
+ */
+
+/**
+ * @brief Identifies a cached setting in change notifications
+ */
+typedef enum {
+    SYSTEM_CONFIG_FIELD_IP = 0,
+    SYSTEM_CONFIG_FIELD_MODBUS_ENABLED,
+    SYSTEM_CONFIG_FIELD_SENSOR_ENABLED,
+    SYSTEM_CONFIG_FIELD_SENSOR_BYTE_OFFSET,
+    SYSTEM_CONFIG_FIELD_MCP_ENABLED,
+    SYSTEM_CONFIG_FIELD_MCP_DEVICE_TYPE,
+    SYSTEM_CONFIG_FIELD_MCP_UPDATE_RATE,
+    SYSTEM_CONFIG_FIELD_I2C_PULLUP,
+    SYSTEM_CONFIG_FIELD_NAU7802_ENABLED,
+    SYSTEM_CONFIG_FIELD_NAU7802_BYTE_OFFSET,
+    SYSTEM_CONFIG_FIELD_NAU7802_CAL_FACTOR,
+    SYSTEM_CONFIG_FIELD_NAU7802_ZERO_OFFSET,
+    SYSTEM_CONFIG_FIELD_NAU7802_UNIT,
+    SYSTEM_CONFIG_FIELD_NAU7802_GAIN,
+    SYSTEM_CONFIG_FIELD_NAU7802_SAMPLE_RATE,
+    SYSTEM_CONFIG_FIELD_NAU7802_CHANNEL,
+    SYSTEM_CONFIG_FIELD_NAU7802_LDO,
+    SYSTEM_CONFIG_FIELD_NAU7802_AVERAGE,
+    SYSTEM_CONFIG_FIELD_MODBUS_WORD_ORDER,
+    SYSTEM_CONFIG_FIELD_COUNT
+} system_config_field_t;
+
+/** Bit for @p field in a changed-field mask */
+#define SYSTEM_CONFIG_FIELD_BIT(field) (1UL << (field))
+
+/**
+ * @brief Snapshot of all cached settings
+ */
+typedef struct {
+    system_ip_config_t ip;
+    bool ip_from_nvs;               // false if ip holds defaults
+    bool modbus_enabled;
+    bool sensor_enabled;
+    uint8_t sensor_byte_offset;
+    bool mcp_enabled;
+    uint8_t mcp_device_type;
+    uint16_t mcp_update_rate_ms;
+    bool i2c_internal_pullup;
+    bool nau7802_enabled;
+    uint8_t nau7802_byte_offset;
+    float nau7802_calibration_factor;
+    float nau7802_zero_offset;
+    uint8_t nau7802_unit;
+    uint8_t nau7802_gain;
+    uint8_t nau7802_sample_rate;
+    uint8_t nau7802_channel;
+    uint8_t nau7802_ldo;
+    uint8_t nau7802_average;
+    uint8_t modbus_word_order;      // 0 = high word first, 1 = low word first
+} system_config_t;
+
+/**
+ * @brief Change notification callback
+ *
+ * Called after the new value is in the cache and committed to NVS, in the
+ * context of the task that saved it. Keep it short (set a flag, notify a
+ * task); calling *_save() from a listener is allowed.
+ *
+ * @param field Setting that changed
+ * @param ctx Context pointer passed to system_config_subscribe()
+ */
+typedef void (*system_config_listener_t)(system_config_field_t field, void *ctx);
+
+/**
+ * @brief Load all settings from NVS into the cache
+ *
+ * Call once after nvs_flash_init(). Accessors called earlier initialize the
+ * cache on first use.
+ */
+void system_config_init(void);
+
+/**
+ * @brief Start a configuration transaction
+ *
+ * Blocks other writers until system_config_commit() or system_config_abort()
+ * and returns a working copy of the current settings to modify. Readers keep
+ * seeing the old values until the commit.
+ *
+ * @return Working copy (valid until commit/abort)
+ */
+system_config_t *system_config_begin(void);
+
+/**
+ * @brief Validate and persist the working copy, then end the transaction
+ * @return true on success (or if nothing changed), false if a value is out of
+ *         range or the NVS write failed; the stored settings are unchanged then
+ */
+bool system_config_commit(void);
+
+/**
+ * @brief Discard the working copy and end the transaction
+ */
+void system_config_abort(void);
+
+/**
+ * @brief Copy a consistent snapshot of all settings
+ * @param config Destination
+ */
+void system_config_get(system_config_t *config);
+
+/**
+ * @brief Configuration version, incremented on every change
+ *
+ * Lets pollers detect a change with a single load instead of comparing values.
+ */
+uint32_t system_config_version(void);
+
+/**
+ * @brief Register a change listener
+ * @param listener Callback
+ * @param ctx Passed back to the callback
+ * @return true on success, false if the listener table is full
+ */
+bool system_config_subscribe(system_config_listener_t listener, void *ctx);
+
 #ifdef __cplusplus
 }
 #endif
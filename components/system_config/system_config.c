@@ -20,33 +20,107 @@
  * THE SOFTWARE.
  */
 
+
 #include "system_config.h"
+#include "system_config_legacy.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
 #include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdatomic.h>
+#include <stddef.h>
 #include <string.h>
 
 static const char *TAG = "system_config";
 static const char *NVS_NAMESPACE = "system";
-static const char *NVS_KEY_IPCONFIG = "ipconfig";
-static const char *NVS_KEY_MODBUS_ENABLED = "modbus_enabled";
-static const char *NVS_KEY_SENSOR_ENABLED = "sensor_enabled";
-static const char *NVS_KEY_SENSOR_BYTE_OFFSET = "sens_byte_off";
-static const char *NVS_KEY_MCP_ENABLED = "mcp_enabled";
-static const char *NVS_KEY_MCP_DEVICE_TYPE = "mcp_dev_type";  // 0 = MCP23017, 1 = MCP23008
-static const char *NVS_KEY_MCP_UPDATE_RATE_MS = "mcp_upd_rate";  // Update rate in milliseconds
-static const char *NVS_KEY_I2C_INTERNAL_PULLUP = "i2c_pullup";
-static const char *NVS_KEY_NAU7802_ENABLED = "nau7802_enabled";
-static const char *NVS_KEY_NAU7802_BYTE_OFFSET = "nau7802_off";
-static const char *NVS_KEY_NAU7802_CAL_FACTOR = "nau7802_cal";
-static const char *NVS_KEY_NAU7802_ZERO_OFFSET = "nau7802_zero";
-static const char *NVS_KEY_NAU7802_UNIT = "nau7802_unit";  // 0=grams, 1=lbs, 2=kg
-static const char *NVS_KEY_NAU7802_GAIN = "nau7802_gain";  // 0-7 (x1-x128)
-static const char *NVS_KEY_NAU7802_SAMPLE_RATE = "nau7802_sps";  // 0,1,2,3,7 (10,20,40,80,320 SPS)
-static const char *NVS_KEY_NAU7802_CHANNEL = "nau7802_chan";  // 0=Channel 1, 1=Channel 2
-static const char *NVS_KEY_NAU7802_LDO = "nau7802_ldo";  // 0-7 (2.4V-4.5V)
-static const char *NVS_KEY_NAU7802_AVERAGE = "nau7802_avg";  // 1-50 samples for regular readings
+static const char *NVS_KEY_RECORD = "config";
+
+#define CONFIG_MAX_LISTENERS 8
+
+#define CONFIG_RECORD_MAGIC      0x47464353u  // "SCFG"
+#define CONFIG_SCHEMA_VERSION    2
+#define CONFIG_RECORD_MAX_SIZE   256          // Largest record accepted from a newer firmware
+
+// Persistent configuration record, stored as a single NVS blob.
+//
+// The layout is append-only: new settings are added at the end and the schema
+// version bumped. An older record is read by copying the bytes it has over a
+// record filled with defaults, so fields it does not contain keep their
+// defaults. The CRC covers everything after the crc32 field, up to length.
+typedef struct {
+    uint32_t magic;
+    uint16_t schema_version;
+    uint16_t length;                // Size of the stored record in bytes
+    uint32_t crc32;
+    uint32_t generation;            // Incremented on every commit
+    // Schema version 1
+    uint32_t ip_address;
+    uint32_t netmask;
+    uint32_t gateway;
+    uint32_t dns1;
+    uint32_t dns2;
+    float nau7802_calibration_factor;
+    float nau7802_zero_offset;
+    uint16_t mcp_update_rate_ms;
+    uint8_t ip_use_dhcp;
+    uint8_t ip_saved;
+    uint8_t modbus_enabled;
+    uint8_t sensor_enabled;
+    uint8_t sensor_byte_offset;
+    uint8_t mcp_enabled;
+    uint8_t mcp_device_type;
+    uint8_t i2c_internal_pullup;
+    uint8_t nau7802_enabled;
+    uint8_t nau7802_byte_offset;
+    uint8_t nau7802_unit;
+    uint8_t nau7802_gain;
+    uint8_t nau7802_sample_rate;
+    uint8_t nau7802_channel;
+    uint8_t nau7802_ldo;
+    uint8_t nau7802_average;
+    uint8_t reserved[2];
+    // Schema version 2
+    uint8_t modbus_word_order;
+    uint8_t reserved_v2[3];
+} config_record_t;
+
+_Static_assert(sizeof(config_record_t) == 68, "config_record_t layout changed");
+_Static_assert(sizeof(config_record_t) <= CONFIG_RECORD_MAX_SIZE, "config_record_t too large");
+
+#define CONFIG_RECORD_CRC_START offsetof(config_record_t, generation)
+
+typedef struct {
+    system_config_listener_t listener;
+    void *ctx;
+} config_subscriber_t;
+
+// In-RAM copy of every setting. Writers are serialized by s_config_write_mutex
+// and bracket their update with two increments of s_config_seq (odd while a
+// write is in progress), so readers can take a consistent snapshot without
+// locking. The update runs in a critical section, so a higher-priority reader
+// on the same core cannot preempt it and spin on an odd sequence forever.
+// Single fields are naturally aligned and read directly.
+static system_config_t s_config;
+static atomic_uint s_config_seq;
+static portMUX_TYPE s_config_lock = portMUX_INITIALIZER_UNLOCKED;
+static atomic_bool s_config_ready;
+static SemaphoreHandle_t s_config_write_mutex = NULL;
+static StaticSemaphore_t s_config_write_mutex_buffer;
+static config_subscriber_t s_subscribers[CONFIG_MAX_LISTENERS];
+static atomic_uint s_subscriber_count;
+
+// Working copy for the open transaction (owned by the holder of s_config_write_mutex)
+static system_config_t s_pending;
+static uint32_t s_generation = 0;
+
+static bool config_cache_ready(void)
+{
+    return atomic_load_explicit(&s_config_ready, memory_order_acquire);
+}
 
 void system_ip_config_get_defaults(system_ip_config_t *config)
 {
@@ -59,1214 +133,671 @@ void system_ip_config_get_defaults(system_ip_config_t *config)
     // All other fields are 0 (DHCP will assign)
 }
 
-bool system_ip_config_load(system_ip_config_t *config)
+static void config_get_defaults(system_config_t *config)
 {
-    if (config == NULL) {
+    memset(config, 0, sizeof(*config));
+    system_ip_config_get_defaults(&config->ip);
+    config->mcp_device_type = 1;           // MCP23008
+    config->mcp_update_rate_ms = 20;       // 50 Hz
+#ifdef CONFIG_OPENER_I2C_INTERNAL_PULLUP
+    config->i2c_internal_pullup = CONFIG_OPENER_I2C_INTERNAL_PULLUP;
+#endif
+    config->nau7802_unit = 1;              // lbs
+    config->nau7802_gain = 7;              // x128
+    config->nau7802_sample_rate = 3;       // 80 SPS
+    config->nau7802_channel = 0;           // Channel 1
+    config->nau7802_ldo = 4;               // 3.3V
+    config->nau7802_average = 1;           // No averaging
+}
+
+static bool config_validate(const system_config_t *config)
+{
+    // Assembly 100 is 32 bytes and the NAU7802 data is 10 bytes (4 weight + 4 raw + 1 unit + 1 status)
+    const uint8_t nau7802_max_offset = 32 - 10;
+
+    if (config->sensor_byte_offset != 0 && config->sensor_byte_offset != 9 &&
+        config->sensor_byte_offset != 18) {
+        ESP_LOGE(TAG, "Invalid sensor byte offset: %d (must be 0, 9, or 18)", config->sensor_byte_offset);
         return false;
     }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved IP configuration found, using defaults");
-            system_ip_config_get_defaults(config);
-            return false;
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
+    if (config->mcp_device_type > 1) {
+        ESP_LOGE(TAG, "Invalid MCP device type: %d (must be 0=MCP23017 or 1=MCP23008)", config->mcp_device_type);
         return false;
     }
-    
-    size_t required_size = sizeof(system_ip_config_t);
-    err = nvs_get_blob(handle, NVS_KEY_IPCONFIG, config, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved IP configuration found, using defaults");
-        system_ip_config_get_defaults(config);
+    if (config->mcp_update_rate_ms < 10 || config->mcp_update_rate_ms > 1000) {
+        ESP_LOGE(TAG, "Invalid MCP update rate %d ms (must be 10-1000ms)", config->mcp_update_rate_ms);
         return false;
     }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load IP configuration: %s", esp_err_to_name(err));
+    if (config->nau7802_byte_offset > nau7802_max_offset) {
+        ESP_LOGE(TAG, "Invalid NAU7802 byte offset %d (must be 0-%d)", config->nau7802_byte_offset, nau7802_max_offset);
         return false;
     }
-    
-    if (required_size != sizeof(system_ip_config_t)) {
-        ESP_LOGW(TAG, "IP configuration size mismatch (expected %zu, got %zu), using defaults",
-                 sizeof(system_ip_config_t), required_size);
-        system_ip_config_get_defaults(config);
+    if (config->nau7802_unit > 2) {
+        ESP_LOGE(TAG, "Invalid NAU7802 unit %d (must be 0=grams, 1=lbs, or 2=kg)", config->nau7802_unit);
         return false;
     }
-    
-    ESP_LOGI(TAG, "IP configuration loaded successfully from NVS (DHCP=%s)", 
-             config->use_dhcp ? "enabled" : "disabled");
-    return true;
-}
-
-bool system_ip_config_save(const system_ip_config_t *config)
-{
-    if (config == NULL) {
+    if (config->nau7802_gain > 7) {
+        ESP_LOGE(TAG, "Invalid NAU7802 gain value: %d (must be 0-7)", config->nau7802_gain);
         return false;
     }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
+    if (config->nau7802_sample_rate > 3 && config->nau7802_sample_rate != 7) {
+        ESP_LOGE(TAG, "Invalid NAU7802 sample rate value: %d (must be 0, 1, 2, 3, or 7)", config->nau7802_sample_rate);
         return false;
     }
-    
-    err = nvs_set_blob(handle, NVS_KEY_IPCONFIG, config, sizeof(system_ip_config_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save IP configuration: %s", esp_err_to_name(err));
-        nvs_close(handle);
+    if (config->nau7802_channel > 1) {
+        ESP_LOGE(TAG, "Invalid NAU7802 channel value: %d (must be 0 or 1)", config->nau7802_channel);
         return false;
     }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit IP configuration: %s", esp_err_to_name(err));
+    if (config->nau7802_ldo > 7) {
+        ESP_LOGE(TAG, "Invalid NAU7802 LDO value: %d (must be 0-7)", config->nau7802_ldo);
+        return false;
+    }
+    if (config->nau7802_average < 1 || config->nau7802_average > 50) {
+        ESP_LOGE(TAG, "Invalid NAU7802 average value: %d (must be 1-50)", config->nau7802_average);
+        return false;
+    }
+    if (config->modbus_word_order > 1) {
+        ESP_LOGE(TAG, "Invalid Modbus word order: %d (must be 0=high word first or 1=low word first)",
+                 config->modbus_word_order);
         return false;
     }
-    
-    ESP_LOGI(TAG, "IP configuration saved successfully to NVS");
     return true;
 }
 
-bool system_modbus_enabled_load(void)
+// Bitmask of SYSTEM_CONFIG_FIELD_* that differ between two configurations
+static uint32_t config_diff(const system_config_t *a, const system_config_t *b)
+{
+    uint32_t changed = 0;
+
+#define CONFIG_DIFF(member, field) \
+    if (a->member != b->member) { changed |= SYSTEM_CONFIG_FIELD_BIT(field); }
+
+    if (memcmp(&a->ip, &b->ip, sizeof(a->ip)) != 0 || a->ip_from_nvs != b->ip_from_nvs) {
+        changed |= SYSTEM_CONFIG_FIELD_BIT(SYSTEM_CONFIG_FIELD_IP);
+    }
+    CONFIG_DIFF(modbus_enabled, SYSTEM_CONFIG_FIELD_MODBUS_ENABLED);
+    CONFIG_DIFF(sensor_enabled, SYSTEM_CONFIG_FIELD_SENSOR_ENABLED);
+    CONFIG_DIFF(sensor_byte_offset, SYSTEM_CONFIG_FIELD_SENSOR_BYTE_OFFSET);
+    CONFIG_DIFF(mcp_enabled, SYSTEM_CONFIG_FIELD_MCP_ENABLED);
+    CONFIG_DIFF(mcp_device_type, SYSTEM_CONFIG_FIELD_MCP_DEVICE_TYPE);
+    CONFIG_DIFF(mcp_update_rate_ms, SYSTEM_CONFIG_FIELD_MCP_UPDATE_RATE);
+    CONFIG_DIFF(i2c_internal_pullup, SYSTEM_CONFIG_FIELD_I2C_PULLUP);
+    CONFIG_DIFF(nau7802_enabled, SYSTEM_CONFIG_FIELD_NAU7802_ENABLED);
+    CONFIG_DIFF(nau7802_byte_offset, SYSTEM_CONFIG_FIELD_NAU7802_BYTE_OFFSET);
+    CONFIG_DIFF(nau7802_calibration_factor, SYSTEM_CONFIG_FIELD_NAU7802_CAL_FACTOR);
+    CONFIG_DIFF(nau7802_zero_offset, SYSTEM_CONFIG_FIELD_NAU7802_ZERO_OFFSET);
+    CONFIG_DIFF(nau7802_unit, SYSTEM_CONFIG_FIELD_NAU7802_UNIT);
+    CONFIG_DIFF(nau7802_gain, SYSTEM_CONFIG_FIELD_NAU7802_GAIN);
+    CONFIG_DIFF(nau7802_sample_rate, SYSTEM_CONFIG_FIELD_NAU7802_SAMPLE_RATE);
+    CONFIG_DIFF(nau7802_channel, SYSTEM_CONFIG_FIELD_NAU7802_CHANNEL);
+    CONFIG_DIFF(nau7802_ldo, SYSTEM_CONFIG_FIELD_NAU7802_LDO);
+    CONFIG_DIFF(nau7802_average, SYSTEM_CONFIG_FIELD_NAU7802_AVERAGE);
+    CONFIG_DIFF(modbus_word_order, SYSTEM_CONFIG_FIELD_MODBUS_WORD_ORDER);
+
+#undef CONFIG_DIFF
+    return changed;
+}
+
+static uint32_t config_record_crc(const config_record_t *record, size_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)record;
+    return esp_rom_crc32_le(0, bytes + CONFIG_RECORD_CRC_START, length - CONFIG_RECORD_CRC_START);
+}
+
+static void config_encode(const system_config_t *config, uint32_t generation, config_record_t *record)
+{
+    memset(record, 0, sizeof(*record));
+    record->magic = CONFIG_RECORD_MAGIC;
+    record->schema_version = CONFIG_SCHEMA_VERSION;
+    record->length = sizeof(*record);
+    record->generation = generation;
+    record->ip_address = config->ip.ip_address;
+    record->netmask = config->ip.netmask;
+    record->gateway = config->ip.gateway;
+    record->dns1 = config->ip.dns1;
+    record->dns2 = config->ip.dns2;
+    record->nau7802_calibration_factor = config->nau7802_calibration_factor;
+    record->nau7802_zero_offset = config->nau7802_zero_offset;
+    record->mcp_update_rate_ms = config->mcp_update_rate_ms;
+    record->ip_use_dhcp = config->ip.use_dhcp;
+    record->ip_saved = config->ip_from_nvs;
+    record->modbus_enabled = config->modbus_enabled;
+    record->sensor_enabled = config->sensor_enabled;
+    record->sensor_byte_offset = config->sensor_byte_offset;
+    record->mcp_enabled = config->mcp_enabled;
+    record->mcp_device_type = config->mcp_device_type;
+    record->i2c_internal_pullup = config->i2c_internal_pullup;
+    record->nau7802_enabled = config->nau7802_enabled;
+    record->nau7802_byte_offset = config->nau7802_byte_offset;
+    record->nau7802_unit = config->nau7802_unit;
+    record->nau7802_gain = config->nau7802_gain;
+    record->nau7802_sample_rate = config->nau7802_sample_rate;
+    record->nau7802_channel = config->nau7802_channel;
+    record->nau7802_ldo = config->nau7802_ldo;
+    record->nau7802_average = config->nau7802_average;
+    record->modbus_word_order = config->modbus_word_order;
+    record->crc32 = config_record_crc(record, sizeof(*record));
+}
+
+static void config_decode(const config_record_t *record, system_config_t *config)
+{
+    config->ip.ip_address = record->ip_address;
+    config->ip.netmask = record->netmask;
+    config->ip.gateway = record->gateway;
+    config->ip.dns1 = record->dns1;
+    config->ip.dns2 = record->dns2;
+    config->ip.use_dhcp = record->ip_use_dhcp != 0;
+    config->ip_from_nvs = record->ip_saved != 0;
+    config->nau7802_calibration_factor = record->nau7802_calibration_factor;
+    config->nau7802_zero_offset = record->nau7802_zero_offset;
+    config->mcp_update_rate_ms = record->mcp_update_rate_ms;
+    config->modbus_enabled = record->modbus_enabled != 0;
+    config->sensor_enabled = record->sensor_enabled != 0;
+    config->sensor_byte_offset = record->sensor_byte_offset;
+    config->mcp_enabled = record->mcp_enabled != 0;
+    config->mcp_device_type = record->mcp_device_type;
+    config->i2c_internal_pullup = record->i2c_internal_pullup != 0;
+    config->nau7802_enabled = record->nau7802_enabled != 0;
+    config->nau7802_byte_offset = record->nau7802_byte_offset;
+    config->nau7802_unit = record->nau7802_unit;
+    config->nau7802_gain = record->nau7802_gain;
+    config->nau7802_sample_rate = record->nau7802_sample_rate;
+    config->nau7802_channel = record->nau7802_channel;
+    config->nau7802_ldo = record->nau7802_ldo;
+    config->nau7802_average = record->nau7802_average;
+    config->modbus_word_order = record->modbus_word_order;
+}
+
+// Read the configuration record. Returns ESP_ERR_NVS_NOT_FOUND if there is
+// none, ESP_ERR_INVALID_CRC / ESP_ERR_INVALID_VERSION if it is unusable.
+static esp_err_t config_record_read(system_config_t *config, uint16_t *schema_version)
 {
     nvs_handle_t handle;
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
     if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved Modbus enabled state found, defaulting to disabled");
-            return false;  // Default to disabled
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;  // Default to disabled on error
+        return err;
     }
-    
-    uint8_t enabled = 0;  // Default to disabled
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_MODBUS_ENABLED, &enabled, &required_size);
+
+    uint8_t buffer[CONFIG_RECORD_MAX_SIZE];
+    size_t size = sizeof(buffer);
+    err = nvs_get_blob(handle, NVS_KEY_RECORD, buffer, &size);
     nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved Modbus enabled state found, defaulting to disabled");
-        return false;  // Default to disabled
+    if (err == ESP_ERR_NVS_INVALID_LENGTH) {
+        ESP_LOGE(TAG, "Configuration record larger than %d bytes", CONFIG_RECORD_MAX_SIZE);
+        return ESP_ERR_INVALID_VERSION;
     }
-    
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load Modbus enabled state: %s", esp_err_to_name(err));
-        return false;  // Default to disabled on error
+        return err;
     }
-    
-    ESP_LOGI(TAG, "Modbus enabled state loaded from NVS: %s", enabled ? "enabled" : "disabled");
-    return enabled != 0;
+
+    config_record_t header;
+    if (size < CONFIG_RECORD_CRC_START + sizeof(header.generation)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(&header, buffer, CONFIG_RECORD_CRC_START + sizeof(header.generation));
+    if (header.magic != CONFIG_RECORD_MAGIC || header.length != size) {
+        ESP_LOGE(TAG, "Configuration record header invalid (magic 0x%08lx, length %u, stored %u)",
+                 (unsigned long)header.magic, header.length, (unsigned)size);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    uint32_t crc = esp_rom_crc32_le(0, buffer + CONFIG_RECORD_CRC_START, size - CONFIG_RECORD_CRC_START);
+    if (crc != header.crc32) {
+        ESP_LOGE(TAG, "Configuration record CRC mismatch (stored 0x%08lx, computed 0x%08lx)",
+                 (unsigned long)header.crc32, (unsigned long)crc);
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    // Bytes beyond what this version stored keep their defaults
+    system_config_t defaults;
+    config_record_t record;
+    config_get_defaults(&defaults);
+    config_encode(&defaults, 0, &record);
+    memcpy(&record, buffer, size < sizeof(record) ? size : sizeof(record));
+
+    config_get_defaults(config);
+    config_decode(&record, config);
+    s_generation = record.generation;
+    *schema_version = record.schema_version;
+    return ESP_OK;
 }
 
-bool system_modbus_enabled_save(bool enabled)
+static esp_err_t config_record_write(const system_config_t *config, uint32_t generation)
 {
+    config_record_t record;
+    config_encode(config, generation, &record);
+
     nvs_handle_t handle;
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
+        return err;
     }
-    
-    uint8_t enabled_val = enabled ? 1 : 0;
-    err = nvs_set_blob(handle, NVS_KEY_MODBUS_ENABLED, &enabled_val, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save Modbus enabled state: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
+
+    // NVS replaces a blob atomically: the previous record stays valid until
+    // the new one is completely written
+    err = nvs_set_blob(handle, NVS_KEY_RECORD, &record, sizeof(record));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
     }
-    
-    err = nvs_commit(handle);
     nvs_close(handle);
-    
+
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit Modbus enabled state: %s", esp_err_to_name(err));
-        return false;
+        ESP_LOGE(TAG, "Failed to save configuration record: %s", esp_err_to_name(err));
     }
-    
-    ESP_LOGI(TAG, "Modbus enabled state saved successfully to NVS: %s", enabled ? "enabled" : "disabled");
-    return true;
+    return err;
 }
 
-bool system_sensor_enabled_load(void)
+void system_config_init(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved sensor enabled state found, defaulting to disabled");
-            return false;  // Default to disabled
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;  // Default to disabled on error
+    if (config_cache_ready()) {
+        return;
     }
-    
-    uint8_t enabled = 0;  // Default to disabled
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_SENSOR_ENABLED, &enabled, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved sensor enabled state found, defaulting to disabled");
-        return false;  // Default to disabled
+
+    if (s_config_write_mutex == NULL) {
+        s_config_write_mutex = xSemaphoreCreateMutexStatic(&s_config_write_mutex_buffer);
     }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load sensor enabled state: %s", esp_err_to_name(err));
-        return false;  // Default to disabled on error
+
+    int64_t start_us = esp_timer_get_time();
+    system_config_t config;
+    uint16_t schema_version = 0;
+    esp_err_t err = config_record_read(&config, &schema_version);
+    bool rewrite = false;
+    bool migrate = false;
+
+    if (err == ESP_OK) {
+        if (schema_version < CONFIG_SCHEMA_VERSION) {
+            ESP_LOGI(TAG, "Upgrading configuration record from schema %u to %u",
+                     schema_version, CONFIG_SCHEMA_VERSION);
+            rewrite = true;
+        } else if (schema_version > CONFIG_SCHEMA_VERSION) {
+            ESP_LOGW(TAG, "Configuration record schema %u is newer than %u, unknown settings ignored",
+                     schema_version, CONFIG_SCHEMA_VERSION);
+        }
+        if (!config_validate(&config)) {
+            ESP_LOGW(TAG, "Configuration record contains invalid settings, using defaults");
+            config_get_defaults(&config);
+            rewrite = true;
+        }
+    } else if (err == ESP_ERR_NVS_NOT_FOUND) {
+        // First boot after an upgrade from per-key settings (or a blank device)
+        ESP_LOGI(TAG, "No configuration record, migrating per-key settings");
+        system_config_legacy_load(&config);
+        if (!config_validate(&config)) {
+            config_get_defaults(&config);
+        }
+        migrate = true;
+        rewrite = true;
+    } else {
+        // The per-key settings are whatever the device had before its first
+        // record was written, so they are no substitute for a damaged record
+        ESP_LOGE(TAG, "Configuration record unusable (%s), all settings reset to defaults",
+                 esp_err_to_name(err));
+        config_get_defaults(&config);
+        rewrite = true;
+    }
+
+    if (rewrite && config_record_write(&config, s_generation + 1) == ESP_OK) {
+        s_generation++;
+        if (migrate) {
+            system_config_legacy_erase();
+        }
     }
-    
-    ESP_LOGI(TAG, "Sensor enabled state loaded from NVS: %s", enabled ? "enabled" : "disabled");
-    return enabled != 0;
+
+    s_config = config;
+    atomic_store_explicit(&s_config_ready, true, memory_order_release);
+    ESP_LOGI(TAG, "Configuration loaded in %lld us (generation %lu%s)",
+             (long long)(esp_timer_get_time() - start_us), (unsigned long)s_generation,
+             rewrite ? ", record written" : "");
 }
 
-bool system_sensor_enabled_save(bool enabled)
+void system_config_get(system_config_t *config)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    uint8_t enabled_val = enabled ? 1 : 0;
-    err = nvs_set_blob(handle, NVS_KEY_SENSOR_ENABLED, &enabled_val, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save sensor enabled state: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
+    if (config == NULL) {
+        return;
     }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit sensor enabled state: %s", esp_err_to_name(err));
-        return false;
+    if (!config_cache_ready()) {
+        system_config_init();
     }
-    
-    ESP_LOGI(TAG, "Sensor enabled state saved successfully to NVS: %s", enabled ? "enabled" : "disabled");
-    return true;
+
+    unsigned int seq;
+    do {
+        seq = atomic_load_explicit(&s_config_seq, memory_order_acquire);
+        memcpy(config, &s_config, sizeof(*config));
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) != 0 || seq != atomic_load_explicit(&s_config_seq, memory_order_relaxed));
 }
 
-uint8_t system_sensor_byte_offset_load(void)
+uint32_t system_config_version(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved sensor byte offset found, defaulting to 0");
-            return 0;  // Default to 0
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return 0;  // Default to 0 on error
-    }
-    
-    uint8_t start_byte = 0;  // Default to 0
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_SENSOR_BYTE_OFFSET, &start_byte, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved sensor byte offset found, defaulting to 0");
-        return 0;  // Default to 0
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load sensor byte offset: %s", esp_err_to_name(err));
-        return 0;  // Default to 0 on error
-    }
-    
-    // Validate: must be 0, 9, or 18
-    if (start_byte != 0 && start_byte != 9 && start_byte != 18) {
-        ESP_LOGW(TAG, "Invalid sensor byte offset %d found in NVS, defaulting to 0", start_byte);
-        return 0;
-    }
-    
-    ESP_LOGI(TAG, "Sensor byte offset loaded from NVS: %d (bytes %d-%d)", start_byte, start_byte, start_byte + 8);
-    return start_byte;
+    return atomic_load_explicit(&s_config_seq, memory_order_acquire) >> 1;
 }
 
-bool system_sensor_byte_offset_save(uint8_t start_byte)
+bool system_config_subscribe(system_config_listener_t listener, void *ctx)
 {
-    // Validate: must be 0, 9, or 18
-    if (start_byte != 0 && start_byte != 9 && start_byte != 18) {
-        ESP_LOGE(TAG, "Invalid sensor byte offset: %d (must be 0, 9, or 18)", start_byte);
+    if (listener == NULL) {
         return false;
     }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
+    if (!config_cache_ready()) {
+        system_config_init();
     }
-    
-    err = nvs_set_blob(handle, NVS_KEY_SENSOR_BYTE_OFFSET, &start_byte, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save sensor byte offset: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
+
+    xSemaphoreTake(s_config_write_mutex, portMAX_DELAY);
+    unsigned int count = atomic_load_explicit(&s_subscriber_count, memory_order_relaxed);
+    bool ok = count < CONFIG_MAX_LISTENERS;
+    if (ok) {
+        s_subscribers[count].listener = listener;
+        s_subscribers[count].ctx = ctx;
+        atomic_store_explicit(&s_subscriber_count, count + 1, memory_order_release);
     }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit sensor byte offset: %s", esp_err_to_name(err));
-        return false;
+    xSemaphoreGive(s_config_write_mutex);
+
+    if (!ok) {
+        ESP_LOGE(TAG, "Too many configuration listeners (max %d)", CONFIG_MAX_LISTENERS);
     }
-    
-    ESP_LOGI(TAG, "Sensor byte offset saved successfully to NVS: %d (bytes %d-%d)", start_byte, start_byte, start_byte + 8);
-    return true;
+    return ok;
 }
 
-bool system_mcp_enabled_load(void)
+system_config_t *system_config_begin(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved MCP enabled state found, defaulting to disabled");
-            return false;
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
+    if (!config_cache_ready()) {
+        system_config_init();
     }
+    xSemaphoreTake(s_config_write_mutex, portMAX_DELAY);
+    s_pending = s_config;
+    return &s_pending;
+}
 
-    uint8_t enabled = 0;
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_MCP_ENABLED, &enabled, &required_size);
-    nvs_close(handle);
+void system_config_abort(void)
+{
+    xSemaphoreGive(s_config_write_mutex);
+}
 
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved MCP enabled state found, defaulting to disabled");
+bool system_config_commit(void)
+{
+    if (!config_validate(&s_pending)) {
+        xSemaphoreGive(s_config_write_mutex);
         return false;
     }
 
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load MCP enabled state: %s", esp_err_to_name(err));
-        return false;
+    uint32_t changed = config_diff(&s_config, &s_pending);
+    if (changed == 0) {
+        xSemaphoreGive(s_config_write_mutex);
+        return true;  // Nothing changed, skip the flash write
     }
 
-    ESP_LOGI(TAG, "MCP enabled state loaded from NVS: %s", enabled ? "enabled" : "disabled");
-    return enabled != 0;
-}
-
-bool system_mcp_enabled_save(bool enabled)
-{
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
+    if (config_record_write(&s_pending, s_generation + 1) != ESP_OK) {
+        xSemaphoreGive(s_config_write_mutex);
         return false;
     }
+    s_generation++;
 
-    uint8_t enabled_val = enabled ? 1 : 0;
-    err = nvs_set_blob(handle, NVS_KEY_MCP_ENABLED, &enabled_val, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save MCP enabled state: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
+    portENTER_CRITICAL(&s_config_lock);
+    atomic_fetch_add_explicit(&s_config_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    s_config = s_pending;
+    atomic_fetch_add_explicit(&s_config_seq, 1, memory_order_release);
+    portEXIT_CRITICAL(&s_config_lock);
+    xSemaphoreGive(s_config_write_mutex);
 
-    err = nvs_commit(handle);
-    nvs_close(handle);
+    ESP_LOGI(TAG, "Configuration saved (generation %lu, changed fields 0x%05lx)",
+             (unsigned long)s_generation, (unsigned long)changed);
 
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit MCP enabled state: %s", esp_err_to_name(err));
-        return false;
+    unsigned int count = atomic_load_explicit(&s_subscriber_count, memory_order_acquire);
+    for (int field = 0; field < SYSTEM_CONFIG_FIELD_COUNT; field++) {
+        if ((changed & SYSTEM_CONFIG_FIELD_BIT(field)) == 0) {
+            continue;
+        }
+        for (unsigned int i = 0; i < count; i++) {
+            s_subscribers[i].listener((system_config_field_t)field, s_subscribers[i].ctx);
+        }
     }
-
-    ESP_LOGI(TAG, "MCP enabled state saved successfully to NVS: %s", enabled ? "enabled" : "disabled");
     return true;
 }
 
-uint8_t system_mcp_device_type_load(void)
+// Cached accessors
+
+static const system_config_t *config_cache(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved MCP device type found, defaulting to MCP23008");
-            return 1;  // Default to MCP23008 (0 = MCP23017, 1 = MCP23008)
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return 1;  // Default to MCP23008 on error
-    }
-    
-    uint8_t device_type = 1;  // Default to MCP23008
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_MCP_DEVICE_TYPE, &device_type, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved MCP device type found, defaulting to MCP23008");
-        return 1;  // Default to MCP23008
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load MCP device type: %s", esp_err_to_name(err));
-        return 1;  // Default to MCP23008 on error
+    if (!config_cache_ready()) {
+        system_config_init();
     }
-    
-    // Validate: must be 0 (MCP23017) or 1 (MCP23008)
-    if (device_type > 1) {
-        ESP_LOGW(TAG, "Invalid MCP device type %d found in NVS, defaulting to MCP23008", device_type);
-        return 1;
-    }
-    
-    ESP_LOGI(TAG, "MCP device type loaded from NVS: %s", device_type == 0 ? "MCP23017" : "MCP23008");
-    return device_type;
+    return &s_config;
 }
 
-bool system_mcp_device_type_save(uint8_t device_type)
+bool system_ip_config_load(system_ip_config_t *config)
 {
-    // Validate: must be 0 (MCP23017) or 1 (MCP23008)
-    if (device_type > 1) {
-        ESP_LOGE(TAG, "Invalid MCP device type: %d (must be 0=MCP23017 or 1=MCP23008)", device_type);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_MCP_DEVICE_TYPE, &device_type, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save MCP device type: %s", esp_err_to_name(err));
-        nvs_close(handle);
+    if (config == NULL) {
         return false;
     }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit MCP device type: %s", esp_err_to_name(err));
+    system_config_t snapshot;
+    system_config_get(&snapshot);
+    *config = snapshot.ip;
+    return snapshot.ip_from_nvs;
+}
+
+bool system_ip_config_save(const system_ip_config_t *config)
+{
+    if (config == NULL) {
         return false;
     }
-    
-    ESP_LOGI(TAG, "MCP device type saved successfully to NVS: %s", device_type == 0 ? "MCP23017" : "MCP23008");
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->ip = *config;
+    pending->ip_from_nvs = true;
+    return system_config_commit();
 }
 
-uint16_t system_mcp_update_rate_ms_load(void)
+bool system_modbus_enabled_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved MCP update rate found, defaulting to 20ms");
-            return 20;  // Default to 20ms (50 Hz)
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return 20;  // Default to 20ms on error
-    }
-    
-    uint16_t update_rate_ms = 20;  // Default to 20ms
-    size_t required_size = sizeof(uint16_t);
-    err = nvs_get_blob(handle, NVS_KEY_MCP_UPDATE_RATE_MS, &update_rate_ms, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved MCP update rate found, defaulting to 20ms");
-        return 20;  // Default to 20ms
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load MCP update rate: %s", esp_err_to_name(err));
-        return 20;  // Default to 20ms on error
-    }
-    
-    // Validate: reasonable range 10ms to 1000ms
-    if (update_rate_ms < 10 || update_rate_ms > 1000) {
-        ESP_LOGW(TAG, "Invalid MCP update rate %d ms found in NVS, defaulting to 20ms", update_rate_ms);
-        return 20;
-    }
-    
-    ESP_LOGI(TAG, "MCP update rate loaded from NVS: %d ms (%.1f Hz)", update_rate_ms, 1000.0f / update_rate_ms);
-    return update_rate_ms;
+    return config_cache()->modbus_enabled;
 }
 
-bool system_mcp_update_rate_ms_save(uint16_t update_rate_ms)
+bool system_modbus_enabled_save(bool enabled)
 {
-    // Validate: reasonable range 10ms to 1000ms
-    if (update_rate_ms < 10 || update_rate_ms > 1000) {
-        ESP_LOGE(TAG, "Invalid MCP update rate %d ms (must be 10-1000ms)", update_rate_ms);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_MCP_UPDATE_RATE_MS, &update_rate_ms, sizeof(uint16_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save MCP update rate: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit MCP update rate: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "MCP update rate saved successfully to NVS: %d ms (%.1f Hz)", update_rate_ms, 1000.0f / update_rate_ms);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->modbus_enabled = enabled;
+    return system_config_commit();
+}
+
+uint8_t system_modbus_word_order_load(void)
+{
+    return config_cache()->modbus_word_order;
+}
+
+bool system_modbus_word_order_save(uint8_t word_order)
+{
+    system_config_t *pending = system_config_begin();
+    pending->modbus_word_order = word_order;
+    return system_config_commit();
+}
+
+bool system_sensor_enabled_load(void)
+{
+    return config_cache()->sensor_enabled;
+}
+
+bool system_sensor_enabled_save(bool enabled)
+{
+    system_config_t *pending = system_config_begin();
+    pending->sensor_enabled = enabled;
+    return system_config_commit();
+}
+
+uint8_t system_sensor_byte_offset_load(void)
+{
+    return config_cache()->sensor_byte_offset;
+}
+
+bool system_sensor_byte_offset_save(uint8_t start_byte)
+{
+    system_config_t *pending = system_config_begin();
+    pending->sensor_byte_offset = start_byte;
+    return system_config_commit();
+}
+
+bool system_mcp_enabled_load(void)
+{
+    return config_cache()->mcp_enabled;
+}
+
+bool system_mcp_enabled_save(bool enabled)
+{
+    system_config_t *pending = system_config_begin();
+    pending->mcp_enabled = enabled;
+    return system_config_commit();
+}
+
+uint8_t system_mcp_device_type_load(void)
+{
+    return config_cache()->mcp_device_type;
+}
+
+bool system_mcp_device_type_save(uint8_t device_type)
+{
+    system_config_t *pending = system_config_begin();
+    pending->mcp_device_type = device_type;
+    return system_config_commit();
+}
+
+uint16_t system_mcp_update_rate_ms_load(void)
+{
+    return config_cache()->mcp_update_rate_ms;
+}
+
+bool system_mcp_update_rate_ms_save(uint16_t update_rate_ms)
+{
+    system_config_t *pending = system_config_begin();
+    pending->mcp_update_rate_ms = update_rate_ms;
+    return system_config_commit();
 }
 
 bool system_i2c_internal_pullup_load(void)
 {
-    // Get compile-time default (Kconfig option)
-    #ifdef CONFIG_OPENER_I2C_INTERNAL_PULLUP
-    bool default_enabled = CONFIG_OPENER_I2C_INTERNAL_PULLUP;
-    #else
-    bool default_enabled = false;  // Default to disabled if not defined
-    #endif
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved I2C pull-up setting found, using compile-time default");
-            return default_enabled;
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return default_enabled;
-    }
-    
-    uint8_t enabled = default_enabled ? 1 : 0;  // Default to Kconfig value
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_I2C_INTERNAL_PULLUP, &enabled, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved I2C pull-up setting found, using compile-time default");
-        return default_enabled;
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load I2C pull-up setting: %s", esp_err_to_name(err));
-        return default_enabled;
-    }
-    
-    ESP_LOGI(TAG, "I2C internal pull-up setting loaded from NVS: %s", enabled ? "enabled" : "disabled");
-    return enabled != 0;
+    return config_cache()->i2c_internal_pullup;
 }
 
 bool system_i2c_internal_pullup_save(bool enabled)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    uint8_t value = enabled ? 1 : 0;
-    err = nvs_set_blob(handle, NVS_KEY_I2C_INTERNAL_PULLUP, &value, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save I2C pull-up setting: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit I2C pull-up setting: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "I2C internal pull-up setting saved to NVS: %s", enabled ? "enabled" : "disabled");
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->i2c_internal_pullup = enabled;
+    return system_config_commit();
 }
 
 bool system_nau7802_enabled_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            return false;  // Default to disabled
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    uint8_t enabled = 0;
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_ENABLED, &enabled, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        return false;  // Default to disabled
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load NAU7802 enabled state: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    return (enabled != 0);
+    return config_cache()->nau7802_enabled;
 }
 
 bool system_nau7802_enabled_save(bool enabled)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    uint8_t value = enabled ? 1 : 0;
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_ENABLED, &value, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 enabled state: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 enabled state: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 enabled state saved to NVS: %s", enabled ? "enabled" : "disabled");
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_enabled = enabled;
+    return system_config_commit();
 }
 
 uint8_t system_nau7802_byte_offset_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            return 0;  // Default to byte 0
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return 0;
-    }
-    
-    uint8_t offset = 0;
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_BYTE_OFFSET, &offset, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        return 0;  // Default to byte 0
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load NAU7802 byte offset: %s", esp_err_to_name(err));
-        return 0;
-    }
-    
-    // Validate offset: Assembly 100 is 32 bytes, NAU7802 data is 10 bytes (4 weight + 4 raw + 1 unit + 1 status)
-    // Maximum valid offset: 32 - 10 = 22
-    const uint8_t assembly_size = 32;
-    const uint8_t nau7802_data_size = 10;
-    const uint8_t max_offset = assembly_size - nau7802_data_size;
-    if (offset > max_offset) {
-        ESP_LOGW(TAG, "Invalid NAU7802 byte offset %d (max %d), using default 0", offset, max_offset);
-        return 0;
-    }
-    
-    return offset;
+    return config_cache()->nau7802_byte_offset;
 }
 
 bool system_nau7802_byte_offset_save(uint8_t start_byte)
 {
-    // Validate byte offset: Assembly 100 is 32 bytes, NAU7802 data is 10 bytes (4 weight + 4 raw + 1 unit + 1 status)
-    // Maximum valid offset: 32 - 10 = 22
-    const uint8_t assembly_size = 32;
-    const uint8_t nau7802_data_size = 10;
-    const uint8_t max_offset = assembly_size - nau7802_data_size;
-    if (start_byte > max_offset) {
-        ESP_LOGE(TAG, "Invalid NAU7802 byte offset %d (must be 0-%d, assembly size %d - data size %d)", 
-                 start_byte, max_offset, assembly_size, nau7802_data_size);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_BYTE_OFFSET, &start_byte, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 byte offset: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 byte offset: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 byte offset saved to NVS: %d", start_byte);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_byte_offset = start_byte;
+    return system_config_commit();
 }
 
 float system_nau7802_calibration_factor_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            return 0.0f;  // Default to 0.0
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return 0.0f;
-    }
-    
-    float factor = 0.0f;
-    size_t required_size = sizeof(float);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_CAL_FACTOR, &factor, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        return 0.0f;  // Default to 0.0
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load NAU7802 calibration factor: %s", esp_err_to_name(err));
-        return 0.0f;
-    }
-    
-    return factor;
+    return config_cache()->nau7802_calibration_factor;
 }
 
 bool system_nau7802_calibration_factor_save(float factor)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_CAL_FACTOR, &factor, sizeof(float));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 calibration factor: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 calibration factor: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 calibration factor saved to NVS: %.6f", factor);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_calibration_factor = factor;
+    return system_config_commit();
 }
 
 float system_nau7802_zero_offset_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            return 0.0f;  // Default to 0.0
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return 0.0f;
-    }
-    
-    float offset = 0.0f;
-    size_t required_size = sizeof(float);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_ZERO_OFFSET, &offset, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        return 0.0f;  // Default to 0.0
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load NAU7802 zero offset: %s", esp_err_to_name(err));
-        return 0.0f;
-    }
-    
-    return offset;
+    return config_cache()->nau7802_zero_offset;
 }
 
 bool system_nau7802_zero_offset_save(float offset)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_ZERO_OFFSET, &offset, sizeof(float));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 zero offset: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 zero offset: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 zero offset saved to NVS: %.6f", offset);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_zero_offset = offset;
+    return system_config_commit();
 }
 
 uint8_t system_nau7802_unit_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            return 1;  // Default to lbs
-        }
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return 1;  // Default to lbs on error
-    }
-    
-    uint8_t unit = 1;  // Default to lbs
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_UNIT, &unit, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        return 1;  // Default to lbs
-    }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to load NAU7802 unit: %s", esp_err_to_name(err));
-        return 1;  // Default to lbs on error
-    }
-    
-    // Validate unit value (0=grams, 1=lbs, 2=kg)
-    if (unit > 2) {
-        ESP_LOGW(TAG, "Invalid NAU7802 unit value %d, defaulting to lbs", unit);
-        return 1;
-    }
-    
-    return unit;
+    return config_cache()->nau7802_unit;
 }
 
 bool system_nau7802_unit_save(uint8_t unit)
 {
-    // Validate unit value (0=grams, 1=lbs, 2=kg)
-    if (unit > 2) {
-        ESP_LOGE(TAG, "Invalid NAU7802 unit %d (must be 0=grams, 1=lbs, or 2=kg)", unit);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_UNIT, &unit, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 unit: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 unit: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    const char *unit_str = (unit == 0) ? "grams" : (unit == 1) ? "lbs" : "kg";
-    ESP_LOGI(TAG, "NAU7802 unit saved to NVS: %s", unit_str);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_unit = unit;
+    return system_config_commit();
 }
 
-// NAU7802 Gain (0-7: x1-x128)
 uint8_t system_nau7802_gain_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGD(TAG, "NVS not available, using default gain (128x)");
-        return 7;  // Default: NAU7802_GAIN_128
-    }
-    
-    uint8_t gain = 7;  // Default: NAU7802_GAIN_128
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_GAIN, &gain, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGD(TAG, "NAU7802 gain not set, using default (128x)");
-        return 7;
-    }
-    
-    if (err != ESP_OK || required_size != sizeof(uint8_t)) {
-        ESP_LOGW(TAG, "Failed to load NAU7802 gain, using default (128x)");
-        return 7;
-    }
-    
-    if (gain > 7) {
-        ESP_LOGW(TAG, "Invalid NAU7802 gain value (%d), using default (128x)", gain);
-        return 7;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 gain loaded from NVS: %d (x%d)", gain, 1 << gain);
-    return gain;
+    return config_cache()->nau7802_gain;
 }
 
 bool system_nau7802_gain_save(uint8_t gain)
 {
-    if (gain > 7) {
-        ESP_LOGE(TAG, "Invalid NAU7802 gain value: %d (must be 0-7)", gain);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_GAIN, &gain, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 gain: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 gain: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 gain saved to NVS: %d (x%d)", gain, 1 << gain);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_gain = gain;
+    return system_config_commit();
 }
 
-// NAU7802 Sample Rate (0=10, 1=20, 2=40, 3=80, 7=320 SPS)
 uint8_t system_nau7802_sample_rate_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGD(TAG, "NVS not available, using default sample rate (80 SPS)");
-        return 3;  // Default: NAU7802_SPS_80
-    }
-    
-    uint8_t sample_rate = 3;  // Default: NAU7802_SPS_80
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_SAMPLE_RATE, &sample_rate, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGD(TAG, "NAU7802 sample rate not set, using default (80 SPS)");
-        return 3;
-    }
-    
-    if (err != ESP_OK || required_size != sizeof(uint8_t)) {
-        ESP_LOGW(TAG, "Failed to load NAU7802 sample rate, using default (80 SPS)");
-        return 3;
-    }
-    
-    // Valid values: 0, 1, 2, 3, 7
-    if (sample_rate != 0 && sample_rate != 1 && sample_rate != 2 && sample_rate != 3 && sample_rate != 7) {
-        ESP_LOGW(TAG, "Invalid NAU7802 sample rate value (%d), using default (80 SPS)", sample_rate);
-        return 3;
-    }
-    
-    const char *sps_str = (sample_rate == 0) ? "10" : (sample_rate == 1) ? "20" : 
-                          (sample_rate == 2) ? "40" : (sample_rate == 3) ? "80" : "320";
-    ESP_LOGI(TAG, "NAU7802 sample rate loaded from NVS: %d (%s SPS)", sample_rate, sps_str);
-    return sample_rate;
+    return config_cache()->nau7802_sample_rate;
 }
 
 bool system_nau7802_sample_rate_save(uint8_t sample_rate)
 {
-    // Valid values: 0, 1, 2, 3, 7
-    if (sample_rate != 0 && sample_rate != 1 && sample_rate != 2 && sample_rate != 3 && sample_rate != 7) {
-        ESP_LOGE(TAG, "Invalid NAU7802 sample rate value: %d (must be 0, 1, 2, 3, or 7)", sample_rate);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_SAMPLE_RATE, &sample_rate, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 sample rate: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 sample rate: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    const char *sps_str = (sample_rate == 0) ? "10" : (sample_rate == 1) ? "20" : 
-                          (sample_rate == 2) ? "40" : (sample_rate == 3) ? "80" : "320";
-    ESP_LOGI(TAG, "NAU7802 sample rate saved to NVS: %d (%s SPS)", sample_rate, sps_str);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_sample_rate = sample_rate;
+    return system_config_commit();
 }
 
-// NAU7802 Channel (0=Channel 1, 1=Channel 2)
 uint8_t system_nau7802_channel_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGD(TAG, "NVS not available, using default channel (Channel 1)");
-        return 0;  // Default: NAU7802_CHANNEL_1
-    }
-    
-    uint8_t channel = 0;  // Default: NAU7802_CHANNEL_1
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_CHANNEL, &channel, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGD(TAG, "NAU7802 channel not set, using default (Channel 1)");
-        return 0;
-    }
-    
-    if (err != ESP_OK || required_size != sizeof(uint8_t)) {
-        ESP_LOGW(TAG, "Failed to load NAU7802 channel, using default (Channel 1)");
-        return 0;
-    }
-    
-    if (channel > 1) {
-        ESP_LOGW(TAG, "Invalid NAU7802 channel value (%d), using default (Channel 1)", channel);
-        return 0;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 channel loaded from NVS: %d (Channel %d)", channel, channel + 1);
-    return channel;
+    return config_cache()->nau7802_channel;
 }
 
 bool system_nau7802_channel_save(uint8_t channel)
 {
-    if (channel > 1) {
-        ESP_LOGE(TAG, "Invalid NAU7802 channel value: %d (must be 0 or 1)", channel);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_CHANNEL, &channel, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 channel: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 channel: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 channel saved to NVS: %d (Channel %d)", channel, channel + 1);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_channel = channel;
+    return system_config_commit();
 }
 
-// NAU7802 LDO Voltage (0-7: 2.4V-4.5V)
 uint8_t system_nau7802_ldo_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGD(TAG, "NVS not available, using default LDO (3.3V)");
-        return 4;  // Default: 3.3V
-    }
-    
-    uint8_t ldo = 4;  // Default: 3.3V
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_LDO, &ldo, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGD(TAG, "NAU7802 LDO not set, using default (3.3V)");
-        return 4;
-    }
-    
-    if (err != ESP_OK || required_size != sizeof(uint8_t)) {
-        ESP_LOGW(TAG, "Failed to load NAU7802 LDO, using default (3.3V)");
-        return 4;
-    }
-    
-    if (ldo > 7) {
-        ESP_LOGW(TAG, "Invalid NAU7802 LDO value (%d), using default (3.3V)", ldo);
-        return 4;
-    }
-    
-    const float voltages[] = {4.5f, 4.2f, 3.9f, 3.6f, 3.3f, 3.0f, 2.7f, 2.4f};
-    ESP_LOGI(TAG, "NAU7802 LDO loaded from NVS: %d (%.1fV)", ldo, voltages[ldo]);
-    return ldo;
+    return config_cache()->nau7802_ldo;
 }
 
 bool system_nau7802_ldo_save(uint8_t ldo)
 {
-    if (ldo > 7) {
-        ESP_LOGE(TAG, "Invalid NAU7802 LDO value: %d (must be 0-7)", ldo);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_LDO, &ldo, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 LDO: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NAU7802 LDO: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    const float voltages[] = {4.5f, 4.2f, 3.9f, 3.6f, 3.3f, 3.0f, 2.7f, 2.4f};
-    ESP_LOGI(TAG, "NAU7802 LDO saved to NVS: %d (%.1fV)", ldo, voltages[ldo]);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_ldo = ldo;
+    return system_config_commit();
 }
 
 uint8_t system_nau7802_average_load(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGD(TAG, "NVS not available, using default average (1 sample)");
-        return 1;  // Default: no averaging (single reading)
-    }
-    
-    uint8_t average = 1;  // Default: no averaging
-    size_t required_size = sizeof(uint8_t);
-    err = nvs_get_blob(handle, NVS_KEY_NAU7802_AVERAGE, &average, &required_size);
-    nvs_close(handle);
-    
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGD(TAG, "NAU7802 average not set, using default (1 sample)");
-        return 1;
-    }
-    
-    if (err != ESP_OK || required_size != sizeof(uint8_t)) {
-        ESP_LOGW(TAG, "Failed to load NAU7802 average, using default (1 sample)");
-        return 1;
-    }
-    
-    // Validate range (1-50)
-    if (average < 1) {
-        ESP_LOGW(TAG, "Invalid NAU7802 average value: %d (must be 1-50), using default (1)", average);
-        return 1;
-    }
-    if (average > 50) {
-        ESP_LOGW(TAG, "Invalid NAU7802 average value: %d (must be 1-50), clamping to 50", average);
-        return 50;
-    }
-    
-    return average;
+    return config_cache()->nau7802_average;
 }
 
 bool system_nau7802_average_save(uint8_t average)
 {
-    if (average < 1 || average > 50) {
-        ESP_LOGE(TAG, "Invalid NAU7802 average value: %d (must be 1-50)", average);
-        return false;
-    }
-    
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    err = nvs_set_blob(handle, NVS_KEY_NAU7802_AVERAGE, &average, sizeof(uint8_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save NAU7802 average: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return false;
-    }
-    
-    err = nvs_commit(handle);
-    nvs_close(handle);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NVS changes for NAU7802 average: %s", esp_err_to_name(err));
-        return false;
-    }
-    
-    ESP_LOGI(TAG, "NAU7802 average saved: %d samples", average);
-    return true;
+    system_config_t *pending = system_config_begin();
+    pending->nau7802_average = average;
+    return system_config_commit();
 }
-
-
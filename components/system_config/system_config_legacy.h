@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef SYSTEM_CONFIG_LEGACY_H
+#define SYSTEM_CONFIG_LEGACY_H
+
+#include "system_config.h"
+
+/**
+ * @brief Read settings from the per-key NVS layout used by older firmware
+ *
+ * Missing or invalid keys are replaced by their defaults. Used once to build
+ * the configuration record on the first boot after an upgrade.
+ *
+ * @param config Filled with the migrated settings
+ */
+void system_config_legacy_load(system_config_t *config);
+
+/**
+ * @brief Remove the per-key NVS settings once they are in the configuration record
+ *
+ * Called after a successful migration, so a record that is later lost or
+ * corrupted can never be rebuilt from settings that have gone stale.
+ */
+void system_config_legacy_erase(void);
+
+#endif // SYSTEM_CONFIG_LEGACY_H
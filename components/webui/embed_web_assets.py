@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Compress the web UI pages and embed them into a C source file.
+
+Each page is gzip-compressed at build time so the HTTP server can send it as
+is with Content-Encoding: gzip. The generated table also carries the
+compressed length and an ETag derived from the compressed bytes, so nothing
+has to be measured or hashed at run time.
+
+Usage: embed_web_assets.py <output_source.c> <uri>=<file> [<uri>=<file> ...]
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+CONTENT_TYPES = {
+    '.html': 'text/html; charset=utf-8',
+    '.js': 'application/javascript',
+    '.css': 'text/css',
+    '.json': 'application/json',
+    '.ico': 'image/x-icon',
+}
+
+
+def c_identifier(path):
+    """Build a C identifier from a file name."""
+    name = os.path.basename(path)
+    return 'asset_' + ''.join(c if c.isalnum() else '_' for c in name)
+
+
+def compress(data):
+    """Compress reproducibly: no file name and a zero timestamp in the gzip header."""
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def embed_web_assets(output_source, entries):
+    assets = []
+    for entry in entries:
+        uri, sep, path = entry.partition('=')
+        if not sep or not uri.startswith('/'):
+            print(f"Error: invalid asset '{entry}', expected <uri>=<file>", file=sys.stderr)
+            sys.exit(1)
+
+        ext = os.path.splitext(path)[1].lower()
+        if ext not in CONTENT_TYPES:
+            print(f"Error: no content type known for '{path}'", file=sys.stderr)
+            sys.exit(1)
+
+        with open(path, 'rb') as f:
+            raw = f.read()
+        data = compress(raw)
+        etag = '"' + hashlib.sha256(data).hexdigest()[:16] + '"'
+        assets.append((uri, path, CONTENT_TYPES[ext], raw, data, etag))
+
+    source_content = """/*******************************************************************************
+ * Auto-generated file - DO NOT EDIT
+ * This file contains the gzip-compressed web UI pages (see embed_web_assets.py)
+ ******************************************************************************/
+
+#include "webui_assets.h"
+
+"""
+
+    for uri, path, content_type, raw, data, etag in assets:
+        source_content += f"// {os.path.basename(path)}: {len(raw)} bytes, {len(data)} bytes compressed\n"
+        source_content += f"static const uint8_t {c_identifier(path)}[] = {{\n"
+        # Write data as hex bytes, 16 per line
+        for i in range(0, len(data), 16):
+            line_bytes = data[i:i+16]
+            hex_bytes = ', '.join(f'0x{b:02x}' for b in line_bytes)
+            source_content += f"    {hex_bytes}"
+            if i + 16 < len(data):
+                source_content += ","
+            source_content += "\n"
+        source_content += "};\n\n"
+
+    source_content += "const webui_asset_t webui_assets[] = {\n"
+    for uri, path, content_type, raw, data, etag in assets:
+        etag_literal = etag.replace('"', '\\"')
+        source_content += (f"    {{ \"{uri}\", \"{content_type}\", \"{etag_literal}\", "
+                           f"{c_identifier(path)}, sizeof({c_identifier(path)}) }},\n")
+    source_content += "};\n\n"
+    source_content += "const size_t webui_asset_count = sizeof(webui_assets) / sizeof(webui_assets[0]);\n"
+
+    with open(output_source, 'w') as f:
+        f.write(source_content)
+
+    for uri, path, content_type, raw, data, etag in assets:
+        print(f"Embedded {uri}: {len(raw)} -> {len(data)} bytes, ETag {etag}")
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        print(f"Usage: {sys.argv[0]} <output_source.c> <uri>=<file> [<uri>=<file> ...]", file=sys.stderr)
+        sys.exit(1)
+
+    embed_web_assets(sys.argv[1], sys.argv[2:])
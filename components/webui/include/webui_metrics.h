@@ -0,0 +1,21 @@
+#ifndef WEBUI_METRICS_H
+#define WEBUI_METRICS_H
+
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register the Prometheus endpoint (GET /metrics)
+ * 
+ * @param server HTTP server handle
+ */
+void webui_register_metrics_handler(httpd_handle_t server);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEBUI_METRICS_H
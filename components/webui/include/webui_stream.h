@@ -0,0 +1,78 @@
+#ifndef WEBUI_STREAM_H
+#define WEBUI_STREAM_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WEBUI_STREAM_SCALE_CHANNEL_MAX 4  /**< Scale channels carried by the stream */
+
+/**
+ * @brief Live values of one scale channel, as published by the acquisition task
+ */
+typedef struct {
+    float weight;            /**< Weight in the configured unit */
+    int32_t weight_scaled;   /**< Weight scaled by 100, as in the assemblies */
+    int32_t raw;             /**< Averaged raw ADC reading */
+    uint8_t unit;            /**< Unit code (0=grams, 1=lbs, 2=kg) */
+    uint8_t status;          /**< Assembly status flags (bit 0 available, bit 1 connected,
+                                  bit 2 initialized, bit 3 stable, bit 4 in motion,
+                                  bit 5 center of zero) */
+} webui_stream_scale_t;
+
+/**
+ * @brief Live stream counters, for measuring the cost per viewer
+ *
+ * Time counters are cumulative microseconds and wrap at 2^32.
+ */
+typedef struct {
+    uint32_t clients;        /**< Viewers currently connected */
+    uint32_t frames;         /**< Frames built (each is sent to every viewer) */
+    uint32_t sends;          /**< Frames sent to individual viewers */
+    uint32_t bytes;          /**< Bytes sent to all viewers */
+    uint32_t dropped;        /**< Viewers disconnected because they fell behind */
+    uint32_t build_us;       /**< Time spent building frames */
+    uint32_t fanout_us;      /**< Time spent sending frames to viewers */
+} webui_stream_stats_t;
+
+/**
+ * @brief Publish the latest values of a scale channel
+ *
+ * Cheap enough to call on every acquisition cycle: it only copies the values.
+ * Viewers are sent the values at most CONFIG_OPENER_WEBUI_STREAM_MAX_RATE_HZ
+ * times per second, and only when something changed.
+ *
+ * @param channel Scale channel (0 to WEBUI_STREAM_SCALE_CHANNEL_MAX - 1)
+ * @param values Current values
+ */
+void webui_stream_publish_scale(uint8_t channel, const webui_stream_scale_t *values);
+
+/**
+ * @brief Register /api/stream and start the stream task (called by webui_init)
+ *
+ * @param server HTTP server handle
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task could not be created
+ */
+esp_err_t webui_stream_start(httpd_handle_t server);
+
+/**
+ * @brief Stop sending to viewers (called by webui_stop before the server stops)
+ */
+void webui_stream_stop(void);
+
+/**
+ * @brief Get the live stream counters
+ *
+ * @param stats Output
+ */
+void webui_stream_get_stats(webui_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEBUI_STREAM_H
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "json_writer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static void flush_buffer(json_writer_t *w)
+{
+    if (w->failed || w->len == 0) {
+        return;
+    }
+    if (!w->flush(w->ctx, w->buf, w->len)) {
+        w->failed = true;
+    }
+    w->flushed += w->len;
+    w->len = 0;
+}
+
+static void put(json_writer_t *w, const char *data, size_t len)
+{
+    while (len > 0 && !w->failed) {
+        size_t space = JSON_WRITER_BUF_SIZE - w->len;
+        if (space == 0) {
+            flush_buffer(w);
+            continue;
+        }
+        size_t n = (len < space) ? len : space;
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void put_char(json_writer_t *w, char c)
+{
+    if (w->len == JSON_WRITER_BUF_SIZE) {
+        flush_buffer(w);
+    }
+    if (!w->failed) {
+        w->buf[w->len++] = c;
+    }
+}
+
+// String contents without the quotes
+static void put_escaped_chars(json_writer_t *w, const char *s, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t run = 0;  // Characters that need no escaping are copied in runs
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        put(w, s + run, i - run);
+        run = i + 1;
+        char esc[6] = {'\\', 0};
+        size_t esc_len = 2;
+        switch (c) {
+            case '"':  esc[1] = '"'; break;
+            case '\\': esc[1] = '\\'; break;
+            case '\b': esc[1] = 'b'; break;
+            case '\f': esc[1] = 'f'; break;
+            case '\n': esc[1] = 'n'; break;
+            case '\r': esc[1] = 'r'; break;
+            case '\t': esc[1] = 't'; break;
+            default:
+                esc[1] = 'u';
+                esc[2] = '0';
+                esc[3] = '0';
+                esc[4] = hex[c >> 4];
+                esc[5] = hex[c & 0x0F];
+                esc_len = 6;
+                break;
+        }
+        put(w, esc, esc_len);
+    }
+    put(w, s + run, len - run);
+}
+
+static void put_escaped(json_writer_t *w, const char *s, size_t len)
+{
+    put_char(w, '"');
+    put_escaped_chars(w, s, len);
+    put_char(w, '"');
+}
+
+// Comma and key in front of a value
+static void begin_value(json_writer_t *w, const char *key)
+{
+    if (w->failed) {
+        return;
+    }
+    if (w->depth > 0) {
+        if (w->has_items[w->depth - 1]) {
+            put_char(w, ',');
+        }
+        w->has_items[w->depth - 1] = true;
+    }
+    if (key != NULL) {
+        put_escaped(w, key, strlen(key));
+        put_char(w, ':');
+    }
+}
+
+static void open_container(json_writer_t *w, const char *key, char bracket)
+{
+    begin_value(w, key);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH) {
+        w->failed = true;
+        return;
+    }
+    put_char(w, bracket);
+    w->has_items[w->depth++] = false;
+}
+
+static void close_container(json_writer_t *w, char bracket)
+{
+    if (w->depth == 0) {
+        w->failed = true;
+        return;
+    }
+    w->depth--;
+    put_char(w, bracket);
+}
+
+void json_writer_init(json_writer_t *w, json_writer_flush_fn flush, void *ctx)
+{
+    w->flush = flush;
+    w->ctx = ctx;
+    w->len = 0;
+    w->flushed = 0;
+    w->depth = 0;
+    w->failed = false;
+}
+
+void json_writer_object_begin(json_writer_t *w, const char *key)
+{
+    open_container(w, key, '{');
+}
+
+void json_writer_object_end(json_writer_t *w)
+{
+    close_container(w, '}');
+}
+
+void json_writer_array_begin(json_writer_t *w, const char *key)
+{
+    open_container(w, key, '[');
+}
+
+void json_writer_array_end(json_writer_t *w)
+{
+    close_container(w, ']');
+}
+
+void json_writer_string(json_writer_t *w, const char *key, const char *value)
+{
+    if (value == NULL) {
+        json_writer_null(w, key);
+        return;
+    }
+    json_writer_string_len(w, key, value, strlen(value));
+}
+
+void json_writer_string_len(json_writer_t *w, const char *key, const char *value, size_t len)
+{
+    begin_value(w, key);
+    put_escaped(w, value, len);
+}
+
+void json_writer_string_begin(json_writer_t *w, const char *key)
+{
+    begin_value(w, key);
+    put_char(w, '"');
+}
+
+void json_writer_string_append(json_writer_t *w, const char *value, size_t len)
+{
+    put_escaped_chars(w, value, len);
+}
+
+void json_writer_string_end(json_writer_t *w)
+{
+    put_char(w, '"');
+}
+
+void json_writer_uint(json_writer_t *w, const char *key, uint64_t value)
+{
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    begin_value(w, key);
+    put(w, digits + sizeof(digits) - n, n);
+}
+
+void json_writer_int(json_writer_t *w, const char *key, int64_t value)
+{
+    if (value >= 0) {
+        json_writer_uint(w, key, (uint64_t)value);
+        return;
+    }
+    char digits[20];
+    uint64_t magnitude = (uint64_t)0 - (uint64_t)value;
+    size_t n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    begin_value(w, key);
+    put_char(w, '-');
+    put(w, digits + sizeof(digits) - n, n);
+}
+
+static void put_number(json_writer_t *w, const char *key, double value, int precision)
+{
+    if (!isfinite(value)) {
+        json_writer_null(w, key);  // JSON has no NaN or infinity
+        return;
+    }
+    char text[32];
+    int n = snprintf(text, sizeof(text), "%.*g", precision, value);
+    begin_value(w, key);
+    put(w, text, (n > 0 && (size_t)n < sizeof(text)) ? (size_t)n : 0);
+}
+
+void json_writer_float(json_writer_t *w, const char *key, float value)
+{
+    put_number(w, key, value, 7);
+}
+
+void json_writer_double(json_writer_t *w, const char *key, double value)
+{
+    put_number(w, key, value, 15);
+}
+
+void json_writer_bool(json_writer_t *w, const char *key, bool value)
+{
+    begin_value(w, key);
+    if (value) {
+        put(w, "true", 4);
+    } else {
+        put(w, "false", 5);
+    }
+}
+
+void json_writer_null(json_writer_t *w, const char *key)
+{
+    begin_value(w, key);
+    put(w, "null", 4);
+}
+
+bool json_writer_finish(json_writer_t *w)
+{
+    flush_buffer(w);
+    return !w->failed && w->depth == 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JSON_WRITER_BUF_SIZE  512  /**< Output is flushed in chunks of at most this size */
+#define JSON_WRITER_MAX_DEPTH 8    /**< Maximum nesting of objects and arrays */
+
+/**
+ * @brief Output callback
+ *
+ * @param ctx Context passed to json_writer_init()
+ * @param data Bytes to write
+ * @param len Number of bytes (never 0)
+ * @return true on success, false to stop writing
+ */
+typedef bool (*json_writer_flush_fn)(void *ctx, const char *data, size_t len);
+
+/**
+ * @brief Streaming JSON encoder with a fixed output buffer
+ *
+ * Values are encoded straight into buf, which is handed to the flush callback
+ * whenever it fills up, so a document of any size is produced without heap
+ * allocation. Commas are inserted automatically. Every value function takes a
+ * key, which must be NULL for array elements and for the top-level value.
+ *
+ * Errors (a failed flush, nesting deeper than JSON_WRITER_MAX_DEPTH) are
+ * sticky: later calls do nothing and json_writer_finish() reports the failure,
+ * so callers only check the result once.
+ */
+typedef struct {
+    json_writer_flush_fn flush;
+    void *ctx;
+    size_t len;                             /**< Bytes buffered in buf */
+    size_t flushed;                         /**< Bytes already handed to flush */
+    uint8_t depth;                          /**< Open objects and arrays */
+    bool has_items[JSON_WRITER_MAX_DEPTH];  /**< Container at each level already has a member */
+    bool failed;
+    char buf[JSON_WRITER_BUF_SIZE];
+} json_writer_t;
+
+/**
+ * @brief Prepare a writer
+ *
+ * @param w Writer (typically on the stack)
+ * @param flush Output callback
+ * @param ctx Context for the callback
+ */
+void json_writer_init(json_writer_t *w, json_writer_flush_fn flush, void *ctx);
+
+void json_writer_object_begin(json_writer_t *w, const char *key);
+void json_writer_object_end(json_writer_t *w);
+void json_writer_array_begin(json_writer_t *w, const char *key);
+void json_writer_array_end(json_writer_t *w);
+
+/** @brief String value, escaped as needed (NULL is written as null) */
+void json_writer_string(json_writer_t *w, const char *key, const char *value);
+
+/** @brief String value of known length, which may contain NUL bytes */
+void json_writer_string_len(json_writer_t *w, const char *key, const char *value, size_t len);
+
+/**
+ * @brief String value written in pieces
+ *
+ * For text that is not in memory in one piece, such as the log ring. Call
+ * json_writer_string_append() any number of times, then json_writer_string_end();
+ * no other value may be written in between.
+ */
+void json_writer_string_begin(json_writer_t *w, const char *key);
+void json_writer_string_append(json_writer_t *w, const char *value, size_t len);
+void json_writer_string_end(json_writer_t *w);
+
+void json_writer_int(json_writer_t *w, const char *key, int64_t value);
+void json_writer_uint(json_writer_t *w, const char *key, uint64_t value);
+
+/** @brief Number with float precision (7 significant digits); NaN and infinity become null */
+void json_writer_float(json_writer_t *w, const char *key, float value);
+
+/** @brief Number with double precision (15 significant digits); NaN and infinity become null */
+void json_writer_double(json_writer_t *w, const char *key, double value);
+
+void json_writer_bool(json_writer_t *w, const char *key, bool value);
+void json_writer_null(json_writer_t *w, const char *key);
+
+/**
+ * @brief Flush the rest of the buffer
+ *
+ * Does not call flush if nothing is buffered. A caller that wants to send a
+ * small document in one piece can check flushed == 0 and use buf/len itself
+ * instead of calling this.
+ *
+ * @param w Writer
+ * @return true if the document was written completely and all containers were closed
+ */
+bool json_writer_finish(json_writer_t *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_WRITER_H
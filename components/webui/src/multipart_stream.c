@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "multipart_stream.h"
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+enum {
+    STATE_PREAMBLE,         // Before the first delimiter
+    STATE_AFTER_DELIMITER,  // "--" (close delimiter) or padding up to the line end
+    STATE_HEADERS,          // Part headers up to the empty line
+    STATE_BODY,             // Part body up to the next delimiter
+    STATE_DONE,
+    STATE_ERROR,
+};
+
+static multipart_result_t fail(multipart_stream_t *p, const char *error)
+{
+    p->state = STATE_ERROR;
+    p->error = error;
+    return MULTIPART_ERROR;
+}
+
+bool multipart_stream_get_boundary(const char *content_type, char *boundary, size_t size)
+{
+    const char *param = content_type;
+    // Parameter names are case-insensitive; match "boundary=" at a parameter start
+    for (; *param != '\0'; param++) {
+        if ((param == content_type || param[-1] == ';' || param[-1] == ' ') &&
+            strncasecmp(param, "boundary=", 9) == 0) {
+            break;
+        }
+    }
+    if (*param == '\0') {
+        return false;
+    }
+    param += 9;
+
+    bool quoted = (*param == '"');
+    if (quoted) {
+        param++;
+    }
+    size_t len = 0;
+    while (param[len] != '\0' && len <= MULTIPART_BOUNDARY_MAX &&
+           (quoted ? param[len] != '"' : (param[len] != ';' && param[len] != ' ' &&
+                                          param[len] != '\r' && param[len] != '\n'))) {
+        len++;
+    }
+    if (len == 0 || len > MULTIPART_BOUNDARY_MAX || len >= size) {
+        return false;
+    }
+    memcpy(boundary, param, len);
+    boundary[len] = '\0';
+    return true;
+}
+
+bool multipart_stream_init(multipart_stream_t *p, const char *boundary, multipart_data_fn on_data, void *ctx)
+{
+    size_t boundary_len = strlen(boundary);
+    if (boundary_len == 0 || boundary_len > MULTIPART_BOUNDARY_MAX) {
+        return false;
+    }
+
+    memset(p, 0, offsetof(multipart_stream_t, delimiter));
+    p->on_data = on_data;
+    p->ctx = ctx;
+    p->state = STATE_PREAMBLE;
+
+    // Every delimiter is CRLF "--" boundary. The first one may start the body
+    // without a line break in front, so the stream starts with a CRLF carried in.
+    memcpy(p->delimiter, "\r\n--", 4);
+    memcpy(p->delimiter + 4, boundary, boundary_len);
+    p->delimiter_len = boundary_len + 4;
+    memcpy(p->carry, "\r\n", 2);
+    p->carry_len = 2;
+
+    size_t m = p->delimiter_len;
+    memset(p->shift, (int)m, sizeof(p->shift));
+    for (size_t i = 0; i + 1 < m; i++) {
+        p->shift[p->delimiter[i]] = (uint8_t)(m - 1 - i);
+    }
+    return true;
+}
+
+// Byte i of the carry followed by the new piece
+static inline uint8_t stream_byte(const multipart_stream_t *p, const uint8_t *data, size_t i)
+{
+    return (i < p->carry_len) ? p->carry[i] : data[i - p->carry_len];
+}
+
+// Pass stream bytes [0, end) to the callback if the current part is the file
+static bool emit(multipart_stream_t *p, const uint8_t *data, size_t end)
+{
+    if (p->state != STATE_BODY || !p->in_file || end == 0) {
+        return true;
+    }
+    size_t from_carry = (end < p->carry_len) ? end : p->carry_len;
+    if (from_carry > 0 && !p->on_data(p->ctx, p->carry, from_carry)) {
+        return false;
+    }
+    if (end > from_carry && !p->on_data(p->ctx, data, end - from_carry)) {
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Horspool search for the delimiter in carry + data. Bytes that cannot be part
+ * of a delimiter are emitted. Returns the number of bytes of data consumed:
+ * up to the end of the delimiter if one was found, otherwise all of it with
+ * the last delimiter_len - 1 bytes of the stream moved into the carry.
+ */
+static size_t search_delimiter(multipart_stream_t *p, const uint8_t *data, size_t len, bool *found)
+{
+    const size_t m = p->delimiter_len;
+    const size_t total = p->carry_len + len;
+
+    for (size_t pos = 0; pos + m <= total; pos += p->shift[stream_byte(p, data, pos + m - 1)]) {
+        size_t i = m;
+        while (i > 0 && stream_byte(p, data, pos + i - 1) == p->delimiter[i - 1]) {
+            i--;
+        }
+        if (i == 0) {
+            *found = true;
+            if (!emit(p, data, pos)) {
+                return 0;
+            }
+            // The carry is shorter than the delimiter, so the match ends in data
+            size_t consumed = pos + m - p->carry_len;
+            p->carry_len = 0;
+            return consumed;
+        }
+    }
+
+    *found = false;
+    size_t keep = (total < m - 1) ? total : m - 1;
+    if (!emit(p, data, total - keep)) {
+        return 0;
+    }
+    uint8_t tail[MULTIPART_DELIMITER_MAX];
+    for (size_t i = 0; i < keep; i++) {
+        tail[i] = stream_byte(p, data, total - keep + i);
+    }
+    memcpy(p->carry, tail, keep);
+    p->carry_len = keep;
+    return len;
+}
+
+// True if the header block names a file (Content-Disposition filename parameter)
+static bool header_has_filename(const multipart_stream_t *p)
+{
+    static const char key[] = "filename=";
+    const size_t key_len = sizeof(key) - 1;
+    for (size_t i = 0; i + key_len <= p->header_len; i++) {
+        if (strncasecmp(&p->header[i], key, key_len) == 0 &&
+            (i == 0 || p->header[i - 1] == ';' || isspace((unsigned char)p->header[i - 1]))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+multipart_result_t multipart_stream_feed(multipart_stream_t *p, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        switch (p->state) {
+        case STATE_PREAMBLE:
+        case STATE_BODY: {
+            bool found;
+            size_t consumed = search_delimiter(p, data, len, &found);
+            if (consumed == 0 && len > 0) {
+                return fail(p, "write failed");
+            }
+            data += consumed;
+            len -= consumed;
+            if (found) {
+                if (p->state == STATE_BODY && p->in_file) {
+                    p->state = STATE_DONE;
+                    return MULTIPART_FILE_DONE;
+                }
+                p->state = STATE_AFTER_DELIMITER;
+                p->after_delimiter = 0;
+            }
+            break;
+        }
+
+        case STATE_AFTER_DELIMITER: {
+            uint8_t c = *data++;
+            len--;
+            if (p->after_delimiter == 1) {
+                if (c != '-') {
+                    return fail(p, "malformed delimiter");
+                }
+                // Close delimiter: the body ended without a file part
+                return fail(p, "no file in the form data");
+            }
+            if (c == '-') {
+                p->after_delimiter = 1;
+            } else if (c == '\n') {
+                p->state = STATE_HEADERS;
+                p->header_len = 0;
+                p->newlines = 1;  // An empty line right away means no headers
+            } else if (c != '\r' && c != ' ' && c != '\t') {
+                return fail(p, "malformed delimiter");
+            }
+            break;
+        }
+
+        case STATE_HEADERS: {
+            uint8_t c = *data++;
+            len--;
+            if (p->header_len < MULTIPART_HEADER_MAX) {
+                p->header[p->header_len] = (char)c;
+            } else if (p->header_len >= MULTIPART_HEADER_LIMIT) {
+                return fail(p, "part headers too long");
+            }
+            p->header_len++;
+            if (c == '\n') {
+                p->newlines++;
+            } else if (c != '\r') {
+                p->newlines = 0;
+            }
+            if (p->newlines == 2) {
+                if (p->header_len > MULTIPART_HEADER_MAX) {
+                    p->header_len = MULTIPART_HEADER_MAX;
+                }
+                p->in_file = header_has_filename(p);
+                p->state = STATE_BODY;
+                p->carry_len = 0;
+            }
+            break;
+        }
+
+        case STATE_DONE:
+            return MULTIPART_FILE_DONE;
+
+        default:
+            return MULTIPART_ERROR;
+        }
+    }
+
+    switch (p->state) {
+    case STATE_DONE:
+        return MULTIPART_FILE_DONE;
+    case STATE_ERROR:
+        return MULTIPART_ERROR;
+    default:
+        return MULTIPART_NEED_MORE;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MULTIPART_STREAM_H
+#define MULTIPART_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MULTIPART_BOUNDARY_MAX  70                           /**< Longest boundary allowed by RFC 2046 */
+#define MULTIPART_DELIMITER_MAX (MULTIPART_BOUNDARY_MAX + 4)  /**< CRLF, "--" and the boundary */
+#define MULTIPART_HEADER_MAX    512                          /**< Part headers kept to look for a file name */
+#define MULTIPART_HEADER_LIMIT  8192                         /**< Longest part header block accepted */
+
+/**
+ * @brief Body callback
+ *
+ * @param ctx Context passed to multipart_stream_init()
+ * @param data Bytes of the file part
+ * @param len Number of bytes (never 0)
+ * @return true on success, false to stop parsing
+ */
+typedef bool (*multipart_data_fn)(void *ctx, const uint8_t *data, size_t len);
+
+typedef enum {
+    MULTIPART_NEED_MORE,   /**< Feed the next piece of the request body */
+    MULTIPART_FILE_DONE,   /**< The file part ended; the rest of the body can be ignored */
+    MULTIPART_ERROR        /**< Malformed body, no file part, or the callback failed */
+} multipart_result_t;
+
+/**
+ * @brief Streaming multipart/form-data parser for one file upload
+ *
+ * The request body is fed in pieces as it arrives and the body of the first
+ * part that has a file name is passed to the callback; other parts are
+ * skipped. Delimiters are found with a Boyer-Moore-Horspool search that
+ * treats the held-back tail of the previous piece and the new piece as one
+ * stream, so a delimiter split across pieces is found without copying the
+ * pieces together. Only up to MULTIPART_DELIMITER_MAX - 1 bytes are held back.
+ */
+typedef struct {
+    multipart_data_fn on_data;
+    void *ctx;
+    uint8_t state;
+    bool in_file;                                  /**< Current part is the file */
+    uint8_t after_delimiter;                       /**< Dashes seen right after a delimiter */
+    uint8_t newlines;                              /**< Consecutive line ends in the part headers */
+    const char *error;                             /**< Reason for MULTIPART_ERROR */
+    size_t delimiter_len;
+    size_t carry_len;                              /**< Bytes held back from the previous piece */
+    size_t header_len;                             /**< Bytes of the current header block */
+    uint8_t delimiter[MULTIPART_DELIMITER_MAX];    /**< CRLF "--" boundary */
+    uint8_t carry[MULTIPART_DELIMITER_MAX];
+    uint8_t shift[256];                            /**< Horspool bad-character shifts */
+    char header[MULTIPART_HEADER_MAX];
+} multipart_stream_t;
+
+/**
+ * @brief Extract the boundary parameter of a multipart Content-Type
+ *
+ * @param content_type Content-Type header value
+ * @param boundary Output, NUL-terminated
+ * @param size Size of boundary (MULTIPART_BOUNDARY_MAX + 1 is enough)
+ * @return true if a boundary of 1 to MULTIPART_BOUNDARY_MAX characters was found
+ */
+bool multipart_stream_get_boundary(const char *content_type, char *boundary, size_t size);
+
+/**
+ * @brief Prepare a parser
+ *
+ * @param p Parser
+ * @param boundary Boundary from the Content-Type header
+ * @param on_data Callback for the file part's body
+ * @param ctx Context for the callback
+ * @return false if the boundary is empty or longer than MULTIPART_BOUNDARY_MAX
+ */
+bool multipart_stream_init(multipart_stream_t *p, const char *boundary, multipart_data_fn on_data, void *ctx);
+
+/**
+ * @brief Parse the next piece of the request body
+ *
+ * Once MULTIPART_FILE_DONE or MULTIPART_ERROR is returned, further calls
+ * return the same result without looking at the data.
+ *
+ * @param p Parser
+ * @param data Body bytes
+ * @param len Number of bytes
+ * @return Parser state after the piece
+ */
+multipart_result_t multipart_stream_feed(multipart_stream_t *p, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MULTIPART_STREAM_H
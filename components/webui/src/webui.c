@@ -26,104 +26,134 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "webui_api.h"
+#include "webui_assets.h"
+#include "webui_metrics.h"
+#include "webui_stream.h"
+#include "sdkconfig.h"
 #include "lwip/sockets.h"
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
-// Forward declarations for HTML content functions
-const char *webui_get_index_html(void);
-const char *webui_get_ota_html(void);
-const char *webui_get_nau7802_html(void);
-// Removed - use API instead
+#ifdef CONFIG_OPENER_WEBUI_STREAM_MAX_CLIENTS
+#define WEBUI_STREAM_MAX_CLIENTS CONFIG_OPENER_WEBUI_STREAM_MAX_CLIENTS
+#else
+#define WEBUI_STREAM_MAX_CLIENTS 4
+#endif
 
 static const char *TAG = "webui";
 static httpd_handle_t server_handle = NULL;
 
-static esp_err_t root_handler(httpd_req_t *req)
+static bool etag_matches(httpd_req_t *req, const char *etag)
 {
-    const char *html = webui_get_index_html();
-    
-    // Calculate actual length by scanning for null terminator
-    // This handles cases where strlen() might stop early due to embedded nulls
-    size_t html_len = 0;
-    const char *p = html;
-    while (*p != '\0' && html_len < 200000) { // Safety limit of 200KB
-        html_len++;
-        p++;
+    char if_none_match[128];
+    size_t len = httpd_req_get_hdr_value_len(req, "If-None-Match");
+    if (len == 0 || len >= sizeof(if_none_match)) {
+        return false;
     }
-    
-    ESP_LOGI(TAG, "HTML string length: %zu bytes", html_len);
-    
-    // Verify the string ends with </html>
-    const char *html_end = "</html>";
-    size_t html_end_len = strlen(html_end);
-    if (html_len < html_end_len || strncmp(html + html_len - html_end_len, html_end, html_end_len) != 0) {
-        ESP_LOGW(TAG, "HTML string may be truncated! Length: %zu, Last 30 bytes: %.30s", html_len, html + (html_len > 30 ? html_len - 30 : 0));
-    } else {
-        ESP_LOGI(TAG, "HTML string appears complete, ends with </html>");
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) != ESP_OK) {
+        return false;
     }
-    
-    // Check if we hit the safety limit (indicates potential issue)
-    if (html_len >= 200000) {
-        ESP_LOGE(TAG, "HTML string appears to be too long or unterminated!");
-        return ESP_ERR_INVALID_SIZE;
-    }
-    
-    // Check for null bytes in the string (which would cause strlen to stop early)
-    for (size_t i = 0; i < html_len && i < 50000; i++) {
-        if (html[i] == '\0' && i < html_len - 1) {
-            ESP_LOGW(TAG, "Found null byte at position %zu (before end of string)", i);
-            break;
+    // The header may list several tags, possibly weak (W/"..."); any match will do
+    return strcmp(if_none_match, "*") == 0 || strstr(if_none_match, etag) != NULL;
+}
+
+// Whether an Accept-Encoding list allows gzip. An explicit gzip entry takes
+// precedence over "*"; either is refused only with q=0.
+static bool encoding_list_accepts_gzip(const char *list)
+{
+    int gzip_allowed = -1;
+    int wildcard_allowed = -1;
+
+    while (*list != '\0') {
+        const char *end = strchr(list, ',');
+        size_t item_len = end != NULL ? (size_t)(end - list) : strlen(list);
+        while (item_len > 0 && (*list == ' ' || *list == '\t')) {
+            list++;
+            item_len--;
         }
-    }
-    
-    httpd_resp_set_type(req, "text/html; charset=utf-8");
-    
-    // Use chunked transfer encoding for large responses
-    // This avoids buffer size limits in httpd_resp_send
-    httpd_resp_set_hdr(req, "Transfer-Encoding", "chunked");
-    
-    const size_t chunk_size = 4096;
-    size_t sent = 0;
-    esp_err_t ret = ESP_OK;
-    
-    while (sent < html_len && ret == ESP_OK) {
-        size_t to_send = (html_len - sent > chunk_size) ? chunk_size : (html_len - sent);
-        ret = httpd_resp_send_chunk(req, html + sent, to_send);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to send HTML chunk at offset %zu/%zu: %s", sent, html_len, esp_err_to_name(ret));
-            return ret;
+        size_t name_len = 0;
+        while (name_len < item_len && list[name_len] != ';' && list[name_len] != ' ' && list[name_len] != '\t') {
+            name_len++;
+        }
+
+        bool allowed = true;
+        const char *q = memchr(list, ';', item_len);
+        if (q != NULL) {
+            q++;
+            while (*q == ' ' || *q == '\t') {
+                q++;
+            }
+            if ((q[0] == 'q' || q[0] == 'Q') && q[1] == '=') {
+                allowed = strtod(&q[2], NULL) > 0.0;
+            }
         }
-        sent += to_send;
+
+        if ((name_len == 4 && strncasecmp(list, "gzip", 4) == 0) ||
+            (name_len == 6 && strncasecmp(list, "x-gzip", 6) == 0)) {
+            gzip_allowed = allowed;
+        } else if (name_len == 1 && list[0] == '*') {
+            wildcard_allowed = allowed;
+        }
+
+        if (end == NULL) {
+            break;
+        }
+        list = end + 1;
     }
-    
-    // Finalize chunked transfer
-    ret = httpd_resp_send_chunk(req, NULL, 0);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to finalize chunked transfer: %s", esp_err_to_name(ret));
-        return ret;
+
+    if (gzip_allowed >= 0) {
+        return gzip_allowed;
     }
-    
-    ESP_LOGI(TAG, "Successfully sent %zu bytes of HTML using chunked encoding", sent);
-    return ESP_OK;
+    return wildcard_allowed > 0;
 }
 
-
-static esp_err_t ota_handler(httpd_req_t *req)
+static bool client_accepts_gzip(httpd_req_t *req)
 {
-    const char *html = webui_get_ota_html();
-    size_t html_len = strlen(html);
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, html, html_len);
-    return ESP_OK;
+    char accept_encoding[128];
+    size_t len = httpd_req_get_hdr_value_len(req, "Accept-Encoding");
+    if (len == 0) {
+        return true; // No header: any content coding is acceptable (RFC 9110, 12.5.3)
+    }
+    if (len >= sizeof(accept_encoding) ||
+        httpd_req_get_hdr_value_str(req, "Accept-Encoding", accept_encoding, sizeof(accept_encoding)) != ESP_OK) {
+        return true; // Browsers send short lists; an unreadable one is not worth refusing the page over
+    }
+    return encoding_list_accepts_gzip(accept_encoding);
 }
 
-static esp_err_t nau7802_handler(httpd_req_t *req)
+static esp_err_t asset_handler(httpd_req_t *req)
 {
-    const char *html = webui_get_nau7802_html();
-    size_t html_len = strlen(html);
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, html, html_len);
-    return ESP_OK;
+    const webui_asset_t *asset = (const webui_asset_t *)req->user_ctx;
+
+    // no-cache lets the browser keep the page but makes it revalidate on every
+    // load, so a firmware update is picked up immediately
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+    // Only the compressed page is stored, so a client that refuses gzip
+    // cannot be served
+    if (!client_accepts_gzip(req)) {
+        ESP_LOGW(TAG, "Client does not accept gzip, refusing %s", asset->uri);
+        httpd_resp_set_status(req, "406 Not Acceptable");
+        httpd_resp_set_type(req, "text/plain");
+        return httpd_resp_sendstr(req, "This page is only available gzip-compressed\n");
+    }
+
+    if (etag_matches(req, asset->etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    // Pages are compressed at build time and sent in a single response
+    httpd_resp_set_type(req, asset->content_type);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    esp_err_t ret = httpd_resp_send(req, (const char *)asset->data, asset->size);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send %s: %s", asset->uri, esp_err_to_name(ret));
+    }
+    return ret;
 }
 
 // Removed - use API instead
@@ -136,28 +166,6 @@ static esp_err_t favicon_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
-static const httpd_uri_t root_uri = {
-    .uri       = "/",
-    .method    = HTTP_GET,
-    .handler   = root_handler,
-    .user_ctx  = NULL
-};
-
-
-static const httpd_uri_t ota_uri = {
-    .uri       = "/ota",
-    .method    = HTTP_GET,
-    .handler   = ota_handler,
-    .user_ctx  = NULL
-};
-
-static const httpd_uri_t nau7802_uri = {
-    .uri       = "/nau7802",
-    .method    = HTTP_GET,
-    .handler   = nau7802_handler,
-    .user_ctx  = NULL
-};
-
 // Removed - use API instead
 
 static const httpd_uri_t favicon_uri = {
@@ -177,7 +185,7 @@ bool webui_init(void)
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
     config.max_uri_handlers = 35; // Increased to accommodate all API endpoints (currently 34 handlers: 4 HTML + 30 API)
-    config.max_open_sockets = 7;
+    config.max_open_sockets = 7 + WEBUI_STREAM_MAX_CLIENTS; // Live stream viewers each hold a socket open
     config.stack_size = 20480; // Increased to 20KB for large HTML pages and file uploads
     config.task_priority = 5;
     config.core_id = 1; // Run on Core 1 with sensor task
@@ -194,13 +202,23 @@ bool webui_init(void)
         ESP_LOGI(TAG, "HTTP server started");
         
         // Register URI handlers
-        httpd_register_uri_handler(server_handle, &root_uri);
-        httpd_register_uri_handler(server_handle, &ota_uri);
-        httpd_register_uri_handler(server_handle, &nau7802_uri);
+        for (size_t i = 0; i < webui_asset_count; i++) {
+            httpd_uri_t asset_uri = {
+                .uri      = webui_assets[i].uri,
+                .method   = HTTP_GET,
+                .handler  = asset_handler,
+                .user_ctx = (void *)&webui_assets[i]
+            };
+            httpd_register_uri_handler(server_handle, &asset_uri);
+        }
         httpd_register_uri_handler(server_handle, &favicon_uri);
         
         // Register API handlers
         webui_register_api_handlers(server_handle);
+        webui_register_metrics_handler(server_handle);
+        if (webui_stream_start(server_handle) != ESP_OK) {
+            ESP_LOGW(TAG, "Live stream not available");
+        }
         
         return true;
     }
@@ -212,6 +230,7 @@ bool webui_init(void)
 void webui_stop(void)
 {
     if (server_handle != NULL) {
+        webui_stream_stop();
         httpd_stop(server_handle);
         server_handle = NULL;
         ESP_LOGI(TAG, "HTTP server stopped");
@@ -24,15 +24,26 @@
 #include "ota_manager.h"
 #include "system_config.h"
 #include "driver/i2c_master.h"
-#include "modbus_tcp.h"
 #include "ciptcpipinterface.h"
 #include "nvtcpip.h"
 #include "log_buffer.h"
 #include "nau7802.h"
+#include "nau7802_history.h"
+#include "nau7802_calibration_job.h"
+#include "i2c_scheduler.h"
+#include "modbus_register_map.h"
+#include "webui_stream.h"
+#include "json_writer.h"
+#include "multipart_stream.h"
+#include "binary_trace.h"
+#include "tracecontrol.h"
+#include "latency_probe.h"
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_system.h"
 #include "esp_ota_ops.h"
+#include "esp_app_desc.h"
+#include "esp_timer.h"
 #include "cJSON.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -41,9 +52,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
-#ifndef _GNU_SOURCE
-#define _GNU_SOURCE  /* For memmem() */
-#endif
+#include <inttypes.h>
 
 // Forward declarations for assembly access
 extern uint8_t g_assembly_data064[32];
@@ -55,42 +64,17 @@ extern SemaphoreHandle_t scale_application_get_assembly_mutex(void);
 
 static const char *TAG = "webui_api";
 
-// Cache for Modbus enabled state to avoid frequent NVS reads
-static bool s_cached_modbus_enabled = false;
-static bool s_modbus_enabled_cached = false;
-
-// Cache for I2C pull-up enabled state to avoid frequent NVS reads
-static bool s_cached_i2c_pullup_enabled = false;
-static bool s_i2c_pullup_enabled_cached = false;
-
-// Cache for NAU7802 enabled state to avoid frequent NVS reads
-static bool s_cached_nau7802_enabled = false;
-static bool s_nau7802_enabled_cached = false;
-static uint8_t s_cached_nau7802_byte_offset = 0;
-static bool s_nau7802_byte_offset_cached = false;
-static uint8_t s_cached_nau7802_unit = 1;  // Default to lbs
-static bool s_nau7802_unit_cached = false;
-static uint8_t s_cached_nau7802_gain = 7;  // Default to x128
-static bool s_nau7802_gain_cached = false;
-static uint8_t s_cached_nau7802_sample_rate = 3;  // Default to 80 SPS
-static bool s_nau7802_sample_rate_cached = false;
-static uint8_t s_cached_nau7802_channel = 0;  // Default to Channel 1
-static bool s_nau7802_channel_cached = false;
-static uint8_t s_cached_nau7802_ldo = 4;  // Default to 3.3V
-static bool s_nau7802_ldo_cached = false;
-static uint8_t s_cached_nau7802_average = 1;  // Default to 1 sample (no averaging)
-static bool s_nau7802_average_cached = false;
-
 // Forward declarations for NAU7802 access functions (implemented in main.c)
-extern nau7802_t* scale_application_get_nau7802_handle(void);
-extern bool scale_application_is_nau7802_initialized(void);
-extern SemaphoreHandle_t scale_application_get_nau7802_mutex(void);
+extern uint8_t scale_application_get_nau7802_count(void);
+extern nau7802_t* scale_application_get_nau7802_handle(uint8_t channel);
+extern bool scale_application_is_nau7802_initialized(uint8_t channel);
+extern SemaphoreHandle_t scale_application_get_nau7802_mutex(uint8_t channel);
 
 // Mutex for protecting g_tcpip structure access (shared between OpENer task and API handlers)
 static SemaphoreHandle_t s_tcpip_mutex = NULL;
 
-// Helper function to send JSON response
-static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, esp_err_t status_code)
+// Helper function to send JSON response with an explicit HTTP status line
+static esp_err_t send_json_with_status(httpd_req_t *req, cJSON *json, const char *status)
 {
     char *json_str = cJSON_Print(json);
     if (json_str == NULL) {
@@ -100,7 +84,7 @@ static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, esp_err_t sta
     }
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_status(req, status_code == ESP_OK ? "200 OK" : "400 Bad Request");
+    httpd_resp_set_status(req, status);
     httpd_resp_send(req, json_str, strlen(json_str));
     
     free(json_str);
@@ -108,35 +92,88 @@ static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, esp_err_t sta
     return ESP_OK;
 }
 
-// Helper function to send JSON error response
-static esp_err_t send_json_error(httpd_req_t *req, const char *message, int http_status)
+// Helper function to send JSON response
+static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, esp_err_t status_code)
 {
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "status", "error");
-    cJSON_AddStringToObject(json, "message", message);
-    
-    char *json_str = cJSON_Print(json);
-    if (json_str == NULL) {
-        cJSON_Delete(json);
-        httpd_resp_send_500(req);
+    return send_json_with_status(req, json, status_code == ESP_OK ? "200 OK" : "400 Bad Request");
+}
+
+// Output callback for the streaming JSON writer: every flush is one HTTP chunk
+static bool json_chunk_flush(void *ctx, const char *data, size_t len)
+{
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len) == ESP_OK;
+}
+
+// Start a JSON response written with the streaming writer (no heap use).
+// The top-level object is open when this returns. Set the status line first.
+static void json_begin(httpd_req_t *req, json_writer_t *w)
+{
+    httpd_resp_set_type(req, "application/json");
+    json_writer_init(w, json_chunk_flush, req);
+    json_writer_object_begin(w, NULL);
+}
+
+// Close the top-level object and complete the response. A document that fit
+// in the writer's buffer goes out in one send with a Content-Length header.
+static esp_err_t json_end(httpd_req_t *req, json_writer_t *w)
+{
+    json_writer_object_end(w);
+    if (w->flushed == 0 && !w->failed && w->depth == 0) {
+        return httpd_resp_send(req, w->buf, w->len);
+    }
+    if (!json_writer_finish(w)) {
+        ESP_LOGW(TAG, "JSON response for %s was not completed", req->uri);
         return ESP_FAIL;
     }
-    
-    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Helper function to send JSON error response
+static esp_err_t send_json_error(httpd_req_t *req, const char *message, int http_status)
+{
     if (http_status == 400) {
         httpd_resp_set_status(req, "400 Bad Request");
+    } else if (http_status == 404) {
+        httpd_resp_set_status(req, "404 Not Found");
+    } else if (http_status == 408) {
+        httpd_resp_set_status(req, "408 Request Timeout");
+    } else if (http_status == 409) {
+        httpd_resp_set_status(req, "409 Conflict");
     } else if (http_status == 500) {
         httpd_resp_set_status(req, "500 Internal Server Error");
+    } else if (http_status == 503) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
     } else {
         httpd_resp_set_status(req, "400 Bad Request");
     }
-    httpd_resp_send(req, json_str, strlen(json_str));
     
-    free(json_str);
-    cJSON_Delete(json);
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_string(&w, "status", "error");
+    json_writer_string(&w, "message", message);
+    json_end(req, &w);
     return ESP_OK;
 }
 
+// Scale channel from the "scale" query parameter (0 if absent).
+// Returns false, after sending a 400 response, if the channel does not exist.
+static bool get_scale_channel(httpd_req_t *req, uint8_t *channel)
+{
+    char query[64];
+    char value[8];
+    *channel = 0;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "scale", value, sizeof(value)) == ESP_OK) {
+        long requested = strtol(value, NULL, 10);
+        if (requested < 0 || requested >= scale_application_get_nau7802_count()) {
+            send_json_error(req, "Invalid scale channel", 400);
+            return false;
+        }
+        *channel = (uint8_t)requested;
+    }
+    return true;
+}
+
 // POST /api/reboot - Reboot the device
 static esp_err_t api_reboot_handler(httpd_req_t *req)
 {
@@ -157,6 +194,15 @@ static esp_err_t api_reboot_handler(httpd_req_t *req)
     return ret; // This will never be reached
 }
 
+#define OTA_RECV_BUFFER_SIZE 4096  // Bytes per httpd_req_recv() of a firmware upload
+
+// Firmware bytes from the multipart parser go to the OTA writer task
+static bool ota_upload_data(void *ctx, const uint8_t *data, size_t len)
+{
+    *(size_t *)ctx += len;
+    return ota_manager_pipeline_write(data, len);
+}
+
 // POST /api/ota/update - Trigger OTA update (supports both URL and file upload)
 static esp_err_t api_ota_update_handler(httpd_req_t *req)
 {
@@ -172,9 +218,11 @@ static esp_err_t api_ota_update_handler(httpd_req_t *req)
     
     ESP_LOGI(TAG, "OTA update request, Content-Type: %s", content_type);
     
-    // Handle file upload (multipart/form-data) - Use streaming to avoid memory issues
+    // Handle file upload (multipart/form-data): the multipart parser feeds the
+    // firmware into the OTA pipeline, whose writer task programs the flash
+    // while the next data is received
     if (strstr(content_type, "multipart/form-data") != NULL) {
-        // Get content length - may be 0 if chunked transfer
+        int64_t upload_start = esp_timer_get_time();
         size_t content_len = req->content_len;
         ESP_LOGI(TAG, "Content-Length: %d", content_len);
         
@@ -190,442 +238,99 @@ static esp_err_t api_ota_update_handler(httpd_req_t *req)
             ESP_LOGW(TAG, "Could not determine partition size, using default: %d bytes", max_firmware_size);
         }
         
-        // Validate size against partition capacity
-        if (content_len > 0 && content_len > max_firmware_size) {
+        // The multipart framing adds a few hundred bytes; the partition size is
+        // enforced exactly by esp_ota_write()
+        if (content_len > max_firmware_size + 4096) {
             ESP_LOGW(TAG, "Content length too large: %d bytes (max: %d bytes)", content_len, max_firmware_size);
             return send_json_error(req, "File too large for OTA partition", 400);
         }
         
-        // Parse multipart boundary first
-        const char *boundary_str = strstr(content_type, "boundary=");
-        if (boundary_str == NULL) {
-            ESP_LOGW(TAG, "No boundary found in Content-Type");
+        char boundary[MULTIPART_BOUNDARY_MAX + 1];
+        if (!multipart_stream_get_boundary(content_type, boundary, sizeof(boundary))) {
+            ESP_LOGW(TAG, "No valid boundary in Content-Type");
             return send_json_error(req, "Invalid multipart data: no boundary", 400);
         }
-        boundary_str += 9; // Skip "boundary="
-        
-        // Extract boundary value
-        char boundary[128];
-        int boundary_len = 0;
-        while (*boundary_str && *boundary_str != ';' && *boundary_str != ' ' && *boundary_str != '\r' && *boundary_str != '\n' && boundary_len < 127) {
-            boundary[boundary_len++] = *boundary_str++;
-        }
-        boundary[boundary_len] = '\0';
         ESP_LOGI(TAG, "Multipart boundary: %s", boundary);
         
-        // Use a small buffer to read multipart headers (64KB should be enough)
-        const size_t header_buffer_size = 64 * 1024;
-        char *header_buffer = malloc(header_buffer_size);
-        if (header_buffer == NULL) {
-            ESP_LOGE(TAG, "Failed to allocate memory for header buffer");
+        multipart_stream_t *parser = malloc(sizeof(multipart_stream_t));
+        uint8_t *recv_buffer = malloc(OTA_RECV_BUFFER_SIZE);
+        if (parser == NULL || recv_buffer == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate upload buffers");
+            free(parser);
+            free(recv_buffer);
             return send_json_error(req, "Failed to allocate memory", 500);
         }
+        size_t firmware_bytes = 0;
+        multipart_stream_init(parser, boundary, ota_upload_data, &firmware_bytes);
         
-        // Read enough to find the data separator (\r\n\r\n)
-        size_t header_read = 0;
-        bool found_separator = false;
-        uint32_t header_timeout_count = 0;
-        const uint32_t max_header_timeouts = 50; // Max 50 timeouts (~5 seconds at 100ms each)
-        
-        while (header_read < header_buffer_size - 1) {
-            int ret = httpd_req_recv(req, header_buffer + header_read, header_buffer_size - header_read - 1);
-            if (ret <= 0) {
-                if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
-                    header_timeout_count++;
-                    if (header_timeout_count > max_header_timeouts) {
-                        ESP_LOGE(TAG, "Too many timeouts reading multipart headers");
-                        free(header_buffer);
-                        return send_json_error(req, "Timeout reading request headers", 408);
-                    }
-                    continue;
-                }
-                ESP_LOGE(TAG, "Error reading headers: %d", ret);
-                free(header_buffer);
-                return send_json_error(req, "Failed to read request headers", 500);
-            }
-            header_timeout_count = 0; // Reset timeout counter on successful read
-            header_read += ret;
-            header_buffer[header_read] = '\0'; // Null terminate for string search
-            
-            // Look for data separator
-            if (strstr(header_buffer, "\r\n\r\n") != NULL || strstr(header_buffer, "\n\n") != NULL) {
-                found_separator = true;
-                break;
-            }
-        }
-        
-        if (!found_separator) {
-            ESP_LOGW(TAG, "Could not find data separator in multipart headers");
-            free(header_buffer);
-            return send_json_error(req, "Invalid multipart format: no data separator", 400);
-        }
-        
-        // Find where data starts
-        char *data_start = strstr(header_buffer, "\r\n\r\n");
-        size_t header_len = 0;
-        if (data_start != NULL) {
-            header_len = (data_start - header_buffer) + 4;
-        } else {
-            data_start = strstr(header_buffer, "\n\n");
-            if (data_start != NULL) {
-                header_len = (data_start - header_buffer) + 2;
-            } else {
-                free(header_buffer);
-                return send_json_error(req, "Invalid multipart format", 400);
-            }
-        }
-        
-        // Calculate how much data we already have in the buffer
-        size_t data_in_buffer = header_read - header_len;
-        
-        // Start streaming OTA update
-        // Estimate firmware size: Content-Length minus multipart headers (typically ~1KB)
-        // This gives us a reasonable estimate for progress tracking
-        size_t estimated_firmware_size = 0;
-        if (content_len > 0) {
-            // Subtract estimated multipart header overhead (boundary + headers ~1KB)
-            estimated_firmware_size = (content_len > 1024) ? (content_len - 1024) : content_len;
-        }
-        esp_ota_handle_t ota_handle = ota_manager_start_streaming_update(estimated_firmware_size);
-        if (ota_handle == 0) {
+        // Multipart overhead is typically well under 1 KB; used for progress only
+        size_t estimated_firmware_size = (content_len > 1024) ? (content_len - 1024) : content_len;
+        if (!ota_manager_pipeline_begin(estimated_firmware_size)) {
             ESP_LOGE(TAG, "Failed to start streaming OTA update - check serial logs for details");
-            free(header_buffer);
+            free(parser);
+            free(recv_buffer);
             return send_json_error(req, "Failed to start OTA update. Check device logs for details.", 500);
         }
         
-        // Prepare boundary strings for detection
-        char start_boundary[256];
-        char end_boundary[256];
-        snprintf(start_boundary, sizeof(start_boundary), "--%s", boundary);
-        snprintf(end_boundary, sizeof(end_boundary), "--%s--", boundary);
-        
-        bool done = false;
-        
-        // Write data we already have in buffer (check for boundary first)
-        if (data_in_buffer > 0) {
-            // Check if boundary is already in the initial data
-            char *boundary_in_header = strstr((char *)(header_buffer + header_len), start_boundary);
-            
-            if (boundary_in_header != NULL) {
-                // Boundary found in initial data - only write up to it
-                size_t initial_to_write = boundary_in_header - (header_buffer + header_len);
-                // Remove trailing \r\n
-                while (initial_to_write > 0 && 
-                       (header_buffer[header_len + initial_to_write - 1] == '\r' || 
-                        header_buffer[header_len + initial_to_write - 1] == '\n')) {
-                    initial_to_write--;
-                }
-                if (initial_to_write > 0) {
-                    if (!ota_manager_write_streaming_chunk(ota_handle, (const uint8_t *)(header_buffer + header_len), initial_to_write)) {
-                        ESP_LOGE(TAG, "Failed to write initial chunk");
-                        free(header_buffer);
-                        return send_json_error(req, "Failed to write firmware data", 500);
-                    }
-                    data_in_buffer = initial_to_write;
-                } else {
-                    data_in_buffer = 0;  // No data to write, boundary was at start
-                }
-                done = true;  // We're done, boundary found
-            } else {
-                // No boundary in initial data, write it all
-                if (!ota_manager_write_streaming_chunk(ota_handle, (const uint8_t *)(header_buffer + header_len), data_in_buffer)) {
-                    ESP_LOGE(TAG, "Failed to write initial chunk");
-                    free(header_buffer);
-                    return send_json_error(req, "Failed to write firmware data", 500);
-                }
-            }
-        }
-        
-        free(header_buffer); // Free header buffer, we'll use a smaller chunk buffer now
-        
-        // If boundary was found in initial data, we're done
-        if (done) {
-            ESP_LOGI(TAG, "Streamed %d bytes to OTA partition", data_in_buffer);
-            
-            // Finish OTA update
-            cJSON *response = cJSON_CreateObject();
-            cJSON_AddStringToObject(response, "status", "ok");
-            cJSON_AddStringToObject(response, "message", "Firmware uploaded successfully. Finishing update and rebooting...");
-            
-            esp_err_t resp_err = send_json_response(req, response, ESP_OK);
-            vTaskDelay(pdMS_TO_TICKS(100));
-            
-            if (!ota_manager_finish_streaming_update(ota_handle)) {
-                ESP_LOGE(TAG, "Failed to finish streaming OTA update");
-                return ESP_FAIL;
-            }
-            return resp_err;
-        }
-        
-        // Stream remaining data in chunks (64KB chunks)
-        const size_t chunk_size = 64 * 1024;
-        char *chunk_buffer = malloc(chunk_size);
-        if (chunk_buffer == NULL) {
-            ESP_LOGE(TAG, "Failed to allocate chunk buffer");
-            // Abort OTA update since we can't continue
-            esp_ota_abort(ota_handle);
-            return send_json_error(req, "Failed to allocate memory", 500);
-        }
-        
-        // Keep a buffer of the last chunk to search for boundary when connection closes
-        // We'll keep the last 4KB to ensure we catch the boundary (boundary + multipart overhead can be ~1KB)
-        const size_t last_chunk_buffer_size = 4096;
-        char *last_chunk_buffer = malloc(last_chunk_buffer_size);
-        size_t last_chunk_size = 0;
-        if (last_chunk_buffer == NULL) {
-            ESP_LOGE(TAG, "Failed to allocate last chunk buffer");
-            free(chunk_buffer);
-            esp_ota_abort(ota_handle);
-            return send_json_error(req, "Failed to allocate memory", 500);
-        }
-        
-        size_t total_written = data_in_buffer;
+        size_t remaining = content_len;
         uint32_t timeout_count = 0;
-        const uint32_t max_timeouts = 100; // Max 100 timeouts (~10 seconds at 100ms each)
+        const uint32_t max_timeouts = 100; // Max 100 consecutive timeouts
+        multipart_result_t result = MULTIPART_NEED_MORE;
+        const char *error = NULL;
+        int error_status = 400;
         
-        // Calculate expected firmware size for validation
-        size_t expected_firmware_bytes = 0;
-        if (content_len > 0) {
-            // Account for multipart overhead (boundary + headers, typically ~1KB)
-            expected_firmware_bytes = (content_len > 1024) ? (content_len - 1024) : content_len;
-        }
-        
-        while (!done) {
-            int ret = httpd_req_recv(req, chunk_buffer, chunk_size);
-            if (ret <= 0) {
-                if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
-                    timeout_count++;
-                    if (timeout_count > max_timeouts) {
-                        ESP_LOGE(TAG, "Too many timeouts during upload, aborting");
-                        esp_ota_abort(ota_handle);
-                        free(chunk_buffer);
-                        return send_json_error(req, "Upload timeout - connection too slow", 408);
-                    }
-                    continue;
-                }
-                
-                // ret == 0 means connection closed by client (EOF)
-                // This is normal when client finishes sending data
-                // If we haven't found the boundary yet, search the last chunk buffer
-                if (ret == 0) {
-                    if (done) {
-                        // Already found boundary, connection close is expected
-                        ESP_LOGI(TAG, "Connection closed by client after boundary found, total written: %d bytes", total_written);
-                        break;
-                    } else {
-                        // Connection closed without finding boundary - search the last chunk buffer
-                        if (last_chunk_size > 0) {
-                            ESP_LOGI(TAG, "Searching last %d bytes for boundary after connection close", last_chunk_size);
-                            char *boundary_pos = NULL;
-                            
-                            // Search for end boundary first
-                            char *end_match = (char *)memmem(last_chunk_buffer, last_chunk_size, end_boundary, strlen(end_boundary));
-                            if (end_match != NULL) {
-                                // Verify it's actually a boundary by checking for \r\n before it
-                                if (end_match == last_chunk_buffer || 
-                                    (end_match > last_chunk_buffer && end_match[-1] == '\n' && 
-                                     (end_match == last_chunk_buffer + 1 || end_match[-2] == '\r'))) {
-                                    boundary_pos = end_match;
-                                }
-                            }
-                            
-                            // If not found, check for start boundary
-                            if (boundary_pos == NULL) {
-                                char *start_match = (char *)memmem(last_chunk_buffer, last_chunk_size, start_boundary, strlen(start_boundary));
-                                if (start_match != NULL) {
-                                    // Verify it's actually a boundary
-                                    if (start_match == last_chunk_buffer || 
-                                        (start_match > last_chunk_buffer && start_match[-1] == '\n' && 
-                                         (start_match == last_chunk_buffer + 1 || start_match[-2] == '\r'))) {
-                                        size_t end_boundary_len = strlen(end_boundary);
-                                        if (start_match + end_boundary_len > last_chunk_buffer + last_chunk_size || 
-                                            memcmp(start_match, end_boundary, end_boundary_len) != 0) {
-                                            boundary_pos = start_match;
-                                        }
-                                    }
-                                }
-                            }
-                            
-                            if (boundary_pos != NULL) {
-                                // Found boundary in last chunk - calculate how much we wrote too many
-                                size_t bytes_before_boundary = boundary_pos - last_chunk_buffer;
-                                // Remove trailing \r\n
-                                while (bytes_before_boundary > 0 && 
-                                       (last_chunk_buffer[bytes_before_boundary - 1] == '\r' || 
-                                        last_chunk_buffer[bytes_before_boundary - 1] == '\n')) {
-                                    bytes_before_boundary--;
-                                }
-                                if (bytes_before_boundary >= 2 && 
-                                    last_chunk_buffer[bytes_before_boundary - 2] == '\r' && 
-                                    last_chunk_buffer[bytes_before_boundary - 1] == '\n') {
-                                    bytes_before_boundary -= 2;
-                                } else if (bytes_before_boundary >= 1 && 
-                                           last_chunk_buffer[bytes_before_boundary - 1] == '\n') {
-                                    bytes_before_boundary -= 1;
-                                }
-                                
-                                // Calculate how many extra bytes we wrote
-                                size_t extra_bytes = last_chunk_size - bytes_before_boundary;
-                                if (extra_bytes > 0 && total_written >= extra_bytes) {
-                                    ESP_LOGW(TAG, "Found boundary in last chunk - wrote %d extra bytes, but cannot undo write", extra_bytes);
-                                    // Note: We can't undo the write, but at least we know where the boundary was
-                                }
-                                ESP_LOGI(TAG, "Boundary found in last chunk at offset %d", (int)(boundary_pos - last_chunk_buffer));
-                            } else {
-                                ESP_LOGW(TAG, "Boundary not found in last %d bytes", last_chunk_size);
-                            }
-                        }
-                        
-                        ESP_LOGW(TAG, "Connection closed by client without finding boundary, received %d bytes (expected ~%d)", 
-                                 total_written, expected_firmware_bytes);
-                        break;
-                    }
-                } else {
-                    // Negative ret value indicates actual error
-                    ESP_LOGE(TAG, "Connection error during upload (ret=%d), aborting OTA", ret);
-                    esp_ota_abort(ota_handle);
-                    free(chunk_buffer);
-                    return send_json_error(req, "Connection error during upload", 500);
-                }
-            }
-            timeout_count = 0; // Reset timeout counter on successful read
-            
-            // Search for boundary markers in this chunk
-            // Only search near the end of chunks to avoid false positives in binary data
-            // Binary firmware can contain any byte sequence, so we need to be careful
-            char *boundary_pos = NULL;
-            size_t to_write = ret;
-            
-            // Determine search range:
-            // - If chunk is small (< 1KB), search entire chunk (likely last chunk)
-            // - If we're close to expected end (within 1KB), search entire chunk
-            // - Otherwise, only search last 512 bytes to avoid false positives
-            size_t search_start_offset = 0;
-            size_t search_len = ret;
-            
-            if (ret > 1024) {
-                // Large chunk - only search last portion unless we're close to expected end
-                if (expected_firmware_bytes > 0 && total_written + ret >= expected_firmware_bytes - 2048) {
-                    // Close to expected end (within 2KB) - search entire chunk aggressively
-                    search_start_offset = 0;
-                    search_len = ret;
-                } else {
-                    // Not close to end - search last 1KB (increased for better detection)
-                    search_start_offset = (ret > 1024) ? (ret - 1024) : 0;
-                    search_len = (ret > 1024) ? 1024 : ret;
-                }
-            }
-            // else: small chunk (< 1KB), search entire chunk
-            
-            char *search_start = chunk_buffer + search_start_offset;
-            
-            // First check for end boundary (--boundary--) - this is the final boundary
-            char *end_match = (char *)memmem(search_start, search_len, end_boundary, strlen(end_boundary));
-            if (end_match != NULL) {
-                // Verify it's actually a boundary by checking for \r\n before it
-                if (end_match == chunk_buffer || 
-                    (end_match > chunk_buffer && end_match[-1] == '\n' && 
-                     (end_match == chunk_buffer + 1 || end_match[-2] == '\r'))) {
-                    boundary_pos = end_match;
-                }
-            }
-            
-            // If not found, check for start boundary (--boundary) - this indicates next part
-            if (boundary_pos == NULL) {
-                char *start_match = (char *)memmem(search_start, search_len, start_boundary, strlen(start_boundary));
-                if (start_match != NULL) {
-                    // Verify it's actually a boundary by checking for \r\n before it
-                    if (start_match == chunk_buffer || 
-                        (start_match > chunk_buffer && start_match[-1] == '\n' && 
-                         (start_match == chunk_buffer + 1 || start_match[-2] == '\r'))) {
-                        // Make sure it's not the end boundary (which starts with the same string)
-                        size_t end_boundary_len = strlen(end_boundary);
-                        if (start_match + end_boundary_len > chunk_buffer + ret || 
-                            memcmp(start_match, end_boundary, end_boundary_len) != 0) {
-                            boundary_pos = start_match;
-                        }
-                    }
-                }
-            }
-            
-            if (boundary_pos != NULL) {
-                // Found boundary - only write up to it (excluding the boundary itself and leading \r\n)
-                to_write = boundary_pos - chunk_buffer;
-                
-                // Remove any trailing \r\n before the boundary (multipart boundaries are preceded by \r\n)
-                // Go back to find the start of the line break sequence
-                while (to_write > 0 && (chunk_buffer[to_write - 1] == '\r' || chunk_buffer[to_write - 1] == '\n')) {
-                    to_write--;
-                }
-                
-                // Make sure we have a complete \r\n sequence removed
-                if (to_write >= 2 && chunk_buffer[to_write - 2] == '\r' && chunk_buffer[to_write - 1] == '\n') {
-                    to_write -= 2;
-                } else if (to_write >= 1 && chunk_buffer[to_write - 1] == '\n') {
-                    to_write -= 1;
-                }
-                
-                ESP_LOGI(TAG, "Boundary found at offset %d in chunk, writing %d bytes (chunk size: %d)", 
-                         (int)(boundary_pos - chunk_buffer), to_write, ret);
-                done = true;
+        while (result == MULTIPART_NEED_MORE) {
+            if (remaining == 0) {
+                error = "Upload incomplete - firmware part not terminated";
+                break;
             }
-            
-            if (to_write > 0) {
-                if (!ota_manager_write_streaming_chunk(ota_handle, (const uint8_t *)chunk_buffer, to_write)) {
-                    ESP_LOGE(TAG, "Failed to write chunk at offset %d", total_written);
-                    free(chunk_buffer);
-                    free(last_chunk_buffer);
-                    return send_json_error(req, "Failed to write firmware data", 500);
-                }
-                total_written += to_write;
-                
-                // Update last chunk buffer for boundary detection on connection close
-                // Keep the last portion of this chunk (up to last_chunk_buffer_size)
-                if (to_write <= last_chunk_buffer_size) {
-                    // Entire chunk fits in buffer
-                    memcpy(last_chunk_buffer, chunk_buffer, to_write);
-                    last_chunk_size = to_write;
-                } else {
-                    // Only keep the last portion
-                    memcpy(last_chunk_buffer, chunk_buffer + to_write - last_chunk_buffer_size, last_chunk_buffer_size);
-                    last_chunk_size = last_chunk_buffer_size;
+            int ret = httpd_req_recv(req, (char *)recv_buffer,
+                                     remaining < OTA_RECV_BUFFER_SIZE ? remaining : OTA_RECV_BUFFER_SIZE);
+            if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+                if (++timeout_count > max_timeouts) {
+                    ESP_LOGE(TAG, "Too many timeouts during upload, aborting");
+                    error = "Upload timeout - connection too slow";
+                    error_status = 408;
+                    break;
                 }
+                continue;
             }
-            
-            // If we found the end boundary or any boundary, we're done - break immediately
-            if (done) {
+            if (ret <= 0) {
+                ESP_LOGE(TAG, "Connection closed or failed during upload (ret=%d)", ret);
+                error = "Upload incomplete - connection may have been interrupted";
                 break;
             }
+            timeout_count = 0;
+            remaining -= ret;
+            result = multipart_stream_feed(parser, recv_buffer, ret);
         }
         
-        free(chunk_buffer);
-        free(last_chunk_buffer);
-        
-        ESP_LOGI(TAG, "Streamed %d bytes to OTA partition", total_written);
-        
-        // Validate upload completeness if Content-Length was provided
-        if (content_len > 0) {
-            // Account for multipart overhead (boundary + headers, typically ~1KB)
-            size_t expected_firmware_bytes = (content_len > 1024) ? (content_len - 1024) : content_len;
-            // Allow 5% tolerance for multipart overhead variations
-            size_t min_expected = (expected_firmware_bytes * 95) / 100;
-            
-            if (total_written < min_expected) {
-                ESP_LOGE(TAG, "Upload incomplete: received %d bytes, expected at least %d bytes", 
-                         total_written, min_expected);
-                esp_ota_abort(ota_handle);
-                return send_json_error(req, "Upload incomplete - connection may have been interrupted", 400);
-            }
-            
-            // Warn if we wrote significantly more than expected (might have included boundary data)
-            if (total_written > expected_firmware_bytes + 500) {
-                ESP_LOGW(TAG, "Upload validation: received %d bytes, expected ~%d bytes (wrote %d bytes too many - boundary may not have been detected)", 
-                         total_written, expected_firmware_bytes, total_written - expected_firmware_bytes);
+        if (error == NULL && result == MULTIPART_ERROR) {
+            ESP_LOGE(TAG, "Upload failed: %s", parser->error);
+            if (strcmp(parser->error, "write failed") == 0) {
+                error = "Failed to write firmware data";
+                error_status = 500;
             } else {
-                ESP_LOGI(TAG, "Upload validation: received %d bytes, expected ~%d bytes (within tolerance)", 
-                         total_written, expected_firmware_bytes);
+                error = "Invalid multipart data";
             }
         }
+        free(parser);
+        free(recv_buffer);
+        
+        if (error != NULL) {
+            ota_manager_pipeline_abort();
+            return send_json_error(req, error, error_status);
+        }
+        
+        // Wait for the writer to program the last buffers
+        esp_ota_handle_t ota_handle = ota_manager_pipeline_end();
+        if (ota_handle == 0) {
+            return send_json_error(req, "Failed to write firmware data", 500);
+        }
+        
+        int64_t elapsed_ms = (esp_timer_get_time() - upload_start) / 1000;
+        ESP_LOGI(TAG, "Streamed %lu bytes to OTA partition in %lld ms (%lld KB/s)", (unsigned long)firmware_bytes, elapsed_ms,
+                 elapsed_ms > 0 ? (int64_t)firmware_bytes / elapsed_ms : 0);
         
         // Finish OTA update (this will set boot partition and reboot)
         // Send HTTP response BEFORE finishing, as the device will reboot
@@ -707,7 +412,6 @@ static esp_err_t api_ota_status_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
-    cJSON *json = cJSON_CreateObject();
     const char *status_str;
     switch (status_info.status) {
         case OTA_STATUS_IDLE:
@@ -727,29 +431,31 @@ static esp_err_t api_ota_status_handler(httpd_req_t *req)
             break;
     }
     
-    cJSON_AddStringToObject(json, "status", status_str);
-    cJSON_AddNumberToObject(json, "progress", status_info.progress);
-    cJSON_AddStringToObject(json, "message", status_info.message);
-    
-    return send_json_response(req, json, ESP_OK);
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_string(&w, "status", status_str);
+    json_writer_uint(&w, "progress", status_info.progress);
+    json_writer_string(&w, "message", status_info.message);
+    return json_end(req, &w);
 }
 
-// GET /api/modbus - Get Modbus enabled state
+// Word order of 32-bit register values as used in the API
+static const char *modbus_word_order_name(uint8_t word_order)
+{
+    return word_order == MODBUS_WORD_ORDER_LOW_FIRST ? "low_first" : "high_first";
+}
+
+// GET /api/modbus - Get Modbus settings
 static esp_err_t api_get_modbus_handler(httpd_req_t *req)
 {
-    // Use cached value if available, otherwise load from NVS and cache it
-    if (!s_modbus_enabled_cached) {
-        s_cached_modbus_enabled = system_modbus_enabled_load();
-        s_modbus_enabled_cached = true;
-    }
-    
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddBoolToObject(json, "enabled", s_cached_modbus_enabled);
-    
-    return send_json_response(req, json, ESP_OK);
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_bool(&w, "enabled", system_modbus_enabled_load());
+    json_writer_string(&w, "word_order", modbus_word_order_name(system_modbus_word_order_load()));
+    return json_end(req, &w);
 }
 
-// POST /api/modbus - Set Modbus enabled state
+// POST /api/modbus - Set Modbus enabled state and/or word order
 static esp_err_t api_post_modbus_handler(httpd_req_t *req)
 {
     char content[128];
@@ -766,42 +472,56 @@ static esp_err_t api_post_modbus_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
-    cJSON *item = cJSON_GetObjectItem(json, "enabled");
-    if (item == NULL || !cJSON_IsBool(item)) {
+    cJSON *enabled_item = cJSON_GetObjectItem(json, "enabled");
+    cJSON *order_item = cJSON_GetObjectItem(json, "word_order");
+    if (enabled_item == NULL && order_item == NULL) {
         cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid 'enabled' field");
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing 'enabled' or 'word_order' field");
         return ESP_FAIL;
     }
-    
-    bool enabled = cJSON_IsTrue(item);
-    cJSON_Delete(json);
-    
-    if (!system_modbus_enabled_save(enabled)) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save Modbus state");
+    if (enabled_item != NULL && !cJSON_IsBool(enabled_item)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid 'enabled' field");
         return ESP_FAIL;
     }
     
-    // Update cache when state changes
-    s_cached_modbus_enabled = enabled;
-    s_modbus_enabled_cached = true;
-    
-    // Apply the change immediately
-    if (enabled) {
-        if (!modbus_tcp_init()) {
-            ESP_LOGW(TAG, "Failed to initialize ModbusTCP");
+    int word_order = -1;
+    if (order_item != NULL) {
+        if (cJSON_IsString(order_item) && strcmp(order_item->valuestring, "high_first") == 0) {
+            word_order = MODBUS_WORD_ORDER_HIGH_FIRST;
+        } else if (cJSON_IsString(order_item) && strcmp(order_item->valuestring, "low_first") == 0) {
+            word_order = MODBUS_WORD_ORDER_LOW_FIRST;
         } else {
-            if (!modbus_tcp_start()) {
-                ESP_LOGW(TAG, "Failed to start ModbusTCP server");
-            }
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                "Invalid 'word_order' field (must be 'high_first' or 'low_first')");
+            return ESP_FAIL;
         }
-    } else {
-        modbus_tcp_stop();
     }
     
+    // Both settings in one transaction
+    system_config_t *config = system_config_begin();
+    if (enabled_item != NULL) {
+        config->modbus_enabled = cJSON_IsTrue(enabled_item);
+    }
+    if (word_order >= 0) {
+        config->modbus_word_order = (uint8_t)word_order;
+    }
+    cJSON_Delete(json);
+    
+    if (!system_config_commit()) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save Modbus settings");
+        return ESP_FAIL;
+    }
+    
+    // The server is started/stopped and the word order applied by the
+    // system_config change listener in main.c
+    
     cJSON *response = cJSON_CreateObject();
     cJSON_AddStringToObject(response, "status", "ok");
-    cJSON_AddBoolToObject(response, "enabled", enabled);
-    cJSON_AddStringToObject(response, "message", "Modbus state saved successfully");
+    cJSON_AddBoolToObject(response, "enabled", system_modbus_enabled_load());
+    cJSON_AddStringToObject(response, "word_order", modbus_word_order_name(system_modbus_word_order_load()));
+    cJSON_AddStringToObject(response, "message", "Modbus settings saved successfully");
     
     return send_json_response(req, response, ESP_OK);
 }
@@ -809,11 +529,11 @@ static esp_err_t api_post_modbus_handler(httpd_req_t *req)
 // GET /api/assemblies/sizes - Get assembly sizes
 static esp_err_t api_get_assemblies_sizes_handler(httpd_req_t *req)
 {
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddNumberToObject(json, "input_assembly_size", sizeof(g_assembly_data064));
-    cJSON_AddNumberToObject(json, "output_assembly_size", sizeof(g_assembly_data096));
-    
-    return send_json_response(req, json, ESP_OK);
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_uint(&w, "input_assembly_size", sizeof(g_assembly_data064));
+    json_writer_uint(&w, "output_assembly_size", sizeof(g_assembly_data096));
+    return json_end(req, &w);
 }
 
 // GET /api/status - Get assembly data for status pages
@@ -828,93 +548,141 @@ static esp_err_t api_get_status_handler(httpd_req_t *req)
         return send_json_error(req, "Failed to acquire assembly mutex", 500);
     }
     
-    cJSON *json = cJSON_CreateObject();
+    // Copy the assemblies so the mutex is not held while the response is sent
+    uint8_t input_data[sizeof(g_assembly_data064)];
+    uint8_t output_data[sizeof(g_assembly_data096)];
+    memcpy(input_data, g_assembly_data064, sizeof(input_data));
+    memcpy(output_data, g_assembly_data096, sizeof(output_data));
+    
+    xSemaphoreGive(mutex);
+    
+    json_writer_t w;
+    json_begin(req, &w);
     
     // Input assembly 100 (g_assembly_data064)
-    cJSON *input_assembly = cJSON_CreateObject();
-    cJSON *input_bytes = cJSON_CreateArray();
-    for (int i = 0; i < sizeof(g_assembly_data064); i++) {
-        cJSON_AddItemToArray(input_bytes, cJSON_CreateNumber(g_assembly_data064[i]));
-    }
-    cJSON_AddItemToObject(input_assembly, "raw_bytes", input_bytes);
-    
-    // Extract NAU7802 data from assembly if enabled and initialized
-    if (scale_application_is_nau7802_initialized()) {
-        // Use cached value for byte offset
-        if (!s_nau7802_byte_offset_cached) {
-            s_cached_nau7802_byte_offset = system_nau7802_byte_offset_load();
-            s_nau7802_byte_offset_cached = true;
-        }
-        uint8_t byte_offset = s_cached_nau7802_byte_offset;
+    json_writer_object_begin(&w, "input_assembly_100");
+    json_writer_array_begin(&w, "raw_bytes");
+    for (size_t i = 0; i < sizeof(input_data); i++) {
+        json_writer_uint(&w, NULL, input_data[i]);
+    }
+    json_writer_array_end(&w);
+    
+    // Extract NAU7802 channel 0 data from assembly if enabled and initialized
+    if (scale_application_is_nau7802_initialized(0)) {
+        uint8_t byte_offset = system_nau7802_byte_offset_load();
         
         // Check if we have valid NAU7802 data in assembly
         if (byte_offset <= 22) {  // Max offset for 10-byte data
             // Extract weight (int32_t, bytes 0-3)
             int32_t weight_scaled = 0;
-            memcpy(&weight_scaled, &g_assembly_data064[byte_offset], sizeof(int32_t));
+            memcpy(&weight_scaled, &input_data[byte_offset], sizeof(int32_t));
             
             // Extract raw reading (int32_t, bytes 4-7)
             int32_t raw_reading = 0;
-            memcpy(&raw_reading, &g_assembly_data064[byte_offset + 4], sizeof(int32_t));
+            memcpy(&raw_reading, &input_data[byte_offset + 4], sizeof(int32_t));
             
             // Extract unit code (uint8, byte 8)
-            uint8_t unit_code = g_assembly_data064[byte_offset + 8];
+            uint8_t unit_code = input_data[byte_offset + 8];
             const char *unit_str = (unit_code == 0) ? "g" : (unit_code == 1) ? "lbs" : "kg";
             
             // Extract status flags (uint8, byte 9)
-            uint8_t status_byte = g_assembly_data064[byte_offset + 9];
+            uint8_t status_byte = input_data[byte_offset + 9];
             bool available = (status_byte & 0x01) != 0;  // Bit 0
             bool connected = (status_byte & 0x02) != 0;  // Bit 1
             bool initialized = (status_byte & 0x04) != 0;  // Bit 2
+            bool stable = (status_byte & 0x08) != 0;  // Bit 3
+            bool in_motion = (status_byte & 0x10) != 0;  // Bit 4
+            bool center_of_zero = (status_byte & 0x20) != 0;  // Bit 5
             
             // Calculate actual weight from scaled value
             float weight_actual = (float)weight_scaled / 100.0f;
             
             // Add NAU7802 data to input assembly object
-            cJSON *nau7802_data = cJSON_CreateObject();
-            cJSON_AddNumberToObject(nau7802_data, "weight_scaled", weight_scaled);
-            cJSON_AddNumberToObject(nau7802_data, "weight", weight_actual);
-            cJSON_AddStringToObject(nau7802_data, "unit", unit_str);
-            cJSON_AddNumberToObject(nau7802_data, "unit_code", unit_code);
-            cJSON_AddNumberToObject(nau7802_data, "raw_reading", raw_reading);
-            cJSON_AddNumberToObject(nau7802_data, "byte_offset", byte_offset);
-            cJSON_AddBoolToObject(nau7802_data, "available", available);
-            cJSON_AddBoolToObject(nau7802_data, "connected", connected);
-            cJSON_AddBoolToObject(nau7802_data, "initialized", initialized);
-            cJSON_AddNumberToObject(nau7802_data, "status_byte", status_byte);
-            cJSON_AddItemToObject(input_assembly, "nau7802", nau7802_data);
+            json_writer_object_begin(&w, "nau7802");
+            json_writer_int(&w, "weight_scaled", weight_scaled);
+            json_writer_float(&w, "weight", weight_actual);
+            json_writer_string(&w, "unit", unit_str);
+            json_writer_uint(&w, "unit_code", unit_code);
+            json_writer_int(&w, "raw_reading", raw_reading);
+            json_writer_uint(&w, "byte_offset", byte_offset);
+            json_writer_bool(&w, "available", available);
+            json_writer_bool(&w, "connected", connected);
+            json_writer_bool(&w, "initialized", initialized);
+            json_writer_bool(&w, "stable", stable);
+            json_writer_bool(&w, "in_motion", in_motion);
+            json_writer_bool(&w, "center_of_zero", center_of_zero);
+            json_writer_uint(&w, "status_byte", status_byte);
+            json_writer_object_end(&w);
         }
     }
-    
-    cJSON_AddItemToObject(json, "input_assembly_100", input_assembly);
+    json_writer_object_end(&w);
     
     // Output assembly 150 (g_assembly_data096)
-    cJSON *output_assembly = cJSON_CreateObject();
-    cJSON *output_bytes = cJSON_CreateArray();
-    for (int i = 0; i < sizeof(g_assembly_data096); i++) {
-        cJSON_AddItemToArray(output_bytes, cJSON_CreateNumber(g_assembly_data096[i]));
-    }
-    cJSON_AddItemToObject(output_assembly, "raw_bytes", output_bytes);
-    cJSON_AddItemToObject(json, "output_assembly_150", output_assembly);
-    
-    xSemaphoreGive(mutex);
-    return send_json_response(req, json, ESP_OK);
+    json_writer_object_begin(&w, "output_assembly_150");
+    json_writer_array_begin(&w, "raw_bytes");
+    for (size_t i = 0; i < sizeof(output_data); i++) {
+        json_writer_uint(&w, NULL, output_data[i]);
+    }
+    json_writer_array_end(&w);
+    json_writer_object_end(&w);
+    
+    // Live stream counters (GET /api/stream), cumulative since boot
+    webui_stream_stats_t stream_stats;
+    webui_stream_get_stats(&stream_stats);
+    json_writer_object_begin(&w, "stream");
+    json_writer_uint(&w, "clients", stream_stats.clients);
+    json_writer_uint(&w, "frames", stream_stats.frames);
+    json_writer_uint(&w, "sends", stream_stats.sends);
+    json_writer_uint(&w, "bytes", stream_stats.bytes);
+    json_writer_uint(&w, "dropped", stream_stats.dropped);
+    json_writer_uint(&w, "build_us", stream_stats.build_us);
+    json_writer_uint(&w, "fanout_us", stream_stats.fanout_us);
+    json_writer_object_end(&w);
+    
+    return json_end(req, &w);
 }
 
 
+// GET /api/i2c/stats - Per-device I2C scheduler statistics (?reset=true clears them after reading)
+static esp_err_t api_get_i2c_stats_handler(httpd_req_t *req)
+{
+    i2c_sched_device_stats_t stats[I2C_SCHED_MAX_DEVICES];
+    size_t count = i2c_sched_get_stats(stats, I2C_SCHED_MAX_DEVICES);
+    
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "reset", value, sizeof(value)) == ESP_OK &&
+        strcmp(value, "true") == 0) {
+        i2c_sched_reset_stats();
+    }
+    
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_array_begin(&w, "devices");
+    for (size_t i = 0; i < count; i++) {
+        json_writer_object_begin(&w, NULL);
+        json_writer_string(&w, "name", stats[i].name);
+        json_writer_uint(&w, "address", stats[i].address);
+        json_writer_uint(&w, "transactions", stats[i].transactions);
+        json_writer_uint(&w, "errors", stats[i].errors);
+        json_writer_uint(&w, "wait_avg_us", stats[i].wait_avg_us);
+        json_writer_uint(&w, "wait_max_us", stats[i].wait_max_us);
+        json_writer_uint(&w, "bus_avg_us", stats[i].bus_avg_us);
+        json_writer_uint(&w, "bus_max_us", stats[i].bus_max_us);
+        json_writer_object_end(&w);
+    }
+    json_writer_array_end(&w);
+    return json_end(req, &w);
+}
+
 // GET /api/i2c/pullup - Get I2C pull-up enabled state
 static esp_err_t api_get_i2c_pullup_handler(httpd_req_t *req)
 {
-    // Use cached value if available, otherwise load from NVS and cache it
-    if (!s_i2c_pullup_enabled_cached) {
-        s_cached_i2c_pullup_enabled = system_i2c_internal_pullup_load();
-        s_i2c_pullup_enabled_cached = true;
-    }
-    
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddBoolToObject(json, "enabled", s_cached_i2c_pullup_enabled);
-    
-    return send_json_response(req, json, ESP_OK);
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_bool(&w, "enabled", system_i2c_internal_pullup_load());
+    return json_end(req, &w);
 }
 
 // POST /api/i2c/pullup - Set I2C pull-up enabled state
@@ -949,10 +717,6 @@ static esp_err_t api_post_i2c_pullup_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
-    // Update cache when state changes
-    s_cached_i2c_pullup_enabled = enabled;
-    s_i2c_pullup_enabled_cached = true;
-    
     cJSON *response = cJSON_CreateObject();
     cJSON_AddStringToObject(response, "status", "ok");
     cJSON_AddBoolToObject(response, "enabled", enabled);
@@ -961,37 +725,68 @@ static esp_err_t api_post_i2c_pullup_handler(httpd_req_t *req)
     return send_json_response(req, response, ESP_OK);
 }
 
-// GET /api/logs - Get system logs
+// GET /api/logs?since=<position> - Logs written since the position (all stored logs without since)
+// Pass the returned "next" position on the following call to fetch only new lines
 static esp_err_t api_get_logs_handler(httpd_req_t *req)
 {
     if (!log_buffer_is_enabled()) {
         return send_json_error(req, "Log buffer not enabled", 503);
     }
     
-    // Get log buffer size
-    size_t log_size = log_buffer_get_size();
+    uint32_t tail;
+    uint32_t head;
+    log_buffer_get_range(&tail, &head);
     
-    // Allocate buffer for logs (limit to 32KB for API response)
-    size_t buffer_size = (log_size < 32 * 1024) ? log_size + 1 : 32 * 1024;
-    char *log_buffer = (char *)malloc(buffer_size);
-    if (log_buffer == NULL) {
-        return send_json_error(req, "Failed to allocate memory for logs", 500);
+    uint32_t since = tail;
+    char query[48];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK) {
+        since = (uint32_t)strtoul(value, NULL, 10);
+        if ((int32_t)(since - head) > 0) {
+            // Position from before a reboot: start over from the oldest stored line
+            since = tail;
+        }
     }
     
-    // Get logs
-    size_t bytes_read = log_buffer_get(log_buffer, buffer_size);
-    
-    // Create JSON response
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "status", "ok");
-    cJSON_AddStringToObject(json, "logs", log_buffer);
-    cJSON_AddNumberToObject(json, "size", bytes_read);
-    cJSON_AddNumberToObject(json, "total_size", log_size);
-    cJSON_AddBoolToObject(json, "truncated", bytes_read < log_size);
-    
-    free(log_buffer);
-    
-    return send_json_response(req, json, ESP_OK);
+    // Stream from the ring up to the head seen above. Records are copied into
+    // a small stack buffer and sent from there; the ring takes no lock, so
+    // logging never waits for this reader or the network.
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_string(&w, "status", "ok");
+    json_writer_string_begin(&w, "logs");
+    uint32_t position = since;
+    uint32_t lost = 0;
+    size_t size = 0;
+    char chunk[256];
+    while (!w.failed && position != head) {
+        uint32_t before = position;
+        uint32_t skipped;
+        size_t len = log_buffer_read(&position, chunk, sizeof(chunk), head, &skipped);
+        json_writer_string_append(&w, chunk, len);
+        lost += skipped;
+        size += len;
+        if (position == before) {
+            break;  // A line still being written; the next poll picks it up
+        }
+    }
+    json_writer_string_end(&w);
+    
+    log_buffer_stats_t stats;
+    log_buffer_get_stats(&stats);
+    json_writer_uint(&w, "since", since);
+    json_writer_uint(&w, "next", position);
+    json_writer_uint(&w, "lost", lost);
+    json_writer_uint(&w, "size", size);
+    json_writer_uint(&w, "total_size", log_buffer_get_size());
+    json_writer_bool(&w, "truncated", lost > 0);
+    json_writer_object_begin(&w, "counters");
+    json_writer_uint(&w, "lines", stats.lines);
+    json_writer_uint(&w, "truncated_lines", stats.truncated);
+    json_writer_uint(&w, "overrun", stats.overrun);
+    json_writer_object_end(&w);
+    return json_end(req, &w);
 }
 
 // Helper function to convert IP string to uint32_t (network byte order)
@@ -1052,26 +847,27 @@ static esp_err_t api_get_ipconfig_handler(httpd_req_t *req)
     xSemaphoreGive(s_tcpip_mutex);
     
     // Build JSON response outside of mutex (safer, no blocking)
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddBoolToObject(json, "use_dhcp", use_dhcp);
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_bool(&w, "use_dhcp", use_dhcp);
     
     char ip_str[16];
     ip_uint32_to_string(ip_address, ip_str, sizeof(ip_str));
-    cJSON_AddStringToObject(json, "ip_address", ip_str);
+    json_writer_string(&w, "ip_address", ip_str);
     
     ip_uint32_to_string(network_mask, ip_str, sizeof(ip_str));
-    cJSON_AddStringToObject(json, "netmask", ip_str);
+    json_writer_string(&w, "netmask", ip_str);
     
     ip_uint32_to_string(gateway, ip_str, sizeof(ip_str));
-    cJSON_AddStringToObject(json, "gateway", ip_str);
+    json_writer_string(&w, "gateway", ip_str);
     
     ip_uint32_to_string(name_server, ip_str, sizeof(ip_str));
-    cJSON_AddStringToObject(json, "dns1", ip_str);
+    json_writer_string(&w, "dns1", ip_str);
     
     ip_uint32_to_string(name_server_2, ip_str, sizeof(ip_str));
-    cJSON_AddStringToObject(json, "dns2", ip_str);
+    json_writer_string(&w, "dns2", ip_str);
     
-    return send_json_response(req, json, ESP_OK);
+    return json_end(req, &w);
 }
 
 // POST /api/ipconfig - Set IP configuration
@@ -1217,53 +1013,30 @@ static esp_err_t api_post_ipconfig_handler(httpd_req_t *req)
     return send_json_response(req, response, ESP_OK);
 }
 
-// GET /api/nau7802 - Get NAU7802 scale reading, status, and configuration
+// GET /api/nau7802?scale=<n> - Get NAU7802 scale reading, status, and configuration
 static esp_err_t api_get_nau7802_handler(httpd_req_t *req)
 {
-    // Use cached value if available, otherwise load from NVS and cache it
-    if (!s_nau7802_enabled_cached) {
-        s_cached_nau7802_enabled = system_nau7802_enabled_load();
-        s_nau7802_enabled_cached = true;
-    }
-    if (!s_nau7802_byte_offset_cached) {
-        s_cached_nau7802_byte_offset = system_nau7802_byte_offset_load();
-        s_nau7802_byte_offset_cached = true;
-    }
-    if (!s_nau7802_unit_cached) {
-        s_cached_nau7802_unit = system_nau7802_unit_load();
-        s_nau7802_unit_cached = true;
-    }
-    if (!s_nau7802_gain_cached) {
-        s_cached_nau7802_gain = system_nau7802_gain_load();
-        s_nau7802_gain_cached = true;
-    }
-    if (!s_nau7802_sample_rate_cached) {
-        s_cached_nau7802_sample_rate = system_nau7802_sample_rate_load();
-        s_nau7802_sample_rate_cached = true;
-    }
-    if (!s_nau7802_channel_cached) {
-        s_cached_nau7802_channel = system_nau7802_channel_load();
-        s_nau7802_channel_cached = true;
-    }
-    if (!s_nau7802_ldo_cached) {
-        s_cached_nau7802_ldo = system_nau7802_ldo_load();
-        s_nau7802_ldo_cached = true;
-    }
-    if (!s_nau7802_average_cached) {
-        s_cached_nau7802_average = system_nau7802_average_load();
-        s_nau7802_average_cached = true;
-    }
-    
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddBoolToObject(json, "enabled", s_cached_nau7802_enabled);
-    cJSON_AddNumberToObject(json, "byte_offset", s_cached_nau7802_byte_offset);
-    cJSON_AddNumberToObject(json, "unit", s_cached_nau7802_unit);
-    cJSON_AddNumberToObject(json, "gain", s_cached_nau7802_gain);
-    cJSON_AddNumberToObject(json, "sample_rate", s_cached_nau7802_sample_rate);
-    cJSON_AddNumberToObject(json, "channel", s_cached_nau7802_channel);
-    cJSON_AddNumberToObject(json, "ldo_value", s_cached_nau7802_ldo);
-    cJSON_AddNumberToObject(json, "average", s_cached_nau7802_average);
-    cJSON_AddBoolToObject(json, "initialized", scale_application_is_nau7802_initialized());
+    uint8_t scale;
+    if (!get_scale_channel(req, &scale)) {
+        return ESP_OK;  // Error response already sent
+    }
+    
+    system_config_t config;
+    system_config_get(&config);
+    
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_uint(&w, "scale", scale);
+    json_writer_uint(&w, "scale_count", scale_application_get_nau7802_count());
+    json_writer_bool(&w, "enabled", config.nau7802_enabled);
+    json_writer_uint(&w, "byte_offset", config.nau7802_byte_offset);
+    json_writer_uint(&w, "unit", config.nau7802_unit);
+    json_writer_uint(&w, "gain", config.nau7802_gain);
+    json_writer_uint(&w, "sample_rate", config.nau7802_sample_rate);
+    json_writer_uint(&w, "channel", config.nau7802_channel);
+    json_writer_uint(&w, "ldo_value", config.nau7802_ldo);
+    json_writer_uint(&w, "average", config.nau7802_average);
+    json_writer_bool(&w, "initialized", scale_application_is_nau7802_initialized(scale));
     
     // Add labels for better readability
     const char *gain_labels[] = {"x1", "x2", "x4", "x8", "x16", "x32", "x64", "x128"};
@@ -1271,28 +1044,28 @@ static esp_err_t api_get_nau7802_handler(httpd_req_t *req)
     const char *unit_labels[] = {"g", "lbs", "kg"};
     const float ldo_voltages[] = {4.5f, 4.2f, 3.9f, 3.6f, 3.3f, 3.0f, 2.7f, 2.4f};
     
-    if (s_cached_nau7802_gain < 8) {
-        cJSON_AddStringToObject(json, "gain_label", gain_labels[s_cached_nau7802_gain]);
+    if (config.nau7802_gain < 8) {
+        json_writer_string(&w, "gain_label", gain_labels[config.nau7802_gain]);
     }
-    if (s_cached_nau7802_sample_rate < 8 && sps_labels[s_cached_nau7802_sample_rate][0] != '\0') {
-        cJSON_AddStringToObject(json, "sample_rate_label", sps_labels[s_cached_nau7802_sample_rate]);
+    if (config.nau7802_sample_rate < 8 && sps_labels[config.nau7802_sample_rate][0] != '\0') {
+        json_writer_string(&w, "sample_rate_label", sps_labels[config.nau7802_sample_rate]);
     }
-    if (s_cached_nau7802_unit < 3) {
-        cJSON_AddStringToObject(json, "unit_label", unit_labels[s_cached_nau7802_unit]);
+    if (config.nau7802_unit < 3) {
+        json_writer_string(&w, "unit_label", unit_labels[config.nau7802_unit]);
     }
-    if (s_cached_nau7802_channel < 2) {
-        cJSON_AddStringToObject(json, "channel_label", s_cached_nau7802_channel == 0 ? "Channel 1" : "Channel 2");
+    if (config.nau7802_channel < 2) {
+        json_writer_string(&w, "channel_label", config.nau7802_channel == 0 ? "Channel 1" : "Channel 2");
     }
-    if (s_cached_nau7802_ldo < 8) {
-        cJSON_AddNumberToObject(json, "ldo_voltage", ldo_voltages[s_cached_nau7802_ldo]);
+    if (config.nau7802_ldo < 8) {
+        json_writer_float(&w, "ldo_voltage", ldo_voltages[config.nau7802_ldo]);
     }
     
     // Get scale reading if initialized
-    nau7802_t *nau7802 = scale_application_get_nau7802_handle();
-    if (nau7802 != NULL && scale_application_is_nau7802_initialized()) {
-        // Get device mutex for thread-safe access
-        SemaphoreHandle_t nau7802_mutex = scale_application_get_nau7802_mutex();
-        bool connected = false;
+    nau7802_t *nau7802 = scale_application_get_nau7802_handle(scale);
+    if (nau7802 != NULL) {
+        // Every read below is a single diagnostic-class transaction on the I2C
+        // scheduler, so the device mutex is not taken and a page refresh never
+        // holds off the acquisition task for more than one transaction
         bool available = false;
         int32_t raw_reading = 0;
         float weight_grams = 0.0f;
@@ -1306,49 +1079,54 @@ static esp_err_t api_get_nau7802_handler(httpd_req_t *req)
         uint8_t pu_ctrl = 0;
         uint8_t ctrl2 = 0;
         
-        if (nau7802_mutex != NULL && xSemaphoreTake(nau7802_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            connected = nau7802_is_connected(nau7802);
-            
-            if (connected) {
-                // Get current reading
-                available = nau7802_available(nau7802);
-                if (available) {
-                    raw_reading = nau7802_get_reading(nau7802);
+        bool connected = nau7802_is_connected(nau7802);
+        if (connected) {
+            // Latest conversion from the acquisition task. Reading the ADC here
+            // would clear CR and steal that conversion from the sample stream.
+            uint32_t head = nau7802_history_head(scale);
+            uint32_t cursor = head - 1;
+            nau7802_history_sample_t latest;
+            if (head > 0 && nau7802_history_read(scale, &cursor, &latest, 1, NULL) == 1) {
+                raw_reading = latest.raw;
+            } else {
+                nau7802_sample_t sample;
+                esp_err_t read_ret = nau7802_read_sample(nau7802, &sample);
+                if (read_ret == ESP_OK || read_ret == ESP_ERR_NOT_FINISHED) {
+                    raw_reading = sample.raw;
+                } else {
+                    ESP_LOGW(TAG, "Failed to read NAU7802 sample: %s", esp_err_to_name(read_ret));
                 }
-                
-                // Get calibrated weight in grams
-                weight_grams = nau7802_get_weight(nau7802, true, 1, 100);
-                
-                // Get calibration parameters
-                cal_factor = nau7802_get_calibration_factor(nau7802);
-                zero_offset = nau7802_get_zero_offset(nau7802);
-                
-                // Get revision code
-                revision_code = nau7802_get_revision_code(nau7802);
-                
-                // Get channel calibration registers
-                ch1_offset = nau7802_get_channel1_offset(nau7802);
-                ch1_gain = nau7802_get_channel1_gain(nau7802);
-                ch2_offset = nau7802_get_channel2_offset(nau7802);
-                ch2_gain = nau7802_get_channel2_gain(nau7802);
-                
-                // Get status flags from registers
-                pu_ctrl = nau7802_get_register(nau7802, NAU7802_REGISTER_PU_CTRL);
-                ctrl2 = nau7802_get_register(nau7802, NAU7802_REGISTER_CTRL2);
             }
             
-            xSemaphoreGive(nau7802_mutex);
-        } else {
-            ESP_LOGW(TAG, "Failed to acquire NAU7802 mutex for GET handler");
+            // Status flags (reading PU_CTRL does not clear CR)
+            pu_ctrl = nau7802_get_register(nau7802, NAU7802_REGISTER_PU_CTRL);
+            ctrl2 = nau7802_get_register(nau7802, NAU7802_REGISTER_CTRL2);
+            available = (pu_ctrl & (1 << NAU7802_PU_CTRL_CR)) != 0;
+            
+            // Get calibration parameters
+            cal_factor = nau7802_get_calibration_factor(nau7802);
+            zero_offset = nau7802_get_zero_offset(nau7802);
+            
+            // Calibrated weight in grams from the same reading
+            weight_grams = ((float)raw_reading - zero_offset) / cal_factor;
+            
+            // Get revision code
+            revision_code = nau7802_get_revision_code(nau7802);
+            
+            // Get channel calibration registers
+            ch1_offset = nau7802_get_channel1_offset(nau7802);
+            ch1_gain = nau7802_get_channel1_gain(nau7802);
+            ch2_offset = nau7802_get_channel2_offset(nau7802);
+            ch2_gain = nau7802_get_channel2_gain(nau7802);
         }
         
         if (connected) {
-            cJSON_AddBoolToObject(json, "connected", true);
-            cJSON_AddNumberToObject(json, "raw_reading", raw_reading);
-            cJSON_AddBoolToObject(json, "available", available);
+            json_writer_bool(&w, "connected", true);
+            json_writer_int(&w, "raw_reading", raw_reading);
+            json_writer_bool(&w, "available", available);
             
-            // Convert to selected unit for display (use cached value)
-            uint8_t unit = s_cached_nau7802_unit;
+            // Convert to selected unit for display
+            uint8_t unit = config.nau7802_unit;
             float weight_display = weight_grams;
             const char *unit_str = "g";
             if (unit == 1) {
@@ -1361,41 +1139,41 @@ static esp_err_t api_get_nau7802_handler(httpd_req_t *req)
                 unit_str = "kg";
             }
             
-            cJSON_AddNumberToObject(json, "weight", weight_display);
-            cJSON_AddStringToObject(json, "unit", unit_str);
-            cJSON_AddNumberToObject(json, "unit_code", unit);
-            cJSON_AddNumberToObject(json, "calibration_factor", cal_factor);
-            cJSON_AddNumberToObject(json, "zero_offset", zero_offset);
-            cJSON_AddNumberToObject(json, "revision_code", revision_code);
+            json_writer_float(&w, "weight", weight_display);
+            json_writer_string(&w, "unit", unit_str);
+            json_writer_uint(&w, "unit_code", unit);
+            json_writer_float(&w, "calibration_factor", cal_factor);
+            json_writer_float(&w, "zero_offset", zero_offset);
+            json_writer_uint(&w, "revision_code", revision_code);
             
-            cJSON *ch1 = cJSON_CreateObject();
-            cJSON_AddNumberToObject(ch1, "offset", ch1_offset);
-            cJSON_AddNumberToObject(ch1, "gain", ch1_gain);
-            cJSON_AddItemToObject(json, "channel1", ch1);
+            json_writer_object_begin(&w, "channel1");
+            json_writer_int(&w, "offset", ch1_offset);
+            json_writer_uint(&w, "gain", ch1_gain);
+            json_writer_object_end(&w);
             
-            cJSON *ch2 = cJSON_CreateObject();
-            cJSON_AddNumberToObject(ch2, "offset", ch2_offset);
-            cJSON_AddNumberToObject(ch2, "gain", ch2_gain);
-            cJSON_AddItemToObject(json, "channel2", ch2);
+            json_writer_object_begin(&w, "channel2");
+            json_writer_int(&w, "offset", ch2_offset);
+            json_writer_uint(&w, "gain", ch2_gain);
+            json_writer_object_end(&w);
             
-            cJSON *status = cJSON_CreateObject();
-            cJSON_AddBoolToObject(status, "available", available);
-            cJSON_AddBoolToObject(status, "power_digital", (pu_ctrl & (1 << NAU7802_PU_CTRL_PUD)) != 0);
-            cJSON_AddBoolToObject(status, "power_analog", (pu_ctrl & (1 << NAU7802_PU_CTRL_PUA)) != 0);
-            cJSON_AddBoolToObject(status, "power_regulator", (pu_ctrl & (1 << NAU7802_PU_CTRL_PUR)) != 0);
-            cJSON_AddBoolToObject(status, "calibration_active", (ctrl2 & NAU7802_CTRL2_CALS) != 0);
-            cJSON_AddBoolToObject(status, "calibration_error", (ctrl2 & NAU7802_CTRL2_CAL_ERROR) != 0);
-            cJSON_AddBoolToObject(status, "oscillator_ready", (pu_ctrl & (1 << NAU7802_PU_CTRL_OSCS)) != 0);
-            cJSON_AddBoolToObject(status, "avdd_ready", (pu_ctrl & (1 << NAU7802_PU_CTRL_AVDDS)) != 0);
-            cJSON_AddItemToObject(json, "status", status);
+            json_writer_object_begin(&w, "status");
+            json_writer_bool(&w, "available", available);
+            json_writer_bool(&w, "power_digital", (pu_ctrl & (1 << NAU7802_PU_CTRL_PUD)) != 0);
+            json_writer_bool(&w, "power_analog", (pu_ctrl & (1 << NAU7802_PU_CTRL_PUA)) != 0);
+            json_writer_bool(&w, "power_regulator", (pu_ctrl & (1 << NAU7802_PU_CTRL_PUR)) != 0);
+            json_writer_bool(&w, "calibration_active", (ctrl2 & NAU7802_CTRL2_CALS) != 0);
+            json_writer_bool(&w, "calibration_error", (ctrl2 & NAU7802_CTRL2_CAL_ERROR) != 0);
+            json_writer_bool(&w, "oscillator_ready", (pu_ctrl & (1 << NAU7802_PU_CTRL_OSCS)) != 0);
+            json_writer_bool(&w, "avdd_ready", (pu_ctrl & (1 << NAU7802_PU_CTRL_AVDDS)) != 0);
+            json_writer_object_end(&w);
         } else {
-            cJSON_AddBoolToObject(json, "connected", false);
+            json_writer_bool(&w, "connected", false);
         }
     } else {
-        cJSON_AddBoolToObject(json, "connected", false);
+        json_writer_bool(&w, "connected", false);
     }
     
-    return send_json_response(req, json, ESP_OK);
+    return json_end(req, &w);
 }
 
 // POST /api/nau7802 - Configure NAU7802 (enable/disable, byte offset)
@@ -1417,15 +1195,15 @@ static esp_err_t api_post_nau7802_handler(httpd_req_t *req)
     
     bool config_changed = false;
     
+    // All fields are applied as one transaction: a single flash write and
+    // nothing stored if any field is rejected
+    system_config_t *config = system_config_begin();
+    
     // Handle enabled state
     cJSON *item = cJSON_GetObjectItem(json, "enabled");
     if (item != NULL && cJSON_IsBool(item)) {
-        bool enabled = cJSON_IsTrue(item);
-        if (system_nau7802_enabled_save(enabled)) {
-            s_cached_nau7802_enabled = enabled;
-            s_nau7802_enabled_cached = true;
-            config_changed = true;
-        }
+        config->nau7802_enabled = cJSON_IsTrue(item);
+        config_changed = true;
     }
     
     // Handle byte offset
@@ -1437,15 +1215,13 @@ static esp_err_t api_post_nau7802_handler(httpd_req_t *req)
         const uint8_t max_offset = assembly_size - nau7802_data_size;  // 32 - 10 = 22
         
         if (byte_offset > max_offset) {
+            system_config_abort();
             cJSON_Delete(json);
             return send_json_error(req, "Byte offset too large. Maximum is 22 (assembly size 32 - data size 10)", 400);
         }
         
-        if (system_nau7802_byte_offset_save(byte_offset)) {
-            s_cached_nau7802_byte_offset = byte_offset;
-            s_nau7802_byte_offset_cached = true;
-            config_changed = true;
-        }
+        config->nau7802_byte_offset = byte_offset;
+        config_changed = true;
     }
     
     // Handle unit selection
@@ -1453,12 +1229,8 @@ static esp_err_t api_post_nau7802_handler(httpd_req_t *req)
     if (item != NULL && cJSON_IsNumber(item)) {
         int unit_int = (int)cJSON_GetNumberValue(item);
         if (unit_int >= 0 && unit_int <= 2) {
-            uint8_t unit = (uint8_t)unit_int;
-            if (system_nau7802_unit_save(unit)) {
-                s_cached_nau7802_unit = unit;
-                s_nau7802_unit_cached = true;
-                config_changed = true;
-            }
+            config->nau7802_unit = (uint8_t)unit_int;
+            config_changed = true;
         }
     }
     
@@ -1467,12 +1239,8 @@ static esp_err_t api_post_nau7802_handler(httpd_req_t *req)
     if (item != NULL && cJSON_IsNumber(item)) {
         int gain_int = (int)cJSON_GetNumberValue(item);
         if (gain_int >= 0 && gain_int <= 7) {
-            uint8_t gain = (uint8_t)gain_int;
-            if (system_nau7802_gain_save(gain)) {
-                s_cached_nau7802_gain = gain;
-                s_nau7802_gain_cached = true;
-                config_changed = true;
-            }
+            config->nau7802_gain = (uint8_t)gain_int;
+            config_changed = true;
         }
     }
     
@@ -1483,12 +1251,8 @@ static esp_err_t api_post_nau7802_handler(httpd_req_t *req)
         // Valid values: 0, 1, 2, 3, 7
         if (sample_rate_int == 0 || sample_rate_int == 1 || sample_rate_int == 2 || 
             sample_rate_int == 3 || sample_rate_int == 7) {
-            uint8_t sample_rate = (uint8_t)sample_rate_int;
-            if (system_nau7802_sample_rate_save(sample_rate)) {
-                s_cached_nau7802_sample_rate = sample_rate;
-                s_nau7802_sample_rate_cached = true;
-                config_changed = true;
-            }
+            config->nau7802_sample_rate = (uint8_t)sample_rate_int;
+            config_changed = true;
         }
     }
     
@@ -1497,12 +1261,8 @@ static esp_err_t api_post_nau7802_handler(httpd_req_t *req)
     if (item != NULL && cJSON_IsNumber(item)) {
         int channel_int = (int)cJSON_GetNumberValue(item);
         if (channel_int >= 0 && channel_int <= 1) {
-            uint8_t channel = (uint8_t)channel_int;
-            if (system_nau7802_channel_save(channel)) {
-                s_cached_nau7802_channel = channel;
-                s_nau7802_channel_cached = true;
-                config_changed = true;
-            }
+            config->nau7802_channel = (uint8_t)channel_int;
+            config_changed = true;
         }
     }
     
@@ -1511,12 +1271,8 @@ static esp_err_t api_post_nau7802_handler(httpd_req_t *req)
     if (item != NULL && cJSON_IsNumber(item)) {
         int ldo_int = (int)cJSON_GetNumberValue(item);
         if (ldo_int >= 0 && ldo_int <= 7) {
-            uint8_t ldo = (uint8_t)ldo_int;
-            if (system_nau7802_ldo_save(ldo)) {
-                s_cached_nau7802_ldo = ldo;
-                s_nau7802_ldo_cached = true;
-                config_changed = true;
-            }
+            config->nau7802_ldo = (uint8_t)ldo_int;
+            config_changed = true;
         }
     }
     
@@ -1525,25 +1281,30 @@ static esp_err_t api_post_nau7802_handler(httpd_req_t *req)
     if (item != NULL && cJSON_IsNumber(item)) {
         int avg_int = (int)cJSON_GetNumberValue(item);
         if (avg_int >= 1 && avg_int <= 50) {
-            uint8_t average = (uint8_t)avg_int;
-            if (system_nau7802_average_save(average)) {
-                s_cached_nau7802_average = average;
-                s_nau7802_average_cached = true;
-                config_changed = true;
-            }
+            config->nau7802_average = (uint8_t)avg_int;
+            config_changed = true;
         }
     }
     
+    if (!system_config_commit()) {
+        cJSON_Delete(json);
+        return send_json_error(req, "Failed to save configuration", 500);
+    }
+    
     cJSON_Delete(json);
     
     cJSON *response = cJSON_CreateObject();
     cJSON_AddStringToObject(response, "status", "ok");
-    cJSON_AddStringToObject(response, "message", config_changed ? "Configuration saved. Reboot required to apply gain, sample rate, channel, or LDO changes." : "No changes");
+    cJSON_AddStringToObject(response, "message", config_changed ? "Configuration saved and applied" : "No changes");
     
     return send_json_response(req, response, ESP_OK);
 }
 
-// POST /api/nau7802/calibrate - Calibrate the scale
+// POST /api/nau7802/calibrate - Start a calibration job on a scale
+// Tare and known-weight calibration average live conversions in the background,
+// so neither the web server nor acquisition waits for them. The response carries
+// a job ID to poll with GET /api/nau7802/calibrate?job=<id>.
+#define NAU7802_CALIBRATION_DEFAULT_SAMPLES 10
 static esp_err_t api_post_nau7802_calibrate_handler(httpd_req_t *req)
 {
     char content[256];
@@ -1560,71 +1321,67 @@ static esp_err_t api_post_nau7802_calibrate_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
-    nau7802_t *nau7802 = scale_application_get_nau7802_handle();
-    if (nau7802 == NULL || !scale_application_is_nau7802_initialized()) {
+    // Optional scale channel (default 0)
+    uint8_t scale = 0;
+    cJSON *item = cJSON_GetObjectItem(json, "scale");
+    if (item != NULL) {
+        int scale_int = cJSON_IsNumber(item) ? (int)cJSON_GetNumberValue(item) : -1;
+        if (scale_int < 0 || scale_int >= scale_application_get_nau7802_count()) {
+            cJSON_Delete(json);
+            return send_json_error(req, "Invalid scale channel", 400);
+        }
+        scale = (uint8_t)scale_int;
+    }
+    
+    nau7802_t *nau7802 = scale_application_get_nau7802_handle(scale);
+    if (nau7802 == NULL) {
         cJSON_Delete(json);
         return send_json_error(req, "NAU7802 not initialized", 500);
     }
+    SemaphoreHandle_t nau7802_mutex = scale_application_get_nau7802_mutex(scale);
+    
+    // Optional number of conversions to average for tare and known-weight calibration
+    uint16_t samples = NAU7802_CALIBRATION_DEFAULT_SAMPLES;
+    item = cJSON_GetObjectItem(json, "samples");
+    if (item != NULL) {
+        int samples_int = cJSON_IsNumber(item) ? (int)cJSON_GetNumberValue(item) : 0;
+        if (samples_int < 1 || samples_int > NAU7802_CAL_JOB_MAX_SAMPLES) {
+            cJSON_Delete(json);
+            return send_json_error(req, "Invalid 'samples' field (must be 1-1024)", 400);
+        }
+        samples = (uint16_t)samples_int;
+    }
     
-    cJSON *item = cJSON_GetObjectItem(json, "action");
+    item = cJSON_GetObjectItem(json, "action");
     if (item == NULL || !cJSON_IsString(item)) {
         cJSON_Delete(json);
         return send_json_error(req, "Missing or invalid 'action' field (must be 'tare' or 'calibrate')", 400);
     }
     
     const char *action = cJSON_GetStringValue(item);
-    cJSON *response = cJSON_CreateObject();
+    nau7802_cal_job_type_t type;
+    float known_weight_grams = 0.0f;
     
     if (strcmp(action, "tare") == 0) {
-        // Tare (zero offset) calibration
-        // Use default of 10 samples for averaging during calibration
-        SemaphoreHandle_t nau7802_mutex = scale_application_get_nau7802_mutex();
-        esp_err_t err = ESP_FAIL;
-        
-        if (nau7802_mutex != NULL && xSemaphoreTake(nau7802_mutex, portMAX_DELAY) == pdTRUE) {
-            err = nau7802_calculate_zero_offset(nau7802, 10, 5000);
-            if (err == ESP_OK) {
-                float zero_offset = nau7802_get_zero_offset(nau7802);
-                xSemaphoreGive(nau7802_mutex);
-                system_nau7802_zero_offset_save(zero_offset);
-                cJSON_AddStringToObject(response, "status", "ok");
-                cJSON_AddStringToObject(response, "message", "Tare calibration completed");
-                cJSON_AddNumberToObject(response, "zero_offset", zero_offset);
-            } else {
-                xSemaphoreGive(nau7802_mutex);
-                ESP_LOGE(TAG, "Tare calibration failed: %s", esp_err_to_name(err));
-                cJSON_AddStringToObject(response, "status", "error");
-                cJSON_AddStringToObject(response, "message", "Tare calibration failed");
-            }
-        } else {
-            ESP_LOGE(TAG, "Failed to acquire NAU7802 mutex for tare calibration");
-            cJSON_AddStringToObject(response, "status", "error");
-            cJSON_AddStringToObject(response, "message", "Failed to acquire device lock");
-        }
+        type = NAU7802_CAL_JOB_TARE;
     } else if (strcmp(action, "calibrate") == 0) {
         // Calibration with known weight
+        type = NAU7802_CAL_JOB_SPAN;
         item = cJSON_GetObjectItem(json, "known_weight");
         if (item == NULL || !cJSON_IsNumber(item)) {
             cJSON_Delete(json);
-            cJSON_Delete(response);
             return send_json_error(req, "Missing or invalid 'known_weight' field", 400);
         }
         
         float known_weight_input = (float)cJSON_GetNumberValue(item);
         if (known_weight_input <= 0.0f) {
             cJSON_Delete(json);
-            cJSON_Delete(response);
             return send_json_error(req, "Known weight must be greater than 0", 400);
         }
         
         // Get unit selection and convert to grams (NAU7802 calibration uses grams internally)
-        // Use cached value if available, otherwise load from NVS
-        if (!s_nau7802_unit_cached) {
-            s_cached_nau7802_unit = system_nau7802_unit_load();
-            s_nau7802_unit_cached = true;
-        }
-        uint8_t unit = s_cached_nau7802_unit;
-        float known_weight_grams = known_weight_input;
+        uint8_t unit = system_nau7802_unit_load();
+        known_weight_grams = known_weight_input;
         if (unit == 1) {
             // Convert lbs to grams: 1 lb = 453.592 grams
             known_weight_grams = known_weight_input * 453.592f;
@@ -1633,65 +1390,410 @@ static esp_err_t api_post_nau7802_calibrate_handler(httpd_req_t *req)
             known_weight_grams = known_weight_input * 1000.0f;
         }
         // unit == 0 means grams, no conversion needed
-        
-        // Use default of 10 samples for averaging during calibration
-        SemaphoreHandle_t nau7802_mutex = scale_application_get_nau7802_mutex();
-        esp_err_t err = ESP_FAIL;
-        
-        if (nau7802_mutex != NULL && xSemaphoreTake(nau7802_mutex, portMAX_DELAY) == pdTRUE) {
-            err = nau7802_calculate_calibration_factor(nau7802, known_weight_grams, 10, 5000);
-            if (err == ESP_OK) {
-                float cal_factor = nau7802_get_calibration_factor(nau7802);
-                float zero_offset = nau7802_get_zero_offset(nau7802);
-                xSemaphoreGive(nau7802_mutex);
-                system_nau7802_calibration_factor_save(cal_factor);
-                system_nau7802_zero_offset_save(zero_offset);
-                cJSON_AddStringToObject(response, "status", "ok");
-                cJSON_AddStringToObject(response, "message", "Calibration completed");
-                cJSON_AddNumberToObject(response, "calibration_factor", cal_factor);
-                cJSON_AddNumberToObject(response, "zero_offset", zero_offset);
-            } else {
-                xSemaphoreGive(nau7802_mutex);
-                ESP_LOGE(TAG, "Known-weight calibration failed: %s", esp_err_to_name(err));
-                cJSON_AddStringToObject(response, "status", "error");
-                cJSON_AddStringToObject(response, "message", "Calibration failed");
-            }
-        } else {
-            ESP_LOGE(TAG, "Failed to acquire NAU7802 mutex for calibration");
-            cJSON_AddStringToObject(response, "status", "error");
-            cJSON_AddStringToObject(response, "message", "Failed to acquire device lock");
-        }
     } else if (strcmp(action, "afe") == 0) {
         // AFE (Analog Front End) calibration
-        ESP_LOGI(TAG, "Performing AFE calibration");
-        SemaphoreHandle_t nau7802_mutex = scale_application_get_nau7802_mutex();
-        esp_err_t err = ESP_FAIL;
-        
-        if (nau7802_mutex != NULL && xSemaphoreTake(nau7802_mutex, portMAX_DELAY) == pdTRUE) {
-            err = nau7802_calibrate_af(nau7802);
-            xSemaphoreGive(nau7802_mutex);
-            
-            if (err == ESP_OK) {
-                cJSON_AddStringToObject(response, "status", "ok");
-                cJSON_AddStringToObject(response, "message", "AFE calibration completed successfully");
-            } else {
-                ESP_LOGE(TAG, "AFE calibration failed: %s", esp_err_to_name(err));
-                cJSON_AddStringToObject(response, "status", "error");
-                cJSON_AddStringToObject(response, "message", "AFE calibration failed");
+        type = NAU7802_CAL_JOB_AFE;
+    } else {
+        cJSON_Delete(json);
+        return send_json_error(req, "Invalid action (must be 'tare', 'calibrate', or 'afe')", 400);
+    }
+    
+    uint32_t job_id = 0;
+    esp_err_t err = nau7802_cal_job_submit(nau7802, nau7802_mutex, scale, type, known_weight_grams,
+                                           samples, &job_id);
+    if (err == ESP_ERR_INVALID_STATE) {
+        cJSON_Delete(json);
+        return send_json_error(req, "A calibration is already running on this scale", 409);
+    }
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        cJSON_Delete(json);
+        return send_json_error(req, "Sample history not available", 503);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start %s job on scale %u: %s", action, scale, esp_err_to_name(err));
+        cJSON_Delete(json);
+        return send_json_error(req, "Failed to start calibration", 500);
+    }
+    ESP_LOGI(TAG, "Started %s job %lu on scale %u", action, (unsigned long)job_id, scale);
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "accepted");
+    cJSON_AddNumberToObject(response, "job_id", job_id);
+    cJSON_AddNumberToObject(response, "scale", scale);
+    cJSON_AddStringToObject(response, "action", action);
+    cJSON_Delete(json);
+    return send_json_with_status(req, response, "202 Accepted");
+}
+
+// GET /api/nau7802/calibrate?job=<id> - Progress and result of a calibration job
+static esp_err_t api_get_nau7802_calibrate_handler(httpd_req_t *req)
+{
+    char query[32];
+    char value[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "job", value, sizeof(value)) != ESP_OK) {
+        return send_json_error(req, "Missing 'job' parameter", 400);
+    }
+    
+    nau7802_cal_job_info_t info;
+    if (nau7802_cal_job_get((uint32_t)strtoul(value, NULL, 10), &info) != ESP_OK) {
+        return send_json_error(req, "Unknown calibration job", 404);
+    }
+    
+    static const char *const action_names[] = { "tare", "calibrate", "afe" };
+    static const char *const done_messages[] = {
+        "Tare calibration completed", "Calibration completed", "AFE calibration completed successfully"
+    };
+    static const char *const failed_messages[] = {
+        "Tare calibration failed", "Calibration failed", "AFE calibration failed"
+    };
+    
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_string(&w, "status", "ok");
+    json_writer_uint(&w, "job_id", info.id);
+    json_writer_uint(&w, "scale", info.channel);
+    json_writer_string(&w, "action", action_names[info.type]);
+    json_writer_uint(&w, "elapsed_ms", info.elapsed_ms);
+    if (info.type != NAU7802_CAL_JOB_AFE) {
+        json_writer_uint(&w, "samples_needed", info.samples_needed);
+        json_writer_uint(&w, "samples_collected", info.samples_collected);
+        json_writer_uint(&w, "progress", info.samples_collected * 100 / info.samples_needed);
+    }
+    
+    if (info.state == NAU7802_CAL_JOB_RUNNING) {
+        json_writer_string(&w, "state", "running");
+    } else if (info.state == NAU7802_CAL_JOB_DONE) {
+        json_writer_string(&w, "state", "done");
+        json_writer_string(&w, "message", done_messages[info.type]);
+        if (info.type != NAU7802_CAL_JOB_AFE) {
+            json_writer_float(&w, "calibration_factor", info.calibration_factor);
+            json_writer_float(&w, "zero_offset", info.zero_offset);
+        }
+    } else {
+        json_writer_string(&w, "state", "failed");
+        json_writer_string(&w, "message", failed_messages[info.type]);
+        json_writer_string(&w, "error", esp_err_to_name(info.error));
+    }
+    
+    return json_end(req, &w);
+}
+
+// GET /api/nau7802/history?scale=<n>&since=<cursor>&max=<n>&format=json|binary
+// Returns samples captured since the cursor; pass the returned "next" cursor on the following call
+#define NAU7802_HISTORY_DEFAULT_MAX 256
+#define NAU7802_HISTORY_LIMIT_MAX   2048
+static esp_err_t api_get_nau7802_history_handler(httpd_req_t *req)
+{
+    if (nau7802_history_capacity() == 0) {
+        return send_json_error(req, "Sample history not available", 503);
+    }
+    
+    uint32_t cursor = 0;
+    size_t max_samples = NAU7802_HISTORY_DEFAULT_MAX;
+    bool binary = false;
+    uint8_t scale;
+    if (!get_scale_channel(req, &scale)) {
+        return ESP_OK;  // Error response already sent
+    }
+    
+    char query[96];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        char value[16];
+        if (httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK) {
+            cursor = (uint32_t)strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "max", value, sizeof(value)) == ESP_OK) {
+            long requested = strtol(value, NULL, 10);
+            if (requested <= 0) {
+                return send_json_error(req, "max must be greater than 0", 400);
             }
-        } else {
-            ESP_LOGE(TAG, "Failed to acquire NAU7802 mutex for AFE calibration");
-            cJSON_AddStringToObject(response, "status", "error");
-            cJSON_AddStringToObject(response, "message", "Failed to acquire device lock");
+            max_samples = (requested > NAU7802_HISTORY_LIMIT_MAX) ? NAU7802_HISTORY_LIMIT_MAX : (size_t)requested;
+        }
+        if (httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK) {
+            binary = (strcmp(value, "binary") == 0);
+        }
+    }
+    
+    nau7802_history_sample_t *samples = (nau7802_history_sample_t *)malloc(max_samples * sizeof(nau7802_history_sample_t));
+    if (samples == NULL) {
+        return send_json_error(req, "Failed to allocate memory for history", 500);
+    }
+    
+    uint32_t lost = 0;
+    size_t count = nau7802_history_read(scale, &cursor, samples, max_samples, &lost);
+    
+    char cursor_str[12];
+    snprintf(cursor_str, sizeof(cursor_str), "%lu", (unsigned long)cursor);
+    httpd_resp_set_hdr(req, "X-History-Next", cursor_str);
+    
+    esp_err_t ret;
+    if (binary) {
+        // 16-byte header (next cursor, lost, count, record size), then 16-byte
+        // records (index, timestamp_us, raw, weight_g float), all little-endian
+        uint32_t header[4] = { cursor, lost, (uint32_t)count, sizeof(nau7802_history_sample_t) };
+        httpd_resp_set_type(req, "application/octet-stream");
+        ret = httpd_resp_send_chunk(req, (const char *)header, sizeof(header));
+        if (ret == ESP_OK && count > 0) {
+            ret = httpd_resp_send_chunk(req, (const char *)samples, count * sizeof(nau7802_history_sample_t));
         }
     } else {
+        // Samples as compact [index, timestamp_us, raw, weight_g] arrays, streamed in chunks
+        json_writer_t w;
+        json_begin(req, &w);
+        json_writer_string(&w, "status", "ok");
+        json_writer_uint(&w, "next", cursor);
+        json_writer_uint(&w, "lost", lost);
+        json_writer_uint(&w, "count", count);
+        json_writer_uint(&w, "capacity", nau7802_history_capacity());
+        json_writer_array_begin(&w, "samples");
+        for (size_t i = 0; i < count; i++) {
+            json_writer_array_begin(&w, NULL);
+            json_writer_uint(&w, NULL, samples[i].index);
+            json_writer_uint(&w, NULL, samples[i].timestamp_us);
+            json_writer_int(&w, NULL, samples[i].raw);
+            json_writer_float(&w, NULL, samples[i].weight_g);
+            json_writer_array_end(&w);
+        }
+        json_writer_array_end(&w);
+        json_writer_object_end(&w);
+        ret = json_writer_finish(&w) ? ESP_OK : ESP_FAIL;
+    }
+    
+    free(samples);
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return ret;
+}
+
+// Trace level names, in bit order (OPENER_TRACE_LEVEL_*)
+static const char *const s_trace_level_names[] = { "error", "warning", "state", "info" };
+
+static void write_trace_levels(httpd_req_t *req)
+{
+    uint32_t mask = TraceControlGetMask();
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_uint(&w, "mask", mask);
+    json_writer_object_begin(&w, "modules");
+    for (unsigned module = 0; module < OPENER_TRACE_MODULE_COUNT; module++) {
+        uint8_t levels = (uint8_t)((mask >> (4 * module)) & TRACE_CONTROL_MODULE_LEVELS);
+        json_writer_array_begin(&w, TraceControlModuleName(module));
+        for (unsigned bit = 0; bit < 4; bit++) {
+            if (levels & (1U << bit)) {
+                json_writer_string(&w, NULL, s_trace_level_names[bit]);
+            }
+        }
+        json_writer_array_end(&w);
+    }
+    json_writer_object_end(&w);
+    json_end(req, &w);
+}
+
+// Level bits from a JSON array of level names or a number (0-15); -1 if invalid
+static int parse_trace_levels(const cJSON *item)
+{
+    if (cJSON_IsNumber(item)) {
+        return (item->valueint >= 0 && item->valueint <= (int)TRACE_CONTROL_MODULE_LEVELS) ? item->valueint : -1;
+    }
+    if (!cJSON_IsArray(item)) {
+        return -1;
+    }
+    int levels = 0;
+    const cJSON *name;
+    cJSON_ArrayForEach(name, item) {
+        if (!cJSON_IsString(name)) {
+            return -1;
+        }
+        unsigned bit = 0;
+        while (bit < 4 && strcmp(name->valuestring, s_trace_level_names[bit]) != 0) {
+            bit++;
+        }
+        if (bit == 4) {
+            return -1;
+        }
+        levels |= 1 << bit;
+    }
+    return levels;
+}
+
+// GET /api/trace/levels - Runtime trace levels per module
+static esp_err_t api_get_trace_levels_handler(httpd_req_t *req)
+{
+    write_trace_levels(req);
+    return ESP_OK;
+}
+
+// POST /api/trace/levels - Set the whole mask and/or the levels of some modules
+static esp_err_t api_post_trace_levels_handler(httpd_req_t *req)
+{
+    char content[512];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    content[ret] = '\0';
+    
+    cJSON *json = cJSON_Parse(content);
+    if (json == NULL) {
+        return send_json_error(req, "Invalid JSON", 400);
+    }
+    
+    cJSON *mask_item = cJSON_GetObjectItem(json, "mask");
+    cJSON *modules_item = cJSON_GetObjectItem(json, "modules");
+    if (mask_item == NULL && modules_item == NULL) {
         cJSON_Delete(json);
-        cJSON_Delete(response);
-        return send_json_error(req, "Invalid action (must be 'tare', 'calibrate', or 'afe')", 400);
+        return send_json_error(req, "Missing 'mask' or 'modules' field", 400);
     }
     
+    uint32_t mask = TraceControlGetMask();
+    if (mask_item != NULL) {
+        if (!cJSON_IsNumber(mask_item) || mask_item->valuedouble < 0 || mask_item->valuedouble > 4294967295.0) {
+            cJSON_Delete(json);
+            return send_json_error(req, "Invalid 'mask' field", 400);
+        }
+        mask = (uint32_t)mask_item->valuedouble;
+    }
+    if (modules_item != NULL) {
+        if (!cJSON_IsObject(modules_item)) {
+            cJSON_Delete(json);
+            return send_json_error(req, "Invalid 'modules' field", 400);
+        }
+        const cJSON *module_item;
+        cJSON_ArrayForEach(module_item, modules_item) {
+            int module = TraceControlModuleFromName(module_item->string);
+            int levels = parse_trace_levels(module_item);
+            if (module < 0 || levels < 0) {
+                cJSON_Delete(json);
+                return send_json_error(req, "Unknown module or level in 'modules'", 400);
+            }
+            mask &= ~(TRACE_CONTROL_MODULE_LEVELS << (4 * module));
+            mask |= (uint32_t)levels << (4 * module);
+        }
+    }
     cJSON_Delete(json);
-    return send_json_response(req, response, ESP_OK);
+    
+    TraceControlSetMask(mask);
+    ESP_LOGI(TAG, "Trace mask set to 0x%08" PRIx32, mask);
+    write_trace_levels(req);
+    return ESP_OK;
+}
+
+// GET /api/trace?clear=true
+// Binary trace rings for tools/trace_decode.py. 48-byte header (magic, version
+// u16, cores u16, now_us, ring_words, app ELF SHA-256), then per core: core,
+// word count, records overwritten, records. All little-endian.
+static esp_err_t api_get_trace_handler(httpd_req_t *req)
+{
+    size_t ring_words = binary_trace_ring_words();
+    if (ring_words == 0) {
+        return send_json_error(req, "Binary trace not enabled", 503);
+    }
+    
+    bool clear = false;
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "clear", value, sizeof(value)) == ESP_OK) {
+        clear = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+    }
+    
+    uint32_t *words = (uint32_t *)malloc(ring_words * sizeof(uint32_t));
+    if (words == NULL) {
+        return send_json_error(req, "Failed to allocate memory for trace", 500);
+    }
+    
+    struct {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t cores;
+        uint32_t now_us;
+        uint32_t ring_words;
+        uint8_t elf_sha256[32];
+    } header = {
+        .magic = BINARY_TRACE_DUMP_MAGIC,
+        .version = BINARY_TRACE_DUMP_VERSION,
+        .cores = portNUM_PROCESSORS,
+        .now_us = (uint32_t)esp_timer_get_time(),
+        .ring_words = (uint32_t)ring_words,
+    };
+    memcpy(header.elf_sha256, esp_app_get_description()->app_elf_sha256, sizeof(header.elf_sha256));
+    
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.bin\"");
+    esp_err_t ret = httpd_resp_send_chunk(req, (const char *)&header, sizeof(header));
+    for (uint32_t core = 0; core < portNUM_PROCESSORS && ret == ESP_OK; core++) {
+        size_t count = binary_trace_snapshot(core, words, ring_words);
+        uint32_t core_header[3] = { core, (uint32_t)count, binary_trace_overwritten(core) };
+        ret = httpd_resp_send_chunk(req, (const char *)core_header, sizeof(core_header));
+        if (ret == ESP_OK && count > 0) {
+            ret = httpd_resp_send_chunk(req, (const char *)words, count * sizeof(uint32_t));
+        }
+    }
+    free(words);
+    
+    if (ret == ESP_OK) {
+        if (clear) {
+            binary_trace_clear();
+        }
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return ret;
+}
+
+// GET /api/latency?reset=true
+// Hot-path latency histograms (CONFIG_OPENER_LATENCY_PROBES). Times are in ns;
+// buckets lists [upper bound ns, count] for the non-empty buckets only.
+static esp_err_t api_get_latency_handler(httpd_req_t *req)
+{
+    if (!latency_probe_enabled()) {
+        return send_json_error(req, "Latency probes not enabled", 503);
+    }
+    
+    bool reset = false;
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "reset", value, sizeof(value)) == ESP_OK) {
+        reset = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+    }
+    
+    uint32_t buckets[LATENCY_PROBE_BUCKETS];
+    json_writer_t w;
+    json_begin(req, &w);
+    json_writer_object_begin(&w, "probes");
+    for (int id = 0; id < LATENCY_PROBE_COUNT; id++) {
+        latency_probe_stats_t stats;
+        if (!latency_probe_get_stats((latency_probe_id_t)id, &stats, buckets)) {
+            continue;
+        }
+        json_writer_object_begin(&w, latency_probe_name((latency_probe_id_t)id));
+        json_writer_uint(&w, "count", stats.count);
+        json_writer_uint(&w, "migrated", stats.migrated);
+        json_writer_uint(&w, "min_ns", stats.min_ns);
+        json_writer_uint(&w, "max_ns", stats.max_ns);
+        json_writer_uint(&w, "mean_ns", stats.mean_ns);
+        json_writer_uint(&w, "p50_ns", stats.p50_ns);
+        json_writer_uint(&w, "p99_ns", stats.p99_ns);
+        json_writer_array_begin(&w, "buckets");
+        for (unsigned b = 0; b < LATENCY_PROBE_BUCKETS; b++) {
+            if (buckets[b] != 0) {
+                json_writer_array_begin(&w, NULL);
+                json_writer_uint(&w, NULL, latency_probe_bucket_upper_ns(b));
+                json_writer_uint(&w, NULL, buckets[b]);
+                json_writer_array_end(&w);
+            }
+        }
+        json_writer_array_end(&w);
+        json_writer_object_end(&w);
+        if (reset) {
+            latency_probe_reset((latency_probe_id_t)id);
+        }
+    }
+    json_writer_object_end(&w);
+    return json_end(req, &w);
 }
 
 void webui_register_api_handlers(httpd_handle_t server)
@@ -1766,6 +1868,15 @@ void webui_register_api_handlers(httpd_handle_t server)
     };
     httpd_register_uri_handler(server, &get_status_uri);
     
+    // GET /api/i2c/stats
+    httpd_uri_t get_i2c_stats_uri = {
+        .uri       = "/api/i2c/stats",
+        .method    = HTTP_GET,
+        .handler   = api_get_i2c_stats_handler,
+        .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(server, &get_i2c_stats_uri);
+    
     // GET /api/i2c/pullup
     httpd_uri_t get_i2c_pullup_uri = {
         .uri       = "/api/i2c/pullup",
@@ -1785,7 +1896,7 @@ void webui_register_api_handlers(httpd_handle_t server)
     httpd_register_uri_handler(server, &post_i2c_pullup_uri);
     
     
-    // GET /api/logs - Get system logs
+    // GET /api/logs?since=<position> - Get system logs
     httpd_uri_t get_logs_uri = {
         .uri       = "/api/logs",
         .method    = HTTP_GET,
@@ -1849,6 +1960,60 @@ void webui_register_api_handlers(httpd_handle_t server)
     };
     httpd_register_uri_handler(server, &post_nau7802_calibrate_uri);
     
+    // GET /api/nau7802/calibrate
+    httpd_uri_t get_nau7802_calibrate_uri = {
+        .uri       = "/api/nau7802/calibrate",
+        .method    = HTTP_GET,
+        .handler   = api_get_nau7802_calibrate_handler,
+        .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(server, &get_nau7802_calibrate_uri);
+    
+    // GET /api/nau7802/history
+    httpd_uri_t get_nau7802_history_uri = {
+        .uri       = "/api/nau7802/history",
+        .method    = HTTP_GET,
+        .handler   = api_get_nau7802_history_handler,
+        .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(server, &get_nau7802_history_uri);
+    
+    // GET /api/trace
+    httpd_uri_t get_trace_uri = {
+        .uri       = "/api/trace",
+        .method    = HTTP_GET,
+        .handler   = api_get_trace_handler,
+        .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(server, &get_trace_uri);
+    
+    // GET /api/trace/levels
+    httpd_uri_t get_trace_levels_uri = {
+        .uri       = "/api/trace/levels",
+        .method    = HTTP_GET,
+        .handler   = api_get_trace_levels_handler,
+        .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(server, &get_trace_levels_uri);
+    
+    // POST /api/trace/levels
+    httpd_uri_t post_trace_levels_uri = {
+        .uri       = "/api/trace/levels",
+        .method    = HTTP_POST,
+        .handler   = api_post_trace_levels_handler,
+        .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(server, &post_trace_levels_uri);
+    
+    // GET /api/latency
+    httpd_uri_t get_latency_uri = {
+        .uri       = "/api/latency",
+        .method    = HTTP_GET,
+        .handler   = api_get_latency_handler,
+        .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(server, &get_latency_uri);
+    
     ESP_LOGI(TAG, "API handler registration complete");
 }
 
@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Prometheus text exposition of the runtime counters (GET /metrics)
+ *
+ * Collects the counters kept by the network handler, the Connection Manager,
+ * the Ethernet Link media counters, LLDP, Modbus TCP, the scale channels,
+ * FreeRTOS and the heap into one scrape. Lines are formatted into a fixed
+ * buffer that is sent as an HTTP chunk whenever it fills up, so a scrape
+ * allocates nothing from the heap. The task table is static for the same
+ * reason; requests are served one at a time by the HTTP server task.
+ *
+ * Counters are read without stopping their writers: a value may be one
+ * event behind, which a scraper cannot tell from a slightly earlier scrape.
+ */
+
+#include "webui_metrics.h"
+#include "opener_user_conf.h"
+#include "generic_networkhandler.h"
+#include "cipconnectionmanager.h"
+#include "appcontype.h"
+#include "eth_media_counters.h"
+#include "lldp_reception.h"
+#include "lldp_neighbor_db.h"
+#include "modbus_tcp.h"
+#include "nau7802_history.h"
+#include "i2c_scheduler.h"
+#include "scalechannels.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/inet.h"
+#include "sdkconfig.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define METRICS_BUF_SIZE   1024  // Output is sent in chunks of at most this size
+#define METRICS_MAX_TASKS  48    // Tasks reported; the task metrics are left out if there are more
+#define METRICS_MAX_IO_CONNECTIONS                                                \
+    (OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS +                                        \
+     OPENER_CIP_NUM_INPUT_ONLY_CONNS * OPENER_CIP_NUM_INPUT_ONLY_CONNS_PER_CON_PATH + \
+     OPENER_CIP_NUM_LISTEN_ONLY_CONNS * OPENER_CIP_NUM_LISTEN_ONLY_CONNS_PER_CON_PATH)
+
+static const char *TAG = "webui_metrics";
+
+// Assembly 102 (scale channels) and its lock, in the scale application
+extern uint8_t g_assembly_data066[SCALE_CHANNEL_ASSEMBLY_SIZE];
+extern SemaphoreHandle_t scale_application_get_assembly_mutex(void);
+extern uint8_t scale_application_get_nau7802_count(void);
+
+typedef struct {
+    httpd_req_t *req;
+    size_t len;
+    bool failed;
+    char buf[METRICS_BUF_SIZE];
+} metrics_writer_t;
+
+static metrics_writer_t s_writer;
+#if configUSE_TRACE_FACILITY
+static TaskStatus_t s_tasks[METRICS_MAX_TASKS];
+#endif
+
+static void metrics_flush(metrics_writer_t *w)
+{
+    if (!w->failed && w->len > 0 &&
+        httpd_resp_send_chunk(w->req, w->buf, w->len) != ESP_OK) {
+        w->failed = true;
+    }
+    w->len = 0;
+}
+
+// Append formatted text; a line that does not fit goes out after a flush
+static void metrics_printf(metrics_writer_t *w, const char *fmt, ...)
+{
+    if (w->failed) {
+        return;
+    }
+    for (int attempt = 0; attempt < 2; attempt++) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(&w->buf[w->len], sizeof(w->buf) - w->len, fmt, args);
+        va_end(args);
+        if (n < 0) {
+            w->failed = true;
+            return;
+        }
+        if ((size_t)n < sizeof(w->buf) - w->len) {
+            w->len += (size_t)n;
+            return;
+        }
+        metrics_flush(w);
+    }
+    w->failed = true;  // Longer than the whole buffer
+}
+
+static void metric_family(metrics_writer_t *w, const char *name, const char *type, const char *help)
+{
+    metrics_printf(w, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// One sample; labels is the text between the braces, or NULL
+static void metric_uint(metrics_writer_t *w, const char *name, const char *labels, uint64_t value)
+{
+    if (labels != NULL) {
+        metrics_printf(w, "%s{%s} %" PRIu64 "\n", name, labels, value);
+    } else {
+        metrics_printf(w, "%s %" PRIu64 "\n", name, value);
+    }
+}
+
+static void metric_double(metrics_writer_t *w, const char *name, const char *labels, double value)
+{
+    if (labels != NULL) {
+        metrics_printf(w, "%s{%s} %.9g\n", name, labels, value);
+    } else {
+        metrics_printf(w, "%s %.9g\n", name, value);
+    }
+}
+
+// Copy a label value, escaping backslash, double quote and newline
+static void escape_label(char *out, size_t size, const char *in)
+{
+    size_t o = 0;
+    for (; *in != '\0' && o + 2 < size; in++) {
+        if (*in == '\\' || *in == '"') {
+            out[o++] = '\\';
+            out[o++] = *in;
+        } else if (*in == '\n') {
+            out[o++] = '\\';
+            out[o++] = 'n';
+        } else {
+            out[o++] = *in;
+        }
+    }
+    out[o] = '\0';
+}
+
+static void write_interface_metrics(metrics_writer_t *w)
+{
+    const NetworkInterfaceCounters *c = NetworkGetInterfaceCounters();
+
+    metric_family(w, "enip_interface_octets_total", "counter",
+                  "Octets received and sent by the EtherNet/IP stack");
+    metric_uint(w, "enip_interface_octets_total", "direction=\"in\"", c->in_octets);
+    metric_uint(w, "enip_interface_octets_total", "direction=\"out\"", c->out_octets);
+
+    metric_family(w, "enip_interface_packets_total", "counter",
+                  "Packets received and sent by the EtherNet/IP stack");
+    metric_uint(w, "enip_interface_packets_total", "direction=\"in\",cast=\"unicast\"", c->in_ucast_packets);
+    metric_uint(w, "enip_interface_packets_total", "direction=\"in\",cast=\"multicast\"", c->in_nucast_packets);
+    metric_uint(w, "enip_interface_packets_total", "direction=\"out\",cast=\"unicast\"", c->out_ucast_packets);
+    metric_uint(w, "enip_interface_packets_total", "direction=\"out\",cast=\"multicast\"", c->out_nucast_packets);
+
+    metric_family(w, "enip_interface_discards_total", "counter", "Packets discarded");
+    metric_uint(w, "enip_interface_discards_total", "direction=\"in\"", c->in_discards);
+    metric_uint(w, "enip_interface_discards_total", "direction=\"out\"", c->out_discards);
+
+    metric_family(w, "enip_interface_errors_total", "counter", "Packets with errors");
+    metric_uint(w, "enip_interface_errors_total", "direction=\"in\"", c->in_errors);
+    metric_uint(w, "enip_interface_errors_total", "direction=\"out\"", c->out_errors);
+
+    metric_family(w, "enip_interface_unknown_protos_total", "counter",
+                  "Packets received for an unknown protocol");
+    metric_uint(w, "enip_interface_unknown_protos_total", NULL, c->in_unknown_protos);
+
+#if defined(OPENER_ETHLINK_CNTRS_ENABLE) && 0 != OPENER_ETHLINK_CNTRS_ENABLE
+    static const char *const media_names[] = {
+        "align_errs", "fcs_errs", "single_coll", "multi_coll", "sqe_test_errs", "def_trans",
+        "late_coll", "exc_coll", "mac_tx_errs", "crs_errs", "frame_too_long", "mac_rx_errs",
+    };
+    CipEthernetLinkMediaCounters media;
+    EthMediaCountersCollect(&media);
+    metric_family(w, "enip_ethernet_media_errors_total", "counter",
+                  "Ethernet Link media counters (attribute 5)");
+    for (size_t i = 0; i < sizeof(media_names) / sizeof(media_names[0]); i++) {
+        char labels[32];
+        snprintf(labels, sizeof(labels), "counter=\"%s\"", media_names[i]);
+        metric_uint(w, "enip_ethernet_media_errors_total", labels, media.cntr32[i]);
+    }
+#endif
+}
+
+static void write_connection_metrics(metrics_writer_t *w)
+{
+    // The Connection Manager counters are CIP UINTs and wrap at 65536
+    const ConnectionManagerStatistics *cm = ConnectionManagerGetStatistics();
+    metric_family(w, "enip_cm_open_requests_total", "counter", "Forward Open requests accepted");
+    metric_uint(w, "enip_cm_open_requests_total", NULL, cm->open_requests);
+    metric_family(w, "enip_cm_open_rejects_total", "counter", "Forward Open requests rejected");
+    metric_uint(w, "enip_cm_open_rejects_total", "reason=\"format\"", cm->open_format_rejects);
+    metric_uint(w, "enip_cm_open_rejects_total", "reason=\"resource\"", cm->open_resource_rejects);
+    metric_uint(w, "enip_cm_open_rejects_total", "reason=\"other\"", cm->open_other_rejects);
+    metric_family(w, "enip_cm_close_requests_total", "counter", "Forward Close requests accepted");
+    metric_uint(w, "enip_cm_close_requests_total", NULL, cm->close_requests);
+    metric_family(w, "enip_cm_close_rejects_total", "counter", "Forward Close requests rejected");
+    metric_uint(w, "enip_cm_close_rejects_total", "reason=\"format\"", cm->close_format_requests);
+    metric_uint(w, "enip_cm_close_rejects_total", "reason=\"other\"", cm->close_other_requests);
+    metric_family(w, "enip_cm_connection_timeouts_total", "counter", "Connections closed by a timeout");
+    metric_uint(w, "enip_cm_connection_timeouts_total", NULL, cm->connection_timeouts);
+
+    IoConnectionCounters conns[METRICS_MAX_IO_CONNECTIONS];
+    size_t count = GetIoConnectionCounters(conns, METRICS_MAX_IO_CONNECTIONS);
+    char labels[METRICS_MAX_IO_CONNECTIONS][96];
+    for (size_t i = 0; i < count; i++) {
+        const char *type = conns[i].instance_type == kConnectionObjectInstanceTypeIOExclusiveOwner ? "exclusive_owner" :
+                           conns[i].instance_type == kConnectionObjectInstanceTypeIOInputOnly ? "input_only" :
+                           conns[i].instance_type == kConnectionObjectInstanceTypeIOListenOnly ? "listen_only" : "io";
+        struct in_addr addr = { .s_addr = conns[i].originator_address };
+        char ip[INET_ADDRSTRLEN];
+        inet_ntoa_r(addr, ip, sizeof(ip));
+        snprintf(labels[i], sizeof(labels[i]), "type=\"%s\",originator=\"%s\",serial=\"%u\",assembly=\"%u\"",
+                 type, ip, (unsigned)conns[i].connection_serial_number, (unsigned)conns[i].produced_point);
+    }
+
+    metric_family(w, "enip_io_connections", "gauge", "Established I/O connections");
+    metric_uint(w, "enip_io_connections", NULL, count);
+    metric_family(w, "enip_io_packets_total", "counter", "I/O packets of each established connection");
+    for (size_t i = 0; i < count; i++) {
+        char both[128];
+        snprintf(both, sizeof(both), "%s,direction=\"consumed\"", labels[i]);
+        metric_uint(w, "enip_io_packets_total", both, conns[i].consumed);
+        snprintf(both, sizeof(both), "%s,direction=\"produced\"", labels[i]);
+        metric_uint(w, "enip_io_packets_total", both, conns[i].produced);
+    }
+    metric_family(w, "enip_io_late_packets_total", "counter",
+                  "I/O packets dropped because a newer sequence count had already arrived");
+    for (size_t i = 0; i < count; i++) {
+        metric_uint(w, "enip_io_late_packets_total", labels[i], conns[i].late);
+    }
+    metric_family(w, "enip_io_lost_packets_total", "counter",
+                  "Sequence counts skipped between consumed I/O packets");
+    for (size_t i = 0; i < count; i++) {
+        metric_uint(w, "enip_io_lost_packets_total", labels[i], conns[i].lost);
+    }
+}
+
+static void write_lldp_modbus_metrics(metrics_writer_t *w)
+{
+    lldp_reception_stats_t lldp;
+    lldp_reception_get_stats(&lldp);
+    metric_family(w, "enip_lldp_frames_received_total", "counter", "LLDP frames received");
+    metric_uint(w, "enip_lldp_frames_received_total", NULL, lldp.frames_received);
+    metric_family(w, "enip_lldp_frames_discarded_total", "counter", "LLDP frames that could not be processed");
+    metric_uint(w, "enip_lldp_frames_discarded_total", NULL, lldp.frames_discarded);
+    metric_family(w, "enip_lldp_receive_errors_total", "counter", "Failed reads from the LLDP socket");
+    metric_uint(w, "enip_lldp_receive_errors_total", NULL, lldp.receive_errors);
+    metric_family(w, "enip_lldp_neighbors", "gauge", "LLDP neighbors known");
+    metric_uint(w, "enip_lldp_neighbors", NULL, (uint64_t)lldp_neighbor_db_get_count());
+
+    modbus_tcp_stats_t modbus;
+    modbus_tcp_get_stats(&modbus);
+    metric_family(w, "enip_modbus_requests_total", "counter", "Modbus TCP requests answered");
+    metric_uint(w, "enip_modbus_requests_total", NULL, modbus.requests);
+    metric_family(w, "enip_modbus_exceptions_total", "counter", "Modbus TCP requests answered with an exception");
+    metric_uint(w, "enip_modbus_exceptions_total", NULL, modbus.exceptions);
+    metric_family(w, "enip_modbus_framing_errors_total", "counter",
+                  "Modbus TCP connections closed for an invalid MBAP header");
+    metric_uint(w, "enip_modbus_framing_errors_total", NULL, modbus.framing_errors);
+    metric_family(w, "enip_modbus_connections", "gauge", "Modbus TCP clients connected");
+    metric_uint(w, "enip_modbus_connections", NULL, modbus.connections_active);
+    metric_family(w, "enip_modbus_connections_closed_total", "counter", "Modbus TCP clients closed by the server");
+    metric_uint(w, "enip_modbus_connections_closed_total", "reason=\"evicted\"", modbus.connections_evicted);
+    metric_uint(w, "enip_modbus_connections_closed_total", "reason=\"idle\"", modbus.connections_timed_out);
+    metric_family(w, "enip_modbus_connections_accepted_total", "counter", "Modbus TCP clients accepted");
+    metric_uint(w, "enip_modbus_connections_accepted_total", NULL, modbus.connections_accepted);
+}
+
+static void write_scale_metrics(metrics_writer_t *w)
+{
+    static const char *const unit_names[] = { "g", "lbs", "kg" };
+    static const char *const flag_names[] = {
+        "available", "connected", "initialized", "stable", "in_motion", "center_of_zero",
+    };
+
+    uint8_t channels = scale_application_get_nau7802_count();
+    if (channels > SCALE_CHANNEL_MAX) {
+        channels = SCALE_CHANNEL_MAX;
+    }
+    uint8_t records[SCALE_CHANNEL_ASSEMBLY_SIZE];
+    SemaphoreHandle_t mutex = scale_application_get_assembly_mutex();
+    if (mutex == NULL || xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        channels = 0;
+    } else {
+        memcpy(records, g_assembly_data066, sizeof(records));
+        xSemaphoreGive(mutex);
+    }
+
+    metric_family(w, "enip_scale_weight", "gauge", "Weight in the configured unit");
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        const uint8_t *record = &records[ch * SCALE_CHANNEL_RECORD_SIZE];
+        int32_t weight_scaled;
+        memcpy(&weight_scaled, &record[0], sizeof(weight_scaled));
+        char labels[32];
+        snprintf(labels, sizeof(labels), "channel=\"%u\",unit=\"%s\"", ch,
+                 record[8] < 3 ? unit_names[record[8]] : "unknown");
+        metric_double(w, "enip_scale_weight", labels, weight_scaled / 100.0);
+    }
+    metric_family(w, "enip_scale_raw", "gauge", "Averaged raw ADC reading");
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        int32_t raw;
+        memcpy(&raw, &records[ch * SCALE_CHANNEL_RECORD_SIZE + 4], sizeof(raw));
+        char labels[16];
+        snprintf(labels, sizeof(labels), "channel=\"%u\"", ch);
+        metric_double(w, "enip_scale_raw", labels, raw);
+    }
+    metric_family(w, "enip_scale_status", "gauge", "Scale status flags of the input assembly (1 = set)");
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        uint8_t status = records[ch * SCALE_CHANNEL_RECORD_SIZE + 9];
+        for (unsigned bit = 0; bit < sizeof(flag_names) / sizeof(flag_names[0]); bit++) {
+            char labels[48];
+            snprintf(labels, sizeof(labels), "channel=\"%u\",flag=\"%s\"", ch, flag_names[bit]);
+            metric_uint(w, "enip_scale_status", labels, (status >> bit) & 1U);
+        }
+    }
+    if (nau7802_history_capacity() > 0) {
+        metric_family(w, "enip_scale_samples_total", "counter", "Samples captured");
+        for (uint8_t ch = 0; ch < channels; ch++) {
+            char labels[16];
+            snprintf(labels, sizeof(labels), "channel=\"%u\"", ch);
+            metric_uint(w, "enip_scale_samples_total", labels, nau7802_history_head(ch));
+        }
+    }
+
+    i2c_sched_device_stats_t i2c[I2C_SCHED_MAX_DEVICES];
+    size_t devices = i2c_sched_get_stats(i2c, I2C_SCHED_MAX_DEVICES);
+    char i2c_labels[I2C_SCHED_MAX_DEVICES][48];
+    for (size_t i = 0; i < devices; i++) {
+        char name[sizeof(i2c[i].name) * 2];
+        escape_label(name, sizeof(name), i2c[i].name);
+        snprintf(i2c_labels[i], sizeof(i2c_labels[i]), "device=\"%s\",address=\"0x%02x\"",
+                 name, (unsigned)i2c[i].address);
+    }
+    metric_family(w, "enip_i2c_transactions_total", "counter", "I2C transactions");
+    for (size_t i = 0; i < devices; i++) {
+        metric_uint(w, "enip_i2c_transactions_total", i2c_labels[i], i2c[i].transactions);
+    }
+    metric_family(w, "enip_i2c_errors_total", "counter", "I2C transactions that failed");
+    for (size_t i = 0; i < devices; i++) {
+        metric_uint(w, "enip_i2c_errors_total", i2c_labels[i], i2c[i].errors);
+    }
+}
+
+static void write_system_metrics(metrics_writer_t *w)
+{
+    metric_family(w, "enip_uptime_seconds", "gauge", "Time since boot");
+    metric_double(w, "enip_uptime_seconds", NULL, esp_timer_get_time() / 1e6);
+
+    static const struct {
+        const char *region;
+        uint32_t caps;
+    } regions[] = {
+        { "internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT },
+#ifdef CONFIG_SPIRAM
+        { "psram", MALLOC_CAP_SPIRAM },
+#endif
+    };
+    multi_heap_info_t heap[sizeof(regions) / sizeof(regions[0])];
+    size_t heap_size[sizeof(regions) / sizeof(regions[0])];
+    for (size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        heap_caps_get_info(&heap[i], regions[i].caps);
+        heap_size[i] = heap_caps_get_total_size(regions[i].caps);
+    }
+    char labels[24];
+    metric_family(w, "enip_heap_size_bytes", "gauge", "Heap size");
+    for (size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        snprintf(labels, sizeof(labels), "region=\"%s\"", regions[i].region);
+        metric_uint(w, "enip_heap_size_bytes", labels, heap_size[i]);
+    }
+    metric_family(w, "enip_heap_free_bytes", "gauge", "Free heap");
+    for (size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        snprintf(labels, sizeof(labels), "region=\"%s\"", regions[i].region);
+        metric_uint(w, "enip_heap_free_bytes", labels, heap[i].total_free_bytes);
+    }
+    metric_family(w, "enip_heap_free_min_bytes", "gauge", "Lowest free heap since boot");
+    for (size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        snprintf(labels, sizeof(labels), "region=\"%s\"", regions[i].region);
+        metric_uint(w, "enip_heap_free_min_bytes", labels, heap[i].minimum_free_bytes);
+    }
+    metric_family(w, "enip_heap_largest_free_block_bytes", "gauge", "Largest free heap block");
+    for (size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        snprintf(labels, sizeof(labels), "region=\"%s\"", regions[i].region);
+        metric_uint(w, "enip_heap_largest_free_block_bytes", labels, heap[i].largest_free_block);
+    }
+
+#if configUSE_TRACE_FACILITY
+    UBaseType_t tasks = uxTaskGetSystemState(s_tasks, METRICS_MAX_TASKS, NULL);
+    metric_family(w, "enip_tasks", "gauge", "FreeRTOS tasks");
+    metric_uint(w, "enip_tasks", NULL, uxTaskGetNumberOfTasks());
+#if configGENERATE_RUN_TIME_STATS
+    // The run time counter is in microseconds; as a 32-bit counter it wraps
+    // every 71 minutes, which rate() treats as a counter reset
+    metric_family(w, "enip_task_cpu_seconds_total", "counter", "CPU time used by each task");
+    for (UBaseType_t i = 0; i < tasks; i++) {
+        char name[2 * configMAX_TASK_NAME_LEN];
+        escape_label(name, sizeof(name), s_tasks[i].pcTaskName);
+        char task_labels[sizeof(name) + 8];
+        snprintf(task_labels, sizeof(task_labels), "task=\"%s\"", name);
+        metric_double(w, "enip_task_cpu_seconds_total", task_labels, s_tasks[i].ulRunTimeCounter / 1e6);
+    }
+#endif
+    metric_family(w, "enip_task_stack_free_min_bytes", "gauge", "Lowest free stack of each task since it started");
+    for (UBaseType_t i = 0; i < tasks; i++) {
+        char name[2 * configMAX_TASK_NAME_LEN];
+        escape_label(name, sizeof(name), s_tasks[i].pcTaskName);
+        char task_labels[sizeof(name) + 8];
+        snprintf(task_labels, sizeof(task_labels), "task=\"%s\"", name);
+        metric_uint(w, "enip_task_stack_free_min_bytes", task_labels, s_tasks[i].usStackHighWaterMark);
+    }
+#endif
+}
+
+// GET /metrics - Prometheus text exposition format
+static esp_err_t metrics_handler(httpd_req_t *req)
+{
+    metrics_writer_t *w = &s_writer;
+    w->req = req;
+    w->len = 0;
+    w->failed = false;
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4; charset=utf-8");
+    write_interface_metrics(w);
+    write_connection_metrics(w);
+    write_lldp_modbus_metrics(w);
+    write_scale_metrics(w);
+    write_system_metrics(w);
+    metrics_flush(w);
+
+    if (w->failed) {
+        ESP_LOGW(TAG, "Metrics response was not completed");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+void webui_register_metrics_handler(httpd_handle_t server)
+{
+    httpd_uri_t metrics_uri = {
+        .uri       = "/metrics",
+        .method    = HTTP_GET,
+        .handler   = metrics_handler,
+        .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(server, &metrics_uri);
+}
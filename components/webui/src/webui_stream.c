@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Live scale data for the web UI as Server-Sent Events (GET /api/stream)
+ *
+ * The acquisition task publishes each channel's values into a small table.
+ * A low-priority task checks it at most CONFIG_OPENER_WEBUI_STREAM_MAX_RATE_HZ
+ * times per second and, when something changed and viewers are connected,
+ * serializes one event. The event is wrapped in HTTP chunk framing once and
+ * the same bytes are sent to every viewer, so an additional viewer costs one
+ * send() per update and no I2C traffic or JSON building.
+ *
+ * Sending happens in the HTTP server task (httpd_queue_work), which also owns
+ * the viewer table: viewers are added by the request handler and removed when
+ * the server closes their session, so no lock is needed and a socket number
+ * is never used after the server has released it.
+ */
+
+#include "webui_stream.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include "sdkconfig.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef CONFIG_OPENER_WEBUI_STREAM_MAX_RATE_HZ
+#define STREAM_MAX_RATE_HZ CONFIG_OPENER_WEBUI_STREAM_MAX_RATE_HZ
+#else
+#define STREAM_MAX_RATE_HZ 5
+#endif
+
+#ifdef CONFIG_OPENER_WEBUI_STREAM_MAX_CLIENTS
+#define STREAM_MAX_CLIENTS CONFIG_OPENER_WEBUI_STREAM_MAX_CLIENTS
+#else
+#define STREAM_MAX_CLIENTS 4
+#endif
+
+#define STREAM_KEEPALIVE_US  (15 * 1000000LL)  // Comment frame when nothing changed for this long
+#define STREAM_RETRY_MS      3000              // Browser reconnect delay
+#define STREAM_EVENT_MAX     1536              // One event with all channels
+#define STREAM_TASK_STACK    4096
+#define STREAM_TASK_PRIORITY 3
+
+static const char *TAG = "webui_stream";
+
+typedef struct {
+    int fd;
+    bool active;   // Slot holds a viewer
+    bool closing;  // A send failed and the session close is pending
+} stream_client_t;
+
+// One event in HTTP chunk framing, ready to be sent to every viewer
+typedef struct {
+    httpd_handle_t server;
+    size_t len;
+    char data[];
+} stream_frame_t;
+
+// Latest values per channel, written by the acquisition task
+static webui_stream_scale_t s_scales[WEBUI_STREAM_SCALE_CHANNEL_MAX];
+static uint8_t s_scale_mask;  // Channels published at least once
+static portMUX_TYPE s_scale_lock = portMUX_INITIALIZER_UNLOCKED;
+static atomic_bool s_dirty;
+
+// Viewers, only accessed from the HTTP server task
+static stream_client_t s_clients[STREAM_MAX_CLIENTS];
+static atomic_uint s_client_count;
+
+static httpd_handle_t s_server = NULL;
+static SemaphoreHandle_t s_server_lock = NULL;  // Keeps stop from racing a frame being queued
+static TaskHandle_t s_task_handle = NULL;
+static atomic_bool s_frame_queued;  // A frame waits in the server's work queue
+static atomic_uint s_seq;
+
+static atomic_uint s_stat_frames;
+static atomic_uint s_stat_sends;
+static atomic_uint s_stat_bytes;
+static atomic_uint s_stat_dropped;
+static atomic_uint s_stat_build_us;
+static atomic_uint s_stat_fanout_us;
+
+// Field by field, as memcmp would also compare the struct padding. The weight is
+// compared bitwise so a NaN (uncalibrated scale) does not count as a change.
+static bool scale_values_equal(const webui_stream_scale_t *a, const webui_stream_scale_t *b)
+{
+    return memcmp(&a->weight, &b->weight, sizeof(a->weight)) == 0 && a->weight_scaled == b->weight_scaled && a->raw == b->raw &&
+           a->unit == b->unit && a->status == b->status;
+}
+
+void webui_stream_publish_scale(uint8_t channel, const webui_stream_scale_t *values)
+{
+    if (channel >= WEBUI_STREAM_SCALE_CHANNEL_MAX || values == NULL) {
+        return;
+    }
+    bool changed = false;
+    portENTER_CRITICAL(&s_scale_lock);
+    if (!(s_scale_mask & (1u << channel)) || !scale_values_equal(&s_scales[channel], values)) {
+        s_scales[channel] = *values;
+        s_scale_mask |= 1u << channel;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&s_scale_lock);
+    if (changed) {
+        atomic_store(&s_dirty, true);
+    }
+}
+
+#define STATUS_FLAG(s, bit) (((s)->status & (bit)) ? "true" : "false")
+
+// Serialize the current values of all published channels as one "scale" event.
+// Returns the length, or 0 if the buffer is too small.
+static size_t build_scale_event(char *buf, size_t size)
+{
+    static const char *unit_labels[] = {"g", "lbs", "kg"};
+    webui_stream_scale_t scales[WEBUI_STREAM_SCALE_CHANNEL_MAX];
+    uint8_t mask;
+
+    portENTER_CRITICAL(&s_scale_lock);
+    memcpy(scales, s_scales, sizeof(scales));
+    mask = s_scale_mask;
+    portEXIT_CRITICAL(&s_scale_lock);
+
+    int len = snprintf(buf, size, "event: scale\ndata: {\"seq\":%u,\"uptime_ms\":%llu,\"scales\":[",
+                       atomic_fetch_add(&s_seq, 1),
+                       (unsigned long long)(esp_timer_get_time() / 1000));
+    bool first = true;
+    for (uint8_t ch = 0; ch < WEBUI_STREAM_SCALE_CHANNEL_MAX && len > 0 && (size_t)len < size; ch++) {
+        if (!(mask & (1u << ch))) {
+            continue;
+        }
+        const webui_stream_scale_t *s = &scales[ch];
+        char weight[24];
+        if (isfinite(s->weight)) {
+            snprintf(weight, sizeof(weight), "%.3f", s->weight);
+        } else {
+            strcpy(weight, "null");  // JSON has no NaN or infinity
+        }
+        len += snprintf(buf + len, size - len,
+                        "%s{\"scale\":%u,\"weight\":%s,\"weight_scaled\":%ld,\"unit\":\"%s\",\"unit_code\":%u,"
+                        "\"raw_reading\":%ld,\"status_byte\":%u,\"available\":%s,\"connected\":%s,"
+                        "\"stable\":%s,\"in_motion\":%s,\"center_of_zero\":%s}",
+                        first ? "" : ",", ch, weight, (long)s->weight_scaled,
+                        s->unit < 3 ? unit_labels[s->unit] : "g", s->unit, (long)s->raw, s->status,
+                        STATUS_FLAG(s, 0x01), STATUS_FLAG(s, 0x02),
+                        STATUS_FLAG(s, 0x08), STATUS_FLAG(s, 0x10), STATUS_FLAG(s, 0x20));
+        first = false;
+    }
+    if (len > 0 && (size_t)len < size) {
+        len += snprintf(buf + len, size - len, "]}\n\n");
+    }
+    if (len <= 0 || (size_t)len >= size) {
+        ESP_LOGW(TAG, "Stream event does not fit in %u bytes", (unsigned)size);
+        return 0;
+    }
+    return (size_t)len;
+}
+
+static stream_frame_t *frame_create(httpd_handle_t server, const char *event, size_t event_len)
+{
+    char chunk_header[12];
+    int header_len = snprintf(chunk_header, sizeof(chunk_header), "%x\r\n", (unsigned)event_len);
+    stream_frame_t *frame = malloc(sizeof(*frame) + header_len + event_len + 2);
+    if (frame == NULL) {
+        return NULL;
+    }
+    frame->server = server;
+    frame->len = header_len + event_len + 2;
+    memcpy(frame->data, chunk_header, header_len);
+    memcpy(frame->data + header_len, event, event_len);
+    memcpy(frame->data + header_len + event_len, "\r\n", 2);
+    return frame;
+}
+
+// Runs in the HTTP server task
+static void stream_fanout(void *arg)
+{
+    stream_frame_t *frame = (stream_frame_t *)arg;
+    int64_t start = esp_timer_get_time();
+
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        stream_client_t *client = &s_clients[i];
+        if (!client->active || client->closing) {
+            continue;
+        }
+        // Never block the server on a slow viewer: if a frame does not fit in
+        // the socket's send buffer the viewer is dropped (EventSource reconnects)
+        int ret = httpd_socket_send(frame->server, client->fd, frame->data, frame->len, MSG_DONTWAIT);
+        if (ret == (int)frame->len) {
+            atomic_fetch_add(&s_stat_sends, 1);
+            atomic_fetch_add(&s_stat_bytes, frame->len);
+        } else {
+            ESP_LOGW(TAG, "Dropping stream viewer on socket %d (send returned %d)", client->fd, ret);
+            client->closing = true;
+            atomic_fetch_add(&s_stat_dropped, 1);
+            httpd_sess_trigger_close(frame->server, client->fd);
+        }
+    }
+
+    atomic_fetch_add(&s_stat_fanout_us, (unsigned)(esp_timer_get_time() - start));
+    free(frame);
+    atomic_store(&s_frame_queued, false);
+}
+
+static void stream_task(void *pvParameters)
+{
+    static char event[STREAM_EVENT_MAX];
+    TickType_t period = pdMS_TO_TICKS(1000 / STREAM_MAX_RATE_HZ);
+    if (period == 0) {
+        period = 1;
+    }
+    TickType_t last_wake = xTaskGetTickCount();
+    int64_t last_frame_us = esp_timer_get_time();
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, period);
+
+        // Nothing to do without viewers, and never more than one frame in the
+        // server's queue: values that change meanwhile go out with the next one
+        if (atomic_load(&s_client_count) == 0 || atomic_load(&s_frame_queued)) {
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+        size_t len = 0;
+        if (atomic_exchange(&s_dirty, false)) {
+            len = build_scale_event(event, sizeof(event));
+        } else if (start - last_frame_us >= STREAM_KEEPALIVE_US) {
+            // A comment line keeps the connection alive and finds dead viewers
+            len = (size_t)snprintf(event, sizeof(event), ": keepalive\n\n");
+        }
+        if (len == 0) {
+            continue;
+        }
+
+        xSemaphoreTake(s_server_lock, portMAX_DELAY);
+        if (s_server != NULL) {
+            stream_frame_t *frame = frame_create(s_server, event, len);
+            if (frame != NULL) {
+                atomic_store(&s_frame_queued, true);
+                if (httpd_queue_work(s_server, stream_fanout, frame) == ESP_OK) {
+                    atomic_fetch_add(&s_stat_frames, 1);
+                } else {
+                    atomic_store(&s_frame_queued, false);
+                    free(frame);
+                }
+            }
+        }
+        xSemaphoreGive(s_server_lock);
+
+        atomic_fetch_add(&s_stat_build_us, (unsigned)(esp_timer_get_time() - start));
+        last_frame_us = start;
+    }
+}
+
+// Called by the HTTP server when a viewer's session is closed, for any reason
+static void stream_client_closed(void *ctx)
+{
+    stream_client_t *client = (stream_client_t *)ctx;
+    if (client->active) {
+        client->active = false;
+        atomic_fetch_sub(&s_client_count, 1);
+    }
+}
+
+// GET /api/stream - Server-Sent Events with live scale data
+static esp_err_t stream_handler(httpd_req_t *req)
+{
+    stream_client_t *client = NULL;
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (!s_clients[i].active) {
+            client = &s_clients[i];
+            break;
+        }
+    }
+    if (client == NULL) {
+        static const char *busy = "{\"status\":\"error\",\"message\":\"Too many stream viewers\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, busy, strlen(busy));
+    }
+
+    // Open the stream with the reconnect delay and the current values, so the
+    // page has data before the next change
+    char event[STREAM_EVENT_MAX];
+    int len = snprintf(event, sizeof(event), "retry: %d\n\n", STREAM_RETRY_MS);
+    len += build_scale_event(event + len, sizeof(event) - len);
+
+    httpd_resp_set_type(req, "text/event-stream");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    esp_err_t ret = httpd_resp_send_chunk(req, event, len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // The response stays open; the server keeps the session and tells us
+    // through free_ctx when it closes
+    client->fd = httpd_req_to_sockfd(req);
+    client->active = true;
+    client->closing = false;
+    req->sess_ctx = client;
+    req->free_ctx = stream_client_closed;
+    atomic_fetch_add(&s_client_count, 1);
+    ESP_LOGI(TAG, "Stream viewer connected on socket %d (%u viewers)", client->fd,
+             atomic_load(&s_client_count));
+    return ESP_OK;
+}
+
+esp_err_t webui_stream_start(httpd_handle_t server)
+{
+    if (s_server_lock == NULL) {
+        s_server_lock = xSemaphoreCreateMutex();
+        if (s_server_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(s_server_lock, portMAX_DELAY);
+    s_server = server;
+    atomic_store(&s_frame_queued, false);
+    xSemaphoreGive(s_server_lock);
+
+    if (s_task_handle == NULL &&
+        xTaskCreatePinnedToCore(stream_task, "webui_stream", STREAM_TASK_STACK, NULL,
+                                STREAM_TASK_PRIORITY, &s_task_handle, 1) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create stream task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    httpd_uri_t stream_uri = {
+        .uri = "/api/stream",
+        .method = HTTP_GET,
+        .handler = stream_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &stream_uri);
+
+    ESP_LOGI(TAG, "Live stream ready (max %d Hz, %d viewers)", STREAM_MAX_RATE_HZ, STREAM_MAX_CLIENTS);
+    return ESP_OK;
+}
+
+void webui_stream_stop(void)
+{
+    if (s_server_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_server_lock, portMAX_DELAY);
+    s_server = NULL;
+    xSemaphoreGive(s_server_lock);
+}
+
+void webui_stream_get_stats(webui_stream_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->clients = atomic_load(&s_client_count);
+    stats->frames = atomic_load(&s_stat_frames);
+    stats->sends = atomic_load(&s_stat_sends);
+    stats->bytes = atomic_load(&s_stat_bytes);
+    stats->dropped = atomic_load(&s_stat_dropped);
+    stats->build_us = atomic_load(&s_stat_build_us);
+    stats->fanout_us = atomic_load(&s_stat_fanout_us);
+}
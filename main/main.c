@@ -97,6 +97,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <math.h>
+#include <stdatomic.h>
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -128,13 +129,27 @@
 #include "sdkconfig.h"
 #include "esp_netif_net_stack.h"
 #include "webui.h"
+#include "webui_stream.h"
 #include "modbus_tcp.h"
+#include "modbus_register_map.h"
 #include "ota_manager.h"
 #include "system_config.h"
 #include "log_buffer.h"
 #include "nau7802.h"
+#include "nau7802_stability.h"
+#include "nau7802_history.h"
+#include "nau7802_scale.h"
+#include "nau7802_calibration_storage.h"
+#include "sampleblock.h"
+#include "scalechannels.h"
+#if CONFIG_OPENER_NAU7802_SIMULATED
+#include "nau7802_sim.h"
+#endif
 #include "driver/i2c_master.h"
+#include "i2c_scheduler.h"
 #include "eth_media_counters.h"
+#include "latency_probe.h"
+#include "tracecontrol.h"
 #if OPENER_LLDP_ENABLED
 #include "esp_vfs_l2tap.h"
 #endif
@@ -148,6 +163,7 @@ void ScaleApplicationNotifyLinkDown(void);
 
 // External assembly data arrays (defined in opener component)
 extern uint8_t g_assembly_data064[32];  // Input Assembly 100
+extern uint8_t g_assembly_data066[SCALE_CHANNEL_ASSEMBLY_SIZE];  // Input Assembly 102 (scale channels)
 extern uint8_t g_assembly_data096[32];  // Output Assembly 150
 
 static const char *TAG = "opener_main";
@@ -156,13 +172,18 @@ static SemaphoreHandle_t s_netif_mutex = NULL;
 static bool s_services_initialized = false;
 static esp_eth_mac_t *s_eth_mac = NULL;  // MAC pointer for media counter access
 
-// NAU7802 scale device
-static nau7802_t s_nau7802_device;
+// NAU7802 scale channels, one NAU7802 per load cell
+static nau7802_scale_t s_scales[SCALE_CHANNEL_COUNT];
+_Static_assert(NAU7802_SCALE_RECORD_SIZE == SCALE_CHANNEL_RECORD_SIZE,
+               "Scale record size differs between nau7802_scale and Assembly 102");
 static i2c_master_bus_handle_t s_i2c_bus_handle = NULL;
-static bool s_nau7802_initialized = false;
+static i2c_master_dev_handle_t s_scale_mux_dev = NULL;  // TCA9548A in front of the scales, if any
+#if CONFIG_OPENER_NAU7802_SIMULATED
+static nau7802_sim_t s_scale_sims[SCALE_CHANNEL_COUNT];  // Register models standing in for the scales
+#endif
 static TaskHandle_t s_nau7802_task_handle = NULL;
-static SemaphoreHandle_t s_nau7802_mutex = NULL;  // Protects device I2C operations
-static SemaphoreHandle_t s_nau7802_state_mutex = NULL;  // Protects initialization flag
+static SemaphoreHandle_t s_nau7802_state_mutex = NULL;  // Protects the initialized flags
+static atomic_uint s_nau7802_config_changes;  // SYSTEM_CONFIG_FIELD_BIT mask pending for the scale task
 
 
 // User LED state (GPIO27)
@@ -366,7 +387,8 @@ static void user_led_flash_task(void *pvParameters);
 static void user_led_start_flash(void);
 static void user_led_stop_flash(void);
 
-// NAU7802 scale reading task
+// NAU7802 scale channels
+static void nau7802_scales_init(void);
 static void nau7802_scale_task(void *pvParameters);
 
 /**
@@ -1204,12 +1226,12 @@ static void got_ip_event_handler(void *arg, esp_event_base_t event_base,
     xSemaphoreGive(s_netif_mutex);
     
     // Create NAU7802 mutexes if not already created (only once)
-    if (s_nau7802_mutex == NULL) {
-        s_nau7802_mutex = xSemaphoreCreateMutex();
-        if (s_nau7802_mutex == NULL) {
-            ESP_LOGE(TAG, "Failed to create NAU7802 device mutex");
-        } else {
-            ESP_LOGI(TAG, "NAU7802 device mutex created");
+    for (uint8_t ch = 0; ch < SCALE_CHANNEL_COUNT; ch++) {
+        if (s_scales[ch].mutex == NULL) {
+            s_scales[ch].mutex = xSemaphoreCreateMutex();
+            if (s_scales[ch].mutex == NULL) {
+                ESP_LOGE(TAG, "Failed to create NAU7802 %u device mutex", ch);
+            }
         }
     }
     if (s_nau7802_state_mutex == NULL) {
@@ -1268,6 +1290,41 @@ static void got_ip_event_handler(void *arg, esp_event_base_t event_base,
     }
 }
 
+// Start or stop the Modbus TCP server when it is enabled or disabled at runtime.
+// Before the network is up the cached setting is picked up by got_ip instead.
+static void modbus_config_changed(system_config_field_t field, void *ctx)
+{
+    (void)ctx;
+    if (field == SYSTEM_CONFIG_FIELD_MODBUS_WORD_ORDER) {
+        modbus_register_map_set_word_order(system_modbus_word_order_load());
+        return;
+    }
+    if (field != SYSTEM_CONFIG_FIELD_MODBUS_ENABLED || !s_services_initialized) {
+        return;
+    }
+    
+    if (system_modbus_enabled_load()) {
+        if (!modbus_tcp_init()) {
+            ESP_LOGW(TAG, "Failed to initialize ModbusTCP");
+        } else if (!modbus_tcp_start()) {
+            ESP_LOGW(TAG, "Failed to start ModbusTCP server");
+        }
+    } else {
+        modbus_tcp_stop();
+    }
+}
+
+// Hand NAU7802 setting changes to the scale task, which applies them between samples
+static void nau7802_config_changed(system_config_field_t field, void *ctx)
+{
+    (void)ctx;
+    atomic_fetch_or(&s_nau7802_config_changes, SYSTEM_CONFIG_FIELD_BIT(field));
+    TaskHandle_t task = s_nau7802_task_handle;
+    if (task != NULL) {
+        xTaskNotifyGive(task);
+    }
+}
+
 void app_main(void)
 {
     // Initialize user LED early at boot
@@ -1279,6 +1336,9 @@ void app_main(void)
         ESP_LOGW(TAG, "Failed to initialize log buffer");
     }
     
+    // Modbus and scale ESP log tags follow the trace mask from here on
+    TraceControlInit();
+    
     esp_err_t nvs_ret = nvs_flash_init();
     if (nvs_ret == ESP_ERR_NVS_NO_FREE_PAGES || nvs_ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
@@ -1286,6 +1346,12 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(nvs_ret);
     
+    // Read all settings from NVS once; everything else uses the RAM cache
+    system_config_init();
+    modbus_register_map_set_word_order(system_modbus_word_order_load());
+    system_config_subscribe(modbus_config_changed, NULL);
+    system_config_subscribe(nau7802_config_changed, NULL);
+    
     // Mark the current running app as valid to allow OTA updates
     // This must be done after NVS init and before any OTA operations
     const esp_partition_t *running = esp_ota_get_running_partition();
@@ -1407,293 +1473,511 @@ void app_main(void)
         ESP_LOGI(TAG, "I2C bus initialized successfully (SCL: GPIO%d, SDA: GPIO%d)", 
                  CONFIG_OPENER_I2C_SCL_GPIO, CONFIG_OPENER_I2C_SDA_GPIO);
         
-        // Initialize NAU7802 if enabled
+        // All bus traffic goes through the scheduler; its worker runs above every
+        // bus user (scale task 5, HTTP server 5) so queued work starts immediately
+        if (i2c_sched_init(6) != ESP_OK) {
+            ESP_LOGW(TAG, "I2C scheduler not started, bus access is unscheduled");
+        }
+        
+        // Initialize the NAU7802 scale channels if enabled
         if (system_nau7802_enabled_load()) {
-            esp_err_t nau_err = nau7802_init(&s_nau7802_device, s_i2c_bus_handle, NAU7802_I2C_ADDRESS);
-            if (nau_err == ESP_OK) {
-                if (nau7802_is_connected(&s_nau7802_device)) {
-                    // Load configuration from NVS
-                    uint8_t ldo_value = system_nau7802_ldo_load();
-                    uint8_t gain = system_nau7802_gain_load();
-                    uint8_t sample_rate = system_nau7802_sample_rate_load();
-                    uint8_t channel = system_nau7802_channel_load();
-                    
-                    // Initialize with defaults (nau7802_begin sets LDO=4, gain=128, sample_rate=80)
-                    nau_err = nau7802_begin(&s_nau7802_device);
-                    if (nau_err == ESP_OK) {
-                        bool need_recal = false;
-                        
-                        // Apply LDO if different from default (4 = 3.3V)
-                        if (ldo_value != 4) {
-                            nau_err = nau7802_set_ldo(&s_nau7802_device, ldo_value);
-                            if (nau_err == ESP_OK) {
-                                ESP_LOGI(TAG, "NAU7802 LDO set to %d", ldo_value);
-                                vTaskDelay(pdMS_TO_TICKS(250));  // Wait for LDO to stabilize
-                            } else {
-                                ESP_LOGW(TAG, "Failed to set NAU7802 LDO: %s", esp_err_to_name(nau_err));
-                            }
-                        }
-                        
-                        // Apply gain if different from default (7 = x128)
-                        if (gain != 7) {
-                            nau_err = nau7802_set_gain(&s_nau7802_device, (nau7802_gain_t)gain);
-                            if (nau_err == ESP_OK) {
-                                ESP_LOGI(TAG, "NAU7802 gain set to %d (x%d)", gain, 1 << gain);
-                                need_recal = true;
-                            } else {
-                                ESP_LOGW(TAG, "Failed to set NAU7802 gain: %s", esp_err_to_name(nau_err));
-                            }
-                        }
-                        
-                        // Apply sample rate if different from default (3 = 80 SPS)
-                        if (sample_rate != 3) {
-                            nau_err = nau7802_set_sample_rate(&s_nau7802_device, (nau7802_sps_t)sample_rate);
-                            if (nau_err == ESP_OK) {
-                                const char *sps_str = (sample_rate == 0) ? "10" : (sample_rate == 1) ? "20" : 
-                                                      (sample_rate == 2) ? "40" : (sample_rate == 3) ? "80" : "320";
-                                ESP_LOGI(TAG, "NAU7802 sample rate set to %d (%s SPS)", sample_rate, sps_str);
-                                need_recal = true;
-                            } else {
-                                ESP_LOGW(TAG, "Failed to set NAU7802 sample rate: %s", esp_err_to_name(nau_err));
-                            }
-                        }
-                        
-                        // Apply channel if different from default (0 = Channel 1)
-                        if (channel != 0) {
-                            nau_err = nau7802_set_channel(&s_nau7802_device, (nau7802_channel_t)channel);
-                            if (nau_err == ESP_OK) {
-                                ESP_LOGI(TAG, "NAU7802 channel set to %d (Channel %d)", channel, channel + 1);
-                            } else {
-                                ESP_LOGW(TAG, "Failed to set NAU7802 channel: %s", esp_err_to_name(nau_err));
-                            }
-                        }
-                        
-                        // Recalibrate AFE if gain or sample rate changed
-                        if (need_recal) {
-                            ESP_LOGI(TAG, "Recalibrating NAU7802 AFE due to gain/sample rate change");
-                            nau_err = nau7802_calibrate_af(&s_nau7802_device);
-                            if (nau_err != ESP_OK) {
-                                ESP_LOGW(TAG, "NAU7802 AFE recalibration failed: %s", esp_err_to_name(nau_err));
-                            }
-                        }
-                        
-                        // Load calibration data from NVS
-                        float cal_factor = system_nau7802_calibration_factor_load();
-                        float zero_offset = system_nau7802_zero_offset_load();
-                        if (cal_factor > 0.0f) {
-                            nau7802_set_calibration_factor(&s_nau7802_device, cal_factor);
-                        }
-                        if (zero_offset != 0.0f) {
-                            nau7802_set_zero_offset(&s_nau7802_device, zero_offset);
-                        }
-                        
-                        // Set initialization flag with mutex protection
-                        if (s_nau7802_state_mutex != NULL) {
-                            xSemaphoreTake(s_nau7802_state_mutex, portMAX_DELAY);
-                            s_nau7802_initialized = true;
-                            xSemaphoreGive(s_nau7802_state_mutex);
-                        } else {
-                            s_nau7802_initialized = true;
-                        }
-                        ESP_LOGI(TAG, "NAU7802 initialized successfully");
-                        
-                        // Start NAU7802 scale reading task now that device is initialized
-                        // Delete old task if it exists (e.g., on reinitialization)
-                        if (s_nau7802_task_handle != NULL) {
-                            vTaskDelete(s_nau7802_task_handle);
-                            s_nau7802_task_handle = NULL;
-                            ESP_LOGI(TAG, "Deleted old NAU7802 task");
-                        }
-                        
-                        xTaskCreate(nau7802_scale_task, "nau7802_task", 4096, NULL, 5, &s_nau7802_task_handle);
-                        if (s_nau7802_task_handle == NULL) {
-                            ESP_LOGW(TAG, "Failed to create NAU7802 task");
-                        } else {
-                            ESP_LOGI(TAG, "NAU7802 scale reading task started");
-                        }
-                    } else {
-                        ESP_LOGE(TAG, "NAU7802 begin() failed: %s", esp_err_to_name(nau_err));
-                    }
-                } else {
-                    ESP_LOGW(TAG, "NAU7802 not connected on I2C bus");
-                }
-            } else {
-                ESP_LOGE(TAG, "NAU7802 init() failed: %s", esp_err_to_name(nau_err));
-            }
+            nau7802_scales_init();
         } else {
             ESP_LOGI(TAG, "NAU7802 is disabled in configuration");
         }
     }
 }
 
-// NAU7802 access functions for web API
-nau7802_t* scale_application_get_nau7802_handle(void)
+// Bring up one scale channel: probe it, program the stored front-end settings
+// and apply its calibration record. Returns true if the channel can sample.
+static bool nau7802_channel_begin(uint8_t channel, const nau7802_config_t *nau_config)
 {
-    bool initialized = false;
-    if (s_nau7802_state_mutex != NULL) {
-        xSemaphoreTake(s_nau7802_state_mutex, portMAX_DELAY);
-        initialized = s_nau7802_initialized;
-        xSemaphoreGive(s_nau7802_state_mutex);
+    nau7802_scale_t *scale = &s_scales[channel];
+#if CONFIG_OPENER_NAU7802_SIMULATED
+    // A different load per channel, with a 200 g step every 5 s to exercise
+    // the motion and stability detection
+    nau7802_sim_signal_t signal = {
+        .zero_counts = 20000 + 1000 * channel,
+        .counts_per_gram = 50.0f,
+        .load_g = 500.0f + 250.0f * channel,
+        .step_g = 200.0f,
+        .step_period_ms = 5000,
+        .noise_counts = 40.0f,
+        .drift_counts_per_s = 0.5f,
+        .hum_counts = 25.0f,
+        .hum_hz = 50.0f,
+        .seed = channel + 1,
+    };
+    esp_err_t nau_err = nau7802_sim_init(&s_scale_sims[channel], &signal);
+    if (nau_err == ESP_OK) {
+        nau_err = nau7802_init_device(&scale->device, nau7802_sim_get_handle(&s_scale_sims[channel]),
+                                      NAU7802_I2C_ADDRESS);
+    }
+#else
+    esp_err_t nau_err = nau7802_init(&scale->device, s_i2c_bus_handle, NAU7802_I2C_ADDRESS);
+#endif
+    if (nau_err != ESP_OK) {
+        ESP_LOGE(TAG, "NAU7802 %u init() failed: %s", channel, esp_err_to_name(nau_err));
+        return false;
+    }
+    
+    // Name the channel in the I2C statistics and route it through its mux port
+    // before the first transaction
+    char name[16];
+    snprintf(name, sizeof(name), "nau7802_%u", channel);
+    i2c_sched_register_device(scale->device.i2c_dev, NAU7802_I2C_ADDRESS, name);
+    if (s_scale_mux_dev != NULL) {
+        i2c_sched_set_mux_route(scale->device.i2c_dev, s_scale_mux_dev, channel);
+    }
+    
+    if (!nau7802_is_connected(&scale->device)) {
+        ESP_LOGW(TAG, "NAU7802 %u not connected on I2C bus", channel);
+        return false;
+    }
+    
+    // Program the stored front-end settings during begin so the
+    // AFE is calibrated once, for the final configuration
+    nau_err = nau7802_begin_config(&scale->device, nau_config);
+    if (nau_err != ESP_OK) {
+        ESP_LOGE(TAG, "NAU7802 %u begin() failed: %s", channel, esp_err_to_name(nau_err));
+        return false;
+    }
+    
+    nau7802_calibration_data_t cal;
+    esp_err_t cal_err = nau7802_calibration_load_channel(channel, &cal);
+    if (cal_err != ESP_OK && channel == 0) {
+        // Single-scale firmware kept the calibration in system_config; move it
+        // into the channel 0 record on the first boot after the upgrade
+        float cal_factor = system_nau7802_calibration_factor_load();
+        float zero_offset = system_nau7802_zero_offset_load();
+        cal.calibration_factor = (cal_factor > 0.0f) ? cal_factor : 1.0f;
+        cal.zero_offset = zero_offset;
+        cal.channel1_offset = 0;
+        cal.is_valid = (cal_factor > 0.0f || zero_offset != 0.0f);
+        if (cal.is_valid) {
+            nau7802_calibration_save_channel(0, &cal);
+        }
+        cal_err = ESP_OK;
+    }
+    if (cal_err == ESP_OK && cal.is_valid) {
+        nau7802_set_calibration_factor(&scale->device, cal.calibration_factor);
+        nau7802_set_zero_offset(&scale->device, cal.zero_offset);
+    } else {
+        ESP_LOGW(TAG, "NAU7802 %u has no calibration, reporting raw counts", channel);
+    }
+    
+    ESP_LOGI(TAG, "NAU7802 %u configured: LDO %d, gain x%d, rate %d, channel %d", channel,
+             nau_config->ldo, 1 << nau_config->gain, nau_config->sample_rate, nau_config->channel + 1);
+    return true;
+}
+
+// Bring up all scale channels and start the acquisition task
+static void nau7802_scales_init(void)
+{
+#if CONFIG_OPENER_NAU7802_MUX_ADDRESS && !CONFIG_OPENER_NAU7802_SIMULATED
+    i2c_device_config_t mux_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = CONFIG_OPENER_NAU7802_MUX_ADDRESS,
+        .scl_speed_hz = 400000,
+    };
+    if (i2c_master_bus_add_device(s_i2c_bus_handle, &mux_cfg, &s_scale_mux_dev) == ESP_OK) {
+        i2c_sched_register_device(s_scale_mux_dev, CONFIG_OPENER_NAU7802_MUX_ADDRESS, "tca9548a");
     } else {
-        initialized = s_nau7802_initialized;
+        ESP_LOGE(TAG, "Failed to add TCA9548A at 0x%02X", CONFIG_OPENER_NAU7802_MUX_ADDRESS);
+        s_scale_mux_dev = NULL;
     }
-    return initialized ? &s_nau7802_device : NULL;
+#endif
+    
+    // Every NAU7802 answers at the same address, so without the mux only one can be used
+    uint8_t channel_count = SCALE_CHANNEL_COUNT;
+#if !CONFIG_OPENER_NAU7802_SIMULATED
+    if (channel_count > 1 && s_scale_mux_dev == NULL) {
+        ESP_LOGE(TAG, "%d scale channels configured but no TCA9548A available, using channel 0 only",
+                 SCALE_CHANNEL_COUNT);
+        channel_count = 1;
+    }
+#endif
+    
+    system_config_t sys_config;
+    system_config_get(&sys_config);
+    nau7802_config_t nau_config = {
+        .ldo = sys_config.nau7802_ldo,
+        .gain = (nau7802_gain_t)sys_config.nau7802_gain,
+        .sample_rate = (nau7802_sps_t)sys_config.nau7802_sample_rate,
+        .channel = (nau7802_channel_t)sys_config.nau7802_channel,
+    };
+    
+    uint8_t ready = 0;
+    for (uint8_t ch = 0; ch < channel_count; ch++) {
+        if (!nau7802_channel_begin(ch, &nau_config)) {
+            continue;
+        }
+        
+        // Set initialization flag with mutex protection
+        if (s_nau7802_state_mutex != NULL) {
+            xSemaphoreTake(s_nau7802_state_mutex, portMAX_DELAY);
+            s_scales[ch].initialized = true;
+            xSemaphoreGive(s_nau7802_state_mutex);
+        } else {
+            s_scales[ch].initialized = true;
+        }
+        ready++;
+    }
+    ESP_LOGI(TAG, "NAU7802: %u of %u scale channels initialized", ready, channel_count);
+    if (ready == 0) {
+        return;
+    }
+    
+    // History rings are written by the scale task; allocate them once
+    if (nau7802_history_init(SCALE_CHANNEL_COUNT, CONFIG_OPENER_NAU7802_HISTORY_SAMPLES,
+                             CONFIG_OPENER_NAU7802_HISTORY_FALLBACK_SAMPLES) != ESP_OK) {
+        ESP_LOGW(TAG, "NAU7802 sample history disabled (out of memory)");
+    }
+    
+    // Start NAU7802 scale reading task now that the devices are initialized
+    // Delete old task if it exists (e.g., on reinitialization)
+    if (s_nau7802_task_handle != NULL) {
+        vTaskDelete(s_nau7802_task_handle);
+        s_nau7802_task_handle = NULL;
+        ESP_LOGI(TAG, "Deleted old NAU7802 task");
+    }
+    
+    xTaskCreate(nau7802_scale_task, "nau7802_task", 4096, NULL, 5, &s_nau7802_task_handle);
+    if (s_nau7802_task_handle == NULL) {
+        ESP_LOGW(TAG, "Failed to create NAU7802 task");
+    } else {
+        ESP_LOGI(TAG, "NAU7802 scale reading task started");
+    }
+}
+
+// NAU7802 access functions for web API
+uint8_t scale_application_get_nau7802_count(void)
+{
+    return SCALE_CHANNEL_COUNT;
 }
 
-bool scale_application_is_nau7802_initialized(void)
+bool scale_application_is_nau7802_initialized(uint8_t channel)
 {
+    if (channel >= SCALE_CHANNEL_COUNT) {
+        return false;
+    }
     bool initialized = false;
     if (s_nau7802_state_mutex != NULL) {
         xSemaphoreTake(s_nau7802_state_mutex, portMAX_DELAY);
-        initialized = s_nau7802_initialized;
+        initialized = s_scales[channel].initialized;
         xSemaphoreGive(s_nau7802_state_mutex);
     } else {
-        initialized = s_nau7802_initialized;
+        initialized = s_scales[channel].initialized;
     }
     return initialized;
 }
 
+nau7802_t* scale_application_get_nau7802_handle(uint8_t channel)
+{
+    return scale_application_is_nau7802_initialized(channel) ? &s_scales[channel].device : NULL;
+}
+
 // Get NAU7802 device mutex for API handlers
-SemaphoreHandle_t scale_application_get_nau7802_mutex(void)
+SemaphoreHandle_t scale_application_get_nau7802_mutex(uint8_t channel)
+{
+    return (channel < SCALE_CHANNEL_COUNT) ? s_scales[channel].mutex : NULL;
+}
+
+// Wake the scale task to poll for a new conversion
+static void nau7802_capture_timer_cb(void *arg)
+{
+    xTaskNotifyGive((TaskHandle_t)arg);
+}
+
+// Conversion period in microseconds for a NAU7802 sample rate code
+static uint32_t nau7802_conversion_period_us(uint8_t sample_rate)
+{
+    switch (sample_rate) {
+        case NAU7802_SPS_10:  return 100000;
+        case NAU7802_SPS_20:  return 50000;
+        case NAU7802_SPS_40:  return 25000;
+        case NAU7802_SPS_80:  return 12500;
+        default:              return 3125;  // NAU7802_SPS_320
+    }
+}
+
+// Apply analog front-end settings changed at runtime (LDO, gain, sample rate, channel).
+// The driver diffs against its register shadow, so only changed registers are written.
+static void nau7802_apply_analog_config(uint8_t channel)
+{
+    nau7802_scale_t *scale = &s_scales[channel];
+    system_config_t config;
+    system_config_get(&config);
+    nau7802_config_t nau_config = {
+        .ldo = config.nau7802_ldo,
+        .gain = (nau7802_gain_t)config.nau7802_gain,
+        .sample_rate = (nau7802_sps_t)config.nau7802_sample_rate,
+        .channel = (nau7802_channel_t)config.nau7802_channel,
+    };
+    
+    if (scale->mutex == NULL || xSemaphoreTake(scale->mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGW(TAG, "Failed to acquire NAU7802 %u mutex, configuration change not applied", channel);
+        return;
+    }
+    esp_err_t err = nau7802_configure(&scale->device, &nau_config);
+    xSemaphoreGive(scale->mutex);
+    
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to apply NAU7802 %u configuration: %s", channel, esp_err_to_name(err));
+    } else {
+        ESP_LOGI(TAG, "NAU7802 %u analog configuration applied", channel);
+    }
+}
+
+// Copy the record of one channel into Assembly 102 (and channel 0 into
+// Assembly 100 at the configured offset) and hand the values to Modbus and
+// the web UI. Called with the assembly mutex held.
+static void nau7802_publish(uint8_t channel, uint8_t byte_offset, uint8_t unit)
+{
+    uint8_t record[NAU7802_SCALE_RECORD_SIZE];
+    nau7802_scale_values_t values;
+    nau7802_scale_publish(&s_scales[channel], unit, record, &values);
+    
+    memcpy(&g_assembly_data066[channel * SCALE_CHANNEL_RECORD_SIZE], record, sizeof(record));
+    
+    // Same values as 32-bit Modbus registers (int32 and float)
+    modbus_scale_values_t modbus_values = {
+        .weight_scaled = values.weight_scaled,
+        .weight = values.weight,
+        .raw = values.raw,
+        .filtered = values.filtered,
+        .filtered_exact = values.filtered_exact,
+        .unit = values.unit,
+        .status = values.status,
+    };
+    modbus_register_map_set_scale_values(channel, &modbus_values);
+    
+    // Live values for web UI viewers (GET /api/stream)
+    webui_stream_scale_t stream_values = {
+        .weight = values.weight,
+        .weight_scaled = values.weight_scaled,
+        .raw = values.filtered,
+        .unit = unit,
+        .status = values.status,
+    };
+    webui_stream_publish_scale(channel, &stream_values);
+    if (channel == 0) {
+        // Check if we have space in assembly (need 10 bytes: weight (4), raw (4), unit (1), status (1))
+        if (byte_offset <= 22) {  // Need 10 bytes, so max offset is 22
+            memcpy(&g_assembly_data064[byte_offset], record, sizeof(record));
+        } else {
+            ESP_LOGW(TAG, "NAU7802 byte offset %d too large for 10-byte data (max 22)", byte_offset);
+        }
+    }
+}
+
+#if CONFIG_OPENER_NAU7802_SIMULATED
+// Log the throughput of the simulated front ends since the last report
+static void nau7802_report_sim_stats(uint32_t interval_ms)
 {
-    return s_nau7802_mutex;
+    static nau7802_sim_stats_t s_last[SCALE_CHANNEL_COUNT];
+    for (uint8_t ch = 0; ch < SCALE_CHANNEL_COUNT; ch++) {
+        nau7802_sim_stats_t stats;
+        nau7802_sim_get_stats(&s_scale_sims[ch], &stats);
+        if (stats.transactions == s_last[ch].transactions) {
+            continue;
+        }
+        ESP_LOGI(TAG, "Simulated NAU7802 %u: %lu conversions, %lu read, %lu missed, %lu I2C transactions in %lu ms",
+                 ch, (unsigned long)(stats.conversions - s_last[ch].conversions),
+                 (unsigned long)(stats.reads - s_last[ch].reads),
+                 (unsigned long)(stats.missed - s_last[ch].missed),
+                 (unsigned long)(stats.transactions - s_last[ch].transactions),
+                 (unsigned long)interval_ms);
+        s_last[ch] = stats;
+    }
 }
+#endif
 
-// NAU7802 scale reading task - updates Assembly 100 with scale data
+// NAU7802 scale reading task
+// Captures every ADC conversion of every channel into its history ring (channel 0
+// also into the sample block ring, Assembly 101) and updates Assemblies 100 and
+// 102 with the averaged readings every 100ms
 static void nau7802_scale_task(void *pvParameters)
 {
     (void)pvParameters;
+    i2c_sched_set_task_class(NULL, I2C_SCHED_CLASS_REALTIME);
     const TickType_t update_interval = pdMS_TO_TICKS(100);  // 100ms = 10 Hz update rate
-    const TickType_t config_reload_interval = pdMS_TO_TICKS(5000);  // Reload config every 5s
-    TickType_t last_config_reload = xTaskGetTickCount();
+    TickType_t next_update = xTaskGetTickCount() + update_interval;
+#if CONFIG_OPENER_NAU7802_SIMULATED
+    uint32_t sim_report_count = 0;
+#endif
     
+    // Settings come from the RAM config cache; app_main already applied the
+    // analog ones, so only changes from here on need to be handled
+    atomic_store(&s_nau7802_config_changes, 0);
     uint8_t byte_offset = system_nau7802_byte_offset_load();
     uint8_t average_samples = system_nau7802_average_load();
+    uint8_t sample_rate = system_nau7802_sample_rate_load();
+    uint8_t unit = system_nau7802_unit_load();
+    uint32_t period_us = nau7802_conversion_period_us(sample_rate);
     
-    ESP_LOGI(TAG, "NAU7802 scale task started, byte offset: %d, average samples: %d", byte_offset, average_samples);
+    nau7802_stability_config_t stability_config = {
+        .window = CONFIG_OPENER_NAU7802_STABILITY_WINDOW,
+        .stable_band_g = CONFIG_OPENER_NAU7802_STABLE_BAND_MG / 1000.0f,
+        .motion_band_g = CONFIG_OPENER_NAU7802_MOTION_BAND_MG / 1000.0f,
+#if CONFIG_OPENER_NAU7802_AZT_ENABLED
+        .azt_enabled = true,
+        .azt_band_g = CONFIG_OPENER_NAU7802_AZT_BAND_MG / 1000.0f,
+        .azt_rate = CONFIG_OPENER_NAU7802_AZT_RATE_PCT / 100.0f,
+        .azt_limit_g = CONFIG_OPENER_NAU7802_AZT_LIMIT_MG / 1000.0f,
+#else
+        .azt_enabled = false,
+#endif
+    };
+    for (uint8_t ch = 0; ch < SCALE_CHANNEL_COUNT; ch++) {
+        nau7802_scale_init(&s_scales[ch], ch, &stability_config);
+    }
+    
+    // The channels convert independently. Each wake-up polls only the channels
+    // whose next conversion may be ready, so reads of different channels
+    // interleave on the bus and the aggregate sample rate grows with the channel
+    // count. The FreeRTOS tick (10ms) is too coarse for 320 SPS, so an esp_timer
+    // paces the task at a quarter of the conversion period.
+    esp_timer_handle_t capture_timer = NULL;
+    const esp_timer_create_args_t capture_timer_args = {
+        .callback = nau7802_capture_timer_cb,
+        .arg = xTaskGetCurrentTaskHandle(),
+        .name = "nau7802_capture",
+    };
+    if (esp_timer_create(&capture_timer_args, &capture_timer) == ESP_OK) {
+        esp_timer_start_periodic(capture_timer, period_us / 4);
+    } else {
+        ESP_LOGW(TAG, "Failed to create NAU7802 capture timer, polling once per tick");
+        capture_timer = NULL;
+    }
+    
+    ESP_LOGI(TAG, "NAU7802 scale task started, %d channels, byte offset: %d, average samples: %d",
+             SCALE_CHANNEL_COUNT, byte_offset, average_samples);
     
     while (1) {
-        // Reload configuration periodically to pick up API changes
-        TickType_t now = xTaskGetTickCount();
-        if (now - last_config_reload >= config_reload_interval) {
-            byte_offset = system_nau7802_byte_offset_load();
-            average_samples = system_nau7802_average_load();
-            last_config_reload = now;
-            ESP_LOGD(TAG, "NAU7802 config reloaded: offset=%d, average=%d", byte_offset, average_samples);
-        }
+        // Wait for the capture timer (or one tick if it is not running)
+        ulTaskNotifyTake(pdTRUE, 1);
         
-        // Check if initialized (with mutex protection)
-        bool initialized = false;
+        // Snapshot the initialized flags (with mutex protection)
+        bool initialized[SCALE_CHANNEL_COUNT];
         if (s_nau7802_state_mutex != NULL) {
             xSemaphoreTake(s_nau7802_state_mutex, portMAX_DELAY);
-            initialized = s_nau7802_initialized;
+        }
+        for (uint8_t ch = 0; ch < SCALE_CHANNEL_COUNT; ch++) {
+            initialized[ch] = s_scales[ch].initialized;
+        }
+        if (s_nau7802_state_mutex != NULL) {
             xSemaphoreGive(s_nau7802_state_mutex);
-        } else {
-            initialized = s_nau7802_initialized;
         }
         
-        if (initialized) {
-            // Check connection and get readings with device mutex protection
-            bool connected = false;
-            if (s_nau7802_mutex != NULL && xSemaphoreTake(s_nau7802_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                connected = nau7802_is_connected(&s_nau7802_device);
-                xSemaphoreGive(s_nau7802_mutex);
-            }
+        // Apply settings changed through system_config (REST API, etc.)
+        uint32_t changes = atomic_exchange(&s_nau7802_config_changes, 0);
+        if (changes != 0) {
+            const uint32_t analog_fields =
+                SYSTEM_CONFIG_FIELD_BIT(SYSTEM_CONFIG_FIELD_NAU7802_LDO) |
+                SYSTEM_CONFIG_FIELD_BIT(SYSTEM_CONFIG_FIELD_NAU7802_GAIN) |
+                SYSTEM_CONFIG_FIELD_BIT(SYSTEM_CONFIG_FIELD_NAU7802_SAMPLE_RATE) |
+                SYSTEM_CONFIG_FIELD_BIT(SYSTEM_CONFIG_FIELD_NAU7802_CHANNEL);
+            bool reset_average = false;
             
-            if (connected) {
-                // Get mutex for assembly access
-                SemaphoreHandle_t assembly_mutex = scale_application_get_assembly_mutex();
-                if (assembly_mutex != NULL && xSemaphoreTake(assembly_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    // Check if we have space in assembly (need 10 bytes: weight (4), raw (4), unit (1), status (1))
-                    if (byte_offset <= 22) {  // Need 10 bytes, so max offset is 22
-                        // Get device readings with mutex protection
-                        bool available = false;
-                        int32_t raw_reading = 0;
-                        float weight_grams = 0.0f;
-                        
-                        if (s_nau7802_mutex != NULL && xSemaphoreTake(s_nau7802_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                            available = nau7802_available(&s_nau7802_device);
-                            
-                            // Get scale reading (use averaging if configured)
-                            if (available) {
-                                if (average_samples > 1) {
-                                    raw_reading = nau7802_get_average(&s_nau7802_device, average_samples, 1000);
-                                } else {
-                                    raw_reading = nau7802_get_reading(&s_nau7802_device);
-                                }
-                            }
-                            
-                            // Get calibrated weight in grams (use averaging if configured)
-                            weight_grams = nau7802_get_weight(&s_nau7802_device, true, average_samples, 1000);
-                            
-                            xSemaphoreGive(s_nau7802_mutex);
-                        } else {
-                            ESP_LOGW(TAG, "Failed to acquire NAU7802 device mutex");
-                        }
-                        
-                        // Convert to selected unit and scale by 100
-                        uint8_t unit = system_nau7802_unit_load();
-                        float weight_converted = weight_grams;
-                        if (unit == 1) {
-                            // Convert grams to lbs: 1 lb = 453.592 grams
-                            weight_converted = weight_grams / 453.592f;
-                        } else if (unit == 2) {
-                            // Convert grams to kg: 1 kg = 1000 grams
-                            weight_converted = weight_grams / 1000.0f;
-                        }
-                        // unit == 0 means grams, no conversion needed
-                        
-                        // Clamp weight to prevent integer overflow (int32_t range: -2147483648 to 2147483647)
-                        // Scaled range: -21474836.48 to 21474836.47
-                        const float max_weight = 21474836.47f;
-                        const float min_weight = -21474836.48f;
-                        if (weight_converted > max_weight) {
-                            weight_converted = max_weight;
-                            ESP_LOGW(TAG, "Weight clamped to maximum (overflow protection)");
-                        } else if (weight_converted < min_weight) {
-                            weight_converted = min_weight;
-                            ESP_LOGW(TAG, "Weight clamped to minimum (overflow protection)");
-                        }
-                        
-                        // Scale by 100 and convert to int32_t (e.g., 100.24 lbs = 10024)
-                        int32_t weight_scaled = (int32_t)(weight_converted * 100.0f + 0.5f);  // Round to nearest
-                        
-                        // Pack status flags into byte: bit 0=available, bit 1=connected, bit 2=initialized
-                        uint8_t status_byte = 0;
-                        if (available) status_byte |= 0x01;  // Bit 0: available
-                        if (connected) status_byte |= 0x02;   // Bit 1: connected
-                        
-                        // Check initialized flag with mutex protection
-                        bool is_initialized = false;
-                        if (s_nau7802_state_mutex != NULL) {
-                            xSemaphoreTake(s_nau7802_state_mutex, portMAX_DELAY);
-                            is_initialized = s_nau7802_initialized;
-                            xSemaphoreGive(s_nau7802_state_mutex);
-                        } else {
-                            is_initialized = s_nau7802_initialized;
-                        }
-                        if (is_initialized) status_byte |= 0x04;  // Bit 2: initialized
-                        // Bits 3-7: reserved
-                        
-                        // Write to assembly (little-endian)
-                        // Bytes 0-3: Weight (int32_t, scaled by 100) in selected unit
-                        // Bytes 4-7: Raw reading (int32_t)
-                        // Byte 8: Unit code (0=grams, 1=lbs, 2=kg)
-                        // Byte 9: Status flags (bit 0=available, bit 1=connected, bit 2=initialized)
-                        memcpy(&g_assembly_data064[byte_offset], &weight_scaled, sizeof(int32_t));
-                        memcpy(&g_assembly_data064[byte_offset + 4], &raw_reading, sizeof(int32_t));
-                        g_assembly_data064[byte_offset + 8] = unit;
-                        g_assembly_data064[byte_offset + 9] = status_byte;
-                    } else {
-                        ESP_LOGW(TAG, "NAU7802 byte offset %d too large for 10-byte data (max 22)", byte_offset);
+            byte_offset = system_nau7802_byte_offset_load();
+            unit = system_nau7802_unit_load();
+            uint8_t new_average = system_nau7802_average_load();
+            if (new_average != average_samples) {
+                average_samples = new_average;
+                reset_average = true;
+            }
+            if (changes & analog_fields) {
+                for (uint8_t ch = 0; ch < SCALE_CHANNEL_COUNT; ch++) {
+                    if (initialized[ch]) {
+                        nau7802_apply_analog_config(ch);
+                        nau7802_stability_reset(&s_scales[ch].stability);
                     }
-                    
-                    xSemaphoreGive(assembly_mutex);
                 }
+                reset_average = true;
+            }
+            uint8_t new_rate = system_nau7802_sample_rate_load();
+            if (new_rate != sample_rate) {
+                period_us = nau7802_conversion_period_us(new_rate);
+                if (capture_timer != NULL) {
+                    esp_timer_stop(capture_timer);
+                    esp_timer_start_periodic(capture_timer, period_us / 4);
+                }
+            }
+            sample_rate = new_rate;
+            for (uint8_t ch = 0; ch < SCALE_CHANNEL_COUNT; ch++) {
+                s_scales[ch].next_poll_us = 0;
+                if (reset_average) {
+                    nau7802_scale_reset_average(&s_scales[ch]);
+                }
+            }
+            ESP_LOGD(TAG, "NAU7802 config updated: offset=%d, average=%d, unit=%d", byte_offset, average_samples, unit);
+        }
+        
+        // Capture new conversions from the channels that are due
+        int64_t now_us = esp_timer_get_time();
+        for (uint8_t ch = 0; ch < SCALE_CHANNEL_COUNT; ch++) {
+            if (initialized[ch] && now_us >= s_scales[ch].next_poll_us) {
+                LATENCY_PROBE_BEGIN(capture_mark);
+                nau7802_history_sample_t captured;
+                if (nau7802_scale_capture(&s_scales[ch], period_us, average_samples, &captured) && ch == 0) {
+                    // The sample block (Assembly 101) carries channel 0 only
+                    ScaleSample sample = {
+                        .timestamp_us = captured.timestamp_us,
+                        .raw = captured.raw,
+                        .weight_scaled = nau7802_scale_weight_scaled(captured.weight_g, unit),
+                    };
+                    ScaleSampleBlockPush(&sample);
+                }
+                LATENCY_PROBE_END(LATENCY_PROBE_SCALE_CAPTURE, capture_mark);
             }
         }
         
-        vTaskDelay(update_interval);
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t)(now - next_update) < 0) {
+            continue;
+        }
+        next_update += update_interval;
+        if ((int32_t)(now - next_update) >= 0) {
+            next_update = now + update_interval;  // Fell behind, don't try to catch up
+        }
+        
+        for (uint8_t ch = 0; ch < SCALE_CHANNEL_COUNT; ch++) {
+            nau7802_scale_t *scale = &s_scales[ch];
+            if (scale->read_errors > 0) {
+                ESP_LOGW(TAG, "NAU7802 %u: %lu sample reads failed", ch, (unsigned long)scale->read_errors);
+                scale->read_errors = 0;
+            }
+            
+            if (!initialized[ch]) {
+                continue;
+            }
+            
+            // Single read-only transaction, no device mutex needed
+            if (!nau7802_is_connected(&scale->device)) {
+                // Let web UI viewers see the scale drop out (status: initialized only)
+                webui_stream_scale_t stream_values = { .unit = unit, .status = 0x04 };
+                webui_stream_publish_scale(ch, &stream_values);
+                continue;
+            }
+            
+            // Get mutex for assembly access
+            SemaphoreHandle_t assembly_mutex = scale_application_get_assembly_mutex();
+            if (assembly_mutex != NULL && xSemaphoreTake(assembly_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                nau7802_publish(ch, byte_offset, unit);
+                if (ch == 0) {
+                    modbus_register_map_assembly_updated(MODBUS_ASSEMBLY_INPUT);
+                }
+                xSemaphoreGive(assembly_mutex);
+            }
+        }
+        
+#if CONFIG_OPENER_NAU7802_SIMULATED
+        if (++sim_report_count >= 100) {  // Every 10 s
+            sim_report_count = 0;
+            nau7802_report_sim_stats(10000);
+        }
+#endif
     }
 }
 
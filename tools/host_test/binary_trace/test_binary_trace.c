@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test: per-core binary trace rings
+ *
+ * Built with a 1 KB ring (256 words) so a few dozen records wrap it. The
+ * single-threaded cases check the record layout word for word, the argument
+ * count and capture of BINARY_TRACE() (0 and 14 arguments, float, double,
+ * 64-bit and negative integers) and that a wrapped ring holds only whole
+ * records, newest last. The concurrent case runs one writer thread per core
+ * flat out while a reader snapshots both rings, and checks that every
+ * snapshot parses into whole, consecutive records.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "host_test.h"
+#include "binary_trace.h"
+
+#define VIRTUAL_START_US   1000000
+#define HEADER_WORDS       3
+#define WRITES_PER_CORE    300000
+#define RING_WORDS_MAX     256
+
+_Static_assert(BINARY_TRACE_COUNT("none") == 0, "no arguments");
+_Static_assert(BINARY_TRACE_COUNT("one %d", 1) == 1, "one argument");
+_Static_assert(BINARY_TRACE_COUNT("%d%d%d%d%d%d%d%d%d%d%d%d%d%d",
+                                  1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14) == 14,
+               "fourteen arguments");
+
+static uint32_t s_words[RING_WORDS_MAX];
+
+static const char s_fmt_seq[] = "seq %u check %x";
+
+static uint32_t fmt_word(const char *fmt)
+{
+    return (uint32_t)(uintptr_t)fmt;
+}
+
+static size_t snapshot(uint32_t core)
+{
+    return binary_trace_snapshot(core, s_words, RING_WORDS_MAX);
+}
+
+// Check one record at words[at] against the expected header and arguments
+static void check_record(const uint32_t *words, size_t at, const char *fmt, uint32_t timestamp,
+                         uint32_t nargs, const uint32_t *args)
+{
+    CHECK_EQ_INT(words[at], (BINARY_TRACE_RECORD_MAGIC << 24) | nargs);
+    CHECK_EQ_INT(words[at + 1], fmt_word(fmt));
+    CHECK_EQ_INT(words[at + 2], timestamp);
+    for (uint32_t i = 0; i < nargs; i++) {
+        CHECK_EQ_INT(words[at + HEADER_WORDS + i], args[i]);
+    }
+}
+
+static void test_record_framing(void)
+{
+    CHECK_EQ_INT(binary_trace_ring_words(), RING_WORDS_MAX);
+    binary_trace_clear();
+    CHECK_EQ_INT(snapshot(0), 0);
+
+    host_clock_set_virtual(true, VIRTUAL_START_US);
+    static const char fmt0[] = "no arguments";
+    static const char fmt14[] = "%d %d %d %d %d %d %d %d %d %d %d %d %d %d";
+    BINARY_TRACE(fmt0);
+    host_clock_advance_us(250);
+    BINARY_TRACE(fmt14, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14);
+    host_clock_advance_us(250);
+    BINARY_TRACE(fmt0);
+
+    size_t n = snapshot(0);
+    CHECK_EQ_INT(n, 3 * HEADER_WORDS + 14);
+    static const uint32_t one_to_14[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+    check_record(s_words, 0, fmt0, VIRTUAL_START_US, 0, NULL);
+    check_record(s_words, HEADER_WORDS, fmt14, VIRTUAL_START_US + 250, 14, one_to_14);
+    check_record(s_words, 2 * HEADER_WORDS + 14, fmt0, VIRTUAL_START_US + 500, 0, NULL);
+
+    // Core 1's ring is separate and still empty
+    CHECK_EQ_INT(snapshot(1), 0);
+    CHECK_EQ_INT(binary_trace_overwritten(0), 0);
+
+    // binary_trace_write() caps the argument count
+    uint32_t many[BINARY_TRACE_MAX_ARGS + 4] = { 0 };
+    binary_trace_clear();
+    binary_trace_write(fmt14, BINARY_TRACE_MAX_ARGS + 4, many);
+    CHECK_EQ_INT(snapshot(0), HEADER_WORDS + BINARY_TRACE_MAX_ARGS);
+    CHECK_EQ_INT(s_words[0], (BINARY_TRACE_RECORD_MAGIC << 24) | BINARY_TRACE_MAX_ARGS);
+
+    // Undersized buffers and unknown cores copy nothing
+    CHECK_EQ_INT(binary_trace_snapshot(0, s_words, RING_WORDS_MAX - 1), 0);
+    CHECK_EQ_INT(binary_trace_snapshot(portNUM_PROCESSORS, s_words, RING_WORDS_MAX), 0);
+    host_clock_set_virtual(false, 0);
+}
+
+static void test_argument_capture(void)
+{
+    binary_trace_clear();
+    static const char fmt[] = "%f %f %lld %llu %d %u %p %c";
+    float f = 1.5f;
+    double d = -2.25;
+    int64_t big = (int64_t)0x123456789ABCDEF0LL;
+    uint64_t ubig = 0xFEDCBA9876543210ULL;
+    int8_t small = -3;
+    uint16_t half = 0xBEEF;
+    const void *ptr = &s_words[7];
+    char c = 'x';
+    BINARY_TRACE(fmt, f, d, big, ubig, small, half, ptr, c);
+
+    CHECK_EQ_INT(snapshot(0), HEADER_WORDS + 8);
+    CHECK_EQ_INT(s_words[0] & 0xFF, 8);
+    const uint32_t *args = &s_words[HEADER_WORDS];
+    CHECK_EQ_INT(args[0], 0x3FC00000);   // 1.5f
+    CHECK_EQ_INT(args[1], 0xC0100000);   // -2.25 stored as float bits
+    CHECK_EQ_INT(args[2], 0x9ABCDEF0);   // 64-bit integers keep the low word
+    CHECK_EQ_INT(args[3], 0x76543210);
+    CHECK_EQ_INT(args[4], 0xFFFFFFFD);   // Sign-extended
+    CHECK_EQ_INT(args[5], 0xBEEF);
+    CHECK_EQ_INT(args[6], (uint32_t)(uintptr_t)ptr);
+    CHECK_EQ_INT(args[7], 'x');
+    CHECK_EQ_INT(binary_trace_float_bits(0.1f), 0x3DCCCCCD);
+}
+
+// Parse a snapshot of records written by writer(): whole records of the
+// sequence format, each sequence number one more than the previous
+static bool check_sequence(const uint32_t *words, size_t n, uint32_t *first, uint32_t *last,
+                           size_t *records)
+{
+    size_t at = 0;
+    *records = 0;
+    while (at < n) {
+        if ((words[at] >> 24) != BINARY_TRACE_RECORD_MAGIC) {
+            return false;
+        }
+        uint32_t nargs = words[at] & 0xFF;
+        if (nargs < 2 || nargs > BINARY_TRACE_MAX_ARGS || at + HEADER_WORDS + nargs > n ||
+            words[at + 1] != fmt_word(s_fmt_seq)) {
+            return false;
+        }
+        const uint32_t *args = &words[at + HEADER_WORDS];
+        uint32_t seq = args[0];
+        if (nargs != 2 + seq % 13 || args[1] != ~seq) {
+            return false;
+        }
+        for (uint32_t i = 2; i < nargs; i++) {
+            if (args[i] != seq + i) {
+                return false;
+            }
+        }
+        if (*records == 0) {
+            *first = seq;
+        } else if (seq != *last + 1) {
+            return false;
+        }
+        *last = seq;
+        (*records)++;
+        at += HEADER_WORDS + nargs;
+    }
+    return true;
+}
+
+static void write_seq(uint32_t seq)
+{
+    uint32_t args[BINARY_TRACE_MAX_ARGS];
+    uint32_t nargs = 2 + seq % 13;
+    args[0] = seq;
+    args[1] = ~seq;
+    for (uint32_t i = 2; i < nargs; i++) {
+        args[i] = seq + i;
+    }
+    binary_trace_write(s_fmt_seq, nargs, args);
+}
+
+static void test_wrap_around(void)
+{
+    binary_trace_clear();
+    const uint32_t total = 1000;
+    for (uint32_t seq = 0; seq < total; seq++) {
+        write_seq(seq);
+    }
+    size_t n = snapshot(0);
+    uint32_t first = 0;
+    uint32_t last = 0;
+    size_t records = 0;
+    CHECK(check_sequence(s_words, n, &first, &last, &records));
+    CHECK_EQ_INT(last, total - 1);
+    CHECK_EQ_INT(records, last - first + 1);
+    CHECK_EQ_INT(binary_trace_overwritten(0), first);
+    // Only as much of the oldest record is dropped as the new one needs
+    CHECK(n <= RING_WORDS_MAX && n > RING_WORDS_MAX - (HEADER_WORDS + BINARY_TRACE_MAX_ARGS));
+
+    binary_trace_clear();
+    CHECK_EQ_INT(snapshot(0), 0);
+    CHECK_EQ_INT(binary_trace_overwritten(0), 0);
+}
+
+typedef struct {
+    pthread_t thread;
+    uint32_t core;
+} writer_t;
+
+static atomic_int s_writers_running;
+
+static void *writer(void *arg)
+{
+    writer_t *w = arg;
+    host_set_core_id((BaseType_t)w->core);
+    for (uint32_t seq = 0; seq < WRITES_PER_CORE; seq++) {
+        write_seq(seq);
+    }
+    atomic_fetch_sub(&s_writers_running, 1);
+    return NULL;
+}
+
+static void test_snapshot_while_writing(void)
+{
+    binary_trace_clear();
+    writer_t writers[portNUM_PROCESSORS];
+    atomic_store(&s_writers_running, portNUM_PROCESSORS);
+    for (uint32_t core = 0; core < portNUM_PROCESSORS; core++) {
+        writers[core].core = core;
+        CHECK(pthread_create(&writers[core].thread, NULL, writer, &writers[core]) == 0);
+    }
+
+    // Snapshot both rings until the writers finish; every copy must parse
+    long snapshots = 0;
+    long empty = 0;
+    long bad = 0;
+    uint32_t last_seen[portNUM_PROCESSORS] = { 0 };
+    while (atomic_load(&s_writers_running) > 0) {
+        for (uint32_t core = 0; core < portNUM_PROCESSORS; core++) {
+            size_t n = snapshot(core);
+            uint32_t first = 0;
+            uint32_t last = 0;
+            size_t records = 0;
+            snapshots++;
+            if (n == 0) {
+                empty++;
+            } else if (!check_sequence(s_words, n, &first, &last, &records)) {
+                bad++;
+            } else if (last < last_seen[core]) {
+                bad++;  // A later snapshot went back in time
+            } else {
+                last_seen[core] = last;
+            }
+        }
+    }
+    for (uint32_t core = 0; core < portNUM_PROCESSORS; core++) {
+        pthread_join(writers[core].thread, NULL);
+    }
+    printf("  %ld snapshots during %d writes per core, %ld empty\n", snapshots, WRITES_PER_CORE, empty);
+    CHECK_EQ_INT(bad, 0);
+    CHECK(snapshots > 0);
+    CHECK(empty < snapshots / 2 + 1);
+
+    // Once the writers are done each ring ends with its last record
+    for (uint32_t core = 0; core < portNUM_PROCESSORS; core++) {
+        size_t n = snapshot(core);
+        uint32_t first = 0;
+        uint32_t last = 0;
+        size_t records = 0;
+        CHECK(check_sequence(s_words, n, &first, &last, &records));
+        CHECK_EQ_INT(last, WRITES_PER_CORE - 1);
+        CHECK_EQ_INT(binary_trace_overwritten(core), first);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_record_framing);
+    RUN_TEST(test_argument_capture);
+    RUN_TEST(test_wrap_around);
+    RUN_TEST(test_snapshot_while_writing);
+    return HOST_TEST_RESULT();
+}
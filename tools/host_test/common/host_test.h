@@ -0,0 +1,58 @@
+/*
+ * Minimal check macros shared by the host tests
+ *
+ * CHECK* record a failure with file/line and keep going, so one run reports
+ * every broken expectation; main() returns HOST_TEST_RESULT().
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+static int s_host_test_failures;
+static int s_host_test_checks;
+
+#define CHECK(cond) \
+    do { \
+        s_host_test_checks++; \
+        if (!(cond)) { \
+            s_host_test_failures++; \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+#define CHECK_EQ_INT(actual, expected) \
+    do { \
+        long long check_a_ = (long long)(actual); \
+        long long check_e_ = (long long)(expected); \
+        s_host_test_checks++; \
+        if (check_a_ != check_e_) { \
+            s_host_test_failures++; \
+            fprintf(stderr, "%s:%d: %s == %lld, expected %s == %lld\n", \
+                    __FILE__, __LINE__, #actual, check_a_, #expected, check_e_); \
+        } \
+    } while (0)
+
+#define CHECK_MEM_EQ(actual, expected, len) \
+    do { \
+        s_host_test_checks++; \
+        if (memcmp((actual), (expected), (len)) != 0) { \
+            s_host_test_failures++; \
+            fprintf(stderr, "%s:%d: %s differs from %s\n", __FILE__, __LINE__, #actual, #expected); \
+        } \
+    } while (0)
+
+#define RUN_TEST(fn) \
+    do { \
+        int run_before_ = s_host_test_failures; \
+        fn(); \
+        printf("%-48s %s\n", #fn, s_host_test_failures == run_before_ ? "ok" : "FAILED"); \
+    } while (0)
+
+#define HOST_TEST_RESULT() \
+    (printf("%d checks, %d failed\n", s_host_test_checks, s_host_test_failures), \
+     s_host_test_failures == 0 ? 0 : 1)
+
+#endif // HOST_TEST_H
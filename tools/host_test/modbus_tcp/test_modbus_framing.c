@@ -0,0 +1,576 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test: Modbus TCP framing in modbus_tcp_process_buffer()
+ *
+ * Byte streams are placed in the connection's receive buffer the way recv()
+ * would leave them: ADUs split anywhere, several ADUs back to back, and
+ * malformed MBAP headers. Requests run against the real register map; the
+ * register cases check FC 0x17 ordering and exceptions, the 32-bit scale
+ * values in both word orders and the byte order of the assembly images
+ * byte for byte.
+ */
+
+#include <stdint.h>
+#include "host_test.h"
+#include "modbus_protocol.h"
+#include "modbus_register_map.h"
+
+#define MBAP_LENGTH_MAX 254   // Unit identifier + 253 byte PDU
+
+extern uint8_t g_assembly_data064[32];
+extern uint8_t g_assembly_data096[32];
+extern uint8_t g_assembly_data097[10];
+
+static modbus_tcp_conn_t s_conn;
+
+static void conn_reset(void)
+{
+    modbus_tcp_conn_init(&s_conn, -1);
+}
+
+static void feed(const uint8_t *bytes, size_t len)
+{
+    memcpy(&s_conn.rx_buf[s_conn.rx_len], bytes, len);
+    s_conn.rx_len += len;
+}
+
+static bool process(unsigned budget)
+{
+    return modbus_tcp_process_buffer(&s_conn, &budget);
+}
+
+static size_t put_header(uint8_t *adu, uint16_t tid, uint16_t length)
+{
+    adu[0] = tid >> 8;
+    adu[1] = tid & 0xFF;
+    adu[2] = 0;
+    adu[3] = 0;
+    adu[4] = length >> 8;
+    adu[5] = length & 0xFF;
+    adu[6] = 1;  // Unit identifier
+    return 7;
+}
+
+// FC 0x03 / 0x04 request, 12 bytes
+static size_t build_read(uint8_t *adu, uint16_t tid, uint8_t fc, uint16_t start, uint16_t quantity)
+{
+    size_t n = put_header(adu, tid, 6);
+    adu[n++] = fc;
+    adu[n++] = start >> 8;
+    adu[n++] = start & 0xFF;
+    adu[n++] = quantity >> 8;
+    adu[n++] = quantity & 0xFF;
+    return n;
+}
+
+// FC 0x06 request, 12 bytes
+static size_t build_write_single(uint8_t *adu, uint16_t tid, uint16_t address, uint16_t value)
+{
+    size_t n = put_header(adu, tid, 6);
+    adu[n++] = 0x06;
+    adu[n++] = address >> 8;
+    adu[n++] = address & 0xFF;
+    adu[n++] = value >> 8;
+    adu[n++] = value & 0xFF;
+    return n;
+}
+
+// FC 0x10 request
+static size_t build_write_multiple(uint8_t *adu, uint16_t tid, uint16_t start,
+                                   uint16_t quantity, const uint16_t *values)
+{
+    size_t n = put_header(adu, tid, 7 + 2 * quantity);
+    adu[n++] = 0x10;
+    adu[n++] = start >> 8;
+    adu[n++] = start & 0xFF;
+    adu[n++] = quantity >> 8;
+    adu[n++] = quantity & 0xFF;
+    adu[n++] = 2 * quantity;
+    for (uint16_t i = 0; i < quantity; i++) {
+        adu[n++] = values[i] >> 8;
+        adu[n++] = values[i] & 0xFF;
+    }
+    return n;
+}
+
+// FC 0x17 request
+static size_t build_read_write(uint8_t *adu, uint16_t tid, uint16_t read_start, uint16_t read_quantity,
+                               uint16_t write_start, uint16_t write_quantity, const uint16_t *values)
+{
+    size_t n = put_header(adu, tid, 11 + 2 * write_quantity);
+    adu[n++] = 0x17;
+    adu[n++] = read_start >> 8;
+    adu[n++] = read_start & 0xFF;
+    adu[n++] = read_quantity >> 8;
+    adu[n++] = read_quantity & 0xFF;
+    adu[n++] = write_start >> 8;
+    adu[n++] = write_start & 0xFF;
+    adu[n++] = write_quantity >> 8;
+    adu[n++] = write_quantity & 0xFF;
+    adu[n++] = 2 * write_quantity;
+    for (uint16_t i = 0; i < write_quantity; i++) {
+        adu[n++] = values[i] >> 8;
+        adu[n++] = values[i] & 0xFF;
+    }
+    return n;
+}
+
+// Run one request on an empty connection
+static void request(const uint8_t *adu, size_t len)
+{
+    conn_reset();
+    feed(adu, len);
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.rx_len, 0);
+}
+
+static void check_response(const uint8_t *expected, size_t len)
+{
+    CHECK_EQ_INT(s_conn.tx_len, len);
+    CHECK_MEM_EQ(s_conn.tx_buf, expected, len);
+}
+
+static uint16_t tx_u16(size_t offset)
+{
+    return (uint16_t)((s_conn.tx_buf[offset] << 8) | s_conn.tx_buf[offset + 1]);
+}
+
+static void test_split_mbap_header_byte_by_byte(void)
+{
+    uint8_t adu[16];
+    size_t len = build_write_single(adu, 0x1234, 100, 0xBEEF);
+    conn_reset();
+
+    for (size_t i = 0; i + 1 < len; i++) {
+        feed(&adu[i], 1);
+        CHECK(process(8));
+        CHECK_EQ_INT(s_conn.tx_len, 0);
+        CHECK_EQ_INT(s_conn.rx_len, i + 1);
+        CHECK(!modbus_tcp_conn_has_request(&s_conn));
+    }
+    feed(&adu[len - 1], 1);
+    CHECK(modbus_tcp_conn_has_request(&s_conn));
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.rx_len, 0);
+    CHECK_EQ_INT(s_conn.tx_len, 12);
+    CHECK_EQ_INT(tx_u16(0), 0x1234);
+    CHECK_MEM_EQ(&s_conn.tx_buf[7], &adu[7], 5);  // Echo of FC, address, value
+}
+
+static void test_split_after_header(void)
+{
+    uint8_t adu[16];
+    size_t len = build_read(adu, 7, 0x03, 100, 1);
+    conn_reset();
+
+    // Complete MBAP header, PDU still missing
+    feed(adu, 7);
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.tx_len, 0);
+    feed(&adu[7], len - 7);
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.tx_len, 11);
+    CHECK_EQ_INT(s_conn.tx_buf[7], 0x03);
+    CHECK_EQ_INT(tx_u16(9), 0xBEEF);  // Written by the previous test
+}
+
+static void test_several_adus_in_one_buffer(void)
+{
+    uint8_t stream[64];
+    size_t n = 0;
+    n += build_write_single(&stream[n], 1, 101, 0x0102);
+    n += build_read(&stream[n], 2, 0x03, 100, 2);
+    n += build_read(&stream[n], 3, 0x04, 0, 4);
+    uint8_t tail[16];
+    size_t tail_len = build_read(tail, 4, 0x03, 150, 5);
+    memcpy(&stream[n], tail, 5);  // First 5 bytes of a fourth ADU
+    n += 5;
+    conn_reset();
+
+    feed(stream, n);
+    CHECK(process(8));
+    // Three responses in request order: 12 + (9 + 4) + (9 + 8)
+    CHECK_EQ_INT(s_conn.tx_len, 12 + 13 + 17);
+    CHECK_EQ_INT(tx_u16(0), 1);
+    CHECK_EQ_INT(tx_u16(12), 2);
+    CHECK_EQ_INT(tx_u16(25), 3);
+    CHECK_EQ_INT(tx_u16(12 + 11), 0x0102);  // Register 101 as written by the first ADU
+    // The partial ADU is moved to the front and kept
+    CHECK_EQ_INT(s_conn.rx_len, 5);
+    CHECK_MEM_EQ(s_conn.rx_buf, tail, 5);
+
+    s_conn.tx_len = 0;
+    feed(&tail[5], tail_len - 5);
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.rx_len, 0);
+    CHECK_EQ_INT(s_conn.tx_len, 9 + 10);
+    CHECK_EQ_INT(tx_u16(0), 4);
+}
+
+static void test_budget_leaves_requests_buffered(void)
+{
+    uint8_t stream[64];
+    size_t n = 0;
+    for (uint16_t tid = 10; tid < 13; tid++) {
+        n += build_read(&stream[n], tid, 0x03, 100, 1);
+    }
+    conn_reset();
+    feed(stream, n);
+
+    unsigned budget = 2;
+    CHECK(modbus_tcp_process_buffer(&s_conn, &budget));
+    CHECK_EQ_INT(budget, 0);
+    CHECK_EQ_INT(s_conn.tx_len, 2 * 11);
+    CHECK_EQ_INT(s_conn.rx_len, 12);
+    CHECK(modbus_tcp_conn_has_request(&s_conn));
+
+    budget = 2;
+    CHECK(modbus_tcp_process_buffer(&s_conn, &budget));
+    CHECK_EQ_INT(budget, 1);
+    CHECK_EQ_INT(tx_u16(22), 12);
+}
+
+static void test_full_response_buffer_stops_early(void)
+{
+    // 16 input registers: 12 byte requests, 41 byte responses
+    const size_t response_len = 9 + 16 * 2;
+    const size_t request_count = MODBUS_TCP_RX_BUFFER_SIZE / 12;
+    uint8_t stream[MODBUS_TCP_RX_BUFFER_SIZE];
+    size_t n = 0;
+    for (uint16_t tid = 0; tid < request_count; tid++) {
+        n += build_read(&stream[n], tid, 0x04, 0, 16);
+    }
+    conn_reset();
+    feed(stream, n);
+
+    // Processing stops once a maximum size response might no longer fit
+    size_t answered = 0;
+    while (MODBUS_TCP_TX_BUFFER_SIZE - answered * response_len >= MODBUS_TCP_MAX_ADU_SIZE) {
+        answered++;
+    }
+    CHECK(answered < request_count);
+    CHECK(process(request_count));
+    CHECK_EQ_INT(s_conn.tx_len, answered * response_len);
+    CHECK_EQ_INT(s_conn.rx_len, (request_count - answered) * 12);
+    CHECK_EQ_INT(tx_u16((answered - 1) * response_len), answered - 1);
+}
+
+static void test_bad_length_closes_after_earlier_requests(void)
+{
+    static const uint16_t bad_lengths[] = { 0, 1, MBAP_LENGTH_MAX + 1, 0xFFFF };
+
+    for (size_t i = 0; i < sizeof(bad_lengths) / sizeof(bad_lengths[0]); i++) {
+        modbus_protocol_stats_t before, after;
+        modbus_protocol_get_stats(&before);
+
+        uint8_t stream[32];
+        size_t n = build_read(stream, 0x55, 0x03, 100, 1);
+        n += put_header(&stream[n], 0x56, bad_lengths[i]);
+        stream[n++] = 0x03;
+        conn_reset();
+        feed(stream, n);
+
+        CHECK(!process(8));
+        // The request in front of the bad header is still answered
+        CHECK_EQ_INT(s_conn.tx_len, 11);
+        CHECK_EQ_INT(tx_u16(0), 0x55);
+        modbus_protocol_get_stats(&after);
+        CHECK_EQ_INT(after.framing_errors - before.framing_errors, 1);
+    }
+
+    // A header is rejected as soon as its six MBAP bytes are in, without
+    // waiting for a PDU that will never be valid
+    uint8_t header[7];
+    put_header(header, 1, MBAP_LENGTH_MAX + 1);
+    conn_reset();
+    feed(header, 6);
+    CHECK(modbus_tcp_conn_has_request(&s_conn));
+    CHECK(!process(8));
+}
+
+static void test_bad_protocol_id(void)
+{
+    uint8_t adu[16];
+    size_t len = build_read(adu, 9, 0x03, 100, 1);
+    adu[3] = 1;
+    conn_reset();
+    feed(adu, len);
+    CHECK(!process(8));
+    CHECK_EQ_INT(s_conn.tx_len, 0);
+}
+
+// FC 0x10 with 123 registers and one trailing byte: MBAP length 254, the
+// largest ADU (260 bytes)
+static size_t build_max_length_write(uint8_t *adu, uint16_t tid)
+{
+    size_t n = put_header(adu, tid, MBAP_LENGTH_MAX);
+    adu[n++] = 0x10;
+    adu[n++] = 0;
+    adu[n++] = 100;
+    adu[n++] = 0;
+    adu[n++] = 123;
+    adu[n++] = 246;
+    for (int i = 0; i < 246; i++) {
+        adu[n++] = (uint8_t)i;
+    }
+    adu[n++] = 0xAA;  // Padding after the register data, allowed by the handler
+    return n;
+}
+
+static void test_max_length_adu(void)
+{
+    uint8_t adu[MODBUS_TCP_MAX_ADU_SIZE];
+    size_t len = build_max_length_write(adu, 0x0254);
+    CHECK_EQ_INT(len, MODBUS_TCP_MAX_ADU_SIZE);
+
+    // Whole ADU at once
+    conn_reset();
+    feed(adu, len);
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.rx_len, 0);
+    CHECK_EQ_INT(s_conn.tx_len, 9);
+    CHECK_EQ_INT(tx_u16(0), 0x0254);
+    // 123 registers starting at 100 do not fit the output range: exception,
+    // but framing is intact
+    CHECK_EQ_INT(s_conn.tx_buf[7], 0x90);
+
+    // One byte short stays buffered
+    conn_reset();
+    feed(adu, len - 1);
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.tx_len, 0);
+    CHECK_EQ_INT(s_conn.rx_len, len - 1);
+    feed(&adu[len - 1], 1);
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.tx_len, 9);
+
+    // Followed by a second ADU in the same buffer
+    conn_reset();
+    feed(adu, len);
+    uint8_t next[16];
+    size_t next_len = build_read(next, 0x0255, 0x03, 100, 1);
+    feed(next, next_len);
+    CHECK(process(8));
+    CHECK_EQ_INT(s_conn.rx_len, 0);
+    CHECK_EQ_INT(s_conn.tx_len, 9 + 11);
+    CHECK_EQ_INT(tx_u16(9), 0x0255);
+}
+
+static void test_read_write_writes_before_reading(void)
+{
+    uint8_t adu[64];
+    static const uint16_t before[] = { 0x0A0B, 0x0C0D, 0x0E0F, 0x1011 };
+    request(adu, build_write_multiple(adu, 1, 100, 4, before));
+
+    // Read 100-103 and write 102-103 in one transaction: the read sees the write
+    static const uint16_t values[] = { 0x1111, 0x2222 };
+    request(adu, build_read_write(adu, 0x0017, 100, 4, 102, 2, values));
+    static const uint8_t expected[] = {
+        0x00, 0x17, 0x00, 0x00, 0x00, 0x0B, 0x01, 0x17, 0x08,
+        0x0A, 0x0B, 0x0C, 0x0D, 0x11, 0x11, 0x22, 0x22,
+    };
+    check_response(expected, sizeof(expected));
+
+    // Write to the outputs, read from the config block
+    static const uint16_t config[] = { 0x0102, 0x0304, 0x0506, 0x0708, 0x090A };
+    request(adu, build_write_multiple(adu, 2, 150, 5, config));
+    static const uint16_t output = 0x7F80;
+    request(adu, build_read_write(adu, 0x0018, 150, 5, 115, 1, &output));
+    static const uint8_t expected_config[] = {
+        0x00, 0x18, 0x00, 0x00, 0x00, 0x0D, 0x01, 0x17, 0x0A,
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A,
+    };
+    check_response(expected_config, sizeof(expected_config));
+    CHECK_EQ_INT(g_assembly_data096[30], 0x80);
+    CHECK_EQ_INT(g_assembly_data096[31], 0x7F);
+}
+
+static void test_read_write_exceptions(void)
+{
+    static const struct {
+        uint16_t read_start, read_quantity, write_start, write_quantity;
+        uint8_t exception;
+    } cases[] = {
+        { 300, 2, 100, 1, 0x02 },  // Read range not mapped
+        { 114, 4, 100, 1, 0x02 },  // Read range runs past the outputs
+        { 250, 20, 100, 1, 0x02 }, // Read range runs past the scale block
+        { 100, 1, 116, 1, 0x02 },  // Write range not mapped
+        { 100, 1, 200, 1, 0x02 },  // Scale values are read-only
+        { 100, 0, 100, 1, 0x03 },  // Read quantity 0
+        { 100, 126, 100, 1, 0x03 },// Read quantity above 125
+        { 100, 1, 100, 0, 0x03 },  // Write quantity 0
+    };
+    static const uint16_t values[] = { 0xDEAD };
+    uint8_t outputs[sizeof(g_assembly_data096)];
+    uint8_t adu[64];
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        memcpy(outputs, g_assembly_data096, sizeof(outputs));
+        size_t len = build_read_write(adu, 0x0100 + i, cases[i].read_start, cases[i].read_quantity,
+                                      cases[i].write_start, cases[i].write_quantity, values);
+        if (cases[i].write_quantity == 0) {
+            len = build_read_write(adu, 0x0100 + i, cases[i].read_start, cases[i].read_quantity,
+                                   cases[i].write_start, 1, values);
+            adu[15] = 0;  // Write quantity 0 with a register of data
+        }
+        request(adu, len);
+        const uint8_t expected[] = {
+            0x01, (uint8_t)i, 0x00, 0x00, 0x00, 0x03, 0x01, 0x97, cases[i].exception,
+        };
+        check_response(expected, sizeof(expected));
+        // Nothing was written
+        CHECK_MEM_EQ(g_assembly_data096, outputs, sizeof(outputs));
+    }
+
+    // Byte count that does not match the write quantity, and a PDU shorter
+    // than its byte count
+    size_t len = build_read_write(adu, 0x0200, 100, 1, 100, 1, values);
+    adu[16] = 4;
+    request(adu, len);
+    static const uint8_t bad_count[] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x03, 0x01, 0x97, 0x03 };
+    check_response(bad_count, sizeof(bad_count));
+
+    static const uint16_t two[] = { 0x1234, 0x5678 };
+    len = build_read_write(adu, 0x0201, 100, 1, 100, 2, two);
+    adu[5] -= 2;  // MBAP length without the last register
+    request(adu, len - 2);
+    static const uint8_t short_pdu[] = { 0x02, 0x01, 0x00, 0x00, 0x00, 0x03, 0x01, 0x97, 0x03 };
+    check_response(short_pdu, sizeof(short_pdu));
+    CHECK_MEM_EQ(g_assembly_data096, outputs, sizeof(outputs));
+}
+
+static void test_scale_values_in_both_word_orders(void)
+{
+    const modbus_scale_values_t values = {
+        .weight_scaled = 0x01020304,
+        .weight = 1.5f,           // 0x3FC00000
+        .raw = -2,                // 0xFFFFFFFE, -2.0f = 0xC0000000
+        .filtered = 100000,       // 0x000186A0
+        .filtered_exact = 0.25f,  // 0x3E800000
+        .unit = 2,
+        .status = 0x0005,
+    };
+    static const uint8_t high_first[] = {
+        0x01, 0x02, 0x03, 0x04, 0x3F, 0xC0, 0x00, 0x00,
+        0xFF, 0xFF, 0xFF, 0xFE, 0xC0, 0x00, 0x00, 0x00,
+        0x00, 0x01, 0x86, 0xA0, 0x3E, 0x80, 0x00, 0x00,
+        0x00, 0x02, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00,
+    };
+    static const uint8_t low_first[] = {
+        0x03, 0x04, 0x01, 0x02, 0x00, 0x00, 0x3F, 0xC0,
+        0xFF, 0xFE, 0xFF, 0xFF, 0x00, 0x00, 0xC0, 0x00,
+        0x86, 0xA0, 0x00, 0x01, 0x00, 0x00, 0x3E, 0x80,
+        0x00, 0x02, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00,
+    };
+    static const struct {
+        uint8_t word_order;
+        const uint8_t *regs;
+    } orders[] = {
+        { MODBUS_WORD_ORDER_HIGH_FIRST, high_first },
+        { MODBUS_WORD_ORDER_LOW_FIRST, low_first },
+    };
+    uint8_t adu[64];
+    uint8_t expected[9 + 32];
+
+    for (size_t i = 0; i < sizeof(orders) / sizeof(orders[0]); i++) {
+        modbus_register_map_set_word_order(orders[i].word_order);
+        modbus_register_map_set_scale_values(1, &values);
+
+        // Channel 1 as input registers
+        request(adu, build_read(adu, 0x0300, 0x04, MODBUS_SCALE_REG_START + MODBUS_SCALE_REGS_PER_CHANNEL, 16));
+        static const uint8_t header[] = { 0x03, 0x00, 0x00, 0x00, 0x00, 0x23, 0x01, 0x04, 0x20 };
+        memcpy(expected, header, sizeof(header));
+        memcpy(&expected[9], orders[i].regs, 32);
+        check_response(expected, sizeof(expected));
+
+        // And through FC 0x17, reading the weight while writing an output
+        static const uint16_t output = 0x0001;
+        request(adu, build_read_write(adu, 0x0301, MODBUS_SCALE_REG_START + MODBUS_SCALE_REGS_PER_CHANNEL,
+                                      4, 100, 1, &output));
+        static const uint8_t rw_header[] = { 0x03, 0x01, 0x00, 0x00, 0x00, 0x0B, 0x01, 0x17, 0x08 };
+        memcpy(expected, rw_header, sizeof(rw_header));
+        memcpy(&expected[9], orders[i].regs, 8);
+        check_response(expected, 9 + 8);
+    }
+    modbus_register_map_set_word_order(MODBUS_WORD_ORDER_HIGH_FIRST);
+}
+
+// Assemblies hold each register little-endian; Modbus sends it big-endian
+static void test_assembly_image_byte_order(void)
+{
+    uint8_t adu[64];
+
+    // Assembly 100 as written by the scale task
+    static const uint8_t input[] = { 0x34, 0x12, 0xCD, 0xAB };
+    memcpy(g_assembly_data064, input, sizeof(input));
+    modbus_register_map_assembly_updated(MODBUS_ASSEMBLY_INPUT);
+    request(adu, build_read(adu, 0x0400, 0x04, 0, 2));
+    static const uint8_t expected_input[] = {
+        0x04, 0x00, 0x00, 0x00, 0x00, 0x07, 0x01, 0x04, 0x04, 0x12, 0x34, 0xAB, 0xCD,
+    };
+    check_response(expected_input, sizeof(expected_input));
+
+    // A Modbus write lands in the assembly little-endian and reads back as written
+    static const uint16_t values[] = { 0x1234, 0xABCD };
+    request(adu, build_write_multiple(adu, 0x0401, 150, 2, values));
+    static const uint8_t expected_write[] = {
+        0x04, 0x01, 0x00, 0x00, 0x00, 0x06, 0x01, 0x10, 0x00, 0x96, 0x00, 0x02,
+    };
+    check_response(expected_write, sizeof(expected_write));
+    static const uint8_t assembly[] = { 0x34, 0x12, 0xCD, 0xAB };
+    CHECK_MEM_EQ(g_assembly_data097, assembly, sizeof(assembly));
+
+    request(adu, build_read(adu, 0x0402, 0x03, 150, 2));
+    static const uint8_t expected_read[] = {
+        0x04, 0x02, 0x00, 0x00, 0x00, 0x07, 0x01, 0x03, 0x04, 0x12, 0x34, 0xAB, 0xCD,
+    };
+    check_response(expected_read, sizeof(expected_read));
+
+    // An EtherNet/IP write to Assembly 150 shows up once the owner reports it
+    g_assembly_data096[0] = 0x78;
+    g_assembly_data096[1] = 0x56;
+    modbus_register_map_assembly_updated(MODBUS_ASSEMBLY_OUTPUT);
+    request(adu, build_read(adu, 0x0403, 0x03, 100, 1));
+    static const uint8_t expected_output[] = {
+        0x04, 0x03, 0x00, 0x00, 0x00, 0x05, 0x01, 0x03, 0x02, 0x56, 0x78,
+    };
+    check_response(expected_output, sizeof(expected_output));
+}
+
+int main(void)
+{
+    RUN_TEST(test_split_mbap_header_byte_by_byte);
+    RUN_TEST(test_split_after_header);
+    RUN_TEST(test_several_adus_in_one_buffer);
+    RUN_TEST(test_budget_leaves_requests_buffered);
+    RUN_TEST(test_full_response_buffer_stops_early);
+    RUN_TEST(test_bad_length_closes_after_earlier_requests);
+    RUN_TEST(test_bad_protocol_id);
+    RUN_TEST(test_max_length_adu);
+    RUN_TEST(test_read_write_writes_before_reading);
+    RUN_TEST(test_read_write_exceptions);
+    RUN_TEST(test_scale_values_in_both_word_orders);
+    RUN_TEST(test_assembly_image_byte_order);
+    return HOST_TEST_RESULT();
+}
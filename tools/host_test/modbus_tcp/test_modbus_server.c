@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * Host test: Modbus TCP server task under load
+ *
+ * Runs the unmodified server task (FreeRTOS tasks are pthreads here) on a
+ * loopback port and drives it with real client sockets: 50 concurrent
+ * clients against 20 slots, a client that pipelines while others wait, a
+ * client that never reads its responses, LRU eviction, the idle timeout,
+ * and stopping with clients connected.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_test.h"
+#include "modbus_tcp.h"
+
+#define LOAD_CLIENTS          50
+#define LOAD_DURATION_MS      1500
+#define LOAD_TRANSACTIONS_PER_CONNECTION 10
+#define PIPELINED_REQUESTS    64
+#define RESPONSE_LEN          (9 + 2 * 2)  // Two input registers
+#define CLIENT_TIMEOUT_MS     3000
+#define STALLED_RCVBUF        4096  // Small receive window so the server's send fills up quickly
+#define STALLED_FLOOD_MS      500
+#define STALLED_MAX_LATENCY_MS 200  // Other clients while one is stalled; a blocking send took 2 s
+
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int client_connect_rcvbuf(int rcvbuf)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (rcvbuf > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    struct timeval timeout = { .tv_sec = CLIENT_TIMEOUT_MS / 1000, .tv_usec = 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int flag = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(MODBUS_TCP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int client_connect(void)
+{
+    return client_connect_rcvbuf(0);
+}
+
+// FC 0x04, input registers 0-1
+static size_t build_read(uint8_t *adu, uint16_t tid)
+{
+    static const uint8_t pdu[] = { 0x00, 0x00, 0x00, 0x06, 0x01, 0x04, 0x00, 0x00, 0x00, 0x02 };
+    adu[0] = tid >> 8;
+    adu[1] = tid & 0xFF;
+    memcpy(&adu[2], pdu, sizeof(pdu));
+    return 2 + sizeof(pdu);
+}
+
+static bool send_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t sent = send(fd, data, len, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        len -= sent;
+    }
+    return true;
+}
+
+static bool recv_all(int fd, uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t got = recv(fd, data, len, 0);
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        len -= got;
+    }
+    return true;
+}
+
+static bool response_ok(const uint8_t *response, uint16_t tid)
+{
+    return response[0] == (tid >> 8) && response[1] == (tid & 0xFF) &&
+           response[5] == RESPONSE_LEN - 6 && response[7] == 0x04 && response[8] == 4;
+}
+
+static bool transact(int fd, uint16_t tid)
+{
+    uint8_t request[12];
+    uint8_t response[RESPONSE_LEN];
+    return send_all(fd, request, build_read(request, tid)) &&
+           recv_all(fd, response, sizeof(response)) &&
+           response_ok(response, tid);
+}
+
+// True once the server has closed the connection
+static bool closed_by_server(int fd, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return false;
+    }
+    uint8_t byte;
+    ssize_t got = recv(fd, &byte, 1, 0);
+    return got == 0 || (got < 0 && errno == ECONNRESET);
+}
+
+static void close_all(int *fds, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+static void test_pipelining_client_does_not_starve_others(void)
+{
+    int fds[MODBUS_TCP_TEST_SLOTS];
+    for (int i = 0; i < MODBUS_TCP_TEST_SLOTS; i++) {
+        fds[i] = client_connect();
+        CHECK(fds[i] >= 0 && transact(fds[i], 1));
+    }
+
+    // Client 0 pipelines a burst; each other client then sends one request
+    // and must be answered without waiting for the whole burst
+    uint8_t burst[PIPELINED_REQUESTS * 12];
+    size_t n = 0;
+    for (uint16_t tid = 0; tid < PIPELINED_REQUESTS; tid++) {
+        n += build_read(&burst[n], 1000 + tid);
+    }
+    CHECK(send_all(fds[0], burst, n));
+    int64_t start = now_ms();
+    for (int i = 1; i < MODBUS_TCP_TEST_SLOTS; i++) {
+        CHECK(transact(fds[i], 2000 + i));
+    }
+    CHECK(now_ms() - start < 1000);
+
+    for (uint16_t tid = 0; tid < PIPELINED_REQUESTS; tid++) {
+        uint8_t response[RESPONSE_LEN];
+        CHECK(recv_all(fds[0], response, sizeof(response)));
+        CHECK(response_ok(response, 1000 + tid));
+    }
+    close_all(fds, MODBUS_TCP_TEST_SLOTS);
+}
+
+// A client pipelines requests and never reads the responses. The server has
+// to stop answering it without blocking, serve everyone else meanwhile, and
+// deliver every response in order once the client reads again.
+static void test_client_that_never_reads(void)
+{
+    modbus_tcp_stats_t before, after;
+    int stalled = client_connect_rcvbuf(STALLED_RCVBUF);
+    int other = client_connect();
+    CHECK(stalled >= 0 && other >= 0);
+    CHECK(transact(other, 1));
+    modbus_tcp_get_stats(&before);
+
+    // Send until neither the server nor the socket buffers take more
+    fcntl(stalled, F_SETFL, fcntl(stalled, F_GETFL) | O_NONBLOCK);
+    uint8_t chunk[64 * 12];
+    uint16_t tid = 0;
+    size_t pending = 0;  // Unsent bytes at the end of chunk
+    size_t sent_bytes = 0;
+    int64_t end = now_ms() + STALLED_FLOOD_MS;
+    while (now_ms() < end) {
+        if (pending == 0) {
+            for (int i = 0; i < 64; i++) {
+                build_read(&chunk[i * 12], tid++);
+            }
+            pending = sizeof(chunk);
+        }
+        ssize_t sent = send(stalled, &chunk[sizeof(chunk) - pending], pending, MSG_NOSIGNAL);
+        if (sent > 0) {
+            pending -= sent;
+            sent_bytes += sent;
+        } else if (sent < 0 && errno == EAGAIN) {
+            usleep(1000);
+        } else {
+            break;
+        }
+    }
+    long requests = sent_bytes / 12;
+    size_t partial = sent_bytes % 12;  // Completed below so framing stays intact
+    CHECK(requests > 0);
+
+    // Other clients are answered promptly while the stalled one is blocked
+    int64_t worst_ms = 0;
+    for (uint16_t i = 0; i < 20; i++) {
+        int64_t start = now_ms();
+        CHECK(transact(other, 100 + i));
+        if (now_ms() - start > worst_ms) {
+            worst_ms = now_ms() - start;
+        }
+    }
+    CHECK(worst_ms < STALLED_MAX_LATENCY_MS);
+    modbus_tcp_get_stats(&after);
+    CHECK_EQ_INT(after.connections_active, before.connections_active);
+
+    // Read everything back: no response lost, duplicated or reordered
+    fcntl(stalled, F_SETFL, fcntl(stalled, F_GETFL) & ~O_NONBLOCK);
+    if (partial > 0) {
+        CHECK(send_all(stalled, &chunk[sizeof(chunk) - pending], 12 - partial));
+        requests++;
+    }
+    long in_order = 0;
+    for (long i = 0; i < requests; i++) {
+        uint8_t response[RESPONSE_LEN];
+        if (!recv_all(stalled, response, sizeof(response))) {
+            break;
+        }
+        if (response_ok(response, (uint16_t)i)) {
+            in_order++;
+        }
+    }
+    CHECK_EQ_INT(in_order, requests);
+    printf("  %ld requests pipelined without reading, other client worst case %lld ms\n",
+           requests, (long long)worst_ms);
+    close(stalled);
+    close(other);
+}
+
+static void test_full_server_evicts_least_recently_active(void)
+{
+    modbus_tcp_stats_t before, after;
+    int fds[MODBUS_TCP_TEST_SLOTS];
+    for (int i = 0; i < MODBUS_TCP_TEST_SLOTS; i++) {
+        fds[i] = client_connect();
+        CHECK(fds[i] >= 0 && transact(fds[i], 1));
+    }
+    // Client 0 talks again, so client 1 becomes the least recently active
+    CHECK(transact(fds[0], 2));
+    modbus_tcp_get_stats(&before);
+    CHECK_EQ_INT(before.connections_active, MODBUS_TCP_TEST_SLOTS);
+
+    int extra = client_connect();
+    CHECK(extra >= 0 && transact(extra, 3));
+    CHECK(closed_by_server(fds[1], CLIENT_TIMEOUT_MS));
+    CHECK(transact(fds[0], 4));
+    modbus_tcp_get_stats(&after);
+    CHECK_EQ_INT(after.connections_evicted - before.connections_evicted, 1);
+    CHECK_EQ_INT(after.connections_active, MODBUS_TCP_TEST_SLOTS);
+
+    close_all(fds, MODBUS_TCP_TEST_SLOTS);
+    close_all(&extra, 1);
+}
+
+typedef struct {
+    pthread_t thread;
+    uint16_t id;
+    unsigned connections;
+    unsigned transactions;
+    unsigned bad_responses;
+    unsigned lost_connections;  // Closed by the server (evicted) mid-sequence
+} load_client_t;
+
+static void *load_client(void *arg)
+{
+    load_client_t *client = arg;
+    int64_t end = now_ms() + LOAD_DURATION_MS;
+    uint16_t tid = (uint16_t)(client->id << 8);
+
+    while (now_ms() < end) {
+        int fd = client_connect();
+        if (fd < 0) {
+            continue;
+        }
+        client->connections++;
+        for (int i = 0; i < LOAD_TRANSACTIONS_PER_CONNECTION; i++) {
+            uint8_t request[12];
+            uint8_t response[RESPONSE_LEN];
+            tid++;
+            if (!send_all(fd, request, build_read(request, tid)) ||
+                !recv_all(fd, response, sizeof(response))) {
+                client->lost_connections++;
+                break;
+            }
+            if (response_ok(response, tid)) {
+                client->transactions++;
+            } else {
+                client->bad_responses++;
+            }
+        }
+        close(fd);
+    }
+    return NULL;
+}
+
+static void test_fifty_clients_share_twenty_slots(void)
+{
+    static load_client_t clients[LOAD_CLIENTS];
+    modbus_tcp_stats_t before, after;
+    modbus_tcp_get_stats(&before);
+
+    for (int i = 0; i < LOAD_CLIENTS; i++) {
+        clients[i] = (load_client_t){ .id = (uint16_t)i };
+        CHECK(pthread_create(&clients[i].thread, NULL, load_client, &clients[i]) == 0);
+    }
+    unsigned transactions = 0;
+    unsigned starved = 0;
+    unsigned bad = 0;
+    unsigned lost = 0;
+    for (int i = 0; i < LOAD_CLIENTS; i++) {
+        pthread_join(clients[i].thread, NULL);
+        transactions += clients[i].transactions;
+        bad += clients[i].bad_responses;
+        lost += clients[i].lost_connections;
+        if (clients[i].transactions == 0) {
+            starved++;
+        }
+    }
+    modbus_tcp_get_stats(&after);
+
+    CHECK_EQ_INT(starved, 0);
+    CHECK_EQ_INT(bad, 0);
+    CHECK_EQ_INT(after.framing_errors, before.framing_errors);
+    CHECK(after.requests - before.requests >= transactions);
+    CHECK(after.connections_evicted - before.connections_evicted >= lost);
+    printf("  %d clients, %u transactions in %d ms, %u connections evicted\n",
+           LOAD_CLIENTS, transactions, LOAD_DURATION_MS,
+           (unsigned)(after.connections_evicted - before.connections_evicted));
+}
+
+static void test_idle_client_is_closed(void)
+{
+    modbus_tcp_stats_t before, after;
+    modbus_tcp_get_stats(&before);
+    int fd = client_connect();
+    CHECK(fd >= 0 && transact(fd, 1));
+
+    int64_t start = now_ms();
+    CHECK(closed_by_server(fd, (MODBUS_TCP_TEST_IDLE_TIMEOUT_S + 2) * 1000));
+    CHECK(now_ms() - start >= MODBUS_TCP_TEST_IDLE_TIMEOUT_S * 1000 - 100);
+    // The counter is updated just after the socket is closed
+    int64_t deadline = now_ms() + 100;
+    do {
+        modbus_tcp_get_stats(&after);
+    } while (after.connections_timed_out == before.connections_timed_out && now_ms() < deadline);
+    CHECK_EQ_INT(after.connections_timed_out - before.connections_timed_out, 1);
+    close(fd);
+}
+
+static void test_stop_with_clients_connected(void)
+{
+    int fds[4];
+    for (int i = 0; i < 4; i++) {
+        fds[i] = client_connect();
+        CHECK(fds[i] >= 0 && transact(fds[i], 1));
+    }
+    modbus_tcp_stop();
+
+    // The task sees the stop within one select() wait and closes every client
+    int64_t deadline = now_ms() + 3000;
+    while (host_task_running_count() > 0 && now_ms() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    CHECK_EQ_INT(host_task_running_count(), 0);
+    for (int i = 0; i < 4; i++) {
+        CHECK(closed_by_server(fds[i], 100));
+    }
+    close_all(fds, 4);
+
+    // And the server can be brought up again
+    CHECK(modbus_tcp_init());
+    CHECK(modbus_tcp_start());
+    int fd = client_connect();
+    CHECK(fd >= 0 && transact(fd, 2));
+    close(fd);
+    modbus_tcp_stop();
+    deadline = now_ms() + 3000;
+    while (host_task_running_count() > 0 && now_ms() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    CHECK_EQ_INT(host_task_running_count(), 0);
+}
+
+int main(void)
+{
+    // lwIP has no SIGPIPE; a send to a client that already closed must not kill the test
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!modbus_tcp_init() || !modbus_tcp_start()) {
+        fprintf(stderr, "Cannot start the server on port %d\n", MODBUS_TCP_PORT);
+        return 1;
+    }
+    RUN_TEST(test_pipelining_client_does_not_starve_others);
+    RUN_TEST(test_client_that_never_reads);
+    RUN_TEST(test_full_server_evicts_least_recently_active);
+    RUN_TEST(test_fifty_clients_share_twenty_slots);
+    RUN_TEST(test_idle_client_is_closed);
+    RUN_TEST(test_stop_with_clients_connected);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test: streaming multipart/form-data parser of the OTA upload
+ *
+ * Each case is a complete request body with the result and the exact file
+ * bytes the parser must produce. Every body is fed whole, split in two at
+ * every offset, in 1-byte pieces and in pieces of a few other sizes; the
+ * emitted bytes and the result must be the same for every split. Covered:
+ * delimiters split across pieces, file bytes that match a prefix of the
+ * delimiter, preamble and non-file parts before the file part, transport
+ * padding, a close delimiter with no file part, part headers over the limit,
+ * and a callback that fails.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "multipart_stream.h"
+
+#define OUT_MAX 16384
+
+typedef struct {
+    uint8_t data[OUT_MAX];
+    size_t len;
+    size_t calls;
+    size_t fail_after;    // Fail the callback once this many bytes were taken (0: never)
+    bool empty_call;      // The callback was called with len 0
+} sink_t;
+
+typedef struct {
+    const char *name;
+    const char *boundary;
+    const uint8_t *body;
+    size_t body_len;
+    multipart_result_t result;
+    const char *error;    // Expected reason for MULTIPART_ERROR
+    const uint8_t *file;  // Expected emitted bytes
+    size_t file_len;
+    size_t fail_after;
+} case_t;
+
+static bool collect(void *ctx, const uint8_t *data, size_t len)
+{
+    sink_t *sink = ctx;
+    sink->calls++;
+    if (len == 0) {
+        sink->empty_call = true;
+    }
+    if (sink->fail_after > 0 && sink->len + len > sink->fail_after) {
+        return false;
+    }
+    if (sink->len + len > OUT_MAX) {
+        return false;
+    }
+    memcpy(&sink->data[sink->len], data, len);
+    sink->len += len;
+    return true;
+}
+
+// Feed the body in the given piece sizes (the last size repeats) and check
+// the outcome against the case. Returns false on a mismatch.
+static bool run_split(const case_t *c, const size_t *pieces, size_t piece_count)
+{
+    static multipart_stream_t parser;
+    static sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.fail_after = c->fail_after;
+    if (!multipart_stream_init(&parser, c->boundary, collect, &sink)) {
+        return false;
+    }
+
+    multipart_result_t result = MULTIPART_NEED_MORE;
+    size_t at = 0;
+    for (size_t i = 0; at < c->body_len; i++) {
+        size_t n = pieces[i < piece_count ? i : piece_count - 1];
+        if (n > c->body_len - at) {
+            n = c->body_len - at;
+        }
+        multipart_result_t r = multipart_stream_feed(&parser, c->body + at, n);
+        // Once done or failed, the parser keeps its result
+        if (result != MULTIPART_NEED_MORE && r != result) {
+            return false;
+        }
+        result = r;
+        at += n;
+    }
+    if (result != c->result || sink.empty_call) {
+        return false;
+    }
+    if (c->result == MULTIPART_ERROR && strcmp(parser.error, c->error) != 0) {
+        return false;
+    }
+    if (c->result == MULTIPART_FILE_DONE && multipart_stream_feed(&parser, c->body, 1) != MULTIPART_FILE_DONE) {
+        return false;
+    }
+    return sink.len == c->file_len && memcmp(sink.data, c->file, c->file_len) == 0;
+}
+
+static void check_case(const case_t *c)
+{
+    size_t failures = 0;
+    size_t runs = 0;
+
+    size_t whole = c->body_len;
+    failures += !run_split(c, &whole, 1);
+    runs++;
+
+    // Two pieces, split at every offset
+    for (size_t split = 1; split < c->body_len; split++) {
+        size_t pieces[] = { split, c->body_len - split };
+        failures += !run_split(c, pieces, 2);
+        runs++;
+    }
+
+    // Equal pieces of 1 byte and of sizes around the delimiter length
+    static const size_t sizes[] = { 1, 2, 3, 5, 7, 11, 13, 64, 1000 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        failures += !run_split(c, &sizes[i], 1);
+        runs++;
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "  %s: %lu of %lu splits wrong\n", c->name, (unsigned long)failures, (unsigned long)runs);
+    }
+    CHECK_EQ_INT(failures, 0);
+}
+
+#define TEXT(s) (const uint8_t *)(s), sizeof(s) - 1
+
+#define FILE_HEADERS(boundary)                                                      \
+    "--" boundary "\r\n"                                                            \
+    "Content-Disposition: form-data; name=\"firmware\"; filename=\"fw.bin\"\r\n"    \
+    "Content-Type: application/octet-stream\r\n"                                    \
+    "\r\n"
+
+// File bytes that look like the start of a delimiter without being one:
+// CRLF, dashes, boundary prefixes, a wrong last byte, and a NUL
+#define TRICKY_FILE                                                                 \
+    "\x7f" "ELF\0\r\n-\r\n--\r\n--X\r\n--XyZ12\r\n--XyZ12x\n--XyZ123"              \
+    "--XyZ123\r--XyZ123 \r\n\r\n--\r\n--XyZ1"
+
+static void test_file_part(void)
+{
+    static const char body[] =
+        FILE_HEADERS("XyZ123")
+        TRICKY_FILE
+        "\r\n--XyZ123--\r\n";
+    static const char file[] = TRICKY_FILE;
+    case_t c = {
+        .name = "file part only",
+        .boundary = "XyZ123",
+        TEXT(body),
+        .result = MULTIPART_FILE_DONE,
+        .file = (const uint8_t *)file,
+        .file_len = sizeof(file) - 1,
+    };
+    check_case(&c);
+}
+
+static void test_fields_before_file(void)
+{
+    static const char body[] =
+        "This is the preamble; --XyZ123 inside a line is not a delimiter\r\n"
+        "--XyZ123 \t\r\n"
+        "Content-Disposition: form-data; name=\"reboot\"\r\n"
+        "\r\n"
+        "true\r\n"
+        "--XyZ123\r\n"
+        "Content-Disposition: form-data; name=\"comment\"\r\n"
+        "\r\n"
+        "filename=\"not-this-one.bin\"\r\n"
+        "--XyZ123\r\n"
+        "Content-Disposition: form-data; name=\"firmware\"; FILENAME=\"fw.bin\"\r\n"
+        "\r\n"
+        "0123456789\r\n--XyZ12\r\n"
+        "\r\n--XyZ123\r\n"
+        "Content-Disposition: form-data; name=\"after\"\r\n"
+        "\r\n"
+        "ignored\r\n"
+        "--XyZ123--\r\n";
+    static const char file[] = "0123456789\r\n--XyZ12\r\n";
+    case_t c = {
+        .name = "fields before the file",
+        .boundary = "XyZ123",
+        TEXT(body),
+        .result = MULTIPART_FILE_DONE,
+        .file = (const uint8_t *)file,
+        .file_len = sizeof(file) - 1,
+    };
+    check_case(&c);
+}
+
+static void test_empty_file_and_long_boundary(void)
+{
+    // 70 characters, the RFC 2046 maximum
+#define LONG_BOUNDARY "----WebKitFormBoundary0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKL"
+    _Static_assert(sizeof(LONG_BOUNDARY) - 1 == MULTIPART_BOUNDARY_MAX, "boundary length");
+    static const char body[] =
+        FILE_HEADERS(LONG_BOUNDARY)
+        "\r\n--" LONG_BOUNDARY "--\r\n";
+    case_t c = {
+        .name = "empty file",
+        .boundary = LONG_BOUNDARY,
+        TEXT(body),
+        .result = MULTIPART_FILE_DONE,
+        .file = (const uint8_t *)"",
+        .file_len = 0,
+    };
+    check_case(&c);
+
+    static const char file_body[] =
+        FILE_HEADERS(LONG_BOUNDARY)
+        "\r\n--" LONG_BOUNDARY "\r\n--" LONG_BOUNDARY "--\r\n";
+    case_t d = {
+        .name = "long boundary",
+        .boundary = LONG_BOUNDARY,
+        TEXT(file_body),
+        .result = MULTIPART_FILE_DONE,
+        .file = (const uint8_t *)"",
+        .file_len = 0,
+    };
+    check_case(&d);
+}
+
+static void test_no_file_part(void)
+{
+    static const char body[] =
+        "--XyZ123\r\n"
+        "Content-Disposition: form-data; name=\"reboot\"\r\n"
+        "\r\n"
+        "true\r\n"
+        "--XyZ123--\r\n";
+    case_t c = {
+        .name = "close delimiter without a file",
+        .boundary = "XyZ123",
+        TEXT(body),
+        .result = MULTIPART_ERROR,
+        .error = "no file in the form data",
+        .file = (const uint8_t *)"",
+        .file_len = 0,
+    };
+    check_case(&c);
+
+    // The body ends inside the file part: no error yet, but not done either
+    static const char truncated[] = FILE_HEADERS("XyZ123") "0123456789\r\n--XyZ12";
+    case_t d = {
+        .name = "unterminated file",
+        .boundary = "XyZ123",
+        TEXT(truncated),
+        .result = MULTIPART_NEED_MORE,
+        .file = (const uint8_t *)"0123456789",
+        .file_len = 10,
+    };
+    check_case(&d);
+
+    static const char garbage[] = "--XyZ123x\r\n\r\ndata\r\n--XyZ123--";
+    case_t e = {
+        .name = "malformed delimiter",
+        .boundary = "XyZ123",
+        TEXT(garbage),
+        .result = MULTIPART_ERROR,
+        .error = "malformed delimiter",
+        .file = (const uint8_t *)"",
+        .file_len = 0,
+    };
+    check_case(&e);
+}
+
+// A file part whose header block (from the line after the delimiter to the
+// empty line, inclusive) is header_block bytes long
+static size_t padded_header_body(uint8_t *body, size_t header_block)
+{
+    static const char delimiter[] = "--XyZ123\r\n";
+    static const char start[] = "Content-Disposition: form-data; name=\"firmware\"; filename=\"fw.bin\"\r\nX-Pad: ";
+    static const char end[] = "\r\n\r\nfile\r\n--XyZ123--\r\n";
+    size_t len = 0;
+    memcpy(&body[len], delimiter, sizeof(delimiter) - 1);
+    len += sizeof(delimiter) - 1;
+    memcpy(&body[len], start, sizeof(start) - 1);
+    len += sizeof(start) - 1;
+    memset(&body[len], 'a', header_block - (sizeof(start) - 1) - 4);
+    len += header_block - (sizeof(start) - 1) - 4;
+    memcpy(&body[len], end, sizeof(end) - 1);
+    len += sizeof(end) - 1;
+    return len;
+}
+
+static void test_headers_over_limit(void)
+{
+    static uint8_t body[MULTIPART_HEADER_LIMIT + 256];
+    case_t c = {
+        .name = "part headers one byte over the limit",
+        .boundary = "XyZ123",
+        .body = body,
+        .body_len = padded_header_body(body, MULTIPART_HEADER_LIMIT + 1),
+        .result = MULTIPART_ERROR,
+        .error = "part headers too long",
+        .file = (const uint8_t *)"",
+        .file_len = 0,
+    };
+    check_case(&c);
+
+    // At the limit the part is accepted; the file name is within the first
+    // MULTIPART_HEADER_MAX bytes, which are the ones kept
+    case_t d = {
+        .name = "part headers at the limit",
+        .boundary = "XyZ123",
+        .body = body,
+        .body_len = padded_header_body(body, MULTIPART_HEADER_LIMIT),
+        .result = MULTIPART_FILE_DONE,
+        .file = (const uint8_t *)"file",
+        .file_len = 4,
+    };
+    check_case(&d);
+}
+
+static void test_callback_failure(void)
+{
+    static const char body[] = FILE_HEADERS("XyZ123") "0123456789abcdef\r\n--XyZ123--\r\n";
+    case_t c = {
+        .name = "callback failure",
+        .boundary = "XyZ123",
+        TEXT(body),
+        .result = MULTIPART_ERROR,
+        .error = "write failed",
+        .fail_after = 8,
+    };
+    // What reached the sink before the failure depends on the split; only the
+    // result is the same for every split
+    static multipart_stream_t parser;
+    static sink_t sink;
+    static const size_t sizes[] = { 1, 3, 9, 100 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        memset(&sink, 0, sizeof(sink));
+        sink.fail_after = c.fail_after;
+        CHECK(multipart_stream_init(&parser, c.boundary, collect, &sink));
+        multipart_result_t result = MULTIPART_NEED_MORE;
+        for (size_t at = 0; at < c.body_len; at += sizes[i]) {
+            size_t n = sizes[i] < c.body_len - at ? sizes[i] : c.body_len - at;
+            result = multipart_stream_feed(&parser, c.body + at, n);
+        }
+        CHECK_EQ_INT(result, MULTIPART_ERROR);
+        CHECK(strcmp(parser.error, c.error) == 0);
+        CHECK(sink.len <= c.fail_after);
+        CHECK_MEM_EQ(sink.data, "01234567", sink.len);
+    }
+}
+
+// A 12 KB file of pseudo-random bytes laced with delimiter prefixes
+static void test_large_file(void)
+{
+    static uint8_t file[12000];
+    uint32_t x = 12345;
+    static const char prefix[] = "\r\n--XyZ123";
+    for (size_t i = 0; i < sizeof(file); i++) {
+        x = x * 1103515245u + 12345u;
+        file[i] = (uint8_t)(x >> 16);
+        if ((x >> 8) % 97 == 0 && i + sizeof(prefix) < sizeof(file)) {
+            // Every prefix length up to one byte short of the delimiter, and
+            // a byte after it that does not continue the delimiter
+            size_t n = 1 + (x >> 4) % (sizeof(prefix) - 2);
+            memcpy(&file[i], prefix, n);
+            file[i + n] = '!';
+            i += n;
+        }
+    }
+    static uint8_t body[sizeof(file) + 256];
+    static const char start[] = FILE_HEADERS("XyZ123");
+    static const char end[] = "\r\n--XyZ123--\r\n";
+    size_t len = 0;
+    memcpy(&body[len], start, sizeof(start) - 1);
+    len += sizeof(start) - 1;
+    memcpy(&body[len], file, sizeof(file));
+    len += sizeof(file);
+    memcpy(&body[len], end, sizeof(end) - 1);
+    len += sizeof(end) - 1;
+
+    case_t c = {
+        .name = "large file",
+        .boundary = "XyZ123",
+        .body = body,
+        .body_len = len,
+        .result = MULTIPART_FILE_DONE,
+        .file = file,
+        .file_len = sizeof(file),
+    };
+    check_case(&c);
+}
+
+static void test_get_boundary(void)
+{
+    char boundary[MULTIPART_BOUNDARY_MAX + 1];
+    CHECK(multipart_stream_get_boundary("multipart/form-data; boundary=XyZ123", boundary, sizeof(boundary)));
+    CHECK(strcmp(boundary, "XyZ123") == 0);
+    CHECK(multipart_stream_get_boundary("multipart/form-data; charset=utf-8; BOUNDARY=\"a b;c\"", boundary, sizeof(boundary)));
+    CHECK(strcmp(boundary, "a b;c") == 0);
+    CHECK(multipart_stream_get_boundary("multipart/form-data;boundary=abc;charset=utf-8", boundary, sizeof(boundary)));
+    CHECK(strcmp(boundary, "abc") == 0);
+    CHECK(multipart_stream_get_boundary("multipart/form-data; boundary=" LONG_BOUNDARY, boundary, sizeof(boundary)));
+    CHECK(!multipart_stream_get_boundary("multipart/form-data; boundary=" LONG_BOUNDARY "M", boundary, sizeof(boundary)));
+    CHECK(!multipart_stream_get_boundary("multipart/form-data; xboundary=abc", boundary, sizeof(boundary)));
+    CHECK(!multipart_stream_get_boundary("multipart/form-data; boundary=", boundary, sizeof(boundary)));
+    CHECK(!multipart_stream_get_boundary("multipart/form-data; boundary=abcdef", boundary, 4));
+
+    multipart_stream_t parser;
+    CHECK(!multipart_stream_init(&parser, "", collect, NULL));
+    CHECK(!multipart_stream_init(&parser, LONG_BOUNDARY "M", collect, NULL));
+}
+
+int main(void)
+{
+    RUN_TEST(test_file_part);
+    RUN_TEST(test_fields_before_file);
+    RUN_TEST(test_empty_file_and_long_boundary);
+    RUN_TEST(test_no_file_part);
+    RUN_TEST(test_headers_over_limit);
+    RUN_TEST(test_callback_failure);
+    RUN_TEST(test_large_file);
+    RUN_TEST(test_get_boundary);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test: scale channel capture and publish against the register model
+ *
+ * The scale task's loop (capture when a conversion may be ready, publish every
+ * 100 ms) runs on the virtual clock over the unmodified driver, stability
+ * filter and history ring. The checks cover the 10-byte record of Assemblies
+ * 100 and 102 byte for byte, the stable, motion and center-of-zero bits, and
+ * the history ring contents including wrap-around. The last case runs capture
+ * and publish flat out and reports captures per second of host time:
+ *
+ *   test_nau7802_scale [captures]
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "host_test.h"
+#include "nau7802_scale.h"
+#include "nau7802_sim.h"
+
+#define VIRTUAL_START_US 1000000
+#define ZERO_COUNTS 100000
+#define COUNTS_PER_GRAM 50.0f
+#define PUBLISH_INTERVAL_US 100000
+#define AVERAGE_SAMPLES 8
+#define HISTORY_CAPACITY 1024
+
+static nau7802_sim_t s_sim;
+static nau7802_scale_t s_ch;
+static long s_bench_captures = 200000;
+
+// Results of the last run
+static uint8_t s_record[NAU7802_SCALE_RECORD_SIZE];
+static nau7802_scale_values_t s_values;
+static long s_captured;
+static nau7802_history_sample_t s_last_capture;
+
+static uint32_t period_us(nau7802_sps_t rate)
+{
+    return rate == NAU7802_SPS_320 ? 3125 : 12500;
+}
+
+static void bring_up(nau7802_sps_t rate)
+{
+    nau7802_sim_signal_t signal = {
+        .zero_counts = ZERO_COUNTS,
+        .counts_per_gram = COUNTS_PER_GRAM,
+        .seed = 3,
+    };
+    host_clock_set_virtual(true, VIRTUAL_START_US);
+    CHECK_EQ_INT(nau7802_sim_init(&s_sim, &signal), ESP_OK);
+    CHECK_EQ_INT(nau7802_init_device(&s_ch.device, nau7802_sim_get_handle(&s_sim), NAU7802_I2C_ADDRESS), ESP_OK);
+    nau7802_config_t config = {
+        .ldo = 0x04,
+        .gain = NAU7802_GAIN_128,
+        .sample_rate = rate,
+        .channel = NAU7802_CHANNEL_1,
+    };
+    CHECK_EQ_INT(nau7802_begin_config(&s_ch.device, &config), ESP_OK);
+    s_ch.device.zero_offset = ZERO_COUNTS;
+    s_ch.device.calibration_factor = COUNTS_PER_GRAM;
+    if (s_ch.mutex == NULL) {
+        s_ch.mutex = xSemaphoreCreateMutex();
+    }
+    s_ch.initialized = true;
+
+    nau7802_stability_config_t stability = {
+        .window = 5,
+        .stable_band_g = 0.5f,
+        .motion_band_g = 2.0f,
+        .azt_enabled = false,
+        .azt_band_g = 1.0f,
+    };
+    nau7802_scale_init(&s_ch, 0, &stability);
+}
+
+// The scale task's loop: a tick every quarter period, capture when due,
+// publish every 100 ms. ramp_g is added to the load before each publish.
+static void run(nau7802_sps_t rate, int64_t duration_us, uint8_t unit, float ramp_g)
+{
+    uint32_t period = period_us(rate);
+    int64_t next_publish = esp_timer_get_time() + PUBLISH_INTERVAL_US;
+    int64_t end = esp_timer_get_time() + duration_us;
+    s_captured = 0;
+    while (esp_timer_get_time() < end) {
+        host_clock_advance_us(period / 4);
+        int64_t now = esp_timer_get_time();
+        if (now >= s_ch.next_poll_us &&
+            nau7802_scale_capture(&s_ch, period, AVERAGE_SAMPLES, &s_last_capture)) {
+            s_captured++;
+        }
+        if (now >= next_publish) {
+            next_publish += PUBLISH_INTERVAL_US;
+            nau7802_scale_publish(&s_ch, unit, s_record, &s_values);
+            if (ramp_g != 0.0f) {
+                nau7802_sim_set_load(&s_sim, s_sim.signal.load_g + ramp_g);
+            }
+        }
+    }
+}
+
+static void test_record_layout(void)
+{
+    bring_up(NAU7802_SPS_80);
+
+    // No load, grams: stable at the center of zero
+    run(NAU7802_SPS_80, 1000000, 0, 0.0f);
+    static const uint8_t zero[] = { 0x00, 0x00, 0x00, 0x00, 0xA0, 0x86, 0x01, 0x00, 0x00, 0x2F };
+    CHECK_MEM_EQ(s_record, zero, sizeof(zero));
+
+    // 1 kg in kg: weight 1.00 -> 100, raw 150000 (0x000249F0)
+    nau7802_sim_set_load(&s_sim, 1000.0f);
+    run(NAU7802_SPS_80, 1000000, 2, 0.0f);
+    static const uint8_t kg[] = { 0x64, 0x00, 0x00, 0x00, 0xF0, 0x49, 0x02, 0x00, 0x02, 0x0F };
+    CHECK_MEM_EQ(s_record, kg, sizeof(kg));
+    CHECK_EQ_INT(s_values.weight_scaled, 100);
+    CHECK(s_values.weight == 1.0f);
+    CHECK_EQ_INT(s_values.raw, 150000);
+    CHECK_EQ_INT(s_values.filtered, 150000);
+    CHECK(s_values.filtered_exact == 150000.0f);
+    CHECK_EQ_INT(s_values.unit, 2);
+    CHECK_EQ_INT(s_values.status, 0x0F);
+
+    // Same load in lbs: 2.2046 lb -> 220
+    run(NAU7802_SPS_80, PUBLISH_INTERVAL_US, 1, 0.0f);
+    static const uint8_t lbs[] = { 0xDC, 0x00, 0x00, 0x00, 0xF0, 0x49, 0x02, 0x00, 0x01, 0x0F };
+    CHECK_MEM_EQ(s_record, lbs, sizeof(lbs));
+
+    // A publish without a new conversion clears only the available bit
+    nau7802_scale_publish(&s_ch, 2, s_record, &s_values);
+    static const uint8_t stale[] = { 0x64, 0x00, 0x00, 0x00, 0xF0, 0x49, 0x02, 0x00, 0x02, 0x0E };
+    CHECK_MEM_EQ(s_record, stale, sizeof(stale));
+
+    // Negative weight after a tare with load on: -1 kg, little-endian two's complement
+    s_ch.device.zero_offset = ZERO_COUNTS + 2 * 1000 * COUNTS_PER_GRAM;
+    run(NAU7802_SPS_80, PUBLISH_INTERVAL_US, 0, 0.0f);
+    int32_t weight;
+    memcpy(&weight, &s_record[0], sizeof(weight));
+    CHECK_EQ_INT(weight, -100000 + 1);  // -1000.00 g, rounded towards +0.5
+    CHECK_EQ_INT(s_record[8], 0);
+}
+
+static void test_stable_and_motion_bits(void)
+{
+    bring_up(NAU7802_SPS_80);
+    run(NAU7802_SPS_80, 1000000, 0, 0.0f);
+    CHECK(s_record[9] & NAU7802_SCALE_STATUS_STABLE);
+    CHECK(!(s_record[9] & NAU7802_SCALE_STATUS_MOTION));
+
+    // 20 g per publish (200 g/s): in motion once the window has seen it
+    run(NAU7802_SPS_80, 1000000, 0, 20.0f);
+    CHECK(s_record[9] & NAU7802_SCALE_STATUS_MOTION);
+    CHECK(!(s_record[9] & NAU7802_SCALE_STATUS_STABLE));
+    CHECK(!(s_record[9] & NAU7802_SCALE_STATUS_CENTER_OF_ZERO));
+
+    // Load held: stable again within a window of publishes, off zero
+    run(NAU7802_SPS_80, 1000000, 0, 0.0f);
+    CHECK(s_record[9] & NAU7802_SCALE_STATUS_STABLE);
+    CHECK(!(s_record[9] & NAU7802_SCALE_STATUS_MOTION));
+    CHECK(!(s_record[9] & NAU7802_SCALE_STATUS_CENTER_OF_ZERO));
+
+    // A capture is skipped while a multi-step operation holds the device
+    xSemaphoreTake(s_ch.mutex, portMAX_DELAY);
+    host_clock_advance_us(2 * period_us(NAU7802_SPS_80));
+    CHECK(!nau7802_scale_capture(&s_ch, period_us(NAU7802_SPS_80), AVERAGE_SAMPLES, NULL));
+    xSemaphoreGive(s_ch.mutex);
+    CHECK(nau7802_scale_capture(&s_ch, period_us(NAU7802_SPS_80), AVERAGE_SAMPLES, NULL));
+    CHECK_EQ_INT(s_ch.read_errors, 0);
+}
+
+static void test_history_contents(void)
+{
+    bring_up(NAU7802_SPS_80);
+    nau7802_sim_set_load(&s_sim, 200.0f);
+    uint32_t cursor = nau7802_history_head(0);
+    run(NAU7802_SPS_80, 500000, 0, 0.0f);
+    CHECK(s_captured >= 39 && s_captured <= 41);
+
+    // Every conversion, in order, one period apart
+    nau7802_history_sample_t samples[64];
+    uint32_t lost = 0;
+    uint32_t first = cursor;
+    size_t n = nau7802_history_read(0, &cursor, samples, 64, &lost);
+    CHECK_EQ_INT(n, s_captured);
+    CHECK_EQ_INT(lost, 0);
+    CHECK_EQ_INT(cursor, first + n);
+    for (size_t i = 0; i < n; i++) {
+        CHECK_EQ_INT(samples[i].index, first + i);
+        CHECK_EQ_INT(samples[i].raw, ZERO_COUNTS + 200 * (int32_t)COUNTS_PER_GRAM);
+        CHECK(samples[i].weight_g == 200.0f);
+        if (i > 0) {
+            CHECK_EQ_INT(samples[i].timestamp_us - samples[i - 1].timestamp_us, 12500);
+        }
+    }
+    CHECK_EQ_INT(s_last_capture.index, samples[n - 1].index);
+    CHECK_EQ_INT(s_last_capture.timestamp_us, samples[n - 1].timestamp_us);
+
+    // 20 s at 320 SPS wraps the ring: a stale cursor loses the overwritten samples
+    uint32_t stale = cursor;
+    bring_up(NAU7802_SPS_320);
+    run(NAU7802_SPS_320, 20000000, 0, 0.0f);
+    CHECK(s_captured >= 6399 && s_captured <= 6401);
+    static nau7802_history_sample_t ring[HISTORY_CAPACITY];
+    n = nau7802_history_read(0, &stale, ring, HISTORY_CAPACITY, &lost);
+    CHECK_EQ_INT(n, HISTORY_CAPACITY);
+    CHECK_EQ_INT(lost, s_captured - HISTORY_CAPACITY);
+    CHECK_EQ_INT(ring[n - 1].index, s_last_capture.index);
+    // Timestamps are poll times, so the spacing is the period to within a tick
+    for (size_t i = 1; i < n; i++) {
+        uint32_t spacing = ring[i].timestamp_us - ring[i - 1].timestamp_us;
+        CHECK_EQ_INT(ring[i].index, ring[i - 1].index + 1);
+        CHECK(spacing >= 3125 - 3125 / 4 && spacing <= 3125 + 3125 / 4);
+    }
+}
+
+static double wall_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// One conversion per iteration at 320 SPS, a publish every 32 captures (100 ms)
+static void test_throughput(void)
+{
+    bring_up(NAU7802_SPS_320);
+    long captured = 0;
+    long published = 0;
+    double start = wall_seconds();
+    for (long i = 0; i < s_bench_captures; i++) {
+        host_clock_advance_us(3125);
+        if (nau7802_scale_capture(&s_ch, 3125, AVERAGE_SAMPLES, NULL)) {
+            captured++;
+        }
+        if (i % 32 == 31) {
+            nau7802_scale_publish(&s_ch, 0, s_record, NULL);
+            published++;
+        }
+    }
+    double elapsed = wall_seconds() - start;
+    CHECK_EQ_INT(captured, s_bench_captures);
+    CHECK_EQ_INT(s_ch.read_errors, 0);
+    printf("  %ld captures, %ld publishes in %.3f s: %.0f captures/s\n",
+           captured, published, elapsed, elapsed > 0 ? captured / elapsed : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        s_bench_captures = strtol(argv[1], NULL, 10);
+    }
+    if (nau7802_history_init(1, HISTORY_CAPACITY, HISTORY_CAPACITY) != ESP_OK) {
+        fprintf(stderr, "Cannot allocate the history ring\n");
+        return 1;
+    }
+    RUN_TEST(test_record_layout);
+    RUN_TEST(test_stable_and_motion_bits);
+    RUN_TEST(test_history_contents);
+    RUN_TEST(test_throughput);
+    return HOST_TEST_RESULT();
+}
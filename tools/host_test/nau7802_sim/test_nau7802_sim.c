@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test: unmodified NAU7802 driver against the register model
+ *
+ * nau7802.c talks to nau7802_sim.c through the direct I2C scheduler shim, on
+ * the virtual clock, so conversion timing is exact and runs are repeatable.
+ * The checks cover bring-up, conversion rate at every CRS setting, readings
+ * against the modelled load and a disconnected device. Power-on to first valid
+ * sample is measured for nau7802_begin_config() and for the fixed-delay
+ * sequence it replaced (old begin() plus the per-setting calls and second
+ * calibration main.c made for non-default settings). The last case runs the
+ * acquisition loop flat out and reports conversions per second of host time:
+ *
+ *   test_nau7802_sim [conversions]
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_test.h"
+#include "nau7802.h"
+#include "nau7802_sim.h"
+
+#define VIRTUAL_START_US 1000000
+#define ZERO_COUNTS 100000
+#define COUNTS_PER_GRAM 50.0f
+#define BUS_BYTES_PER_SAMPLE_MAX 14.5  // Two status polls and one data read
+#define BRING_UP_PERIODS 8             // LDO settle 2, calibration 2, first conversion 1, tick rounding
+#define BRING_UP_OVERHEAD_US 10000     // Reset and power-up
+
+static nau7802_sim_t s_sim;
+static nau7802_t s_dev;
+static long s_bench_conversions = 200000;
+
+static uint32_t period_us(nau7802_sps_t rate)
+{
+    switch (rate) {
+    case NAU7802_SPS_10: return 100000;
+    case NAU7802_SPS_20: return 50000;
+    case NAU7802_SPS_40: return 25000;
+    case NAU7802_SPS_80: return 12500;
+    default:             return 3125;
+    }
+}
+
+static esp_err_t bring_up(nau7802_sps_t rate, nau7802_gain_t gain, float noise_counts)
+{
+    nau7802_sim_signal_t signal = {
+        .zero_counts = ZERO_COUNTS,
+        .counts_per_gram = COUNTS_PER_GRAM,
+        .noise_counts = noise_counts,
+        .seed = 7,
+    };
+    host_clock_set_virtual(true, VIRTUAL_START_US);
+    esp_err_t ret = nau7802_sim_init(&s_sim, &signal);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nau7802_init_device(&s_dev, nau7802_sim_get_handle(&s_sim), NAU7802_I2C_ADDRESS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    nau7802_config_t config = {
+        .ldo = 0x04,  // 3.3 V
+        .gain = gain,
+        .sample_rate = rate,
+        .channel = NAU7802_CHANNEL_1,
+    };
+    return nau7802_begin_config(&s_dev, &config);
+}
+
+// Poll at twice the output data rate, as the scale task does, and average
+// the fresh conversions
+static long poll_fresh(nau7802_sps_t rate, int64_t duration_us, double *mean)
+{
+    uint32_t half = period_us(rate) / 2;
+    long fresh = 0;
+    double sum = 0.0;
+    for (int64_t t = 0; t < duration_us; t += half) {
+        host_clock_advance_us(half);
+        nau7802_sample_t sample;
+        if (nau7802_read_sample(&s_dev, &sample) == ESP_OK) {
+            fresh++;
+            sum += sample.raw;
+        }
+    }
+    if (mean != NULL) {
+        *mean = fresh > 0 ? sum / fresh : 0.0;
+    }
+    return fresh;
+}
+
+static void test_conversion_rate_every_crs_setting(void)
+{
+    static const struct {
+        nau7802_sps_t rate;
+        long sps;
+    } rates[] = {
+        { NAU7802_SPS_10, 10 }, { NAU7802_SPS_20, 20 }, { NAU7802_SPS_40, 40 },
+        { NAU7802_SPS_80, 80 }, { NAU7802_SPS_320, 320 },
+    };
+
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        CHECK_EQ_INT(bring_up(rates[i].rate, NAU7802_GAIN_128, 0.0f), ESP_OK);
+        nau7802_sim_stats_t before;
+        nau7802_sim_get_stats(&s_sim, &before);
+
+        long fresh = poll_fresh(rates[i].rate, 5000000, NULL);
+
+        nau7802_sim_stats_t after;
+        nau7802_sim_get_stats(&s_sim, &after);
+        // Every conversion of the 5 s window is read exactly once
+        CHECK(labs(fresh - 5 * rates[i].sps) <= 1);
+        CHECK_EQ_INT(after.missed, before.missed);
+        CHECK_EQ_INT(after.reads - before.reads, fresh);
+    }
+}
+
+static void test_readings_follow_load_and_gain(void)
+{
+    double mean;
+
+    CHECK_EQ_INT(bring_up(NAU7802_SPS_80, NAU7802_GAIN_128, 20.0f), ESP_OK);
+    CHECK(poll_fresh(NAU7802_SPS_80, 1000000, &mean) >= 79);
+    CHECK(mean > ZERO_COUNTS - 10 && mean < ZERO_COUNTS + 10);
+
+    nau7802_sim_set_load(&s_sim, 1000.0f);
+    poll_fresh(NAU7802_SPS_80, 100000, NULL);
+    poll_fresh(NAU7802_SPS_80, 1000000, &mean);
+    double loaded = ZERO_COUNTS + 1000.0 * COUNTS_PER_GRAM;
+    CHECK(mean > loaded - 10 && mean < loaded + 10);
+
+    // Signal counts are modelled at x128: x64 halves the reading
+    CHECK_EQ_INT(bring_up(NAU7802_SPS_80, NAU7802_GAIN_64, 20.0f), ESP_OK);
+    poll_fresh(NAU7802_SPS_80, 1000000, &mean);
+    CHECK(mean > ZERO_COUNTS / 2 - 10 && mean < ZERO_COUNTS / 2 + 10);
+}
+
+static void test_disconnected_device(void)
+{
+    CHECK_EQ_INT(bring_up(NAU7802_SPS_80, NAU7802_GAIN_128, 0.0f), ESP_OK);
+    nau7802_sim_set_connected(&s_sim, false);
+    nau7802_sample_t sample;
+    host_clock_advance_us(20000);
+    CHECK(nau7802_read_sample(&s_dev, &sample) != ESP_OK);
+    CHECK(!nau7802_is_connected(&s_dev));
+
+    nau7802_sim_set_connected(&s_sim, true);
+    host_clock_advance_us(20000);
+    CHECK_EQ_INT(nau7802_read_sample(&s_dev, &sample), ESP_OK);
+}
+
+// The scale task's polling: a timer tick every quarter period, and no poll
+// before three quarters of a period after the last conversion was read.
+// Returns the fresh conversions; bus use is taken from the model's counters.
+static long poll_like_scale_task(nau7802_sps_t rate, int64_t duration_us)
+{
+    uint32_t period = period_us(rate);
+    int64_t next_poll_us = 0;
+    long fresh = 0;
+    for (int64_t t = 0; t < duration_us; t += period / 4) {
+        host_clock_advance_us(period / 4);
+        if (esp_timer_get_time() < next_poll_us) {
+            continue;
+        }
+        nau7802_sample_t sample;
+        if (nau7802_read_sample(&s_dev, &sample) == ESP_OK) {
+            fresh++;
+            next_poll_us = sample.timestamp_us + period - period / 4;
+        }
+    }
+    return fresh;
+}
+
+static void test_bus_bytes_per_sample(void)
+{
+    static const nau7802_sps_t rates[] = { NAU7802_SPS_10, NAU7802_SPS_80, NAU7802_SPS_320 };
+
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        CHECK_EQ_INT(bring_up(rates[i], NAU7802_GAIN_128, 0.0f), ESP_OK);
+        nau7802_sim_stats_t before;
+        nau7802_sim_get_stats(&s_sim, &before);
+        long fresh = poll_like_scale_task(rates[i], 10000000);
+        nau7802_sim_stats_t after;
+        nau7802_sim_get_stats(&s_sim, &after);
+
+        double bytes = (double)(after.bus_bytes - before.bus_bytes) / fresh;
+        double transactions = (double)(after.transactions - before.transactions) / fresh;
+        CHECK_EQ_INT(after.missed, before.missed);
+        CHECK(fresh > 0);
+        // Status polls of 4 bytes, plus 6 bytes to fetch each conversion
+        CHECK(bytes <= BUS_BYTES_PER_SAMPLE_MAX);
+        printf("  %5lu us period: %.2f bus bytes, %.2f transactions per sample\n",
+               (unsigned long)period_us(rates[i]), bytes, transactions);
+    }
+}
+
+// The bring-up nau7802_begin_config() replaced: the old begin() with its fixed
+// 250 ms LDO wait and 10 x 10 ms flush, then main.c applying each stored
+// setting with its own call, another 250 ms for a new LDO and a second
+// calibration
+static esp_err_t legacy_begin(const nau7802_config_t *config)
+{
+    esp_err_t ret = nau7802_reset(&s_dev);
+    if (ret == ESP_OK) ret = nau7802_power_up(&s_dev);
+    if (ret == ESP_OK) ret = nau7802_set_ldo(&s_dev, 4);
+    if (ret == ESP_OK) ret = nau7802_set_gain(&s_dev, NAU7802_GAIN_128);
+    if (ret == ESP_OK) ret = nau7802_set_sample_rate(&s_dev, NAU7802_SPS_80);
+    if (ret == ESP_OK) ret = nau7802_set_register(&s_dev, NAU7802_REGISTER_ADC, 0x30);
+    if (ret == ESP_OK) ret = nau7802_set_bit(&s_dev, NAU7802_REGISTER_POWER, 7);
+    if (ret == ESP_OK) ret = nau7802_clear_bit(&s_dev, NAU7802_REGISTER_PGA, 5);
+    if (ret != ESP_OK) return ret;
+    vTaskDelay(pdMS_TO_TICKS(250));
+    for (int i = 0; i < 10; i++) {
+        nau7802_sample_t discard;
+        nau7802_read_sample(&s_dev, &discard);
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    ret = nau7802_calibrate_af(&s_dev);
+    if (ret != ESP_OK) return ret;
+
+    bool need_recal = false;
+    if (config->ldo != 4) {
+        ret = nau7802_set_ldo(&s_dev, config->ldo);
+        if (ret != ESP_OK) return ret;
+        vTaskDelay(pdMS_TO_TICKS(250));
+    }
+    if (config->gain != NAU7802_GAIN_128) {
+        ret = nau7802_set_gain(&s_dev, config->gain);
+        need_recal = true;
+    }
+    if (ret == ESP_OK && config->sample_rate != NAU7802_SPS_80) {
+        ret = nau7802_set_sample_rate(&s_dev, config->sample_rate);
+        need_recal = true;
+    }
+    if (ret == ESP_OK && config->channel != NAU7802_CHANNEL_1) {
+        ret = nau7802_set_channel(&s_dev, config->channel);
+    }
+    if (ret == ESP_OK && need_recal) {
+        ret = nau7802_calibrate_af(&s_dev);
+    }
+    return ret;
+}
+
+// Power-on to first valid sample on the virtual clock, polling every 1 ms
+// after bring-up returns
+static int64_t time_to_first_sample(const nau7802_config_t *config, bool legacy,
+                                    uint32_t *transactions)
+{
+    nau7802_sim_signal_t signal = { .zero_counts = ZERO_COUNTS, .counts_per_gram = COUNTS_PER_GRAM };
+    host_clock_set_virtual(true, VIRTUAL_START_US);
+    if (nau7802_sim_init(&s_sim, &signal) != ESP_OK ||
+        nau7802_init_device(&s_dev, nau7802_sim_get_handle(&s_sim), NAU7802_I2C_ADDRESS) != ESP_OK) {
+        return -1;
+    }
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = legacy ? legacy_begin(config) : nau7802_begin_config(&s_dev, config);
+    if (ret != ESP_OK) {
+        return -1;
+    }
+    nau7802_sample_t sample;
+    while (nau7802_read_sample(&s_dev, &sample) != ESP_OK) {
+        if (esp_timer_get_time() - start > 2000000) {
+            return -1;
+        }
+        host_clock_advance_us(1000);
+    }
+    nau7802_sim_stats_t stats;
+    nau7802_sim_get_stats(&s_sim, &stats);
+    *transactions = stats.transactions;
+    return sample.timestamp_us - start;
+}
+
+static void test_bring_up_time(void)
+{
+    static const struct {
+        const char *name;
+        nau7802_config_t config;
+    } cases[] = {
+        { "defaults (3.3 V, x128, 80 SPS)",
+          { .ldo = 4, .gain = NAU7802_GAIN_128, .sample_rate = NAU7802_SPS_80, .channel = NAU7802_CHANNEL_1 } },
+        { "3.0 V, x64, 320 SPS",
+          { .ldo = 5, .gain = NAU7802_GAIN_64, .sample_rate = NAU7802_SPS_320, .channel = NAU7802_CHANNEL_1 } },
+        { "3.3 V, x128, 10 SPS",
+          { .ldo = 4, .gain = NAU7802_GAIN_128, .sample_rate = NAU7802_SPS_10, .channel = NAU7802_CHANNEL_1 } },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint32_t legacy_transactions = 0;
+        uint32_t transactions = 0;
+        int64_t legacy_us = time_to_first_sample(&cases[i].config, true, &legacy_transactions);
+        int64_t us = time_to_first_sample(&cases[i].config, false, &transactions);
+        CHECK(legacy_us > 0);
+        CHECK(us > 0);
+        CHECK(us < legacy_us);
+        // No fixed delays left: bring-up scales with the conversion period
+        CHECK(us <= BRING_UP_OVERHEAD_US + BRING_UP_PERIODS * (int64_t)period_us(cases[i].config.sample_rate));
+        printf("  %-32s first sample after %3ld ms (%3lu transactions), was %3ld ms (%3lu)\n",
+               cases[i].name, (long)(us / 1000), (unsigned long)transactions,
+               (long)(legacy_us / 1000), (unsigned long)legacy_transactions);
+    }
+}
+
+static double wall_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// One conversion per iteration at 320 SPS: clock step, status and data reads, decode
+static void test_throughput(void)
+{
+    CHECK_EQ_INT(bring_up(NAU7802_SPS_320, NAU7802_GAIN_128, 20.0f), ESP_OK);
+    nau7802_sim_stats_t before;
+    nau7802_sim_get_stats(&s_sim, &before);
+
+    long fresh = 0;
+    double start = wall_seconds();
+    for (long i = 0; i < s_bench_conversions; i++) {
+        host_clock_advance_us(3125);
+        nau7802_sample_t sample;
+        if (nau7802_read_sample(&s_dev, &sample) == ESP_OK) {
+            fresh++;
+        }
+    }
+    double elapsed = wall_seconds() - start;
+
+    nau7802_sim_stats_t after;
+    nau7802_sim_get_stats(&s_sim, &after);
+    CHECK_EQ_INT(fresh, s_bench_conversions);
+    CHECK_EQ_INT(after.missed, before.missed);
+
+    printf("  %ld conversions in %.3f s: %.0f conversions/s, %.0f I2C transactions/s\n",
+           fresh, elapsed, elapsed > 0 ? fresh / elapsed : 0.0,
+           elapsed > 0 ? (after.transactions - before.transactions) / elapsed : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        s_bench_conversions = strtol(argv[1], NULL, 10);
+    }
+    RUN_TEST(test_conversion_rate_every_crs_setting);
+    RUN_TEST(test_readings_follow_load_and_gain);
+    RUN_TEST(test_disconnected_device);
+    RUN_TEST(test_bring_up_time);
+    RUN_TEST(test_bus_bytes_per_sample);
+    RUN_TEST(test_throughput);
+    return HOST_TEST_RESULT();
+}
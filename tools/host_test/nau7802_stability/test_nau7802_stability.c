@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test: nau7802_stability flag transitions on synthetic raw traces
+ *
+ * Each trace is a raw ADC sequence fed through nau7802_stability_update() one
+ * sample at a time. The checks pin the sample index at which stable, in_motion
+ * and center_of_zero change, and how far auto-zero tracking moves the zero.
+ *
+ * The traces are synthetic, not captured from a load cell: a fixed 32-entry
+ * noise table (s_noise, +/-20 counts, roughly the spread of a 5 kg cell at
+ * 10 SPS, gain 128) repeated under a hand-written load profile (step, ramp or
+ * creep) per case. The noise table is deterministic, so every flag change
+ * lands on the same sample on every run.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "host_test.h"
+#include "nau7802_stability.h"
+
+#define TRACE_MAX 256
+#define COUNTS_PER_GRAM 100.0f
+#define WINDOW 16
+
+static const int16_t s_noise[32] = {
+      3,  -7,  12,  -2, -15,   6,   9, -11,
+     -4,  17,  -9,   1,   5, -18,  10,  -1,
+     -6,  14,  -3,   8, -12,   2,  19, -10,
+      0,  -5,  11, -16,   7,  -8,   4, -13,
+};
+
+typedef struct {
+    bool stable[TRACE_MAX];
+    bool in_motion[TRACE_MAX];
+    bool center_of_zero[TRACE_MAX];
+    float zero_offset[TRACE_MAX];
+} trace_result_t;
+
+static nau7802_stability_config_t default_config(void)
+{
+    nau7802_stability_config_t cfg = {
+        .window = WINDOW,
+        .stable_band_g = 0.5f,     // 50 counts
+        .motion_band_g = 2.0f,     // 200 counts
+        .azt_enabled = false,
+        .azt_band_g = 1.0f,        // 100 counts
+        .azt_rate = 0.1f,
+        .azt_limit_g = 2.0f,       // 200 counts
+    };
+    return cfg;
+}
+
+static void init_dev(nau7802_t *dev)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->calibration_factor = COUNTS_PER_GRAM;
+    dev->zero_offset = 0.0f;
+}
+
+static void run_trace(nau7802_stability_t *st, nau7802_t *dev, const int32_t *trace, int n,
+                      trace_result_t *res)
+{
+    for (int i = 0; i < n; i++) {
+        nau7802_stability_update(st, dev, trace[i]);
+        res->stable[i] = st->stable;
+        res->in_motion[i] = st->in_motion;
+        res->center_of_zero[i] = st->center_of_zero;
+        res->zero_offset[i] = dev->zero_offset;
+    }
+}
+
+// First index >= from where flags[i] == value, or -1
+static int first_index(const bool *flags, int from, int n, bool value)
+{
+    for (int i = from; i < n; i++) {
+        if (flags[i] == value) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool all_equal(const bool *flags, int from, int to, bool value)
+{
+    for (int i = from; i < to; i++) {
+        if (flags[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void fill_level(int32_t *trace, int from, int to, int32_t level)
+{
+    for (int i = from; i < to; i++) {
+        trace[i] = level + s_noise[i % 32];
+    }
+}
+
+static trace_result_t s_res;
+static int32_t s_trace[TRACE_MAX];
+
+// Empty platform: the window must fill before the reading is stable, and the
+// noise floor alone must never read as motion
+static void test_empty_platform_settles_after_one_window(void)
+{
+    nau7802_stability_t st;
+    nau7802_t dev;
+    nau7802_stability_config_t cfg = default_config();
+    init_dev(&dev);
+    nau7802_stability_init(&st, &cfg);
+
+    fill_level(s_trace, 0, 64, 0);
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, 64, &s_res);
+
+    CHECK_EQ_INT(first_index(s_res.stable, 0, 64, true), WINDOW - 1);
+    CHECK(all_equal(s_res.stable, WINDOW - 1, 64, true));
+    CHECK(all_equal(s_res.in_motion, 0, 64, false));
+    CHECK_EQ_INT(first_index(s_res.center_of_zero, 0, 64, true), WINDOW - 1);
+    CHECK(all_equal(s_res.center_of_zero, WINDOW - 1, 64, true));
+    CHECK(nau7802_stability_get_stddev(&st) < 20.0f);
+    // AZT disabled: zero never moves
+    CHECK(s_res.zero_offset[63] == 0.0f);
+}
+
+// 500 g placed over three samples: motion from the first ramp sample until the
+// last ramp sample leaves the window, then stable at once, away from zero
+static void test_load_step_motion_then_stable(void)
+{
+    nau7802_stability_t st;
+    nau7802_t dev;
+    nau7802_stability_config_t cfg = default_config();
+    init_dev(&dev);
+    nau7802_stability_init(&st, &cfg);
+
+    const int ramp = 32;
+    const int settled = ramp + 3;
+    const int n = 96;
+    fill_level(s_trace, 0, ramp, 0);
+    s_trace[ramp] = 12500 + s_noise[ramp % 32];
+    s_trace[ramp + 1] = 25000 + s_noise[(ramp + 1) % 32];
+    s_trace[ramp + 2] = 37500 + s_noise[(ramp + 2) % 32];
+    fill_level(s_trace, settled, n, 50000);
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, n, &s_res);
+
+    CHECK(s_res.stable[ramp - 1]);
+    CHECK(s_res.center_of_zero[ramp - 1]);
+    CHECK_EQ_INT(first_index(s_res.in_motion, 0, n, true), ramp);
+    CHECK(!s_res.stable[ramp]);
+    CHECK(!s_res.center_of_zero[ramp]);
+
+    // Motion clears on the first window that holds only settled samples
+    int settled_window = settled + WINDOW - 1;
+    CHECK(all_equal(s_res.in_motion, ramp, settled_window, true));
+    CHECK_EQ_INT(first_index(s_res.in_motion, ramp, n, false), settled_window);
+    CHECK_EQ_INT(first_index(s_res.stable, ramp, n, true), settled_window);
+    CHECK(all_equal(s_res.stable, settled_window, n, true));
+    CHECK(all_equal(s_res.center_of_zero, ramp, n, false));
+}
+
+// Creep of 4 counts per sample: drift across the window (60 counts) is over the
+// stable band but under the motion band, so the reading is neither
+static void test_slow_creep_is_neither_stable_nor_motion(void)
+{
+    nau7802_stability_t st;
+    nau7802_t dev;
+    nau7802_stability_config_t cfg = default_config();
+    init_dev(&dev);
+    nau7802_stability_init(&st, &cfg);
+
+    const int creep = 32;
+    const int n = 96;
+    fill_level(s_trace, 0, creep, 20000);
+    for (int i = creep; i < n; i++) {
+        s_trace[i] = 20000 + 4 * (i - creep) + s_noise[i % 32] / 4;
+    }
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, n, &s_res);
+
+    CHECK(s_res.stable[creep - 1]);
+    // Stability is lost while the creep is still entering the window...
+    int lost = first_index(s_res.stable, creep, n, false);
+    CHECK(lost > creep && lost < creep + WINDOW);
+    // ...and once the window holds only creeping samples it stays lost
+    CHECK(all_equal(s_res.stable, creep + WINDOW - 1, n, false));
+    CHECK(all_equal(s_res.in_motion, 0, n, false));
+    CHECK(fabsf(nau7802_stability_get_drift(&st)) > 50.0f);
+    CHECK(fabsf(nau7802_stability_get_drift(&st)) < 200.0f);
+}
+
+// Zero drifting to +0.6 g with AZT on: the zero follows in azt_rate steps
+// while stable and centred, and never overshoots the reading
+static void test_azt_tracks_zero_drift(void)
+{
+    nau7802_stability_t st;
+    nau7802_t dev;
+    nau7802_stability_config_t cfg = default_config();
+    cfg.azt_enabled = true;
+    init_dev(&dev);
+    nau7802_stability_init(&st, &cfg);
+
+    const int n = 200;
+    fill_level(s_trace, 0, n, 60);
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, n, &s_res);
+
+    // First correction on the first stable, centred sample
+    CHECK_EQ_INT(first_index(s_res.center_of_zero, 0, n, true), WINDOW - 1);
+    CHECK(s_res.zero_offset[WINDOW - 2] == 0.0f);
+    CHECK(s_res.zero_offset[WINDOW - 1] > 0.0f);
+    // While the zero error is well above the noise in the window mean, every
+    // step moves toward the reading
+    for (int i = WINDOW; i < WINDOW + 8; i++) {
+        CHECK(s_res.zero_offset[i] > s_res.zero_offset[i - 1]);
+    }
+    // Window mean is 60 +/- noise: converged close to it, but inside the limit
+    CHECK(fabsf(dev.zero_offset - 60.0f) < 10.0f);
+    CHECK(st.azt_total <= cfg.azt_limit_g * COUNTS_PER_GRAM);
+    CHECK(all_equal(s_res.center_of_zero, WINDOW - 1, n, true));
+}
+
+// AZT limit: with a 0.3 g budget the zero stops 30 counts in, even though the
+// reading is still centred; an external tare restarts the budget
+static void test_azt_limit_and_tare_restart(void)
+{
+    nau7802_stability_t st;
+    nau7802_t dev;
+    nau7802_stability_config_t cfg = default_config();
+    cfg.azt_enabled = true;
+    cfg.azt_limit_g = 0.3f;
+    init_dev(&dev);
+    nau7802_stability_init(&st, &cfg);
+
+    const int n = 200;
+    fill_level(s_trace, 0, n, 60);
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, n, &s_res);
+
+    CHECK(fabsf(dev.zero_offset - 30.0f) < 0.01f);
+    CHECK(s_res.center_of_zero[n - 1]);
+
+    // Tare to 55: the accumulator restarts and may move another 30 counts,
+    // but only as far as the reading (about 5 counts away)
+    dev.zero_offset = 55.0f;
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, n, &s_res);
+    CHECK(dev.zero_offset > 55.0f);
+    CHECK(fabsf(dev.zero_offset - 60.0f) < 10.0f);
+}
+
+// Load well outside the AZT band: stable, but never centre of zero, and the
+// zero is left alone even with AZT enabled
+static void test_center_of_zero_clears_outside_band(void)
+{
+    nau7802_stability_t st;
+    nau7802_t dev;
+    nau7802_stability_config_t cfg = default_config();
+    cfg.azt_enabled = true;
+    cfg.azt_band_g = 0.5f;             // 50 counts
+    init_dev(&dev);
+    nau7802_stability_init(&st, &cfg);
+
+    const int step = 48;
+    const int n = 128;
+    fill_level(s_trace, 0, step, 0);
+    fill_level(s_trace, step, n, 100);   // 1 g, outside the 0.5 g AZT band
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, n, &s_res);
+
+    CHECK(s_res.center_of_zero[step - 1]);
+    // A step shows up as up to 1.5x its height in drift; 100 counts stays
+    // under the motion band, so this is only a gap in stability
+    CHECK(all_equal(s_res.in_motion, 0, n, false));
+    int cleared = first_index(s_res.center_of_zero, step, n, false);
+    CHECK(cleared >= step && cleared < step + WINDOW);
+    CHECK(all_equal(s_res.stable, step + WINDOW - 1, n, true));
+    CHECK(all_equal(s_res.center_of_zero, step + WINDOW - 1, n, false));
+    // Whatever AZT did before the step was a fraction of the noise floor, and
+    // nothing moves once the load is outside the band
+    float zero_at_settle = s_res.zero_offset[step + WINDOW - 1];
+    CHECK(fabsf(zero_at_settle) < 20.0f);
+    CHECK(s_res.zero_offset[n - 1] == zero_at_settle);
+}
+
+// Reset discards the window: the next sample cannot be stable on its own
+static void test_reset_requires_full_window(void)
+{
+    nau7802_stability_t st;
+    nau7802_t dev;
+    nau7802_stability_config_t cfg = default_config();
+    init_dev(&dev);
+    nau7802_stability_init(&st, &cfg);
+
+    fill_level(s_trace, 0, 32, 1000);
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, 32, &s_res);
+    CHECK(st.stable);
+
+    nau7802_stability_reset(&st);
+    CHECK(!st.stable && !st.in_motion && !st.center_of_zero);
+    memset(&s_res, 0, sizeof(s_res));
+    run_trace(&st, &dev, s_trace, 32, &s_res);
+    CHECK_EQ_INT(first_index(s_res.stable, 0, 32, true), WINDOW - 1);
+}
+
+int main(void)
+{
+    RUN_TEST(test_empty_platform_settles_after_one_window);
+    RUN_TEST(test_load_step_motion_then_stable);
+    RUN_TEST(test_slow_creep_is_neither_stable_nor_motion);
+    RUN_TEST(test_azt_tracks_zero_drift);
+    RUN_TEST(test_azt_limit_and_tare_restart);
+    RUN_TEST(test_center_of_zero_clears_outside_band);
+    RUN_TEST(test_reset_requires_full_window);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,47 @@
+/*
+ * Host shim: I2C master driver handle types
+ *
+ * Only the opaque handles and the calls the NAU7802 driver makes directly are
+ * declared; host tests reach the device through the i2c_scheduler transport.
+ */
+
+#ifndef HOST_SHIM_DRIVER_I2C_MASTER_H
+#define HOST_SHIM_DRIVER_I2C_MASTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct i2c_master_bus_t *i2c_master_bus_handle_t;
+typedef struct i2c_master_dev_t *i2c_master_dev_handle_t;
+
+typedef enum {
+    I2C_ADDR_BIT_LEN_7 = 0,
+    I2C_ADDR_BIT_LEN_10 = 1,
+} i2c_addr_bit_len_t;
+
+typedef struct {
+    i2c_addr_bit_len_t dev_addr_length;
+    uint16_t device_address;
+    uint32_t scl_speed_hz;
+    uint32_t scl_wait_us;
+    struct {
+        uint32_t disable_ack_check : 1;
+    } flags;
+} i2c_device_config_t;
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle,
+                                    const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle);
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_DRIVER_I2C_MASTER_H
@@ -0,0 +1,43 @@
+/*
+ * Host shim: ESP_LOGx on stderr
+ *
+ * Errors and warnings go to stderr so a failing test shows what the component
+ * reported; info, debug and verbose are type-checked but never printed.
+ * esp_log_write() goes through the vprintf set with esp_log_set_vprintf(),
+ * like on the target, so log capture hooks can be driven directly.
+ */
+
+#ifndef HOST_SHIM_ESP_LOG_H
+#define HOST_SHIM_ESP_LOG_H
+
+#include <stdarg.h>
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+typedef int (*vprintf_like_t)(const char *, va_list);
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define HOST_LOG(letter, tag, format, ...) \
+    fprintf(stderr, letter " (%s) " format "\n", tag, ##__VA_ARGS__)
+
+#define HOST_LOG_NONE(tag, format, ...) \
+    do { if (0) { fprintf(stderr, "%s " format, tag, ##__VA_ARGS__); } } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG_NONE(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG_NONE(tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG_NONE(tag, format, ##__VA_ARGS__)
+
+#endif // HOST_SHIM_ESP_LOG_H
@@ -0,0 +1,37 @@
+/*
+ * Host shim: esp_timer_get_time and the host clock controls
+ *
+ * By default the clock is CLOCK_MONOTONIC. A test that needs deterministic
+ * timing switches to a virtual clock, which only moves when the test
+ * advances it or when code under test calls vTaskDelay().
+ */
+
+#ifndef HOST_SHIM_ESP_TIMER_H
+#define HOST_SHIM_ESP_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Microseconds since the start of the test (or the virtual time) */
+int64_t esp_timer_get_time(void);
+
+/**
+ * @brief Switch between the real and the virtual clock
+ *
+ * The virtual clock starts at @p start_us, which should be non-zero since
+ * several components treat a zero timestamp as "never".
+ */
+void host_clock_set_virtual(bool enable, int64_t start_us);
+
+/** Advance the virtual clock (no effect on the real clock) */
+void host_clock_advance_us(int64_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ESP_TIMER_H
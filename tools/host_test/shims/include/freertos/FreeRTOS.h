@@ -0,0 +1,55 @@
+/*
+ * Host shim: FreeRTOS base types, tick conversion and critical sections
+ *
+ * Critical sections map to a recursive pthread mutex per portMUX_TYPE, which
+ * gives the mutual exclusion the code relies on, not the interrupt masking.
+ *
+ * There are two cores. A thread is on core 0 until it calls
+ * host_set_core_id(). Masking local interrupts does nothing, so code that
+ * relies on it for per-core data needs one writing thread per core.
+ */
+
+#ifndef HOST_SHIM_FREERTOS_H
+#define HOST_SHIM_FREERTOS_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000u))
+
+typedef struct {
+    pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+
+void host_mux_init(portMUX_TYPE *mux);
+
+#define portMUX_INITIALIZE(mux) host_mux_init(mux)
+#define taskENTER_CRITICAL(mux) pthread_mutex_lock(&(mux)->mutex)
+#define taskEXIT_CRITICAL(mux) pthread_mutex_unlock(&(mux)->mutex)
+#define portENTER_CRITICAL(mux) taskENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL(mux) taskEXIT_CRITICAL(mux)
+
+#define portNUM_PROCESSORS 2
+
+BaseType_t xPortGetCoreID(void);
+void host_set_core_id(BaseType_t core);
+
+#define portSET_INTERRUPT_MASK_FROM_ISR() ((UBaseType_t)0)
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(state) ((void)(state))
+
+#endif // HOST_SHIM_FREERTOS_H
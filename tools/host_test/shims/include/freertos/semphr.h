@@ -0,0 +1,38 @@
+/*
+ * Host shim: FreeRTOS semaphores on pthreads
+ *
+ * Mutexes, binary and counting semaphores share one counting implementation
+ * (a mutex is a binary semaphore that starts available). Timeouts are in
+ * real ticks even when the virtual clock is enabled.
+ */
+
+#ifndef HOST_SHIM_FREERTOS_SEMPHR_H
+#define HOST_SHIM_FREERTOS_SEMPHR_H
+
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+    int dynamic;
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+SemaphoreHandle_t host_semaphore_create(StaticSemaphore_t *buffer, UBaseType_t max, UBaseType_t initial);
+
+#define xSemaphoreCreateMutex() host_semaphore_create(NULL, 1, 1)
+#define xSemaphoreCreateMutexStatic(buffer) host_semaphore_create((buffer), 1, 1)
+#define xSemaphoreCreateBinary() host_semaphore_create(NULL, 1, 0)
+#define xSemaphoreCreateBinaryStatic(buffer) host_semaphore_create((buffer), 1, 0)
+#define xSemaphoreCreateCounting(max, initial) host_semaphore_create(NULL, (max), (initial))
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem);
+
+#endif // HOST_SHIM_FREERTOS_SEMPHR_H
@@ -0,0 +1,29 @@
+/*
+ * Host shim: FreeRTOS tasks, task delay and tick count
+ *
+ * Tasks are detached pthreads; stack size and priority are ignored.
+ * vTaskDelay() advances the virtual clock when it is enabled (see
+ * esp_timer.h) and sleeps otherwise.
+ */
+
+#ifndef HOST_SHIM_FREERTOS_TASK_H
+#define HOST_SHIM_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth,
+                       void *parameters, UBaseType_t priority, TaskHandle_t *created_task);
+// Only vTaskDelete(NULL) from the task itself is supported
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+// Tasks created with xTaskCreate() that have not returned or deleted themselves
+unsigned host_task_running_count(void);
+
+#endif // HOST_SHIM_FREERTOS_TASK_H
@@ -0,0 +1,10 @@
+/*
+ * Host shim: lwIP address conversion mapped to the host headers
+ */
+
+#ifndef HOST_SHIM_LWIP_INET_H
+#define HOST_SHIM_LWIP_INET_H
+
+#include <arpa/inet.h>
+
+#endif // HOST_SHIM_LWIP_INET_H
@@ -0,0 +1,10 @@
+/*
+ * Host shim: lwIP netdb API mapped to the host resolver headers
+ */
+
+#ifndef HOST_SHIM_LWIP_NETDB_H
+#define HOST_SHIM_LWIP_NETDB_H
+
+#include <netdb.h>
+
+#endif // HOST_SHIM_LWIP_NETDB_H
@@ -0,0 +1,17 @@
+/*
+ * Host shim: lwIP socket API mapped to the host BSD sockets
+ */
+
+#ifndef HOST_SHIM_LWIP_SOCKETS_H
+#define HOST_SHIM_LWIP_SOCKETS_H
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#endif // HOST_SHIM_LWIP_SOCKETS_H
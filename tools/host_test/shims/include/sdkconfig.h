@@ -0,0 +1,11 @@
+/*
+ * Host shim: the subset of sdkconfig.h the host-tested sources read
+ */
+
+#ifndef HOST_SHIM_SDKCONFIG_H
+#define HOST_SHIM_SDKCONFIG_H
+
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_LOG_MAXIMUM_LEVEL 3
+
+#endif // HOST_SHIM_SDKCONFIG_H
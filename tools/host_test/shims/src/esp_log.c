@@ -0,0 +1,21 @@
+/*
+ * Host shim: esp_log_write() through a replaceable vprintf
+ */
+
+#include <stdatomic.h>
+#include "esp_log.h"
+
+static _Atomic(vprintf_like_t) s_log_vprintf = vprintf;
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
+{
+    return atomic_exchange(&s_log_vprintf, func);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    atomic_load(&s_log_vprintf)(format, args);
+    va_end(args);
+}
@@ -0,0 +1,74 @@
+/*
+ * Host shim: real / virtual clock behind esp_timer_get_time and vTaskDelay
+ */
+
+#include <stdatomic.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static atomic_bool s_virtual;
+static atomic_llong s_virtual_us;
+
+static int64_t monotonic_us(void)
+{
+    static int64_t s_origin_us;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (s_origin_us == 0) {
+        // Start at 1 s, like a device that has just booted
+        s_origin_us = now - 1000000;
+    }
+    return now - s_origin_us;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    if (atomic_load(&s_virtual)) {
+        return atomic_load(&s_virtual_us);
+    }
+    return monotonic_us();
+}
+
+void host_clock_set_virtual(bool enable, int64_t start_us)
+{
+    atomic_store(&s_virtual_us, start_us);
+    atomic_store(&s_virtual, enable);
+}
+
+void host_clock_advance_us(int64_t us)
+{
+    atomic_fetch_add(&s_virtual_us, us);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    int64_t us = (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+    if (atomic_load(&s_virtual)) {
+        host_clock_advance_us(us);
+        return;
+    }
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return (TaskHandle_t)(uintptr_t)pthread_self();
+}
+
+void host_mux_init(portMUX_TYPE *mux)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mux->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
@@ -0,0 +1,85 @@
+/*
+ * Host shim: FreeRTOS semaphores on pthreads
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+#include "freertos/semphr.h"
+
+SemaphoreHandle_t host_semaphore_create(StaticSemaphore_t *buffer, UBaseType_t max, UBaseType_t initial)
+{
+    StaticSemaphore_t *sem = buffer;
+    if (sem == NULL) {
+        sem = calloc(1, sizeof(*sem));
+        if (sem == NULL) {
+            return NULL;
+        }
+        sem->dynamic = 1;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->count = initial;
+    sem->max = max;
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    struct timespec deadline;
+    if (ticks != portMAX_DELAY) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        long long ns = deadline.tv_nsec + (long long)ticks * portTICK_PERIOD_MS * 1000000LL;
+        deadline.tv_sec += ns / 1000000000LL;
+        deadline.tv_nsec = ns % 1000000000LL;
+    }
+
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        if (ticks == 0) {
+            break;
+        }
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&sem->cond, &sem->lock);
+        } else if (pthread_cond_timedwait(&sem->cond, &sem->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    BaseType_t taken = pdFALSE;
+    if (sem->count > 0) {
+        sem->count--;
+        taken = pdTRUE;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    BaseType_t given = pdFALSE;
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count < sem->max) {
+        sem->count++;
+        given = pdTRUE;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return given;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    if (sem->dynamic) {
+        free(sem);
+    }
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    UBaseType_t count = sem->count;
+    pthread_mutex_unlock(&sem->lock);
+    return count;
+}
@@ -0,0 +1,82 @@
+/*
+ * Host shim: FreeRTOS tasks as detached pthreads, and the core a thread runs on
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef struct {
+    TaskFunction_t function;
+    void *parameters;
+} host_task_start_t;
+
+static atomic_uint s_running_tasks;
+static _Thread_local BaseType_t s_core_id;
+
+BaseType_t xPortGetCoreID(void)
+{
+    return s_core_id;
+}
+
+void host_set_core_id(BaseType_t core)
+{
+    s_core_id = core;
+}
+
+static void task_exited(void *unused)
+{
+    atomic_fetch_sub(&s_running_tasks, 1);
+}
+
+static void *task_entry(void *arg)
+{
+    host_task_start_t start = *(host_task_start_t *)arg;
+    free(arg);
+    pthread_cleanup_push(task_exited, NULL);
+    start.function(start.parameters);
+    pthread_cleanup_pop(1);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth,
+                       void *parameters, UBaseType_t priority, TaskHandle_t *created_task)
+{
+    host_task_start_t *start = malloc(sizeof(*start));
+    if (start == NULL) {
+        return pdFAIL;
+    }
+    start->function = function;
+    start->parameters = parameters;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    atomic_fetch_add(&s_running_tasks, 1);
+    int err = pthread_create(&thread, &attr, task_entry, start);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        atomic_fetch_sub(&s_running_tasks, 1);
+        free(start);
+        return pdFAIL;
+    }
+    if (created_task != NULL) {
+        *created_task = (TaskHandle_t)(uintptr_t)thread;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL) {
+        pthread_exit(NULL);
+    }
+    abort();
+}
+
+unsigned host_task_running_count(void)
+{
+    return atomic_load(&s_running_tasks);
+}
@@ -0,0 +1,24 @@
+/*
+ * Host shim: I2C master driver entry points
+ *
+ * There is no bus on the host; devices are reached through a transport set
+ * with i2c_sched_set_device_transport(), e.g. the NAU7802 model.
+ */
+
+#include "driver/i2c_master.h"
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle,
+                                    const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle)
+{
+    (void)bus_handle;
+    (void)dev_config;
+    (void)ret_handle;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
@@ -0,0 +1,137 @@
+/*
+ * Host shim: I2C scheduler that runs every transaction immediately
+ *
+ * Implements the i2c_scheduler.h API without the scheduler task: devices
+ * must have a transport (see i2c_sched_set_device_transport()), which is
+ * called synchronously in the caller's thread. Classes, mux routes and bus
+ * statistics are accepted and ignored.
+ */
+
+#include <string.h>
+#include "i2c_scheduler.h"
+
+typedef struct {
+    i2c_master_dev_handle_t dev;
+    i2c_sched_transfer_fn_t transfer;
+    void *ctx;
+} direct_device_t;
+
+static direct_device_t s_devices[I2C_SCHED_MAX_DEVICES];
+
+static direct_device_t *find_device(i2c_master_dev_handle_t dev)
+{
+    for (size_t i = 0; i < I2C_SCHED_MAX_DEVICES; i++) {
+        if (s_devices[i].dev == dev) {
+            return &s_devices[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t i2c_sched_init(UBaseType_t priority)
+{
+    (void)priority;
+    return ESP_OK;
+}
+
+esp_err_t i2c_sched_register_device(i2c_master_dev_handle_t dev, uint16_t address, const char *name)
+{
+    (void)address;
+    (void)name;
+    if (dev == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (find_device(dev) != NULL) {
+        return ESP_OK;
+    }
+    direct_device_t *slot = find_device(NULL);
+    if (slot == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    slot->dev = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_sched_set_mux_route(i2c_master_dev_handle_t dev, i2c_master_dev_handle_t mux_dev,
+                                  uint8_t port)
+{
+    (void)dev;
+    (void)mux_dev;
+    (void)port;
+    return ESP_OK;
+}
+
+esp_err_t i2c_sched_set_device_transport(i2c_master_dev_handle_t dev, i2c_sched_transfer_fn_t transfer,
+                                         void *ctx)
+{
+    direct_device_t *d = find_device(dev);
+    if (d == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    d->transfer = transfer;
+    d->ctx = ctx;
+    return ESP_OK;
+}
+
+esp_err_t i2c_sched_set_task_class(TaskHandle_t task, i2c_sched_class_t cls)
+{
+    (void)task;
+    (void)cls;
+    return ESP_OK;
+}
+
+i2c_sched_class_t i2c_sched_task_class(void)
+{
+    return I2C_SCHED_CLASS_REALTIME;
+}
+
+esp_err_t i2c_sched_submit(const i2c_sched_op_t *ops, size_t count, i2c_sched_class_t cls)
+{
+    (void)cls;
+    if (ops == NULL || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < count; i++) {
+        direct_device_t *d = find_device(ops[i].dev);
+        if (d == NULL || d->transfer == NULL) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        esp_err_t ret = d->transfer(d->ctx, ops[i].write_buf, ops[i].write_len,
+                                    ops[i].read_buf, ops[i].read_len, ops[i].timeout_ms);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_sched_transmit(i2c_master_dev_handle_t dev, const uint8_t *write_buf,
+                             size_t write_len, int timeout_ms)
+{
+    i2c_sched_op_t op = {
+        .dev = dev, .write_buf = write_buf, .write_len = write_len, .timeout_ms = timeout_ms,
+    };
+    return i2c_sched_submit(&op, 1, I2C_SCHED_CLASS_REALTIME);
+}
+
+esp_err_t i2c_sched_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *write_buf,
+                                     size_t write_len, uint8_t *read_buf, size_t read_len,
+                                     int timeout_ms)
+{
+    i2c_sched_op_t op = {
+        .dev = dev, .write_buf = write_buf, .write_len = write_len,
+        .read_buf = read_buf, .read_len = read_len, .timeout_ms = timeout_ms,
+    };
+    return i2c_sched_submit(&op, 1, I2C_SCHED_CLASS_REALTIME);
+}
+
+size_t i2c_sched_get_stats(i2c_sched_device_stats_t *out, size_t max_devices)
+{
+    (void)out;
+    (void)max_devices;
+    return 0;
+}
+
+void i2c_sched_reset_stats(void)
+{
+}
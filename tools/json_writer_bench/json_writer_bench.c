@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host benchmark: JSON response building with json_writer vs cJSON
+ *
+ * Builds documents shaped like the GET /api/status, /api/nau7802 and
+ * /api/nau7802/history responses, the way the firmware does, and reports
+ * output bytes per second and heap allocations per document. The writer's
+ * output goes to a counting sink; the cJSON path builds the tree, prints it
+ * with cJSON_Print (as send_json_response did) and frees everything.
+ *
+ * Writer only:
+ *   gcc -O2 -I../../components/webui/src json_writer_bench.c \
+ *       ../../components/webui/src/json_writer.c -o json_writer_bench
+ *
+ * With the cJSON comparison (the copy shipped with ESP-IDF):
+ *   gcc -O2 -DWITH_CJSON -I../../components/webui/src -I$IDF_PATH/components/json/cJSON \
+ *       json_writer_bench.c ../../components/webui/src/json_writer.c \
+ *       $IDF_PATH/components/json/cJSON/cJSON.c -o json_writer_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "json_writer.h"
+#ifdef WITH_CJSON
+#include "cJSON.h"
+#endif
+
+#define HISTORY_SAMPLES 256
+
+static size_t s_allocs;
+static size_t s_alloc_bytes;
+
+static void *counting_malloc(size_t size)
+{
+    s_allocs++;
+    s_alloc_bytes += size;
+    return malloc(size);
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Writer sink: count bytes, keep the last chunk live so nothing is optimized out
+typedef struct {
+    size_t bytes;
+    size_t chunks;
+    unsigned check;
+} sink_t;
+
+static bool sink_flush(void *ctx, const char *data, size_t len)
+{
+    sink_t *sink = (sink_t *)ctx;
+    sink->bytes += len;
+    sink->chunks++;
+    sink->check += (unsigned char)data[len - 1];
+    return true;
+}
+
+/* ---- Documents written with json_writer ---- */
+
+static void writer_status(json_writer_t *w)
+{
+    json_writer_object_begin(w, NULL);
+    json_writer_object_begin(w, "input_assembly_100");
+    json_writer_array_begin(w, "raw_bytes");
+    for (int i = 0; i < 32; i++) {
+        json_writer_uint(w, NULL, (i * 37) & 0xFF);
+    }
+    json_writer_array_end(w);
+    json_writer_object_begin(w, "nau7802");
+    json_writer_int(w, "weight_scaled", 123456);
+    json_writer_float(w, "weight", 1234.56f);
+    json_writer_string(w, "unit", "g");
+    json_writer_uint(w, "unit_code", 0);
+    json_writer_int(w, "raw_reading", -8388000);
+    json_writer_uint(w, "byte_offset", 0);
+    json_writer_bool(w, "available", true);
+    json_writer_bool(w, "connected", true);
+    json_writer_bool(w, "initialized", true);
+    json_writer_bool(w, "stable", true);
+    json_writer_bool(w, "in_motion", false);
+    json_writer_bool(w, "center_of_zero", false);
+    json_writer_uint(w, "status_byte", 0x0F);
+    json_writer_object_end(w);
+    json_writer_object_end(w);
+    json_writer_object_begin(w, "output_assembly_150");
+    json_writer_array_begin(w, "raw_bytes");
+    for (int i = 0; i < 32; i++) {
+        json_writer_uint(w, NULL, 0);
+    }
+    json_writer_array_end(w);
+    json_writer_object_end(w);
+    json_writer_object_begin(w, "stream");
+    json_writer_uint(w, "clients", 2);
+    json_writer_uint(w, "frames", 48213);
+    json_writer_uint(w, "sends", 96426);
+    json_writer_uint(w, "bytes", 14000212);
+    json_writer_uint(w, "dropped", 0);
+    json_writer_uint(w, "build_us", 1523300);
+    json_writer_uint(w, "fanout_us", 3012200);
+    json_writer_object_end(w);
+    json_writer_object_end(w);
+}
+
+static void writer_nau7802(json_writer_t *w)
+{
+    json_writer_object_begin(w, NULL);
+    json_writer_uint(w, "scale", 0);
+    json_writer_uint(w, "scale_count", 1);
+    json_writer_bool(w, "enabled", true);
+    json_writer_uint(w, "byte_offset", 0);
+    json_writer_uint(w, "unit", 0);
+    json_writer_uint(w, "gain", 7);
+    json_writer_uint(w, "sample_rate", 3);
+    json_writer_uint(w, "channel", 0);
+    json_writer_uint(w, "ldo_value", 4);
+    json_writer_uint(w, "average", 4);
+    json_writer_bool(w, "initialized", true);
+    json_writer_string(w, "gain_label", "x128");
+    json_writer_string(w, "sample_rate_label", "80");
+    json_writer_string(w, "unit_label", "g");
+    json_writer_string(w, "channel_label", "Channel 1");
+    json_writer_float(w, "ldo_voltage", 3.3f);
+    json_writer_bool(w, "connected", true);
+    json_writer_int(w, "raw_reading", -8388000);
+    json_writer_bool(w, "available", true);
+    json_writer_float(w, "weight", 1234.56f);
+    json_writer_string(w, "unit", "g");
+    json_writer_uint(w, "unit_code", 0);
+    json_writer_float(w, "calibration_factor", 412.3771f);
+    json_writer_float(w, "zero_offset", -8897541.0f);
+    json_writer_uint(w, "revision_code", 15);
+    json_writer_object_begin(w, "channel1");
+    json_writer_int(w, "offset", -1201);
+    json_writer_uint(w, "gain", 8388608);
+    json_writer_object_end(w);
+    json_writer_object_begin(w, "channel2");
+    json_writer_int(w, "offset", 0);
+    json_writer_uint(w, "gain", 8388608);
+    json_writer_object_end(w);
+    json_writer_object_begin(w, "status");
+    json_writer_bool(w, "available", true);
+    json_writer_bool(w, "power_digital", true);
+    json_writer_bool(w, "power_analog", true);
+    json_writer_bool(w, "power_regulator", true);
+    json_writer_bool(w, "calibration_active", false);
+    json_writer_bool(w, "calibration_error", false);
+    json_writer_bool(w, "oscillator_ready", true);
+    json_writer_bool(w, "avdd_ready", true);
+    json_writer_object_end(w);
+    json_writer_object_end(w);
+}
+
+static void writer_history(json_writer_t *w)
+{
+    json_writer_object_begin(w, NULL);
+    json_writer_string(w, "status", "ok");
+    json_writer_uint(w, "next", 100256);
+    json_writer_uint(w, "lost", 0);
+    json_writer_uint(w, "count", HISTORY_SAMPLES);
+    json_writer_uint(w, "capacity", 4096);
+    json_writer_array_begin(w, "samples");
+    for (int i = 0; i < HISTORY_SAMPLES; i++) {
+        json_writer_array_begin(w, NULL);
+        json_writer_uint(w, NULL, 100000 + i);
+        json_writer_uint(w, NULL, 1250000000u + i * 12500u);
+        json_writer_int(w, NULL, -8388000 + i * 17);
+        json_writer_float(w, NULL, 1234.56f + i * 0.01f);
+        json_writer_array_end(w);
+    }
+    json_writer_array_end(w);
+    json_writer_object_end(w);
+}
+
+#ifdef WITH_CJSON
+/* ---- The same documents built with cJSON ---- */
+
+static cJSON *cjson_status(void)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON *input = cJSON_CreateObject();
+    cJSON *bytes = cJSON_CreateArray();
+    for (int i = 0; i < 32; i++) {
+        cJSON_AddItemToArray(bytes, cJSON_CreateNumber((i * 37) & 0xFF));
+    }
+    cJSON_AddItemToObject(input, "raw_bytes", bytes);
+    cJSON *nau = cJSON_CreateObject();
+    cJSON_AddNumberToObject(nau, "weight_scaled", 123456);
+    cJSON_AddNumberToObject(nau, "weight", 1234.56f);
+    cJSON_AddStringToObject(nau, "unit", "g");
+    cJSON_AddNumberToObject(nau, "unit_code", 0);
+    cJSON_AddNumberToObject(nau, "raw_reading", -8388000);
+    cJSON_AddNumberToObject(nau, "byte_offset", 0);
+    cJSON_AddBoolToObject(nau, "available", true);
+    cJSON_AddBoolToObject(nau, "connected", true);
+    cJSON_AddBoolToObject(nau, "initialized", true);
+    cJSON_AddBoolToObject(nau, "stable", true);
+    cJSON_AddBoolToObject(nau, "in_motion", false);
+    cJSON_AddBoolToObject(nau, "center_of_zero", false);
+    cJSON_AddNumberToObject(nau, "status_byte", 0x0F);
+    cJSON_AddItemToObject(input, "nau7802", nau);
+    cJSON_AddItemToObject(json, "input_assembly_100", input);
+    cJSON *output = cJSON_CreateObject();
+    bytes = cJSON_CreateArray();
+    for (int i = 0; i < 32; i++) {
+        cJSON_AddItemToArray(bytes, cJSON_CreateNumber(0));
+    }
+    cJSON_AddItemToObject(output, "raw_bytes", bytes);
+    cJSON_AddItemToObject(json, "output_assembly_150", output);
+    cJSON *stream = cJSON_CreateObject();
+    cJSON_AddNumberToObject(stream, "clients", 2);
+    cJSON_AddNumberToObject(stream, "frames", 48213);
+    cJSON_AddNumberToObject(stream, "sends", 96426);
+    cJSON_AddNumberToObject(stream, "bytes", 14000212);
+    cJSON_AddNumberToObject(stream, "dropped", 0);
+    cJSON_AddNumberToObject(stream, "build_us", 1523300);
+    cJSON_AddNumberToObject(stream, "fanout_us", 3012200);
+    cJSON_AddItemToObject(json, "stream", stream);
+    return json;
+}
+
+static cJSON *cjson_nau7802(void)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "scale", 0);
+    cJSON_AddNumberToObject(json, "scale_count", 1);
+    cJSON_AddBoolToObject(json, "enabled", true);
+    cJSON_AddNumberToObject(json, "byte_offset", 0);
+    cJSON_AddNumberToObject(json, "unit", 0);
+    cJSON_AddNumberToObject(json, "gain", 7);
+    cJSON_AddNumberToObject(json, "sample_rate", 3);
+    cJSON_AddNumberToObject(json, "channel", 0);
+    cJSON_AddNumberToObject(json, "ldo_value", 4);
+    cJSON_AddNumberToObject(json, "average", 4);
+    cJSON_AddBoolToObject(json, "initialized", true);
+    cJSON_AddStringToObject(json, "gain_label", "x128");
+    cJSON_AddStringToObject(json, "sample_rate_label", "80");
+    cJSON_AddStringToObject(json, "unit_label", "g");
+    cJSON_AddStringToObject(json, "channel_label", "Channel 1");
+    cJSON_AddNumberToObject(json, "ldo_voltage", 3.3f);
+    cJSON_AddBoolToObject(json, "connected", true);
+    cJSON_AddNumberToObject(json, "raw_reading", -8388000);
+    cJSON_AddBoolToObject(json, "available", true);
+    cJSON_AddNumberToObject(json, "weight", 1234.56f);
+    cJSON_AddStringToObject(json, "unit", "g");
+    cJSON_AddNumberToObject(json, "unit_code", 0);
+    cJSON_AddNumberToObject(json, "calibration_factor", 412.3771f);
+    cJSON_AddNumberToObject(json, "zero_offset", -8897541.0f);
+    cJSON_AddNumberToObject(json, "revision_code", 15);
+    cJSON *ch1 = cJSON_CreateObject();
+    cJSON_AddNumberToObject(ch1, "offset", -1201);
+    cJSON_AddNumberToObject(ch1, "gain", 8388608);
+    cJSON_AddItemToObject(json, "channel1", ch1);
+    cJSON *ch2 = cJSON_CreateObject();
+    cJSON_AddNumberToObject(ch2, "offset", 0);
+    cJSON_AddNumberToObject(ch2, "gain", 8388608);
+    cJSON_AddItemToObject(json, "channel2", ch2);
+    cJSON *status = cJSON_CreateObject();
+    cJSON_AddBoolToObject(status, "available", true);
+    cJSON_AddBoolToObject(status, "power_digital", true);
+    cJSON_AddBoolToObject(status, "power_analog", true);
+    cJSON_AddBoolToObject(status, "power_regulator", true);
+    cJSON_AddBoolToObject(status, "calibration_active", false);
+    cJSON_AddBoolToObject(status, "calibration_error", false);
+    cJSON_AddBoolToObject(status, "oscillator_ready", true);
+    cJSON_AddBoolToObject(status, "avdd_ready", true);
+    cJSON_AddItemToObject(json, "status", status);
+    return json;
+}
+
+static cJSON *cjson_history(void)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "status", "ok");
+    cJSON_AddNumberToObject(json, "next", 100256);
+    cJSON_AddNumberToObject(json, "lost", 0);
+    cJSON_AddNumberToObject(json, "count", HISTORY_SAMPLES);
+    cJSON_AddNumberToObject(json, "capacity", 4096);
+    cJSON *samples = cJSON_CreateArray();
+    for (int i = 0; i < HISTORY_SAMPLES; i++) {
+        cJSON *sample = cJSON_CreateArray();
+        cJSON_AddItemToArray(sample, cJSON_CreateNumber(100000 + i));
+        cJSON_AddItemToArray(sample, cJSON_CreateNumber(1250000000u + i * 12500u));
+        cJSON_AddItemToArray(sample, cJSON_CreateNumber(-8388000 + i * 17));
+        cJSON_AddItemToArray(sample, cJSON_CreateNumber(1234.56f + i * 0.01f));
+        cJSON_AddItemToArray(samples, sample);
+    }
+    cJSON_AddItemToObject(json, "samples", samples);
+    return json;
+}
+#endif
+
+typedef struct {
+    const char *name;
+    void (*writer)(json_writer_t *w);
+#ifdef WITH_CJSON
+    cJSON *(*cjson)(void);
+#endif
+} document_t;
+
+static const document_t s_documents[] = {
+#ifdef WITH_CJSON
+    { "status", writer_status, cjson_status },
+    { "nau7802", writer_nau7802, cjson_nau7802 },
+    { "history", writer_history, cjson_history },
+#else
+    { "status", writer_status },
+    { "nau7802", writer_nau7802 },
+    { "history", writer_history },
+#endif
+};
+
+static void report(const char *doc, const char *path, size_t iterations, size_t bytes,
+                   double elapsed, size_t allocs, size_t alloc_bytes)
+{
+    printf("%-8s %-7s %8zu %10.0f %10.2f %9.1f %12.0f\n", doc, path, bytes / iterations,
+           iterations / elapsed, bytes / elapsed / 1e6, (double)allocs / iterations,
+           (double)alloc_bytes / iterations);
+}
+
+int main(int argc, char **argv)
+{
+    size_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : 20000;
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+#ifdef WITH_CJSON
+    cJSON_Hooks hooks = { counting_malloc, free };
+    cJSON_InitHooks(&hooks);
+#else
+    (void)counting_malloc;
+#endif
+
+    printf("%-8s %-7s %8s %10s %10s %9s %12s\n",
+           "document", "path", "bytes", "docs/s", "MB/s", "allocs", "alloc bytes");
+    for (size_t d = 0; d < sizeof(s_documents) / sizeof(s_documents[0]); d++) {
+        const document_t *doc = &s_documents[d];
+
+        // The writer lives on the stack and has no allocator calls (nm json_writer.o
+        // shows no malloc), so its counters stay at zero
+        sink_t sink = { 0 };
+        s_allocs = 0;
+        s_alloc_bytes = 0;
+        double start = now_s();
+        for (size_t i = 0; i < iterations; i++) {
+            json_writer_t w;
+            json_writer_init(&w, sink_flush, &sink);
+            doc->writer(&w);
+            if (!json_writer_finish(&w)) {
+                fprintf(stderr, "%s: writer failed\n", doc->name);
+                return 1;
+            }
+        }
+        report(doc->name, "writer", iterations, sink.bytes, now_s() - start, s_allocs, s_alloc_bytes);
+
+#ifdef WITH_CJSON
+        size_t bytes = 0;
+        unsigned check = 0;
+        s_allocs = 0;
+        s_alloc_bytes = 0;
+        start = now_s();
+        for (size_t i = 0; i < iterations; i++) {
+            cJSON *json = doc->cjson();
+            char *text = cJSON_Print(json);
+            if (text == NULL) {
+                fprintf(stderr, "%s: cJSON_Print failed\n", doc->name);
+                return 1;
+            }
+            size_t len = strlen(text);
+            bytes += len;
+            check += (unsigned char)text[len - 1];
+            free(text);
+            cJSON_Delete(json);
+        }
+        report(doc->name, "cJSON", iterations, bytes, now_s() - start, s_allocs, s_alloc_bytes);
+        (void)check;
+#endif
+        (void)sink.check;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+Measure the device CPU cost of live stream viewers (GET /api/stream).
+
+Opens an increasing number of Server-Sent Events connections to the device
+and, for each step, reads the stream counters from GET /api/status at the
+start and end of a measurement window. The firmware times frame building
+(stream task) and sending to viewers (HTTP server task) itself, so the
+numbers are device CPU time, not network round trips.
+
+Usage:
+  python sse_stream_bench.py 172.16.82.99
+  python sse_stream_bench.py 172.16.82.99 --viewers 0 1 2 4 --duration 30
+
+Load a scale (or run a CONFIG_OPENER_NAU7802_SIMULATED build) so values
+change and frames are sent at the configured maximum rate.
+"""
+
+import argparse
+import json
+import socket
+import sys
+import threading
+import time
+import urllib.request
+
+
+def get_stream_stats(host, port):
+    """Read the stream counters from /api/status."""
+    with urllib.request.urlopen(f"http://{host}:{port}/api/status", timeout=5) as resp:
+        return json.load(resp)["stream"]
+
+
+class Viewer(threading.Thread):
+    """One SSE connection that counts the events it receives."""
+
+    def __init__(self, host, port):
+        super().__init__(daemon=True)
+        self.sock = socket.create_connection((host, port), timeout=10)
+        self.sock.sendall(f"GET /api/stream HTTP/1.1\r\nHost: {host}\r\n"
+                          "Accept: text/event-stream\r\n\r\n".encode())
+        self.events = 0
+        self.bytes = 0
+        self.error = None
+        self.running = True
+
+    def run(self):
+        try:
+            while self.running:
+                data = self.sock.recv(4096)
+                if not data:
+                    self.error = "closed by device"
+                    return
+                self.bytes += len(data)
+                self.events += data.count(b"event: scale")
+        except OSError as e:
+            if self.running:
+                self.error = str(e)
+
+    def close(self):
+        self.running = False
+        try:
+            self.sock.close()
+        except OSError:
+            pass
+
+
+def delta(after, before, key):
+    return (after[key] - before[key]) & 0xFFFFFFFF
+
+
+def measure(host, port, viewers, duration, warmup):
+    clients = [Viewer(host, port) for _ in range(viewers)]
+    for c in clients:
+        c.start()
+    time.sleep(warmup)
+
+    events_before = [c.events for c in clients]
+    before = get_stream_stats(host, port)
+    start = time.monotonic()
+    time.sleep(duration)
+    after = get_stream_stats(host, port)
+    elapsed = time.monotonic() - start
+    events = [c.events - e for c, e in zip(clients, events_before)]
+    errors = [c.error for c in clients if c.error]
+
+    for c in clients:
+        c.close()
+    time.sleep(1)  # Let the device see the connections close
+
+    build_us = delta(after, before, "build_us") / elapsed
+    fanout_us = delta(after, before, "fanout_us") / elapsed
+    return {
+        "viewers": viewers,
+        "connected": after["clients"],
+        "frames_per_s": delta(after, before, "frames") / elapsed,
+        "events_per_viewer_s": (sum(events) / len(events) / elapsed) if events else 0.0,
+        "bytes_per_s": delta(after, before, "bytes") / elapsed,
+        "build_us_per_s": build_us,
+        "fanout_us_per_s": fanout_us,
+        "fanout_us_per_viewer_s": fanout_us / viewers if viewers else 0.0,
+        "cpu_percent": (build_us + fanout_us) / 1e4,
+        "dropped": delta(after, before, "dropped"),
+        "errors": errors,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure device CPU per live stream viewer")
+    parser.add_argument("host", help="Device IP address")
+    parser.add_argument("--port", type=int, default=80, help="HTTP port (default: 80)")
+    parser.add_argument("--viewers", type=int, nargs="+", default=[0, 1, 2, 4],
+                        help="Viewer counts to measure (default: 0 1 2 4)")
+    parser.add_argument("--duration", type=float, default=20.0, help="Measurement window per step in seconds")
+    parser.add_argument("--warmup", type=float, default=3.0, help="Seconds to wait after connecting")
+    args = parser.parse_args()
+
+    try:
+        get_stream_stats(args.host, args.port)
+    except Exception as e:
+        print(f"Cannot read stream counters from http://{args.host}:{args.port}/api/status: {e}")
+        return 1
+
+    print(f"{'viewers':>7} {'frames/s':>9} {'events/s':>9} {'KB/s':>7} "
+          f"{'build us/s':>11} {'send us/s':>10} {'us/s/viewer':>12} {'CPU %':>6} {'dropped':>8}")
+    for n in args.viewers:
+        r = measure(args.host, args.port, n, args.duration, args.warmup)
+        print(f"{r['viewers']:>7} {r['frames_per_s']:>9.2f} {r['events_per_viewer_s']:>9.2f} "
+              f"{r['bytes_per_s'] / 1024:>7.2f} {r['build_us_per_s']:>11.1f} {r['fanout_us_per_s']:>10.1f} "
+              f"{r['fanout_us_per_viewer_s']:>12.1f} {r['cpu_percent']:>6.3f} {r['dropped']:>8}")
+        if r["connected"] != n:
+            print(f"        note: device reported {r['connected']} viewers during the window")
+        for err in r["errors"]:
+            print(f"        viewer error: {err}")
+
+    print()
+    print("CPU % is the share of one core spent building and sending frames.")
+    print("lwIP's own per-segment work in the TCP/IP task is not included.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""
+Decode the binary trace rings of a device (CONFIG_OPENER_BINARY_TRACE).
+
+With binary trace enabled, OPENER_TRACE_* calls store the address of the
+format string, a microsecond timestamp and the raw argument words instead of
+printing. This tool reads a dump of the rings (GET /api/trace), looks up the
+format strings (and %s arguments that point into the image) in the firmware
+ELF, formats the lines and prints the records of all cores in time order.
+
+Usage:
+  python trace_decode.py build/ENIP-Scale.elf --host 172.16.82.99
+  python trace_decode.py build/ENIP-Scale.elf --host 172.16.82.99 --save trace.bin --clear
+  python trace_decode.py build/ENIP-Scale.elf trace.bin
+
+The ELF must be the one the device is running; the dump carries its SHA-256
+and the tool refuses a mismatch unless --ignore-sha is given.
+"""
+
+import argparse
+import hashlib
+import re
+import struct
+import sys
+import urllib.request
+
+DUMP_MAGIC = 0x43525442  # "BTRC"
+DUMP_VERSION = 1
+RECORD_MAGIC = 0xB7
+MAX_ARGS = 14
+HEADER = struct.Struct("<IHHII32s")
+CORE_HEADER = struct.Struct("<III")
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+# printf conversion: flags, width, precision, length modifier, conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXcspfFeEgGaA%])")
+
+
+class Elf:
+    """Bytes of the allocated sections of a little-endian ELF32 image, by address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        self.sha256 = hashlib.sha256(self.data).digest()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError(f"{path} is not a little-endian 32-bit ELF file")
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, sh_flags, sh_addr, sh_offset, sh_size) = struct.unpack_from(
+                "<IIIIII", self.data, shoff + i * shentsize)
+            if sh_flags & SHF_ALLOC and sh_type != SHT_NOBITS and sh_addr and sh_size:
+                self.sections.append((sh_addr, sh_size, sh_offset))
+
+    def string(self, address, limit=512):
+        """NUL-terminated string at a firmware address, or None if not in the image."""
+        for addr, size, offset in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.find(b"\0", start, min(start + limit, offset + size))
+                if end < 0:
+                    return None
+                return self.data[start:end].decode("utf-8", errors="replace")
+        return None
+
+
+def signed(word):
+    return word - (1 << 32) if word & 0x80000000 else word
+
+
+def format_line(elf, fmt, args):
+    """Expand a printf format string with 32-bit argument words."""
+    args = list(args)
+
+    def take():
+        return args.pop(0) if args else 0
+
+    def expand(m):
+        flags, width, precision, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if width == "*":
+            width = str(signed(take()))
+        if precision == "*":
+            precision = str(signed(take()))
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+        word = take()
+        if conv in "di":
+            return (spec + "d") % signed(word)
+        if conv in "ouxX":
+            return (spec + conv) % word
+        if conv == "c":
+            return (spec + "c") % chr(word & 0xFF)
+        if conv == "p":
+            return f"0x{word:08x}"
+        if conv == "s":
+            text = elf.string(word) if word else "(null)"
+            if text is None:
+                text = f"<0x{word:08x}>"
+            return (spec + "s") % text
+        value = struct.unpack("<f", struct.pack("<I", word))[0]
+        return (spec + ("e" if conv in "aA" else conv)) % value
+
+    try:
+        return CONVERSION.sub(expand, fmt)
+    except (TypeError, ValueError) as e:
+        return f"{fmt!r} {[hex(a) for a in args]} ({e})"
+
+
+def parse_dump(data):
+    """Split a dump into its header and (core, overwritten, words) per core."""
+    if len(data) < HEADER.size:
+        raise ValueError("dump is too short")
+    magic, version, cores, now_us, ring_words, sha = HEADER.unpack_from(data, 0)
+    if magic != DUMP_MAGIC:
+        raise ValueError("not a binary trace dump (bad magic)")
+    if version != DUMP_VERSION:
+        raise ValueError(f"unsupported dump version {version}")
+    offset = HEADER.size
+    rings = []
+    for _ in range(cores):
+        core, count, overwritten = CORE_HEADER.unpack_from(data, offset)
+        offset += CORE_HEADER.size
+        words = struct.unpack_from(f"<{count}I", data, offset)
+        offset += count * 4
+        rings.append((core, overwritten, words))
+    return {"now_us": now_us, "ring_words": ring_words, "sha256": sha}, rings
+
+
+def records(core, words):
+    """Yield (timestamp_us, core, fmt_address, args) for the records of one ring."""
+    i = 0
+    while i + 3 <= len(words):
+        head = words[i]
+        nargs = head & 0xFF
+        if head >> 24 != RECORD_MAGIC or nargs > MAX_ARGS or i + 3 + nargs > len(words):
+            print(f"# core {core}: corrupt record at word {i}, rest of ring skipped", file=sys.stderr)
+            return
+        yield words[i + 2], core, words[i + 1], words[i + 3:i + 3 + nargs]
+        i += 3 + nargs
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the device's binary trace")
+    parser.add_argument("elf", help="Firmware ELF the device is running")
+    parser.add_argument("dump", nargs="?", help="Dump file saved from /api/trace")
+    parser.add_argument("--host", help="Fetch the dump from this device instead of a file")
+    parser.add_argument("--port", type=int, default=80, help="HTTP port (default: 80)")
+    parser.add_argument("--clear", action="store_true", help="Clear the rings after fetching")
+    parser.add_argument("--save", help="Also write the fetched dump to this file")
+    parser.add_argument("--ignore-sha", action="store_true", help="Decode even if the ELF does not match")
+    args = parser.parse_args()
+
+    if (args.dump is None) == (args.host is None):
+        parser.error("give either a dump file or --host")
+
+    if args.host:
+        url = f"http://{args.host}:{args.port}/api/trace" + ("?clear=true" if args.clear else "")
+        with urllib.request.urlopen(url, timeout=10) as resp:
+            data = resp.read()
+        if args.save:
+            with open(args.save, "wb") as f:
+                f.write(data)
+    else:
+        with open(args.dump, "rb") as f:
+            data = f.read()
+
+    elf = Elf(args.elf)
+    header, rings = parse_dump(data)
+    if header["sha256"] != elf.sha256:
+        print(f"ELF SHA-256 {elf.sha256.hex()[:16]}... does not match the device "
+              f"({header['sha256'].hex()[:16]}...)", file=sys.stderr)
+        if not args.ignore_sha:
+            return 1
+
+    now = header["now_us"]
+    merged = []
+    for core, overwritten, words in rings:
+        if overwritten:
+            print(f"# core {core}: {overwritten} older records overwritten", file=sys.stderr)
+        merged.extend(records(core, words))
+    # Timestamps are 32-bit microseconds; order by age so a wrap sorts correctly
+    merged.sort(key=lambda r: (now - r[0]) & 0xFFFFFFFF, reverse=True)
+
+    for timestamp, core, fmt_address, words in merged:
+        fmt = elf.string(fmt_address)
+        if fmt is None:
+            text = f"<format 0x{fmt_address:08x}> {' '.join(f'0x{w:x}' for w in words)}"
+        else:
+            text = format_line(elf, fmt, words).rstrip("\n")
+        print(f"[{timestamp // 1000000:5d}.{timestamp % 1000000:06d}] C{core} {text}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())